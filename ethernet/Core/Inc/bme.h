@@ -16,9 +16,17 @@ typedef struct {
 } bme280_data_t;
 
 void bme280_init(I2C_HandleTypeDef *hi2c);
-bool bme280_read(bme280_data_t *out);
+
+/* Start a forced conversion: the trigger and the result burst go over I2C
+   by interrupt, nothing here waits. Ignored while one is still running. */
 void bme280_forced_measure(void);
 
+/* Advance the conversion, call from the main loop */
+void bme280_process(void);
+
+/* Compensated values of a finished conversion, once; false when none */
+bool bme280_read(bme280_data_t *out);
+
 
 
 #endif /* INC_BME_H_ */
@@ -21,6 +21,17 @@
 #define REG_CONFIG    0xF5
 #define REG_PRESS_MSB 0xF7
 
+#define BME280_MEAS_MS      10  // Forced conversion, x1 oversampling: 9.3 ms max
+#define BME280_XFER_MS      50  // An I2C transfer not done by then is given up
+
+typedef enum {
+    BME_IDLE,
+    BME_TRIGGER,        // ctrl_meas write in flight
+    BME_CONVERTING,     // Waiting BME280_MEAS_MS
+    BME_READING,        // Burst read from 0xF7 in flight
+    BME_DONE            // bme_raw holds a result for bme280_read()
+} bme_state_t;
+
 static I2C_HandleTypeDef *bme_i2c;
 
 static uint16_t dig_T1;
@@ -32,6 +43,12 @@ static int16_t  dig_H2, dig_H4, dig_H5;
 static int8_t   dig_H6;
 static int32_t  t_fine;
 
+static bool bme_present = false;
+static volatile uint8_t bme_state = BME_IDLE;
+static volatile uint32_t bme_state_at;  // HAL tick the current state began
+static uint8_t bme_ctrl;                // Sent by interrupt, must outlive the call
+static uint8_t bme_raw[8];
+
 static void bme_read_calibration(void);
 static uint8_t bme_read8(uint8_t reg);
 static void bme_read_buf(uint8_t reg, uint8_t *buf, uint16_t len);
@@ -52,18 +69,69 @@ void bme280_init(I2C_HandleTypeDef *hi2c)
     bme_write8(REG_CTRL_HUM, 0x01);
     bme_write8(REG_CONFIG, 0x00);
     bme_write8(REG_CTRL_MEAS, 0x25);
+    bme_present = true;
 }
 
 void bme280_forced_measure(void)
 {
-    uint8_t ctrl = 0x25 | 0x01; // forced mode
-    bme_write8(REG_CTRL_MEAS, ctrl);
+    if (!bme_present || bme_state != BME_IDLE) return;
+
+    bme_ctrl = 0x25 | 0x01; // forced mode
+    bme_state_at = HAL_GetTick();
+    bme_state = BME_TRIGGER;
+    if (HAL_I2C_Mem_Write_IT(bme_i2c, BME280_ADDR, REG_CTRL_MEAS, I2C_MEMADD_SIZE_8BIT,
+                             &bme_ctrl, 1) != HAL_OK) {
+        bme_state = BME_IDLE;
+    }
+}
+
+void bme280_process(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    switch (bme_state) {
+    case BME_CONVERTING:
+        if (now - bme_state_at < BME280_MEAS_MS) break;
+        bme_state_at = now;
+        bme_state = BME_READING;
+        if (HAL_I2C_Mem_Read_IT(bme_i2c, BME280_ADDR, REG_PRESS_MSB, I2C_MEMADD_SIZE_8BIT,
+                                bme_raw, sizeof(bme_raw)) != HAL_OK) {
+            bme_state = BME_IDLE;
+        }
+        break;
+    case BME_TRIGGER:
+    case BME_READING:
+        // No completion or error callback: drop it, the next trigger retries
+        if (now - bme_state_at > BME280_XFER_MS) bme_state = BME_IDLE;
+        break;
+    default:
+        break;
+    }
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c != bme_i2c || bme_state != BME_TRIGGER) return;
+    bme_state_at = HAL_GetTick();
+    bme_state = BME_CONVERTING;
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c == bme_i2c && bme_state == BME_READING) bme_state = BME_DONE;
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+    if (hi2c == bme_i2c) bme_state = BME_IDLE;
 }
 
 bool bme280_read(bme280_data_t *out)
 {
-    uint8_t buf[8];
-    bme_read_buf(REG_PRESS_MSB, buf, 8);
+    if (bme_state != BME_DONE) return false;
+    bme_state = BME_IDLE;   // bme_raw is only refilled from bme280_process()
+
+    const uint8_t *buf = bme_raw;
 
     int32_t adc_P = ((int32_t)buf[0] << 12) | ((int32_t)buf[1] << 4) | (buf[2] >> 4);
     int32_t adc_T = ((int32_t)buf[3] << 12) | ((int32_t)buf[4] << 4) | (buf[5] >> 4);
@@ -358,10 +358,6 @@ int main(void) {
 	            last_sensor_poll = now;
 
 	            bme280_forced_measure();
-	            HAL_Delay(10);
-	            if(bme280_read(&bme_data)) {
-	                bme_data.last_update = now;
-	            }
 
 	            gps_data = gps_get_last_position();
 	            if(gps_data.valid) {
@@ -369,6 +365,12 @@ int main(void) {
 	            }
 	        }
 
+	        // Conversion result arrives ~10 ms after the trigger above
+	        bme280_process();
+	        if(bme280_read(&bme_data)) {
+	            bme_data.last_update = now;
+	        }
+
 	        if(now - last_display_update > 1000) {
 	            last_display_update = now;
 	            display_update();
@@ -0,0 +1,14 @@
+#ifndef _BH1750_H_
+#define _BH1750_H_
+
+#include "sensors.h"
+
+#define BH1750_PERIOD_MS    1000    // Read period; continuous H-resolution converts every 120-180 ms
+
+/**
+ * Registry driver (sensors.c): ambient light at 0x23 (ADDR low) or 0x5C,
+ * continuous high-resolution mode, reports SENSOR_LUX
+ */
+extern const sensor_driver_t bh1750_driver;
+
+#endif /* _BH1750_H_ */
@@ -4,21 +4,79 @@
 #define INC_BME_H_
 
 #include "stm32f4xx_hal.h"
+#include "sensors.h"
 #include <stdint.h>
 #include <stdbool.h>
 
+#define BME280_MIN_PERIOD_MS    10
+
+#ifndef BME280_PRESSURE_32BIT
+#define BME280_PRESSURE_32BIT   0       // 1: 32-bit pressure formula, ~1 Pa coarser, no 64-bit divide
+#endif
+
+typedef enum {
+    BME280_MODE_FORCED = 1,     // One measurement per period, sleeps in between
+    BME280_MODE_NORMAL = 3      // Sensor cycles on its own (t_meas + standby), read once per period
+} bme280_mode_t;
+
+/**
+ * Measurement settings, values as in the datasheet (not register codes)
+ */
+typedef struct {
+    const char* name;       // Preset name, "custom" otherwise
+    uint8_t  mode;          // bme280_mode_t
+    uint8_t  osrs_t;        // Oversampling 1, 2, 4, 8, 16 (temperature cannot be skipped)
+    uint8_t  osrs_p;        // Oversampling 0 (skipped), 1, 2, 4, 8, 16
+    uint8_t  osrs_h;
+    uint8_t  filter;        // IIR coefficient 0 (off), 2, 4, 8, 16
+    uint32_t standby_us;    // Normal mode: 500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000
+    uint32_t period_ms;     // Forced: trigger period, normal: read period
+} bme280_profile_t;
+
+/**
+ * Datasheet figures for a profile (section 9)
+ */
 typedef struct {
-    float temperature;   // °C
-    float pressure;      // hPa
-    float humidity;      // %RH
-    uint32_t last_update;
-    bool valid;
-} bme280_data_t;
+    uint32_t meas_typ_us;   // Measurement time, typical
+    uint32_t meas_max_us;   // Measurement time, maximum (forced mode wait)
+    uint32_t odr_mhz;       // Sensor output data rate, mHz
+    uint32_t current_na;    // Average supply current, nA
+} bme280_profile_info_t;
+
+/**
+ * Registry driver (sensors.c): probes 0x76 then 0x77, reads the calibration
+ * and writes the profile at init; reports SENSOR_TEMP, SENSOR_PRESS and
+ * SENSOR_HUM (pressure and humidity unless the profile skips them)
+ */
+extern const sensor_driver_t bme280_driver;
+
+/**
+ * Switch the measurement settings. The register writes are queued on the
+ * I2C bus right away (or after the next sample if the queue is full).
+ * @return 0, or -1 for a value the sensor does not support
+ */
+int bme280_set_profile(const bme280_profile_t *p);
+
+/**
+ * Switch to a built-in profile ("default", "weather", "humidity", "indoor",
+ * "fast"), name not case sensitive
+ * @return 0, or -1 for an unknown name
+ */
+int bme280_set_preset(const char *name);
 
-void bme280_init(I2C_HandleTypeDef *hi2c);
-bool bme280_read(bme280_data_t *out);
-void bme280_forced_measure(void);
+/**
+ * Built-in profile by index, NULL past the last one
+ */
+const bme280_profile_t *bme280_preset(uint8_t i);
 
+/**
+ * Current (or pending) profile
+ */
+void bme280_get_profile(bme280_profile_t *out);
 
+/**
+ * Measurement time, data rate and current for a profile
+ */
+void bme280_profile_info(const bme280_profile_t *p, bme280_profile_info_t *out);
 
 #endif /* INC_BME_H_ */
@@ -8,6 +8,13 @@
 
 #include "main.h"
 
+/* The network may only read state: REBOOT and BME profile changes from
+   /ws (cli_run()) and POST /bme/profile are refused unless the firmware
+   is built with CLI_REMOTE_WRITE=1. The UART CLI can always write. */
+#ifndef CLI_REMOTE_WRITE
+#define CLI_REMOTE_WRITE    0
+#endif
+
 /**
  * @brief Initialize CLI system
  */
@@ -18,4 +25,14 @@ void cli_init(void);
  */
 void cli_process(void);
 
+/**
+ * @brief Execute one command line and capture its output (network CLI,
+ *        read-only unless CLI_REMOTE_WRITE)
+ * @param line Command, NUL terminated
+ * @param out Output buffer (not NUL terminated)
+ * @param out_size Size of out
+ * @return Number of bytes written to out
+ */
+uint16_t cli_run(const char* line, char* out, uint16_t out_size);
+
 #endif /* CLI_H */
@@ -0,0 +1,59 @@
+#ifndef _DHCP_H_
+#define _DHCP_H_
+
+#include <stdint.h>
+#include "wizchip_conf.h"
+
+#define DHCP_SOCKET             1
+#define DHCP_SERVER_PORT        67
+#define DHCP_CLIENT_PORT        68
+
+#define DHCP_RETRY_MS           2000    // First retransmission, doubled up to DHCP_RETRY_MAX_MS
+#define DHCP_RETRY_MAX_MS       16000
+#define DHCP_REQUEST_TRIES      4       // REQUESTs for one OFFER before starting over
+#define DHCP_FALLBACK_MS        10000   // No lease by then -> static fallback address
+#define DHCP_STATIC_RETRY_MS    60000   // DISCOVER interval while on the fallback address
+#define DHCP_RENEW_RETRY_MIN_MS 60000   // Shortest RENEWING / REBINDING retransmission
+
+typedef enum {
+    DHCP_STATE_INIT = 0,    // Socket opening, DISCOVER next
+    DHCP_STATE_SELECTING,   // DISCOVER sent, waiting for an OFFER
+    DHCP_STATE_REQUESTING,  // REQUEST sent for an OFFER, waiting for the ACK
+    DHCP_STATE_BOUND,
+    DHCP_STATE_RENEWING,    // T1 passed, REQUEST unicast to the leasing server
+    DHCP_STATE_REBINDING,   // T2 passed, REQUEST broadcast to any server
+    DHCP_STATE_STATIC       // No lease, fallback address in use, still DISCOVERing
+} dhcp_state_t;
+
+/**
+ * Called after the address was changed with setnetinfo(): a new lease,
+ * the fallback address, or a lease that moved to another address
+ */
+typedef void (*dhcp_callback_t)(void);
+
+/**
+ * Start leasing an address on DHCP_SOCKET
+ * @param fallback Configuration applied when no lease is obtained within
+ *                 DHCP_FALLBACK_MS (mac is taken from the chip)
+ * @param hostname Sent as option 12, may be NULL
+ * @param cb Address change handler, may be NULL
+ */
+void dhcp_init(const wiz_NetInfo* fallback, const char* hostname, dhcp_callback_t cb);
+
+/**
+ * Advance the client: reads replies, sends at most one message and never
+ * waits. Call from the main loop.
+ */
+void dhcp_process(void);
+
+/**
+ * Current client state
+ */
+dhcp_state_t dhcp_get_state(void);
+
+/**
+ * Seconds left on the lease, 0 without one
+ */
+uint32_t dhcp_lease_remaining(void);
+
+#endif /* _DHCP_H_ */
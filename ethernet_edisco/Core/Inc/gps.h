@@ -5,8 +5,8 @@
 #include <stdbool.h>
 
 typedef struct {
-    double lat_deg;
-    double lon_deg;
+    int32_t lat_e7;     // 1e-7 deg, as the receiver reports it
+    int32_t lon_e7;
     uint8_t fix;
     uint8_t sats;
     uint16_t age_ms;
@@ -14,9 +14,54 @@ typedef struct {
     int year, month, day, hour, min, sec;
 } gps_pos_t;
 
+/* UTC time from the receiver and the moment the sentence carrying it began */
+typedef struct {
+    uint32_t unix_sec;  // UTC seconds since 1970
+    uint16_t ms;        // Sub-second part the sentence refers to
+    uint32_t cyc;       // DWT->CYCCNT when the sentence's '$' arrived
+    uint32_t seq;       // Incremented per new time, 0 = no time yet
+} gps_time_ref_t;
+
+#define GPS_MAX_SATS        32      // Satellites kept from GSV per epoch
+#define GPS_MAX_USED        24      // PRNs kept from GSA per epoch
+
+/* One satellite in view (GSV), flagged when GSA lists it as used */
+typedef struct {
+    char     gnss;          // Talker system: 'P' GPS, 'L' GLONASS, 'A' Galileo, 'B' BeiDou...
+    uint8_t  prn;
+    int8_t   elev_deg;
+    uint16_t azim_deg;
+    uint8_t  snr_db;        // 0 = not tracked
+    uint8_t  used;
+} gps_sat_t;
+
+/* Everything the receiver reported for one fix time, merged from
+   RMC/GGA (position), GSA, GSV, VTG and ZDA */
+typedef struct {
+    uint32_t seq;           // Incremented per published epoch, 0 = none yet
+    int      year, month, day;      // RMC or ZDA (4-digit year)
+    int      hour, min, sec, ms;    // Fix time, the key that ties sentences together
+    uint8_t  fix_mode;      // GSA: 1 no fix, 2 2D, 3 3D (0 = not reported)
+    uint16_t pdop, hdop, vdop;      // GSA, x100 (0 = not reported)
+    uint16_t course_cdeg;   // VTG / RMC true course, 0.01 deg (0xFFFF = unknown)
+    uint32_t speed_cms;     // VTG / RMC ground speed, cm/s
+    uint8_t  in_view;       // GSV total, all systems
+    uint8_t  used_count;    // GSA PRNs
+    uint8_t  sat_count;     // Entries in sats
+    gps_sat_t sats[GPS_MAX_SATS];
+    uint32_t parse_us;      // CPU time spent parsing this epoch's sentences
+} gps_epoch_t;
+
 void gps_init(void);
 gps_pos_t gps_get_last_position(void);
 uint32_t gps_get_last_age_ms(void);
+void gps_on_new_position(int32_t lat_e7, int32_t lon_e7, uint8_t fix, uint8_t sats,
+                         int year,int month,int day,int hour,int min,int sec);
+void gps_on_new_time(int year,int month,int day,int hour,int min,int sec,int ms, uint32_t cyc);
+gps_time_ref_t gps_get_time_ref(void);
+void gps_on_epoch(const gps_epoch_t* e);
+void gps_get_epoch(gps_epoch_t* out);
+uint32_t gps_unix_time(int year,int month,int day,int hour,int min,int sec);
 void format_lat_lon(double lat, double lon, char* out, int out_sz, int prec);
 void format_utc_time(int year,int month,int day,int hour,int min,int sec, char* out, int out_sz);
 
@@ -0,0 +1,91 @@
+#ifndef _HISTORY_H_
+#define _HISTORY_H_
+
+#include <stdint.h>
+
+/* Every series keeps three rings of fixed-size blocks. Retention depends
+   on how much the values move; with one byte per quiet raw sample:
+     1 s:  32 blocks x 54 samples  ~ 29 min
+     1 m:  48 blocks x ~15 rollups ~ 12 h
+     1 h:  16 blocks x ~15 rollups ~ 10 days
+   RAM: 9 series x 96 blocks x 64 bytes = 54 KB, plus HISTORY_OUT_SIZE */
+#define HISTORY_BLOCK_SIZE      64
+#define HISTORY_RAW_BLOCKS      32
+#define HISTORY_1M_BLOCKS       48
+#define HISTORY_1H_BLOCKS       16
+#define HISTORY_OUT_SIZE        8192    // Rendered /history body
+
+typedef enum {
+    HISTORY_T_C = 0,        // 0.01 °C
+    HISTORY_P_HPA,          // Pa (0.01 hPa)
+    HISTORY_RH_PCT,         // 0.01 %RH
+    HISTORY_LUX,            // 0.1 lx
+    HISTORY_LAT,            // 1e-7 deg
+    HISTORY_LON,            // 1e-7 deg
+    HISTORY_FIX,            // GGA fix quality
+    HISTORY_SATS,           // Satellites used
+    HISTORY_HDOP,           // 0.01
+    HISTORY_SERIES_COUNT
+} history_series_t;
+
+typedef enum {
+    HISTORY_RES_1S = 0,     // Raw samples
+    HISTORY_RES_1M,         // min/avg/max per minute
+    HISTORY_RES_1H,         // min/avg/max per hour
+    HISTORY_RES_COUNT
+} history_res_t;
+
+#define HISTORY_FMT_JSON        0
+#define HISTORY_FMT_BIN         1
+
+/**
+ * Empty every ring
+ */
+void history_init(void);
+
+/**
+ * Store one sample per series, call once a second. Series not in mask
+ * leave a gap. Minute and hour rollups are written when t_s crosses
+ * into the next interval.
+ * @param t_s Uptime seconds
+ * @param values HISTORY_SERIES_COUNT values in the units above
+ * @param mask Bit (1 << history_series_t) per valid value
+ */
+void history_add(uint32_t t_s, const int32_t* values, uint16_t mask);
+
+/**
+ * Series by its /status name ("t_c", "p_hpa", ...)
+ * @return history_series_t, -1 if unknown
+ */
+int history_series_id(const char* name);
+
+/**
+ * Resolution by name ("1s", "1m", "1h")
+ * @return history_res_t, -1 if unknown
+ */
+int history_res_id(const char* name);
+
+/**
+ * Render the entries at or after since, oldest first.
+ *
+ * JSON: {"series","res","period_s","decimals","uptime_s","unix_s",
+ * "runs":[{"t":<uptime s>,"v":[...]}],"next","more"}. A run has no gaps;
+ * raw values are numbers, rollups [min,avg,max].
+ *
+ * Binary (little-endian): 'H' 'S', u8 version 1, u8 series, u8 res,
+ * u8 decimals, u8 fields (1 raw, 3 rollup), u8 flags (bit 0: more),
+ * u16 period_s, u16 block count, u32 uptime_s, u32 unix_s, u32 next; then
+ * the stored blocks: u32 t0, i32 base, u8 count, u8 length, length bytes of
+ * entries. An entry is the zigzag varint delta to the previous value (the
+ * first to base), rollups followed by varints avg - min and max - avg.
+ * Whole blocks are sent, entries before since included.
+ *
+ * Output stops before HISTORY_OUT_SIZE with "more": the request can be
+ * repeated with since = next.
+ * @param unix_now UTC seconds at uptime_s, 0 if unknown
+ * @return Bytes written, 0 if out is too small for the header
+ */
+uint16_t history_render(history_series_t series, history_res_t res, uint32_t since,
+                        uint8_t format, uint32_t unix_now, char* out, uint16_t size);
+
+#endif /* _HISTORY_H_ */
@@ -0,0 +1,91 @@
+#ifndef _HTTP_PARSER_H_
+#define _HTTP_PARSER_H_
+
+#include <stdint.h>
+
+#define HTTP_MAX_PATH           128     // Request target incl. query, longer -> 414
+#define HTTP_MAX_HEADER_LINE    192     // One header line, longer -> 431
+#define HTTP_MAX_HEADERS_SIZE   2048    // All header lines together, more -> 431
+#define HTTP_MAX_ETAG           64      // If-None-Match kept up to this length
+#define HTTP_WS_KEY_LEN         24      // Sec-WebSocket-Key: base64 of 16 bytes
+
+typedef enum {
+    HTTP_METHOD_OTHER = 0,
+    HTTP_METHOD_GET,
+    HTTP_METHOD_HEAD,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_PUT,
+    HTTP_METHOD_DELETE,
+    HTTP_METHOD_OPTIONS
+} http_method_t;
+
+typedef enum {
+    HTTP_PARSE_MORE = 0,    // Need more bytes
+    HTTP_PARSE_DONE,        // Request complete (head and Content-Length body)
+    HTTP_PARSE_ERROR        // Malformed or over a limit, see status
+} http_parse_result_t;
+
+/* Connection header */
+#define HTTP_CONN_HDR_NONE      0
+#define HTTP_CONN_HDR_CLOSE     1
+#define HTTP_CONN_HDR_KEEPALIVE 2
+
+/* Body framing headers seen */
+#define HTTP_FRAMING_LENGTH     0x01    // Content-Length
+#define HTTP_FRAMING_CHUNKED    0x02    // Transfer-Encoding, answered with 501
+
+/**
+ * Parser state for one connection. Holds the parsed request line and the
+ * header values the server cares about; header lines are buffered one at
+ * a time, so memory use does not depend on request size.
+ */
+typedef struct {
+    uint8_t  state;
+    uint8_t  method;            // http_method_t
+    uint8_t  version;           // 10 or 11
+    uint8_t  conn_hdr;          // HTTP_CONN_HDR_*
+    uint8_t  accept_gzip;       // Accept-Encoding lists gzip
+    uint8_t  conn_upgrade;      // Connection lists upgrade
+    uint8_t  upgrade_ws;        // Upgrade lists websocket
+    uint8_t  ws_version;        // Sec-WebSocket-Version, 0 if absent
+    uint16_t status;            // HTTP status to answer with on HTTP_PARSE_ERROR
+    uint8_t  cr;                // Last byte was '\r', only '\n' may follow
+    uint8_t  framing;           // HTTP_FRAMING_*
+    uint16_t header_bytes;
+    uint32_t content_length;
+    uint32_t body_left;
+    uint8_t  tok_len;
+    char     tok[12];           // Method / version token
+    uint16_t path_len;
+    char     path[HTTP_MAX_PATH + 1];
+    char     if_none_match[HTTP_MAX_ETAG + 1];  // Empty if absent or too long
+    char     ws_key[HTTP_WS_KEY_LEN + 1];       // Empty if absent or malformed
+    uint16_t line_len;
+    char     line[HTTP_MAX_HEADER_LINE];
+} http_parser_t;
+
+/**
+ * Reset for the next request
+ * @param p Parser
+ */
+void http_parser_reset(http_parser_t* p);
+
+/**
+ * Feed request bytes. Stops right after the end of a request so that
+ * pipelined data stays in the caller's buffer for the next one.
+ * @param p Parser
+ * @param data Bytes received
+ * @param len Number of bytes
+ * @param result HTTP_PARSE_MORE/DONE/ERROR
+ * @return Number of bytes consumed
+ */
+uint16_t http_parser_feed(http_parser_t* p, const char* data, uint16_t len,
+                          http_parse_result_t* result);
+
+/**
+ * Whether any byte of a request has been seen since the last reset
+ * @param p Parser
+ */
+uint8_t http_parser_started(const http_parser_t* p);
+
+#endif /* _HTTP_PARSER_H_ */
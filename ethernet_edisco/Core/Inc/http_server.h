@@ -0,0 +1,193 @@
+#ifndef _HTTP_SERVER_H_
+#define _HTTP_SERVER_H_
+
+#include <stdint.h>
+#include "http_parser.h"
+
+#define HTTP_PORT               80
+
+/* Listening sockets HTTP_POOL_FIRST .. HTTP_POOL_FIRST + HTTP_POOL_SIZE - 1
+   (0 NTP, 1 DHCP, 2 mDNS) */
+#ifndef HTTP_POOL_FIRST
+#define HTTP_POOL_FIRST         3
+#endif
+#ifndef HTTP_POOL_SIZE
+#define HTTP_POOL_SIZE          5
+#endif
+
+#define HTTP_TX_BUF_SIZE        768     // Response header (+ small body)
+#define HTTP_RX_CHUNK           256     // Bytes peeked from socket RX per parser feed
+#define HTTP_IDLE_TIMEOUT_MS    10000   // Drop clients that stall mid-request or stop reading
+#define HTTP_KEEPALIVE_MS       5000    // Close persistent connections idle between requests
+#define HTTP_MAX_REQUESTS       100     // Requests served per connection before closing
+
+#define HTTP_EVENTS_MAX         3       // Event stream subscribers (rest of the pool stays for requests)
+#define HTTP_EVENTS_FRAME_SIZE  384     // "data: " + payload + blank line
+#define HTTP_EVENTS_HEARTBEAT_MS 15000  // Comment line sent to idle subscribers
+#define HTTP_EVENTS_RETRY_MS    2000    // Reconnect delay suggested to EventSource
+
+/* What a connection turns into after its response (http_server_upgrade) */
+#define HTTP_UPGRADE_NONE       0
+#define HTTP_UPGRADE_EVENTS     1       // Server-Sent Events stream
+#define HTTP_UPGRADE_WEBSOCKET  2       // websocket.c
+
+/**
+ * One parsed request, as handed to a route handler
+ */
+typedef struct {
+    uint8_t     conn;       // Pool slot serving the request
+    uint8_t     method;     // http_method_t
+    const char* path;       // Request target incl. query, NUL terminated
+    uint16_t    path_len;
+    uint8_t     keep_alive; // Response must say keep-alive, else close
+    uint8_t     accept_gzip;
+    const char* if_none_match;  // Empty string if absent
+    uint8_t     upgrade_ws; // Connection: upgrade and Upgrade: websocket
+    uint8_t     ws_version; // Sec-WebSocket-Version, 0 if absent
+    const char* ws_key;     // Sec-WebSocket-Key, empty if absent or malformed
+} http_request_t;
+
+/**
+ * Build the response for one request. Responses must carry Content-Length
+ * (see http_write_head) so the connection can stay open.
+ * @param req Request
+ * @param out Buffer for the response header and any small generated body
+ * @param out_size Size of out
+ * @param body Set to a constant body that is streamed after out (or left NULL)
+ * @param body_len Length of *body
+ * @return Bytes written to out
+ */
+typedef uint16_t (*http_handler_t)(const http_request_t* req,
+                                   char* out, uint16_t out_size,
+                                   const uint8_t** body, uint16_t* body_len);
+
+/**
+ * Route table entry. path is matched against the request target without
+ * its query string: exactly, or as a subtree when it ends in '/' ("/api/").
+ * The first entry whose path and method match wins; a path match with no
+ * method match answers 405, no path match 404.
+ */
+typedef struct {
+    uint8_t        method;  // http_method_t
+    const char*    path;
+    http_handler_t handler;
+} http_route_t;
+
+/**
+ * Write a response header with Content-Length and Connection set
+ * (Content-Length is left out for "304 ...")
+ * @param out Output buffer
+ * @param out_size Size of out
+ * @param status Status line tail, e.g. "200 OK"
+ * @param content_type Content-Type value
+ * @param content_length Body length
+ * @param keep_alive req->keep_alive
+ * @param extra Additional header lines ending in CRLF, or NULL
+ * @return Bytes written (0 if it does not fit)
+ */
+uint16_t http_write_head(char* out, uint16_t out_size, const char* status,
+                         const char* content_type, uint32_t content_length,
+                         uint8_t keep_alive, const char* extra);
+
+/**
+ * Short text/plain error response
+ * @param out Output buffer
+ * @param out_size Size of out
+ * @param status HTTP status code
+ * @param keep_alive req->keep_alive
+ * @param extra Additional header lines ending in CRLF, or NULL
+ * @return Bytes written (0 if it does not fit)
+ */
+uint16_t http_write_error(char* out, uint16_t out_size, uint16_t status,
+                          uint8_t keep_alive, const char* extra);
+
+/**
+ * Value of one query string parameter ("/x?a=1&b" -> a "1", b "")
+ * @param path req->path
+ * @param name Parameter name
+ * @param out Value, NUL terminated, truncated to out_size - 1
+ * @param out_size Size of out
+ * @return Value length, -1 if the parameter is absent
+ */
+int http_query_param(const char* path, const char* name, char* out, uint16_t out_size);
+
+/**
+ * Route handler serving the packed web assets (web_assets.h), "/" maps to
+ * "/index.html". Sends the gzip copy when accepted, 304 on a matching
+ * If-None-Match; bodies are streamed from flash as TX space frees up.
+ */
+uint16_t http_asset_handler(const http_request_t* req,
+                            char* out, uint16_t out_size,
+                            const uint8_t** body, uint16_t* body_len);
+
+/**
+ * Route handler that turns the connection into a Server-Sent Events stream
+ * fed by http_events_publish(). Answers 503 when HTTP_EVENTS_MAX
+ * subscribers are already connected.
+ */
+uint16_t http_events_handler(const http_request_t* req,
+                             char* out, uint16_t out_size,
+                             const uint8_t** body, uint16_t* body_len);
+
+/**
+ * Push a frame to every event stream subscriber. Only the latest frame is
+ * kept: subscribers whose TX buffer has no room get it once space frees up,
+ * frames published in between are skipped. Publishing the same data again
+ * is a no-op.
+ * @param data Payload of one "data:" line (no newlines)
+ * @param len Length of data
+ * @return Number of subscribers notified, 0 if unchanged, negative if too long
+ */
+int http_events_publish(const char* data, uint16_t len);
+
+/**
+ * Number of connected event stream subscribers
+ */
+uint8_t http_events_subscribers(void);
+
+/**
+ * Switch a connection to another protocol once the response being built
+ * has been sent. Called by route handlers with req->conn.
+ * @param conn Pool slot
+ * @param kind HTTP_UPGRADE_*
+ */
+void http_server_upgrade(uint8_t conn, uint8_t kind);
+
+/**
+ * Step a connection on the next http_server_process() call, for modules
+ * that have something to send on an upgraded connection
+ * @param conn Pool slot
+ */
+void http_server_wake(uint8_t conn);
+
+/**
+ * Number of connections upgraded (or being upgraded) to kind
+ * @param kind HTTP_UPGRADE_*
+ */
+uint8_t http_server_upgraded(uint8_t kind);
+
+/**
+ * Open the socket pool on HTTP_PORT and register for W5500 events.
+ * Sockets are opened asynchronously, call after w5500_event_init().
+ * @param routes Route table (must stay valid)
+ * @param count Number of routes
+ */
+void http_server_init(const http_route_t* routes, uint8_t count);
+
+/**
+ * Step every connection that has pending events, call from main loop
+ */
+void http_server_process(void);
+
+/**
+ * Number of pool connections currently serving a client
+ */
+uint8_t http_server_active(void);
+
+/**
+ * A connection is still sending a body from [buf, buf + len): handlers
+ * that render into a static buffer check this before overwriting it
+ */
+uint8_t http_server_body_busy(const void* buf, uint16_t len);
+
+#endif /* _HTTP_SERVER_H_ */
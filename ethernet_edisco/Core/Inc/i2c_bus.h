@@ -0,0 +1,92 @@
+#ifndef _I2C_BUS_H_
+#define _I2C_BUS_H_
+
+#include <stdint.h>
+#include "main.h"
+
+#define I2C_BUS_QUEUE_LEN       8       // Transactions waiting or in flight
+#define I2C_BUS_TIMEOUT_MS      20      // One transfer, then bus recovery
+#define I2C_BUS_BLOCKING_MS     10      // Boot-time transfers
+#define I2C_BUS_MAX_WRITE       2       // Bytes carried in a queued write
+#define I2C_NO_REG              (-1)    // Plain transfer without a register address
+
+typedef struct {
+    uint32_t transfers;     // Completed without error
+    uint32_t nacks;         // Address or data not acknowledged
+    uint32_t bus_errors;    // Bus error, arbitration lost, overrun, DMA
+    uint32_t timeouts;      // No completion within I2C_BUS_TIMEOUT_MS
+    uint32_t recoveries;    // Peripheral re-init and bus clear
+    uint32_t queue_full;    // Submissions refused
+} i2c_bus_stats_t;
+
+/**
+ * Transaction finished, runs from i2c_bus_process() (main loop)
+ * @param ctx Caller's pointer
+ * @param err HAL_I2C_ERROR_NONE, HAL_I2C_GetError() flags or HAL_I2C_ERROR_TIMEOUT
+ */
+typedef void (*i2c_bus_done_t)(void* ctx, uint32_t err);
+
+/**
+ * Take over an initialised I2C handle
+ */
+void i2c_bus_init(I2C_HandleTypeDef* hi2c);
+
+/**
+ * Probe every 7-bit address (0x08-0x77), blocking, boot only
+ * @return Number of devices that acknowledged
+ */
+uint8_t i2c_bus_scan(void);
+
+/**
+ * Address acknowledged during the last scan
+ */
+uint8_t i2c_bus_present(uint8_t addr);
+
+/**
+ * Blocking transfers for device setup at boot (bounded by I2C_BUS_BLOCKING_MS)
+ * @param addr 7-bit address
+ * @param reg Register, or I2C_NO_REG
+ * @return 0, or -1 on error
+ */
+int i2c_bus_read_blocking(uint8_t addr, int16_t reg, uint8_t* buf, uint16_t len);
+int i2c_bus_write_blocking(uint8_t addr, int16_t reg, const uint8_t* data, uint16_t len);
+
+/**
+ * Queue a read, done by DMA (interrupt for single bytes)
+ * @param buf Destination, must stay valid until cb runs
+ * @param cb Completion, or NULL
+ * @return 0, or -1 if the queue is full
+ */
+int i2c_bus_read(uint8_t addr, int16_t reg, uint8_t* buf, uint8_t len,
+                 i2c_bus_done_t cb, void* ctx);
+
+/**
+ * Queue a write of up to I2C_BUS_MAX_WRITE bytes (copied)
+ * @return 0, or -1 if the queue is full or data too long
+ */
+int i2c_bus_write(uint8_t addr, int16_t reg, const uint8_t* data, uint8_t len,
+                  i2c_bus_done_t cb, void* ctx);
+
+/**
+ * Free queue slots, to submit a group of writes all or nothing
+ */
+uint8_t i2c_bus_free(void);
+
+/**
+ * Start queued transfers, run completions, recover from timeouts and bus
+ * errors; call from the main loop
+ */
+void i2c_bus_process(void);
+
+/**
+ * Transfer finished (call from the HAL I2C callbacks)
+ * @param err HAL_I2C_ERROR_NONE or the HAL_I2C_GetError() flags
+ */
+void i2c_bus_irq_done(uint32_t err);
+
+/**
+ * Counters
+ */
+void i2c_bus_get_stats(i2c_bus_stats_t* out);
+
+#endif /* _I2C_BUS_H_ */
@@ -0,0 +1,66 @@
+#ifndef _JSON_WRITER_H_
+#define _JSON_WRITER_H_
+
+#include <stdint.h>
+
+#define JSON_MAX_DEPTH  16
+
+/**
+ * JSON writer over a caller-provided buffer. Commas and nesting are
+ * handled by the writer, numbers are formatted without printf.
+ */
+typedef struct {
+    char*       buf;
+    uint16_t    size;
+    uint16_t    len;
+    uint8_t     overflow;   // Output did not fit
+    uint8_t     depth;
+    uint16_t    first;      // Bit n: nothing written yet at depth n
+} json_writer_t;
+
+/**
+ * Start writing into buf
+ * @param w Writer
+ * @param buf Output buffer
+ * @param size Buffer size
+ */
+void json_init(json_writer_t* w, char* buf, uint16_t size);
+
+/**
+ * Open an object / array. key is NULL at top level and inside arrays.
+ */
+void json_obj_begin(json_writer_t* w, const char* key);
+void json_obj_end(json_writer_t* w);
+void json_arr_begin(json_writer_t* w, const char* key);
+void json_arr_end(json_writer_t* w);
+
+/**
+ * Members (key NULL inside arrays)
+ */
+void json_str(json_writer_t* w, const char* key, const char* value);
+void json_int(json_writer_t* w, const char* key, int32_t value);
+void json_uint(json_writer_t* w, const char* key, uint32_t value);
+void json_bool(json_writer_t* w, const char* key, uint8_t value);
+void json_null(json_writer_t* w, const char* key);
+
+/**
+ * Fixed-point number: value is in units of 10^-decimals
+ * (json_fixed(w, "t_c", 215, 1) writes 21.5)
+ */
+void json_fixed(json_writer_t* w, const char* key, int32_t value, uint8_t decimals);
+
+/**
+ * Fixed-point value in units of 10^-value_decimals written with fewer
+ * decimals, rounded half away from zero. A negative value that rounds to
+ * zero keeps its minus sign, as printf("%.*f") does
+ * (json_fixed_rounded(w, "lat", -4, 7, 6) writes -0.000000)
+ */
+void json_fixed_rounded(json_writer_t* w, const char* key, int32_t value,
+                        uint8_t value_decimals, uint8_t decimals);
+
+/**
+ * Bytes in the buffer
+ */
+uint16_t json_len(const json_writer_t* w);
+
+#endif /* _JSON_WRITER_H_ */
@@ -4,9 +4,34 @@
 #include <stdint.h>
 #include "main.h"
 
-#define MDNS_SOCKET     2
+#define MDNS_SOCKET         2
+#define MDNS_PORT           5353
+#define MDNS_SERVICE_PORT   80          // Advertised _http._tcp port
+#define MDNS_SERVICE_TXT    "path=/"    // Single TXT string of the service
+#define MDNS_TTL_HOST       120         // A and SRV records
+#define MDNS_TTL_OTHER      4500        // PTR and TXT records
 
+/**
+ * Start the responder: <hostname>.local and the web panel as
+ * <hostname>._http._tcp.local. The socket is opened, the names probed and
+ * announced by mdns_process().
+ * @param hostname Host label, dots and spaces are dropped
+ */
 void mdns_init(const char* hostname);
+
+/**
+ * Answer queries and run probe / announce timers, call from the main loop
+ */
 void mdns_process(void);
 
+/**
+ * Re-read the IP address after it changed (DHCP) and re-announce the A record
+ */
+void mdns_update_address(void);
+
+/**
+ * Host label in use (hostname, or hostname-N after a name conflict)
+ */
+const char* mdns_hostname(void);
+
 #endif
@@ -4,21 +4,43 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "gps.h"
+
+/* Parse time allowed per epoch: 1% of the CPU at 10 Hz output */
+#define NMEA_EPOCH_BUDGET_US    1000
 
 void nmea_init(void);
 void nmea_parser_init(void);
 
 
+/**
+ * Feed received bytes, called from the UART interrupt. The last byte of buf
+ * is taken to have arrived one character time before the call.
+ */
 void nmea_push_chunk(const uint8_t *buf, size_t len);
 
+/**
+ * Line speed, used to date sentence starts inside a batched chunk
+ */
+void nmea_set_baudrate(uint32_t baud);
+
 typedef struct {
-    uint32_t lines;
-    uint32_t valid;
-    uint32_t checksum_failed;
+    uint32_t lines;             // Sentences started ('$' seen)
+    uint32_t valid;             // Checksum and line end correct, handed to the parser
+    uint32_t checksum_failed;   // CHECKSUM_LO: "*hh" does not match the body
+    uint32_t truncated;         // Any state: '$' before the previous sentence ended
+    uint32_t bad_char;          // BODY: control or non-ASCII byte
+    uint32_t overflow;          // BODY: longer than the 82 character NMEA limit
+    uint32_t bad_checksum_hex;  // CHECKSUM_HI/LO: not a hex digit
+    uint32_t bad_eol;           // EOL: something other than "\r\n" after the checksum
+    uint32_t epochs;            // Epochs published to gps_on_epoch()
+    uint32_t epoch_parse_us_max;// Most CPU time spent parsing one epoch
+    uint32_t epochs_over_budget;// Epochs that took longer than NMEA_EPOCH_BUDGET_US
 } nmea_stats_t;
 
 nmea_stats_t nmea_get_stats(void);
 
 int nmea_process(void);
+void nmea_get_position(gps_pos_t *out);
 
 #endif /* INC_NMEA_H_ */
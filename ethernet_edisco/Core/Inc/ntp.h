@@ -0,0 +1,53 @@
+#ifndef _NTP_H_
+#define _NTP_H_
+
+#include <stdint.h>
+#include "main.h"
+
+#define NTP_SOCKET          0
+#define NTP_PORT            123
+#define NTP_HOLDOVER_S      300     // Unsynchronized when the last GPS time is older
+// Without PPS the second comes from the start of RMC (NAV-PVT in UBX mode),
+// which a u-blox 6/M8 sends once the fix is computed: tens of ms after the
+// second it reports, up to ~250 ms with the default 9600 Bd message set
+// under load. The reference is corrected by the middle of 0..250 ms and the
+// rest goes into the root dispersion. Measure against PPS for another receiver.
+#define NTP_NMEA_DELAY_US   125000  // Middle of the sentence start delay
+#define NTP_NMEA_SPREAD_US  125000  // Delay is within +-this of the middle
+#define NTP_PPS_WINDOW_MS   1000    // PPS edge this close before the sentence marks its second
+#define NTP_FREQ_TOL_PPM    200     // PPS frequency estimates further off are rejected
+#define NTP_DRIFT_PPM       15      // Assumed crystal wander for root dispersion
+
+typedef struct {
+    uint32_t requests;      // Client requests received
+    uint32_t replies;       // Server replies sent
+    uint32_t dropped;       // Malformed, not mode 3, or the reply could not be queued
+    uint8_t  synced;        // Reference is valid (LI != 3)
+    uint8_t  pps;           // Reference second comes from a PPS edge
+    uint32_t ref_age_ms;    // Since the last GPS time, UINT32_MAX if never
+    uint32_t freq_hz;       // Estimated core clock
+} ntp_stats_t;
+
+/**
+ * Start the server on NTP_SOCKET, enables the DWT cycle counter used for
+ * all timestamps. Call before GPS UART reception starts.
+ */
+void ntp_init(void);
+
+/**
+ * Follow the GPS time reference and answer requests, call from the main loop
+ * at least every 40 s (DWT->CYCCNT wraps after 44 s at 96 MHz)
+ */
+void ntp_process(void);
+
+/**
+ * GPS PPS rising edge (call from HAL_GPIO_EXTI_Callback)
+ */
+void ntp_pps_irq(void);
+
+/**
+ * Counters and reference state
+ */
+void ntp_get_stats(ntp_stats_t* out);
+
+#endif /* _NTP_H_ */
@@ -0,0 +1,121 @@
+#ifndef _SENSORS_H_
+#define _SENSORS_H_
+
+#include <stdint.h>
+#include "i2c_bus.h"
+
+#define SENSORS_MAX             4       // Registered drivers
+#define SENSORS_MAX_READ        16      // Longest data burst
+#define SENSORS_BACKOFF_MS      5000    // After a failed transfer before the next try
+#define SENSORS_STALE_GRACE_MS  2000    // Sample older than period + this is stale
+
+/* Quantities in the sample table, fixed-point */
+typedef enum {
+    SENSOR_TEMP = 0,        // 0.01 °C
+    SENSOR_PRESS,           // Pa
+    SENSOR_HUM,             // 1/1024 %RH
+    SENSOR_LUX,             // 0.001 lx
+    SENSOR_QTY_COUNT
+} sensor_qty_t;
+
+/**
+ * Decoded readings of one sample; mask bit (1 << sensor_qty_t) marks the
+ * values that were measured
+ */
+typedef struct {
+    int32_t value[SENSOR_QTY_COUNT];
+    uint8_t mask;
+} sensor_values_t;
+
+/**
+ * Read schedule, filled by the driver's init and changed by the driver at
+ * run time (e.g. a new BME280 profile). Every period_ms: optionally write
+ * trigger_val and wait conv_ms, then read read_len bytes and decode them.
+ */
+typedef struct {
+    uint32_t period_ms;
+    uint8_t  trigger;       // 1: send trigger_val first
+    int16_t  trigger_reg;   // Register, or I2C_NO_REG for a bare command byte
+    uint8_t  trigger_val;
+    uint16_t conv_ms;       // Conversion time after the trigger
+    int16_t  read_reg;      // Register, or I2C_NO_REG for a plain read
+    uint8_t  read_len;      // Up to SENSORS_MAX_READ
+} sensor_schedule_t;
+
+typedef struct {
+    const char* name;
+    uint8_t addr[2];        // 7-bit addresses to look for, 0 if only one
+    /** Set up the device found at addr (blocking, boot only), 0 if usable */
+    int  (*init)(uint8_t addr, sensor_schedule_t* sched);
+    /** Convert a data burst, 0 if usable */
+    int  (*decode)(const uint8_t* raw, sensor_values_t* out);
+    /** Optional: queue the configuration again, before the first transfer after a failure */
+    void (*reconfigure)(void);
+} sensor_driver_t;
+
+typedef struct {
+    int32_t  value;
+    uint32_t last_update;   // Tick, 0 if never measured
+    int8_t   source;        // Sensor index, -1 if none
+} sensor_sample_t;
+
+typedef struct {
+    const char* name;
+    uint8_t  addr;          // 0 if not found
+    uint8_t  present;
+    uint32_t period_ms;
+    uint32_t samples;
+    uint32_t errors;        // NACK, bus error, timeout or rejected data
+    uint32_t last_update;
+    uint32_t decode_cycles; // Last decode, CPU cycles
+} sensor_info_t;
+
+/**
+ * Add a driver before sensors_init()
+ * @return Sensor index, -1 if the table is full
+ */
+int sensors_register(const sensor_driver_t* drv);
+
+/**
+ * Scan the bus and initialise every registered driver whose address
+ * acknowledged (blocking, boot only, after i2c_bus_init())
+ * @return Number of sensors in use
+ */
+uint8_t sensors_init(void);
+
+/**
+ * Queue due triggers and reads, call from the main loop after i2c_bus_process()
+ * @return 1 if the sample table changed since the last call
+ */
+int sensors_process(void);
+
+/**
+ * Latest value of a quantity (from whichever sensor measured it last)
+ */
+sensor_sample_t sensors_get(sensor_qty_t q);
+
+/**
+ * Age after which a quantity is stale: its sensor's period + grace,
+ * SENSORS_STALE_GRACE_MS + 1 s if no sensor provides it
+ */
+uint32_t sensors_stale_ms(sensor_qty_t q);
+
+/**
+ * Registry entry
+ * @return 1, or 0 past the last registered sensor
+ */
+int sensors_info(uint8_t index, sensor_info_t* out);
+
+/**
+ * Latest value in tenths of the display unit, rounded: 0.1 °C, 0.1 hPa,
+ * 0.1 %RH, 0.1 lx (for json_fixed(..., 1) and sensors_format_tenths)
+ */
+int32_t sensors_tenths(sensor_qty_t q);
+
+/**
+ * Format a value in tenths as "-12.3" without floating point
+ * @return Characters written, excluding the NUL
+ */
+int sensors_format_tenths(char* buf, uint16_t size, int32_t tenths);
+
+#endif /* _SENSORS_H_ */
@@ -3,6 +3,85 @@
 
 #include <stdint.h>
 
+/**
+ * Socket commands tracked by the asynchronous command state machine
+ */
+typedef enum {
+    SOCK_CMD_OPEN = 0,
+    SOCK_CMD_LISTEN,
+    SOCK_CMD_CONNECT,
+    SOCK_CMD_SEND,
+    SOCK_CMD_RECV,
+    SOCK_CMD_DISCON,
+    SOCK_CMD_CLOSE,
+    SOCK_CMD_COUNT
+} sock_cmd_t;
+
+typedef enum {
+    SOCK_ST_IDLE = 0,   // Nothing issued yet
+    SOCK_ST_BUSY,       // Command in flight
+    SOCK_ST_DONE,       // Completed (SR reached the expected state / SENDOK seen)
+    SOCK_ST_FAILED      // Timed out, rejected or socket closed underneath
+} sock_cmd_state_t;
+
+/**
+ * Latency of one command type, from Sn_CR write to completion
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t failures;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} sock_cmd_stats_t;
+
+/**
+ * Issue a command and return at once, completion is picked up by
+ * socket_cmd_poll()/socket_cmd_process(). A SEND still waiting for SENDOK
+ * keeps being tracked in the background; CLOSE overrides anything in flight.
+ * OPEN needs mode and port, use socket_open_async() for it.
+ * @param sn Socket number
+ * @param cmd Command to issue
+ * @return 0 if issued, -1 if another command is still in flight
+ */
+int socket_cmd_start(uint8_t sn, sock_cmd_t cmd);
+
+/**
+ * Open a socket without waiting: CLOSE first if needed, OPEN is chained
+ * @param sn Socket number (0-7)
+ * @param protocol 0x01=TCP, 0x02=UDP
+ * @param port Local port number
+ * @param flags Additional flags (usually 0)
+ * @return 0 if issued, -1 if the socket is busy
+ */
+int socket_open_async(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flags);
+
+/**
+ * Advance the command state machine of one socket (one or two register reads)
+ * @param sn Socket number
+ * @return sock_cmd_state_t of the current command
+ */
+int socket_cmd_poll(uint8_t sn);
+
+/**
+ * Poll all sockets with a command in flight, call from the main loop
+ */
+void socket_cmd_process(void);
+
+/**
+ * State of the last command issued on a socket
+ * @param sn Socket number
+ * @return Command state
+ */
+sock_cmd_state_t socket_cmd_state(uint8_t sn);
+
+/**
+ * Latency counters (microseconds, DWT cycle counter based)
+ * @param cmd Command type
+ * @return Counters for that command, NULL if cmd is out of range
+ */
+const sock_cmd_stats_t* socket_cmd_stats(sock_cmd_t cmd);
+
 /**
  * Open a socket
  * @param sn Socket number (0-7)
@@ -32,12 +111,13 @@ int accept_socket(uint8_t sn);
  * @param sn Socket number
  * @param addr Remote IP address (4 bytes)
  * @param port Remote port number
- * @return 0 on success, negative on error
+ * @return 0 if CONNECT was issued (check socket_cmd_state()), negative on error
  */
 int connect_socket(uint8_t sn, const uint8_t* addr, uint16_t port);
 
 /**
- * Send data through socket
+ * Send data through socket, blocking until all of it is queued.
+ * Data larger than Sn_TX_FSR is sent in several chunks as space frees up.
  * @param sn Socket number
  * @param buf Data buffer to send
  * @param len Length of data
@@ -45,6 +125,46 @@ int connect_socket(uint8_t sn, const uint8_t* addr, uint16_t port);
  */
 int send_socket(uint8_t sn, const uint8_t* buf, uint16_t len);
 
+/**
+ * Send as much as currently fits in Sn_TX_FSR, never waits
+ * @param sn Socket number
+ * @param buf Data buffer to send
+ * @param len Length of data
+ * @return Number of bytes queued (0 if TX buffer full), negative on error
+ */
+int send_socket_nb(uint8_t sn, const uint8_t* buf, uint16_t len);
+
+/**
+ * Send as much as fits in Sn_TX_FSR up to the TX ring wrap, copying it into
+ * the chip by DMA straight from buf. Returns once the transfer is started;
+ * the completion interrupt marks the socket and socket_cmd_poll() then
+ * moves Sn_TX_WR and issues SEND. Below W5500_DMA_MIN_LEN, or if the DMA
+ * is taken, it behaves like send_socket_nb().
+ * @param sn Socket number
+ * @param buf Data, must stay unchanged while socket_tx_dma_busy()
+ * @param len Length of data
+ * @return Number of bytes queued (0 if TX buffer full or still sending), negative on error
+ */
+int send_socket_dma(uint8_t sn, const uint8_t* buf, uint16_t len);
+
+/**
+ * A send_socket_dma() transfer is still reading its buffer. A finished one
+ * gets its SEND issued here, so 0 means the data is queued in the chip.
+ * @param sn Socket number
+ * @return 1 while the DMA runs
+ */
+uint8_t socket_tx_dma_busy(uint8_t sn);
+
+/**
+ * Wait for the last SEND to get SENDOK or TIMEOUT. The chip reads
+ * Sn_DIPR/Sn_DPORT until then, so a UDP socket must not change its
+ * destination before this returns 0 or -1.
+ * @param sn Socket number
+ * @param block 1 to wait (bounded by the SEND timeout), 0 to only check
+ * @return 0 done, 1 still sending (block == 0 only), -1 the SEND failed
+ */
+int socket_send_wait(uint8_t sn, uint8_t block);
+
 /**
  * Receive data from socket
  * @param sn Socket number
@@ -55,9 +175,41 @@ int send_socket(uint8_t sn, const uint8_t* buf, uint16_t len);
 int recv_socket(uint8_t sn, uint8_t* buf, uint16_t len);
 
 /**
- * Disconnect socket (TCP)
+ * Read RX data straight from W5500 memory without consuming it
  * @param sn Socket number
- * @return 0 on success, negative on error
+ * @param offset Offset from the current read pointer
+ * @param buf Buffer to store data
+ * @param len Maximum bytes to read
+ * @return Number of bytes read, 0 if nothing at that offset
+ */
+int peek_socket(uint8_t sn, uint16_t offset, uint8_t* buf, uint16_t len);
+
+/**
+ * Consume RX data (advance read pointer and issue RECV)
+ * @param sn Socket number
+ * @param len Bytes to drop, must not exceed get_socket_rx_size()
+ * @return Number of bytes consumed, negative on error
+ */
+int consume_socket(uint8_t sn, uint16_t len);
+
+/**
+ * Free space in socket TX buffer (Sn_TX_FSR)
+ * @param sn Socket number
+ * @return Free bytes
+ */
+uint16_t get_socket_tx_free(uint8_t sn);
+
+/**
+ * Received data size (Sn_RX_RSR)
+ * @param sn Socket number
+ * @return Bytes waiting in RX buffer
+ */
+uint16_t get_socket_rx_size(uint8_t sn);
+
+/**
+ * Disconnect socket (TCP), returns without waiting for the FIN handshake
+ * @param sn Socket number
+ * @return 0 if DISCON was issued, negative on error
  */
 int disconnect_socket(uint8_t sn);
 
@@ -0,0 +1,40 @@
+#ifndef _STATUS_JSON_H_
+#define _STATUS_JSON_H_
+
+#include <stdint.h>
+#include "gps.h"
+#include "json_writer.h"
+
+/* proto_ver 1 documents served on /status and pushed on /events. Every
+   value is an integer scaled the way the sources report it, so the
+   rendering needs neither floats nor printf. */
+
+#define STATUS_JSON_MAX     560     // Longest /status document, any inputs
+#define STATUS_AGE_NEVER    0xFFFFFFFF
+
+/* Readings shared by /status and /events */
+typedef struct {
+    const gps_pos_t* pos;           // lat/lon in 1e-7 deg
+    int32_t  env_tenths[4];         // t_c, p_hpa, rh_pct, lux in 0.1 units
+} status_readings_t;
+
+/**
+ * Write the time_utc, gps and env members into an open object
+ */
+void status_json_readings(json_writer_t* w, const status_readings_t* r);
+
+/**
+ * Write the fix_quality object for an epoch (GSA, GSV, VTG)
+ */
+void status_json_fix_quality(json_writer_t* w, const gps_epoch_t* e);
+
+/**
+ * Render the whole /status document
+ * @param gps_age_ms Since the last position, STATUS_AGE_NEVER if none yet
+ * @param env_age_ms Since the last sensor reading, STATUS_AGE_NEVER if none yet
+ * @return Length, 0 if it did not fit
+ */
+uint16_t status_json(char* buf, uint16_t size, const status_readings_t* r,
+                     const gps_epoch_t* e, uint32_t gps_age_ms, uint32_t env_age_ms);
+
+#endif /* _STATUS_JSON_H_ */
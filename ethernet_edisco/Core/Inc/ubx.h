@@ -0,0 +1,70 @@
+#ifndef _UBX_H_
+#define _UBX_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "main.h"
+
+#ifndef UBX_ENABLE
+#define UBX_ENABLE          1       // 0: leave the receiver in its NMEA default
+#endif
+
+#define UBX_BAUD            115200  // Receiver and USART1 speed in UBX mode
+#define UBX_NMEA_BAUD       9600    // Receiver default, used until UBX is confirmed
+#define UBX_RATE_MS         200     // Navigation rate: 200 = 5 Hz, 100 = 10 Hz (M8 and later)
+#define UBX_START_DELAY_MS  1000    // Receiver boot time before the first command
+#define UBX_ACK_TIMEOUT_MS  500
+#define UBX_RETRIES         3
+#define UBX_PVT_TIMEOUT_MS  3000    // No NAV-PVT for this long in UBX mode -> back to NMEA
+#define UBX_MAX_PAYLOAD     100     // NAV-PVT is 92 bytes, longer frames are dropped
+
+typedef enum {
+    UBX_MODE_NMEA = 0,      // Receiver did not answer (or UBX_ENABLE 0), NMEA at UBX_NMEA_BAUD
+    UBX_MODE_CONFIGURING,
+    UBX_MODE_UBX            // NAV-PVT at UBX_BAUD
+} ubx_mode_t;
+
+typedef struct {
+    uint32_t frames;        // Checksum correct
+    uint32_t checksum_failed;
+    uint32_t too_long;      // Payload over UBX_MAX_PAYLOAD, dropped
+    uint32_t pvt;           // NAV-PVT solutions decoded
+    uint32_t fallbacks;     // Times the receiver was put back to NMEA
+} ubx_stats_t;
+
+/**
+ * Change the USART1 speed (abort RX, re-init, restart RX)
+ */
+typedef void (*ubx_set_baud_t)(uint32_t baud);
+
+/**
+ * Start configuring the receiver from ubx_process(), USART1 must be
+ * receiving at UBX_NMEA_BAUD
+ * @param uart GPS UART, used for commands
+ * @param set_baud Baud rate switch
+ */
+void ubx_init(UART_HandleTypeDef* uart, ubx_set_baud_t set_baud);
+
+/**
+ * Feed received bytes, called from the UART interrupt next to
+ * nmea_push_chunk(); the last byte arrived one character time ago
+ */
+void ubx_push_chunk(const uint8_t* buf, size_t len);
+
+/**
+ * Run the configuration sequence and watch for NAV-PVT, call from the main loop
+ * @return 1 if a NAV-PVT position arrived since the last call (like nmea_process)
+ */
+int ubx_process(void);
+
+/**
+ * Current input protocol
+ */
+ubx_mode_t ubx_get_mode(void);
+
+/**
+ * Frame counters
+ */
+ubx_stats_t ubx_get_stats(void);
+
+#endif /* _UBX_H_ */
@@ -34,6 +34,8 @@ extern "C" {
 
 extern UART_HandleTypeDef huart1;
 
+extern DMA_HandleTypeDef hdma_usart1_rx;
+
 /* USER CODE BEGIN Private defines */
 
 /* USER CODE END Private defines */
@@ -52,6 +52,8 @@
 /* Socket TX/RX Buffer Memory Map */
 // TX Buffers: 0x8000 + (socket_num * 0x0800)  [2KB per socket]
 // RX Buffers: 0xC000 + (socket_num * 0x0800)  [2KB per socket]
+// This flat map only fits 2KB buffers; socket.c uses W5500_WRITE_TXBUF /
+// W5500_READ_RXBUF, which address each socket's buffer block directly.
 
 /* ==== Socket Commands (Sn_CR) ==== */
 #define W5500_CR_OPEN       0x01
@@ -104,5 +106,30 @@ void     W5500_WRITE_REG(uint16_t addr, uint8_t data);
 uint16_t W5500_READ_REG16(uint16_t addr);
 void     W5500_WRITE_BUF(uint16_t addr, const uint8_t* buf, uint16_t len);
 void     W5500_READ_BUF(uint16_t addr, uint8_t* buf, uint16_t len);
+void     W5500_WRITE_TXBUF(uint8_t sn, uint16_t offset, const uint8_t* buf, uint16_t len);
+void     W5500_READ_RXBUF(uint8_t sn, uint16_t offset, uint8_t* buf, uint16_t len);
+
+/* ==== DMA Burst Transport ====
+   W5500_READ_BUF/W5500_WRITE_BUF and the TX/RX buffer calls are blocking
+   bursts: header and payload under one chip select, at most two HAL calls.
+   W5500_WRITE_TXBUF_DMA() hands a TX block to SPI2 DMA straight from the
+   caller's buffer and returns; the blocking calls wait for it first. */
+#define W5500_DMA_MIN_LEN       32      // Below this DMA setup costs more than it saves
+#define W5500_DMA_MAX_LEN       2048    // Largest payload per DMA frame
+#define W5500_DMA_TIMEOUT_MS    10      // 2 KB at 12 MBit/s takes ~1.4 ms
+
+/* Transfer finished, status 0 = OK, -1 = DMA error or timeout (interrupt context) */
+typedef void (*w5500_dma_done_t)(void* ctx, int status);
+
+/**
+ * Write a socket TX buffer block by DMA without waiting. buf must stay
+ * valid and unchanged until done() has run.
+ * @return 0 started, -1 len out of range, -2 a transfer is in flight, -3 DMA did not start
+ */
+int      W5500_WRITE_TXBUF_DMA(uint8_t sn, uint16_t offset, const uint8_t* buf, uint16_t len,
+                               w5500_dma_done_t done, void* ctx);
+
+/* Called from the SPI2 DMA complete/error callbacks, status 0 = OK */
+void     w5500_dma_complete(int status);
 
 #endif /* _W5500_H_ */
@@ -0,0 +1,57 @@
+#ifndef _W5500_EVENT_H_
+#define _W5500_EVENT_H_
+
+#include <stdint.h>
+#include "w5500.h"
+
+/* Event bits passed to handlers are the Sn_IR flags from w5500.h:
+   W5500_Sn_IR_CON, _DISCON, _RECV, _TIMEOUT, _SENDOK */
+#define W5500_EVT_ALL   (W5500_Sn_IR_CON | W5500_Sn_IR_DISCON | W5500_Sn_IR_RECV | \
+                         W5500_Sn_IR_TIMEOUT | W5500_Sn_IR_SENDOK)
+
+/**
+ * Per-socket event handler
+ * @param sn Socket number
+ * @param events Sn_IR flags that fired (already cleared in the chip)
+ */
+typedef void (*w5500_event_cb_t)(uint8_t sn, uint8_t events);
+
+/**
+ * Reset the dispatch table and mask all W5500 interrupts.
+ * Call after wizchip_init() (the chip reset clears SIMR/Sn_IMR).
+ */
+void w5500_event_init(void);
+
+/**
+ * Register a handler for socket events and unmask them in Sn_IMR/SIMR
+ * @param sn Socket number (0-7)
+ * @param mask Sn_IR flags to deliver
+ * @param cb Handler, NULL to unregister and mask the socket
+ */
+void w5500_event_register(uint8_t sn, uint8_t mask, w5500_event_cb_t cb);
+
+/**
+ * W5500_INT falling edge (call from HAL_GPIO_EXTI_Callback)
+ */
+void w5500_event_irq(void);
+
+/**
+ * Read SIR and Sn_IR once per interrupt and dispatch to handlers.
+ * Call from main loop; does no SPI traffic when no interrupt is pending.
+ * @return Number of sockets that had events
+ */
+int w5500_event_process(void);
+
+/**
+ * Number of W5500_INT interrupts seen since init
+ */
+uint32_t w5500_event_irq_count(void);
+
+/**
+ * DWT cycle counter at the last W5500_INT edge: the earliest moment a
+ * received packet is known to the MCU, used as its arrival time
+ * (the counter must have been enabled, see ntp_init())
+ */
+uint32_t w5500_event_irq_cycles(void);
+
+#endif /* _W5500_EVENT_H_ */
@@ -0,0 +1,23 @@
+#ifndef _WEB_ASSETS_H_
+#define _WEB_ASSETS_H_
+
+#include <stdint.h>
+
+/**
+ * Static file packed into flash by tools/gen_assets.py
+ */
+typedef struct {
+    const char*    path;            // URL path, e.g. "/index.html"
+    const char*    content_type;
+    const uint8_t* data;            // Identity encoding
+    uint16_t       len;
+    const char*    etag;            // Quoted strong ETag of data
+    const uint8_t* gz_data;         // gzip encoding
+    uint16_t       gz_len;
+    const char*    gz_etag;         // Quoted strong ETag of gz_data
+} web_asset_t;
+
+extern const web_asset_t web_assets[];
+extern const uint8_t web_asset_count;
+
+#endif /* _WEB_ASSETS_H_ */
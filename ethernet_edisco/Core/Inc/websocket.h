@@ -0,0 +1,81 @@
+#ifndef _WEBSOCKET_H_
+#define _WEBSOCKET_H_
+
+#include <stdint.h>
+#include "http_server.h"
+
+#define WS_MAX_CLIENTS          2       // Upgraded pool connections at a time
+#define WS_MAX_MESSAGE          128     // Text message (command) from a client, longer -> 1009
+#define WS_MAX_RECORD           125     // Binary record pushed to clients (one-byte length)
+#define WS_OUT_SIZE             1024    // Queued reply / control frames per client (STATUS is ~700 B)
+#define WS_PING_MS              15000   // Ping idle clients this often
+
+/**
+ * Execute one command received as a text message
+ * @param cmd Command line, NUL terminated
+ * @param reply Buffer for the reply text
+ * @param reply_size Size of reply
+ * @return Reply length (0 sends no reply)
+ */
+typedef uint16_t (*ws_command_t)(const char* cmd, char* reply, uint16_t reply_size);
+
+/**
+ * Set the handler for text messages from clients
+ * @param handler Command handler (NULL ignores text messages)
+ */
+void websocket_init(ws_command_t handler);
+
+/**
+ * Route handler for the RFC 6455 opening handshake. Answers 101 and hands
+ * the connection to this module, 426 for a plain request or another
+ * protocol version, 503 when WS_MAX_CLIENTS are connected.
+ */
+uint16_t websocket_handler(const http_request_t* req,
+                           char* out, uint16_t out_size,
+                           const uint8_t** body, uint16_t* body_len);
+
+/**
+ * Take over an upgraded connection (called by the HTTP server)
+ * @param conn Pool slot
+ * @param sn Socket number
+ */
+void websocket_open(uint8_t conn, uint8_t sn);
+
+/**
+ * Forget a connection that is being closed (called by the HTTP server)
+ * @param conn Pool slot
+ */
+void websocket_close(uint8_t conn);
+
+/**
+ * Read frames, answer them and push pending records (called by the HTTP server)
+ * @param conn Pool slot
+ * @param sn Socket number
+ * @return 0 idle, 1 to be polled again, negative to close the connection
+ */
+int websocket_step(uint8_t conn, uint8_t sn);
+
+/**
+ * Push a binary record to every client. Only the latest record is kept:
+ * clients without TX space get it once space frees up, records published
+ * in between are skipped.
+ * @param data Record
+ * @param len Length (up to WS_MAX_RECORD)
+ * @return Number of clients notified, negative if too long
+ */
+int websocket_publish(const uint8_t* data, uint8_t len);
+
+/**
+ * Number of connected clients
+ */
+uint8_t websocket_clients(void);
+
+/**
+ * Sec-WebSocket-Accept for a Sec-WebSocket-Key:
+ * base64(SHA-1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"))
+ * @param key Client key, NUL terminated
+ * @param out 29 bytes, receives the NUL terminated accept value
+ */
+void websocket_accept_key(const char* key, char* out);
+
+#endif /* _WEBSOCKET_H_ */
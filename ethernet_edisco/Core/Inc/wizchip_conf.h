@@ -13,6 +13,15 @@ void wizchip_deselect(void);
 uint8_t wiz_spi_readbyte(void);
 void wiz_spi_writebyte(uint8_t byte);
 
+/* === Burst / DMA callbacks (must be provided by user) === */
+void wiz_spi_readburst(uint8_t* buf, uint16_t len);
+void wiz_spi_writeburst(const uint8_t* buf, uint16_t len);
+/* Start a DMA transfer inside the current frame (chip selected, header sent);
+   rx may be NULL for write-only transfers. Return 0 if started, the user then
+   calls w5500_dma_complete() from the completion/error interrupt. */
+int  wiz_spi_dma_start(const uint8_t* tx, uint8_t* rx, uint16_t len);
+void wiz_spi_dma_abort(void);
+
 /* === Chip select macros inside driver === */
 #define WIZCHIP_CRIS_ENTER()
 #define WIZCHIP_CRIS_EXIT()
@@ -32,6 +41,10 @@ void wizchip_getnetinfo(wiz_NetInfo* p);
 /* === Wizchip init === */
 int wizchip_init(const uint8_t* tx_size, const uint8_t* rx_size);
 
+/* Socket buffer sizes in bytes, as configured by wizchip_init() */
+uint16_t wizchip_txbuf_size(uint8_t sn);
+uint16_t wizchip_rxbuf_size(uint8_t sn);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,52 @@
+/* bh1750.c - BH1750 ambient light sensor driver
+ *
+ * The sensor converts continuously on its own, so the schedule is a plain
+ * two-byte read once per period (no register address, no trigger).
+ */
+
+#include "bh1750.h"
+
+#define CMD_POWER_ON        0x01
+#define CMD_CONT_H_RES      0x10    // 1 lx resolution, 120 ms typical
+
+static uint8_t bh_addr = 0;
+
+static int bh1750_init(uint8_t addr, sensor_schedule_t* sched) {
+    uint8_t cmd = CMD_POWER_ON;
+    if (i2c_bus_write_blocking(addr, I2C_NO_REG, &cmd, 1) != 0) return -1;
+    cmd = CMD_CONT_H_RES;
+    if (i2c_bus_write_blocking(addr, I2C_NO_REG, &cmd, 1) != 0) return -1;
+
+    bh_addr = addr;
+    sched->period_ms = BH1750_PERIOD_MS;
+    sched->trigger = 0;
+    sched->conv_ms = 0;
+    sched->read_reg = I2C_NO_REG;
+    sched->read_len = 2;
+    return 0;
+}
+
+static int bh1750_decode(const uint8_t* raw, sensor_values_t* out) {
+    uint32_t count = ((uint32_t)raw[0] << 8) | raw[1];
+    // lx = count / 1.2 (datasheet, measurement accuracy 1.0)
+    out->value[SENSOR_LUX] = (int32_t)(count * 2500 / 3);
+    out->mask = 1 << SENSOR_LUX;
+    return 0;
+}
+
+/* A power cycle leaves it in power-down: send both commands again */
+static void bh1750_reconfigure(void) {
+    static const uint8_t cmds[] = { CMD_POWER_ON, CMD_CONT_H_RES };
+    if (i2c_bus_free() < 2) return;
+    for (uint8_t i = 0; i < 2; i++) {
+        i2c_bus_write(bh_addr, I2C_NO_REG, &cmds[i], 1, NULL, NULL);
+    }
+}
+
+const sensor_driver_t bh1750_driver = {
+    .name = "bh1750",
+    .addr = { 0x23, 0x5C },
+    .init = bh1750_init,
+    .decode = bh1750_decode,
+    .reconfigure = bh1750_reconfigure,
+};
@@ -8,10 +8,12 @@
 
 #include "bme.h"
 #include "main.h"
+#include "i2c_bus.h"
 #include <string.h>
-#include <math.h>
+#include <strings.h>
 
-#define BME280_ADDR  (0x76 << 1) // or 0x77 << 1 depending on SDO
+#define BME280_ADDR_PRIMARY     0x76    // SDO low
+#define BME280_ADDR_SECONDARY   0x77    // SDO high
 
 #define REG_ID        0xD0
 #define REG_RESET     0xE0
@@ -21,137 +23,382 @@
 #define REG_CONFIG    0xF5
 #define REG_PRESS_MSB 0xF7
 
-static I2C_HandleTypeDef *bme_i2c;
+#define MODE_SLEEP          0
+#define CONFIG_WRITES_MAX   4
 
-static uint16_t dig_T1;
-static int16_t dig_T2, dig_T3;
-static uint16_t dig_P1;
-static int16_t dig_P2, dig_P3, dig_P4, dig_P5, dig_P6, dig_P7, dig_P8, dig_P9;
-static uint8_t  dig_H1, dig_H3;
-static int16_t  dig_H2, dig_H4, dig_H5;
-static int8_t   dig_H6;
-static int32_t  t_fine;
+/* Recommended modes of operation, datasheet section 3.5 */
+static const bme280_profile_t presets[] = {
+    // name       mode                T  P   H  IIR standby period
+    { "default",  BME280_MODE_FORCED, 1, 1,  1, 0,  500, 1000 },
+    { "weather",  BME280_MODE_FORCED, 1, 1,  1, 0,  500, 60000 },  // 1 sample per minute
+    { "humidity", BME280_MODE_FORCED, 1, 0,  1, 0,  500, 1000 },
+    { "indoor",   BME280_MODE_NORMAL, 2, 16, 1, 16, 500, 1000 },   // Indoor navigation, 25 Hz ODR
+    { "fast",     BME280_MODE_NORMAL, 1, 4,  0, 16, 500, 100 },    // Gaming, fast pressure, 83 Hz ODR
+};
 
-static void bme_read_calibration(void);
-static uint8_t bme_read8(uint8_t reg);
-static void bme_read_buf(uint8_t reg, uint8_t *buf, uint16_t len);
-static void bme_write8(uint8_t reg, uint8_t val);
+static const uint8_t osrs_values[] = { 0, 1, 2, 4, 8, 16 };
+static const uint8_t filter_values[] = { 0, 2, 4, 8, 16 };
+static const uint32_t standby_values[] = { 500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000 };
 
-void bme280_init(I2C_HandleTypeDef *hi2c)
+static uint8_t bme_addr = 0;            // 0 until found by bme280_driver_init
+static sensor_schedule_t *bme_sched;
+
+static bme280_profile_t profile;        // Requested
+static bme280_profile_t active;         // Written to the sensor, or queued
+static bool profile_dirty = false;
+
+
+/* Calibration with the constant shifts of the Bosch formulas applied once
+   at init, ordered so packing adds no unaligned accesses */
+typedef struct __attribute__((packed)) {
+#if BME280_PRESSURE_32BIT
+    int32_t  p4_s16;    // dig_P4 << 16
+    int32_t  p7;
+#else
+    int64_t  p4_s35;    // dig_P4 << 35
+    int32_t  p7_s4;     // dig_P7 << 4
+#endif
+    int32_t  t1;        // dig_T1
+    int32_t  t1_s1;     // dig_T1 << 1
+    int32_t  h4_s20;    // dig_H4 << 20
+    int16_t  t2, t3;
+    uint16_t p1;
+    int16_t  p2, p3, p5, p6, p8, p9;
+    int16_t  h2, h5;
+    uint8_t  h1, h3;
+    int8_t   h6;
+} bme280_calib_t;
+
+
+static bme280_calib_t cal;
+
+static int bme_read_calibration(void);
+
+/* Register code of a datasheet value, -1 if the sensor has none */
+static int code_u8(const uint8_t *values, uint8_t n, uint8_t v)
+{
+    for (uint8_t i = 0; i < n; i++) if (values[i] == v) return i;
+    return -1;
+}
+
+static int code_standby(uint32_t us)
+{
+    for (uint8_t i = 0; i < sizeof(standby_values) / sizeof(standby_values[0]); i++) {
+        if (standby_values[i] == us) return i;
+    }
+    return -1;
+}
+
+#define OSRS(v)     code_u8(osrs_values, sizeof(osrs_values), (v))
+#define FILTER(v)   code_u8(filter_values, sizeof(filter_values), (v))
+
+static uint8_t ctrl_meas(const bme280_profile_t *p, uint8_t mode)
+{
+    return (OSRS(p->osrs_t) << 5) | (OSRS(p->osrs_p) << 2) | mode;
+}
+
+/* Register writes for a profile. CONFIG is only reliably taken in sleep
+   mode and CTRL_HUM only after a CTRL_MEAS write, hence the order. */
+static uint8_t build_config(const bme280_profile_t *p, uint8_t *reg, uint8_t *val)
+{
+    uint8_t n = 0;
+    reg[n] = REG_CTRL_MEAS; val[n++] = ctrl_meas(p, MODE_SLEEP);
+    reg[n] = REG_CTRL_HUM;  val[n++] = OSRS(p->osrs_h);
+    reg[n] = REG_CONFIG;    val[n++] = (code_standby(p->standby_us) << 5) | (FILTER(p->filter) << 2);
+    if (p->mode == BME280_MODE_NORMAL) {
+        reg[n] = REG_CTRL_MEAS; val[n++] = ctrl_meas(p, BME280_MODE_NORMAL);
+    }
+    return n;
+}
+
+/* Forced mode: trigger, wait t_meas max, read. Normal mode: read only. */
+static void build_schedule(const bme280_profile_t *p, sensor_schedule_t *s)
+{
+    bme280_profile_info_t info;
+    bme280_profile_info(p, &info);
+
+    s->period_ms = p->period_ms;
+    s->trigger = (p->mode == BME280_MODE_FORCED);
+    s->trigger_reg = REG_CTRL_MEAS;
+    s->trigger_val = ctrl_meas(p, BME280_MODE_FORCED);
+    s->conv_ms = (info.meas_max_us + 999) / 1000;
+    s->read_reg = REG_PRESS_MSB;
+    s->read_len = 8;
+}
+
+static void config_done(void *ctx, uint32_t err)
 {
-    bme_i2c = hi2c;
+    (void)ctx;
+    if (err != HAL_I2C_ERROR_NONE) profile_dirty = true;
+}
+
+/* Queue the profile writes behind whatever is on the bus, all or none */
+static void apply_profile(void)
+{
+    uint8_t reg[CONFIG_WRITES_MAX], val[CONFIG_WRITES_MAX];
+    uint8_t n = build_config(&profile, reg, val);
+
+    if (!bme_addr || i2c_bus_free() < n) return;
+    for (uint8_t i = 0; i < n; i++) {
+        i2c_bus_write(bme_addr, reg[i], &val[i], 1, config_done, NULL);
+    }
+    active = profile;
+    build_schedule(&active, bme_sched);
+    profile_dirty = false;
+}
 
-    uint8_t id = bme_read8(REG_ID);
-    if (id != 0x60) return;
+/* --- Driver --- */
 
-    bme_write8(REG_RESET, 0xB6);
+static int bme280_driver_init(uint8_t addr, sensor_schedule_t *sched)
+{
+    uint8_t id = 0;
+    if (i2c_bus_read_blocking(addr, REG_ID, &id, 1) != 0 || id != 0x60) return -1;
+
+    uint8_t v = 0xB6;
+    i2c_bus_write_blocking(addr, REG_RESET, &v, 1);
     HAL_Delay(10);
 
-    bme_read_calibration();
+    bme_addr = addr;
+    if (bme_read_calibration() != 0) goto absent;
+
+    if (!profile.name) profile = presets[0];
+    uint8_t reg[CONFIG_WRITES_MAX], val[CONFIG_WRITES_MAX];
+    uint8_t n = build_config(&profile, reg, val);
+    for (uint8_t i = 0; i < n; i++) {
+        if (i2c_bus_write_blocking(addr, reg[i], &val[i], 1) != 0) goto absent;
+    }
 
-    bme_write8(REG_CTRL_HUM, 0x01);
-    bme_write8(REG_CONFIG, 0x00);
-    bme_write8(REG_CTRL_MEAS, 0x25);
+    active = profile;
+    bme_sched = sched;
+    build_schedule(&active, sched);
+    profile_dirty = false;
+    return 0;
+
+absent:
+    bme_addr = 0;
+    return -1;
 }
 
-void bme280_forced_measure(void)
+/* Integer compensation from the datasheet (section 8.2) and Bosch
+   BME280_compensate_*_int32/int64, returning the scaled readings */
+static int32_t compensate_t(int32_t adc_T, int32_t *t_fine)
 {
-    uint8_t ctrl = 0x25 | 0x01; // forced mode
-    bme_write8(REG_CTRL_MEAS, ctrl);
+    int32_t var1 = (((adc_T >> 3) - cal.t1_s1) * cal.t2) >> 11;
+    int32_t d = (adc_T >> 4) - cal.t1;
+    int32_t var2 = (((d * d) >> 12) * cal.t3) >> 14;
+    *t_fine = var1 + var2;
+    return (*t_fine * 5 + 128) >> 8;            // 0.01 degC
 }
 
-bool bme280_read(bme280_data_t *out)
+#if BME280_PRESSURE_32BIT
+static uint32_t compensate_p(int32_t adc_P, int32_t t_fine)
 {
-    uint8_t buf[8];
-    bme_read_buf(REG_PRESS_MSB, buf, 8);
+    int32_t var1 = (t_fine >> 1) - 64000;
+    int32_t sq = (var1 >> 2) * (var1 >> 2);
+    int32_t var2 = ((sq >> 11) * cal.p6) + ((var1 * cal.p5) << 1);
+    var2 = (var2 >> 2) + cal.p4_s16;
+    var1 = (((cal.p3 * (sq >> 13)) >> 3) + ((cal.p2 * var1) >> 1)) >> 18;
+    var1 = ((32768 + var1) * (int32_t)cal.p1) >> 15;
+    if (var1 == 0) return 0;
 
+    uint32_t p = ((uint32_t)(1048576 - adc_P) - (var2 >> 12)) * 3125;
+    if (p < 0x80000000u) p = (p << 1) / (uint32_t)var1;
+    else p = (p / (uint32_t)var1) * 2;
+    var1 = (cal.p9 * (int32_t)(((p >> 3) * (p >> 3)) >> 13)) >> 12;
+    var2 = ((int32_t)(p >> 2) * cal.p8) >> 13;
+    return (uint32_t)((int32_t)p + ((var1 + var2 + cal.p7) >> 4));  // Pa
+}
+#else
+static uint32_t compensate_p(int32_t adc_P, int32_t t_fine)
+{
+    int64_t var1 = (int64_t)t_fine - 128000;
+    int64_t var2 = var1 * var1 * cal.p6;
+    var2 += (var1 * cal.p5) << 17;
+    var2 += cal.p4_s35;
+    var1 = ((var1 * var1 * cal.p3) >> 8) + ((var1 * cal.p2) << 12);
+    var1 = ((((int64_t)1 << 47) + var1) * cal.p1) >> 33;
+    if (var1 == 0) return 0;
+
+    int64_t p = 1048576 - adc_P;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = ((int64_t)cal.p9 * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t)cal.p8 * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + cal.p7_s4;  // Q24.8 Pa
+    return (uint32_t)((p + 128) >> 8);
+}
+#endif
+
+static uint32_t compensate_h(int32_t adc_H, int32_t t_fine)
+{
+    int32_t v = t_fine - 76800;
+    v = ((((adc_H << 14) - cal.h4_s20 - (cal.h5 * v)) + 16384) >> 15) *
+        (((((((v * cal.h6) >> 10) * (((v * cal.h3) >> 11) + 32768)) >> 10) + 2097152) *
+          cal.h2 + 8192) >> 14);
+    v -= ((((v >> 15) * (v >> 15)) >> 7) * cal.h1) >> 4;
+    if (v < 0) v = 0;
+    if (v > 419430400) v = 419430400;
+    return (uint32_t)(v >> 12);                 // 1/1024 %RH
+}
+
+static int bme280_decode(const uint8_t *buf, sensor_values_t *out)
+{
     int32_t adc_P = ((int32_t)buf[0] << 12) | ((int32_t)buf[1] << 4) | (buf[2] >> 4);
     int32_t adc_T = ((int32_t)buf[3] << 12) | ((int32_t)buf[4] << 4) | (buf[5] >> 4);
     int32_t adc_H = ((int32_t)buf[6] << 8)  | buf[7];
+    int32_t t_fine;
 
-    // temperature
-    int32_t var1 = ((((adc_T>>3) - ((int32_t)dig_T1<<1))) * ((int32_t)dig_T2)) >> 11;
-    int32_t var2 = (((((adc_T>>4) - ((int32_t)dig_T1)) * ((adc_T>>4) - ((int32_t)dig_T1))) >> 12) *
-                    ((int32_t)dig_T3)) >> 14;
-    t_fine = var1 + var2;
-    float T = (t_fine * 5 + 128) >> 8;
-    out->temperature = T / 100.0f;
-
-    // pressure
-    int64_t var1p = ((int64_t)t_fine) - 128000;
-    int64_t var2p = var1p * var1p * (int64_t)dig_P6;
-    var2p = var2p + ((var1p * (int64_t)dig_P5) << 17);
-    var2p = var2p + (((int64_t)dig_P4) << 35);
-    var1p = ((var1p * var1p * (int64_t)dig_P3) >> 8) + ((var1p * (int64_t)dig_P2) << 12);
-    var1p = (((((int64_t)1) << 47) + var1p)) * ((int64_t)dig_P1) >> 33;
-    if (var1p == 0) return false;
-    int64_t p = 1048576 - adc_P;
-    p = (((p << 31) - var2p) * 3125) / var1p;
-    var1p = (((int64_t)dig_P9) * (p >> 13) * (p >> 13)) >> 25;
-    var2p = (((int64_t)dig_P8) * p) >> 19;
-    p = ((p + var1p + var2p) >> 8) + (((int64_t)dig_P7) << 4);
-    out->pressure = (float)p / 25600.0f;
-
-    // humidity
-    int32_t v_x1_u32r;
-    v_x1_u32r = (t_fine - ((int32_t)76800));
-    v_x1_u32r = (((((adc_H << 14) - (((int32_t)dig_H4) << 20) -
-                    (((int32_t)dig_H5) * v_x1_u32r)) + ((int32_t)16384)) >> 15) *
-                  (((((((v_x1_u32r * ((int32_t)dig_H6)) >> 10) *
-                       (((v_x1_u32r * ((int32_t)dig_H3)) >> 11) + ((int32_t)32768))) >> 10) +
-                     ((int32_t)2097152)) * ((int32_t)dig_H2) + 8192) >> 14));
-    v_x1_u32r = v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) *
-                               ((int32_t)dig_H1)) >> 4);
-    v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
-    v_x1_u32r = (v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r);
-    out->humidity = (v_x1_u32r >> 12) / 1024.0f;
-
-    out->last_update = HAL_GetTick();
-    out->valid = true;
-    return true;
-}
-
-static void bme_read_calibration(void)
-{
-    uint8_t calib1[26];
-    bme_read_buf(0x88, calib1, 26);
-
-    dig_T1 = (uint16_t)(calib1[1] << 8 | calib1[0]);
-    dig_T2 = (int16_t)(calib1[3] << 8 | calib1[2]);
-    dig_T3 = (int16_t)(calib1[5] << 8 | calib1[4]);
-    dig_P1 = (uint16_t)(calib1[7] << 8 | calib1[6]);
-    dig_P2 = (int16_t)(calib1[9] << 8 | calib1[8]);
-    dig_P3 = (int16_t)(calib1[11] << 8 | calib1[10]);
-    dig_P4 = (int16_t)(calib1[13] << 8 | calib1[12]);
-    dig_P5 = (int16_t)(calib1[15] << 8 | calib1[14]);
-    dig_P6 = (int16_t)(calib1[17] << 8 | calib1[16]);
-    dig_P7 = (int16_t)(calib1[19] << 8 | calib1[18]);
-    dig_P8 = (int16_t)(calib1[21] << 8 | calib1[20]);
-    dig_P9 = (int16_t)(calib1[23] << 8 | calib1[22]);
-    dig_H1 = calib1[25];
-
-    uint8_t calib2[7];
-    bme_read_buf(0xE1, calib2, 7);
-    dig_H2 = (int16_t)(calib2[1] << 8 | calib2[0]);
-    dig_H3 = calib2[2];
-    dig_H4 = (int16_t)((calib2[3] << 4) | (calib2[4] & 0x0F));
-    dig_H5 = (int16_t)((calib2[5] << 4) | (calib2[4] >> 4));
-    dig_H6 = (int8_t)calib2[6];
-}
-
-static uint8_t bme_read8(uint8_t reg)
-{
-    uint8_t val;
-    HAL_I2C_Mem_Read(bme_i2c, BME280_ADDR, reg, I2C_MEMADD_SIZE_8BIT, &val, 1, HAL_MAX_DELAY);
-    return val;
-}
-
-static void bme_read_buf(uint8_t reg, uint8_t *buf, uint16_t len)
-{
-    HAL_I2C_Mem_Read(bme_i2c, BME280_ADDR, reg, I2C_MEMADD_SIZE_8BIT, buf, len, HAL_MAX_DELAY);
-}
-
-static void bme_write8(uint8_t reg, uint8_t val)
-{
-    HAL_I2C_Mem_Write(bme_i2c, BME280_ADDR, reg, I2C_MEMADD_SIZE_8BIT, &val, 1, HAL_MAX_DELAY);
+    // 0x80000 is the reset value of a channel that never converted
+    if (adc_T == 0x80000) return -1;
+    out->value[SENSOR_TEMP] = compensate_t(adc_T, &t_fine);
+    out->mask = 1 << SENSOR_TEMP;
+    // Skipped channels are left out of the mask (also right after a
+    // profile change, when they may still hold the reset value)
+    if (active.osrs_p && adc_P != 0x80000) {
+        uint32_t p = compensate_p(adc_P, t_fine);
+        if (p == 0) return -1;
+        out->value[SENSOR_PRESS] = (int32_t)p;
+        out->mask |= 1 << SENSOR_PRESS;
+    }
+    if (active.osrs_h && adc_H != 0x8000) {
+        out->value[SENSOR_HUM] = (int32_t)compensate_h(adc_H, t_fine);
+        out->mask |= 1 << SENSOR_HUM;
+    }
+
+    // A profile change that found the queue full goes out after this sample
+    if (profile_dirty) apply_profile();
+    return 0;
+}
+
+/* After a failed transfer: the sensor may have been reset, which also drops
+   it back to sleep mode with default settings */
+static void bme280_reconfigure(void)
+{
+    profile_dirty = true;
+    apply_profile();
+}
+
+const sensor_driver_t bme280_driver = {
+    .name = "bme280",
+    .addr = { BME280_ADDR_PRIMARY, BME280_ADDR_SECONDARY },
+    .init = bme280_driver_init,
+    .decode = bme280_decode,
+    .reconfigure = bme280_reconfigure,
+};
+
+/* --- Profiles --- */
+
+int bme280_set_profile(const bme280_profile_t *p)
+{
+    if (p->mode != BME280_MODE_FORCED && p->mode != BME280_MODE_NORMAL) return -1;
+    if (p->osrs_t == 0 || OSRS(p->osrs_t) < 0 || OSRS(p->osrs_p) < 0 || OSRS(p->osrs_h) < 0) return -1;
+    if (FILTER(p->filter) < 0 || code_standby(p->standby_us) < 0) return -1;
+    if (p->period_ms < BME280_MIN_PERIOD_MS) return -1;
+
+    bme280_profile_info_t info;
+    bme280_profile_info(p, &info);
+    // A forced measurement has to finish before the next trigger
+    if (p->mode == BME280_MODE_FORCED && (uint64_t)p->period_ms * 1000 <= info.meas_max_us) return -1;
+
+    profile = *p;
+    profile.name = "custom";
+    for (uint8_t i = 0; i < sizeof(presets) / sizeof(presets[0]); i++) {
+        const bme280_profile_t *q = &presets[i];
+        if (q->mode == p->mode && q->osrs_t == p->osrs_t && q->osrs_p == p->osrs_p &&
+            q->osrs_h == p->osrs_h && q->filter == p->filter &&
+            q->standby_us == p->standby_us && q->period_ms == p->period_ms) {
+            profile.name = q->name;
+            break;
+        }
+    }
+    profile_dirty = true;
+    apply_profile();
+    return 0;
+}
+
+int bme280_set_preset(const char *name)
+{
+    for (uint8_t i = 0; i < sizeof(presets) / sizeof(presets[0]); i++) {
+        if (strcasecmp(name, presets[i].name) == 0) return bme280_set_profile(&presets[i]);
+    }
+    return -1;
+}
+
+const bme280_profile_t *bme280_preset(uint8_t i)
+{
+    return i < sizeof(presets) / sizeof(presets[0]) ? &presets[i] : NULL;
+}
+
+void bme280_get_profile(bme280_profile_t *out)
+{
+    *out = profile.name ? profile : presets[0];
+}
+
+/* Datasheet section 9.1 (measurement time) and the per-channel currents of
+   table 2: 350 uA temperature, 714 uA pressure, 340 uA humidity */
+void bme280_profile_info(const bme280_profile_t *p, bme280_profile_info_t *out)
+{
+    uint32_t t_us = 2000u * p->osrs_t;
+    uint32_t p_us = p->osrs_p ? 2000u * p->osrs_p + 500 : 0;
+    uint32_t h_us = p->osrs_h ? 2000u * p->osrs_h + 500 : 0;
+
+    out->meas_typ_us = 1000 + t_us + p_us + h_us;
+    out->meas_max_us = 1250 + 2300u * p->osrs_t +
+                       (p->osrs_p ? 2300u * p->osrs_p + 575 : 0) +
+                       (p->osrs_h ? 2300u * p->osrs_h + 575 : 0);
+
+    uint32_t cycle_us, idle_na;
+    if (p->mode == BME280_MODE_NORMAL) {
+        cycle_us = out->meas_typ_us + p->standby_us;
+        idle_na = 200;      // Standby current
+    } else {
+        cycle_us = p->period_ms * 1000u;
+        idle_na = 100;      // Sleep current
+    }
+    out->odr_mhz = 1000000000u / cycle_us;
+
+    // Charge per measurement in pC (us * uA), spread over the cycle
+    uint64_t charge = (uint64_t)t_us * 350 + (uint64_t)p_us * 714 + (uint64_t)h_us * 340;
+    out->current_na = (uint32_t)(charge * 1000 / cycle_us) + idle_na;
+}
+
+static int bme_read_calibration(void)
+{
+    uint8_t c[26];
+    if (i2c_bus_read_blocking(bme_addr, 0x88, c, 26) != 0) return -1;
+
+    uint16_t t1 = (uint16_t)(c[1] << 8 | c[0]);
+    cal.t1 = t1;
+    cal.t1_s1 = (int32_t)t1 << 1;
+    cal.t2 = (int16_t)(c[3] << 8 | c[2]);
+    cal.t3 = (int16_t)(c[5] << 8 | c[4]);
+    cal.p1 = (uint16_t)(c[7] << 8 | c[6]);
+    cal.p2 = (int16_t)(c[9] << 8 | c[8]);
+    cal.p3 = (int16_t)(c[11] << 8 | c[10]);
+    int16_t p4 = (int16_t)(c[13] << 8 | c[12]);
+#if BME280_PRESSURE_32BIT
+    cal.p4_s16 = (int32_t)p4 * 65536;
+#else
+    cal.p4_s35 = (int64_t)p4 * ((int64_t)1 << 35);
+#endif
+    cal.p5 = (int16_t)(c[15] << 8 | c[14]);
+    cal.p6 = (int16_t)(c[17] << 8 | c[16]);
+    int16_t p7 = (int16_t)(c[19] << 8 | c[18]);
+#if BME280_PRESSURE_32BIT
+    cal.p7 = p7;
+#else
+    cal.p7_s4 = (int32_t)p7 * 16;
+#endif
+    cal.p8 = (int16_t)(c[21] << 8 | c[20]);
+    cal.p9 = (int16_t)(c[23] << 8 | c[22]);
+    cal.h1 = c[25];
+
+    if (i2c_bus_read_blocking(bme_addr, 0xE1, c, 7) != 0) return -1;
+    cal.h2 = (int16_t)(c[1] << 8 | c[0]);
+    cal.h3 = c[2];
+    // H4 and H5 are 12-bit signed, sharing 0xE5
+    int16_t h4 = (int16_t)((int8_t)c[3] * 16) | (c[4] & 0x0F);
+    cal.h4_s20 = (int32_t)h4 * 1048576;
+    cal.h5 = (int16_t)((int8_t)c[5] * 16) | (c[4] >> 4);
+    cal.h6 = (int8_t)c[6];
+    return 0;
 }
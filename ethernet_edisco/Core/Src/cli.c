@@ -8,22 +8,38 @@
 #include "w5500.h"
 #include "wizchip_conf.h"
 #include "bme.h"
+#include "sensors.h"
+#include "i2c_bus.h"
 #include "gps.h"
+#include "nmea.h"
+#include "ubx.h"
+#include "ntp.h"
+#include "socket.h"
 #include <string.h>
 #include <stdio.h>
 
 static uint32_t gps_last_update = 0;
-static uint32_t env_last_update = 0;
 
 #define CLI_BUF_SIZE 128
 static char cli_buffer[CLI_BUF_SIZE];
 static uint8_t cli_index = 0;
 
 extern wiz_NetInfo gWIZNETINFO;
-extern bme280_data_t bme_data;
 extern gps_pos_t gps_data;
 
+// Output goes to a buffer while cli_run() executes a command, else to the UART
+static char* cli_out = NULL;
+static uint16_t cli_out_size = 0;
+static uint16_t cli_out_len = 0;
+
 static void cli_print(const char* str) {
+    if (cli_out) {
+        uint16_t n = strlen(str);
+        if (n > cli_out_size - cli_out_len) n = cli_out_size - cli_out_len;
+        memcpy(cli_out + cli_out_len, str, n);
+        cli_out_len += n;
+        return;
+    }
     HAL_UART_Transmit(&huart1, (uint8_t*)str, strlen(str), 1000);
 }
 
@@ -32,6 +48,16 @@ static void cli_println(const char* str) {
     cli_print("\r\n");
 }
 
+/**
+ * @brief Commands that change the device: always from the UART, from the
+ *        network (output captured by cli_run) only with CLI_REMOTE_WRITE
+ */
+static int cli_write_allowed(void) {
+    if (CLI_REMOTE_WRITE || !cli_out) return 1;
+    cli_println("Not allowed over the network (read-only)");
+    return 0;
+}
+
 /**
  * @brief NET command - Display network parameters and status
  */
@@ -45,35 +71,35 @@ static void cmd_net(void) {
     wizchip_getnetinfo(&netinfo);
 
     // MAC Address
-    printf(buf, "MAC:  %02X:%02X:%02X:%02X:%02X:%02X",
+    snprintf(buf, sizeof(buf), "MAC:  %02X:%02X:%02X:%02X:%02X:%02X",
             netinfo.mac[0], netinfo.mac[1], netinfo.mac[2],
             netinfo.mac[3], netinfo.mac[4], netinfo.mac[5]);
     cli_println(buf);
 
     // IP Address
-    printf(buf, "IP:   %d.%d.%d.%d",
+    snprintf(buf, sizeof(buf), "IP:   %d.%d.%d.%d",
             netinfo.ip[0], netinfo.ip[1], netinfo.ip[2], netinfo.ip[3]);
     cli_println(buf);
 
     // Subnet Mask
-    printf(buf, "Mask: %d.%d.%d.%d",
+    snprintf(buf, sizeof(buf), "Mask: %d.%d.%d.%d",
             netinfo.sn[0], netinfo.sn[1], netinfo.sn[2], netinfo.sn[3]);
     cli_println(buf);
 
     // Gateway
-    printf(buf, "GW:   %d.%d.%d.%d",
+    snprintf(buf, sizeof(buf), "GW:   %d.%d.%d.%d",
             netinfo.gw[0], netinfo.gw[1], netinfo.gw[2], netinfo.gw[3]);
     cli_println(buf);
 
     // DNS Server
-    printf(buf, "DNS:  %d.%d.%d.%d",
+    snprintf(buf, sizeof(buf), "DNS:  %d.%d.%d.%d",
             netinfo.dns[0], netinfo.dns[1], netinfo.dns[2], netinfo.dns[3]);
     cli_println(buf);
 
     // Link Status (simple check - if IP is not 0.0.0.0)
     uint8_t link_up = (netinfo.ip[0] != 0 || netinfo.ip[1] != 0 ||
                        netinfo.ip[2] != 0 || netinfo.ip[3] != 0);
-    printf(buf, "Link: %s", link_up ? "UP" : "DOWN");
+    snprintf(buf, sizeof(buf), "Link: %s", link_up ? "UP" : "DOWN");
     cli_println(buf);
 
     // Uptime
@@ -81,9 +107,22 @@ static void cmd_net(void) {
     uint32_t hours = uptime_sec / 3600;
     uint32_t minutes = (uptime_sec % 3600) / 60;
     uint32_t seconds = uptime_sec % 60;
-    printf(buf, "Uptime: %luh %lum %lus", hours, minutes, seconds);
+    snprintf(buf, sizeof(buf), "Uptime: %luh %lum %lus", hours, minutes, seconds);
     cli_println(buf);
 
+    // Socket command latency, Sn_CR write to completion
+    static const char* const cmd_name[SOCK_CMD_COUNT] = {
+        "OPEN", "LISTEN", "CONNECT", "SEND", "RECV", "DISCON", "CLOSE"
+    };
+    cli_println("Socket cmd   count   fail  last us   max us   avg us");
+    for (uint8_t i = 0; i < SOCK_CMD_COUNT; i++) {
+        const sock_cmd_stats_t* st = socket_cmd_stats((sock_cmd_t)i);
+        snprintf(buf, sizeof(buf), "  %-8s %7lu %6lu %8lu %8lu %8lu", cmd_name[i],
+                 st->count, st->failures, st->last_us, st->max_us,
+                 st->count ? (uint32_t)(st->total_us / st->count) : 0);
+        cli_println(buf);
+    }
+
     cli_println("====================\r\n");
 }
 
@@ -92,8 +131,11 @@ static void cmd_net(void) {
  */
 static void cmd_help(void) {
     cli_println("\r\nAvailable Commands:");
-    cli_println("  NET    - Show network status");
-    cli_println("  STATUS - Show sensor data status");
+    cli_println("  NET    - Show network status and socket command latency");
+    cli_println("  STATUS - Show sensor data and GPS receiver status");
+    cli_println("  NTP    - Show time server status");
+    cli_println("  BME    - Show sensor profile, BME <preset> to switch,");
+    cli_println("           BME SET <t> <p> <h> <iir> <standby_us> FORCED|NORMAL <period_ms>");
     cli_println("  REBOOT - Restart device");
     cli_println("  HELP   - Show this message\r\n");
 }
@@ -102,7 +144,7 @@ static void cmd_help(void) {
  * @brief STATUS command - Show sensor data status
  */
 static void cmd_status(void) {
-    char buf[100];
+    char buf[128];
     uint32_t now = HAL_GetTick();
 
     cli_println("\r\n=== Sensor Status ===");
@@ -111,46 +153,169 @@ static void cmd_status(void) {
     float gps_age = (float)(now - gps_last_update) / 1000.0f;
     if(gps_last_update == 0) gps_age = 999.9f;
 
-    printf(buf, "GPS:     Age %.1fs %s",
+    snprintf(buf, sizeof(buf), "GPS:     Age %.1fs %s",
             gps_age, gps_age > 3.0f ? "(STALE)" : "(OK)");
     cli_println(buf);
 
-    printf(buf, "         Lat: %.5f, Lon: %.5f",
-            gps_data.lat_deg, gps_data.lon_deg);
+    snprintf(buf, sizeof(buf), "         Lat: %.5f, Lon: %.5f",
+            gps_data.lat_e7 / 1e7, gps_data.lon_e7 / 1e7);
     cli_println(buf);
 
-    printf(buf, "         Fix: %d, Sats: %d",
+    snprintf(buf, sizeof(buf), "         Fix: %d, Sats: %d",
             gps_data.fix, gps_data.sats);
     cli_println(buf);
 
+    static const char* const ubx_mode_name[] = { "NMEA", "configuring", "UBX NAV-PVT" };
+    ubx_stats_t us = ubx_get_stats();
+    snprintf(buf, sizeof(buf), "         Receiver: %s, UBX %lu frames, %lu PVT, %lu cksum, %lu long, %lu fallback",
+            ubx_mode_name[ubx_get_mode()], us.frames, us.pvt, us.checksum_failed, us.too_long,
+            us.fallbacks);
+    cli_println(buf);
+
+    nmea_stats_t ns = nmea_get_stats();
+    snprintf(buf, sizeof(buf), "         NMEA: %lu/%lu ok, cksum %lu, trunc %lu, char %lu, long %lu, eol %lu",
+            ns.valid, ns.lines, ns.checksum_failed + ns.bad_checksum_hex, ns.truncated,
+            ns.bad_char, ns.overflow, ns.bad_eol);
+    cli_println(buf);
+    snprintf(buf, sizeof(buf), "         Epochs: %lu, parse max %lu us (budget %u), %lu over",
+            ns.epochs, ns.epoch_parse_us_max, NMEA_EPOCH_BUDGET_US, ns.epochs_over_budget);
+    cli_println(buf);
+
     // Sensor status
-    float sensor_age = (float)(now - bme_data.last_update) / 1000.0f;
-    if(bme_data.last_update == 0) sensor_age = 999.9f;
+    sensor_sample_t env = sensors_get(SENSOR_TEMP);
+    float sensor_age = (float)(now - env.last_update) / 1000.0f;
+    if(env.last_update == 0) sensor_age = 999.9f;
 
-    printf(buf, "Sensors: Age %.1fs %s",
-            sensor_age, sensor_age > 3.0f ? "(STALE)" : "(OK)");
+    snprintf(buf, sizeof(buf), "Sensors: Age %.1fs %s",
+            sensor_age, sensor_age > sensors_stale_ms(SENSOR_TEMP) / 1000.0f ? "(STALE)" : "(OK)");
     cli_println(buf);
 
-    printf(buf, "         T: %.1f°C, P: %.1f hPa, H: %.1f%%",
-            bme_data.temperature, bme_data.pressure, bme_data.humidity);
+    char t[12], p[12], h[12], l[12];
+    sensors_format_tenths(t, sizeof(t), sensors_tenths(SENSOR_TEMP));
+    sensors_format_tenths(p, sizeof(p), sensors_tenths(SENSOR_PRESS));
+    sensors_format_tenths(h, sizeof(h), sensors_tenths(SENSOR_HUM));
+    sensors_format_tenths(l, sizeof(l), sensors_tenths(SENSOR_LUX));
+    snprintf(buf, sizeof(buf), "         T: %s°C, P: %s hPa, H: %s%%, L: %s lx", t, p, h, l);
+    cli_println(buf);
+
+    sensor_info_t si;
+    for (uint8_t i = 0; sensors_info(i, &si); i++) {
+        if (si.present) {
+            snprintf(buf, sizeof(buf), "         %-7s 0x%02X every %lums, %lu samples, %lu err, %lu cyc",
+                    si.name, si.addr, si.period_ms, si.samples, si.errors, si.decode_cycles);
+        } else {
+            snprintf(buf, sizeof(buf), "         %-7s absent", si.name);
+        }
+        cli_println(buf);
+    }
+
+    i2c_bus_stats_t bs;
+    i2c_bus_get_stats(&bs);
+    snprintf(buf, sizeof(buf), "         I2C: %lu ok, NACK %lu, err %lu, timeout %lu, recover %lu",
+            bs.transfers, bs.nacks, bs.bus_errors, bs.timeouts, bs.recoveries);
     cli_println(buf);
 
     cli_println("====================\r\n");
 }
 
+/**
+ * @brief BME command - Show or change the BME280 measurement profile
+ */
+static void cmd_bme(const char* args) {
+    char buf[100];
+
+    if (*args) {
+        int ret;
+        if (strncmp(args, "SET ", 4) == 0) {
+            bme280_profile_t p;
+            unsigned t, pr, h, iir;
+            unsigned long sb, period;
+            char mode[8];
+            bme280_get_profile(&p);
+            if (sscanf(args + 4, "%u %u %u %u %lu %7s %lu", &t, &pr, &h, &iir, &sb, mode, &period) != 7 ||
+                t > 0xFF || pr > 0xFF || h > 0xFF || iir > 0xFF) {
+                cli_println("Usage: BME SET <t> <p> <h> <iir> <standby_us> FORCED|NORMAL <period_ms>");
+                return;
+            }
+            p.osrs_t = t; p.osrs_p = pr; p.osrs_h = h; p.filter = iir;
+            p.standby_us = sb;
+            p.period_ms = period;
+            p.mode = strcmp(mode, "NORMAL") == 0 ? BME280_MODE_NORMAL :
+                     strcmp(mode, "FORCED") == 0 ? BME280_MODE_FORCED : 0;
+            ret = bme280_set_profile(&p);
+        } else {
+            ret = bme280_set_preset(args);
+        }
+        if (ret < 0) {
+            cli_println("Invalid profile (oversampling 0-16, IIR 0-16, datasheet standby, period > t_meas)");
+            return;
+        }
+    }
+
+    bme280_profile_t p;
+    bme280_profile_info_t info;
+    bme280_get_profile(&p);
+    bme280_profile_info(&p, &info);
+
+    cli_println("\r\n=== BME280 Profile ===");
+    snprintf(buf, sizeof(buf), "Profile: %s, %s mode, every %lu ms",
+             p.name, p.mode == BME280_MODE_NORMAL ? "normal" : "forced", p.period_ms);
+    cli_println(buf);
+    snprintf(buf, sizeof(buf), "Oversampling: T x%u, P x%u, H x%u  IIR %u  Standby %lu us",
+             p.osrs_t, p.osrs_p, p.osrs_h, p.filter, p.standby_us);
+    cli_println(buf);
+    snprintf(buf, sizeof(buf), "t_meas: %.2f ms typ, %.2f ms max  ODR %.3f Hz  I %.2f uA",
+             info.meas_typ_us / 1000.0f, info.meas_max_us / 1000.0f,
+             info.odr_mhz / 1000.0f, info.current_na / 1000.0f);
+    cli_println(buf);
+
+    cli_print("Presets:");
+    const bme280_profile_t* q;
+    for (uint8_t i = 0; (q = bme280_preset(i)) != NULL; i++) {
+        cli_print(" ");
+        cli_print(q->name);
+    }
+    cli_println("\r\n======================\r\n");
+}
+
+/**
+ * @brief NTP command - Time server reference and counters
+ */
+static void cmd_ntp(void) {
+    char buf[80];
+    ntp_stats_t st;
+    ntp_get_stats(&st);
+
+    cli_println("\r\n=== NTP Server ===");
+    if (st.ref_age_ms == UINT32_MAX) {
+        cli_println("Reference: none (stratum 16)");
+    } else {
+        snprintf(buf, sizeof(buf), "Reference: %s, age %lu ms %s",
+                 st.pps ? "PPS" : "GPS", (unsigned long)st.ref_age_ms,
+                 st.synced ? "(stratum 1)" : "(unsynchronized)");
+        cli_println(buf);
+    }
+    snprintf(buf, sizeof(buf), "Clock:     %lu Hz", (unsigned long)st.freq_hz);
+    cli_println(buf);
+    snprintf(buf, sizeof(buf), "Requests:  %lu, replies %lu, dropped %lu",
+             (unsigned long)st.requests, (unsigned long)st.replies, (unsigned long)st.dropped);
+    cli_println(buf);
+    cli_println("==================\r\n");
+}
+
 /**
  * @brief REBOOT command - Software reset
  */
 static void cmd_reboot(void) {
     cli_println("\r\nRebooting...\r\n");
     HAL_Delay(100);
-    NVIC_SystemReset();
+    HAL_NVIC_SystemReset();
 }
 
 /**
- * @brief Parse and execute command
+ * @brief Parse and execute the command in cli_buffer
  */
-static void cli_execute(void) {
+static void cli_run_buffer(void) {
     // Convert to uppercase
     for(int i = 0; i < cli_index; i++) {
         if(cli_buffer[i] >= 'a' && cli_buffer[i] <= 'z') {
@@ -171,18 +336,59 @@ static void cli_execute(void) {
     else if(strcmp(cli_buffer, "STATUS") == 0) {
         cmd_status();
     }
+    else if(strcmp(cli_buffer, "BME") == 0) {
+        cmd_bme("");
+    }
+    else if(strncmp(cli_buffer, "BME ", 4) == 0) {
+        if(cli_write_allowed()) cmd_bme(cli_buffer + 4);
+    }
+    else if(strcmp(cli_buffer, "NTP") == 0) {
+        cmd_ntp();
+    }
     else if(strcmp(cli_buffer, "REBOOT") == 0) {
-        cmd_reboot();
+        if(cli_write_allowed()) cmd_reboot();
     }
     else if(strlen(cli_buffer) > 0) {
         cli_println("Unknown command. Type HELP for list.");
     }
+}
+
+/**
+ * @brief Execute the typed line and prompt for the next one
+ */
+static void cli_execute(void) {
+    cli_run_buffer();
 
     // Reset buffer
     cli_index = 0;
     cli_print("> ");
 }
 
+/**
+ * @brief Execute one command line, output goes to out instead of the UART
+ */
+uint16_t cli_run(const char* line, char* out, uint16_t out_size) {
+    // Shares cli_buffer with the UART line editor, keep what was typed there
+    char saved[CLI_BUF_SIZE];
+    uint8_t saved_index = cli_index;
+    memcpy(saved, cli_buffer, sizeof(saved));
+
+    uint16_t n = strlen(line);
+    if (n > CLI_BUF_SIZE - 1) n = CLI_BUF_SIZE - 1;
+    memcpy(cli_buffer, line, n);
+    cli_index = n;
+
+    cli_out = out;
+    cli_out_size = out_size;
+    cli_out_len = 0;
+    cli_run_buffer();
+    cli_out = NULL;
+
+    memcpy(cli_buffer, saved, sizeof(saved));
+    cli_index = saved_index;
+    return cli_out_len;
+}
+
 /**
  * @brief Process CLI characters
  */
@@ -0,0 +1,449 @@
+/* dhcp.c - non-blocking DHCP client (RFC 2131) for W5500
+ *
+ * The client is a state machine stepped by dhcp_process() from the main
+ * loop. A step reads whatever replies are queued on DHCP_SOCKET and sends
+ * at most one message when a timer is due; nothing waits for the network,
+ * so sensor and display work carry on while an address is being leased
+ * or renewed. Between events a step costs no SPI traffic: replies wake it
+ * through w5500_event, timers through HAL_GetTick.
+ *
+ *   INIT -> SELECTING -> REQUESTING -> BOUND -> RENEWING -> REBINDING
+ *              ^  |                      ^  (T1)    |  (T2)     |
+ *              |  v (DHCP_FALLBACK_MS)   +----ACK---+-----------+
+ *            STATIC                       lease expired -> SELECTING
+ *
+ * Messages ask for broadcast replies, so OFFER/ACK reach the chip before
+ * it has an address. Lease times are clamped to 24 days so every timer
+ * stays within the HAL_GetTick wrap.
+ *
+ * Not implemented: ARP probing of the offered address (DECLINE), RELEASE,
+ * INIT-REBOOT with a remembered address, option overload.
+ */
+
+#include "dhcp.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include "main.h"
+#include <string.h>
+
+#define DHCP_BUF_SIZE       576     // Minimum datagram every host must accept
+#define DHCP_FIXED_LEN      236     // BOOTP header up to the options
+#define DHCP_MIN_LEN        300     // BOOTP minimum, some relays drop shorter ones
+#define DHCP_MAX_LEASE_S    2000000 // Clamp so lease timers fit int32 milliseconds
+
+#define DHCP_BOOTREQUEST    1
+#define DHCP_BOOTREPLY      2
+
+/* Message types, option 53 */
+#define DHCP_DISCOVER   1
+#define DHCP_OFFER      2
+#define DHCP_REQUEST    3
+#define DHCP_ACK        5
+#define DHCP_NAK        6
+
+/* Options */
+#define OPT_PAD         0
+#define OPT_SUBNET      1
+#define OPT_ROUTER      3
+#define OPT_DNS         6
+#define OPT_HOSTNAME    12
+#define OPT_REQ_IP      50
+#define OPT_LEASE       51
+#define OPT_MSG_TYPE    53
+#define OPT_SERVER_ID   54
+#define OPT_PARAM_LIST  55
+#define OPT_T1          58
+#define OPT_T2          59
+#define OPT_CLIENT_ID   61
+#define OPT_END         255
+
+static const uint8_t magic[4] = {0x63, 0x82, 0x53, 0x63};
+static const uint8_t bcast_ip[4] = {255, 255, 255, 255};
+
+/* Fields of a received reply */
+typedef struct {
+    uint8_t  type;
+    uint8_t  yiaddr[4];
+    uint8_t  server_id[4];
+    uint8_t  mask[4];
+    uint8_t  router[4];
+    uint8_t  dns[4];
+    uint32_t lease_s, t1_s, t2_s;   // 0 = not sent
+} dhcp_reply_t;
+
+static dhcp_state_t state = DHCP_STATE_INIT;
+static wiz_NetInfo fallback_info;
+static wiz_NetInfo applied;         // Configuration last written with setnetinfo()
+static char hostname[32];
+static dhcp_callback_t on_change = NULL;
+static uint8_t mac[6];
+static uint8_t fallback_active = 0;
+
+static uint32_t xid = 0;
+static uint8_t offered_ip[4];
+static uint8_t server_ip[4];
+static uint8_t tries = 0;           // REQUESTs sent for the current OFFER
+static uint32_t start_ms = 0;       // Start of the current acquisition or renewal
+static uint32_t next_ms = 0;        // Next (re)transmission or lease timer
+static uint32_t retry_ms = DHCP_RETRY_MS;
+
+static uint32_t bound_ms = 0;       // When the lease was (last) acknowledged
+static uint32_t t1_ms, t2_ms, lease_ms;  // Relative to bound_ms
+
+static volatile uint8_t dhcp_pending = 1;
+static uint8_t buf[DHCP_BUF_SIZE];
+
+static void dhcp_socket_event(uint8_t sn, uint8_t events) {
+    (void)sn; (void)events;
+    dhcp_pending = 1;
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void set32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = (v >> 16) & 0xFF;
+    p[2] = (v >> 8) & 0xFF;
+    p[3] = v & 0xFF;
+}
+
+static uint32_t secs_to_ms(uint32_t s) {
+    return (s > DHCP_MAX_LEASE_S ? DHCP_MAX_LEASE_S : s) * 1000;
+}
+
+static int ip_is_zero(const uint8_t* ip) {
+    return (ip[0] | ip[1] | ip[2] | ip[3]) == 0;
+}
+
+static uint32_t due_in(uint32_t now) {
+    return (int32_t)(next_ms - now) > 0 ? next_ms - now : 0;
+}
+
+/* --- Sending --- */
+
+static uint8_t* put_opt(uint8_t* p, uint8_t code, const void* data, uint8_t len) {
+    p[0] = code;
+    p[1] = len;
+    memcpy(p + 2, data, len);
+    return p + 2 + len;
+}
+
+/* Queue one message, 0 if sent, negative to retry on the next step */
+static int send_msg(uint8_t type, uint32_t now) {
+    uint8_t renewing = (state == DHCP_STATE_RENEWING || state == DHCP_STATE_REBINDING);
+    uint16_t secs = (now - start_ms) / 1000;
+
+    memset(buf, 0, DHCP_FIXED_LEN);
+    buf[0] = DHCP_BOOTREQUEST;
+    buf[1] = 1;     // Ethernet
+    buf[2] = 6;     // MAC length
+    set32(buf + 4, xid);
+    buf[8] = secs >> 8;
+    buf[9] = secs & 0xFF;
+    if (renewing) {
+        memcpy(buf + 12, applied.ip, 4);    // ciaddr, replies come unicast
+    } else {
+        buf[10] = 0x80;                     // BROADCAST, we cannot receive unicast yet
+    }
+    memcpy(buf + 28, mac, 6);
+    memcpy(buf + DHCP_FIXED_LEN, magic, 4);
+
+    uint8_t* p = buf + DHCP_FIXED_LEN + 4;
+    p = put_opt(p, OPT_MSG_TYPE, &type, 1);
+    uint8_t client_id[7] = { 1, mac[0], mac[1], mac[2], mac[3], mac[4], mac[5] };
+    p = put_opt(p, OPT_CLIENT_ID, client_id, sizeof(client_id));
+    if (hostname[0]) p = put_opt(p, OPT_HOSTNAME, hostname, strlen(hostname));
+    if (state == DHCP_STATE_REQUESTING) {
+        p = put_opt(p, OPT_REQ_IP, offered_ip, 4);
+        p = put_opt(p, OPT_SERVER_ID, server_ip, 4);
+    }
+    static const uint8_t params[] = { OPT_SUBNET, OPT_ROUTER, OPT_DNS, OPT_LEASE, OPT_T1, OPT_T2 };
+    p = put_opt(p, OPT_PARAM_LIST, params, sizeof(params));
+    *p++ = OPT_END;
+
+    uint16_t len = p - buf;
+    if (len < DHCP_MIN_LEN) {
+        memset(p, OPT_PAD, DHCP_MIN_LEN - len);
+        len = DHCP_MIN_LEN;
+    }
+
+    // A datagram goes out whole or not at all, retry next step if TX is busy
+    if (get_socket_tx_free(DHCP_SOCKET) < len) return -1;
+
+    // The chip reads Sn_DIPR until the previous SEND got SENDOK or TIMEOUT
+    // (a unicast REQUEST can sit in ARP), switch it only after that
+    if (socket_send_wait(DHCP_SOCKET, 0) > 0) return -1;
+
+    // Renewal is unicast to the leasing server, everything else broadcast
+    const uint8_t* ip = (state == DHCP_STATE_RENEWING) ? server_ip : bcast_ip;
+    uint8_t d[6] = { ip[0], ip[1], ip[2], ip[3], DHCP_SERVER_PORT >> 8, DHCP_SERVER_PORT & 0xFF };
+    W5500_WRITE_BUF(W5500_Sn_DIPR0(DHCP_SOCKET), d, sizeof(d));
+
+    return (send_socket_nb(DHCP_SOCKET, buf, len) == len) ? 0 : -1;
+}
+
+/* --- State changes --- */
+
+/* New transaction; start_ms (the fallback deadline) is left to the caller */
+static void start_discovery(uint32_t now) {
+    xid = xid * 1103515245u + 12345u + now;
+    state = fallback_active ? DHCP_STATE_STATIC : DHCP_STATE_SELECTING;
+    retry_ms = DHCP_RETRY_MS;
+    next_ms = now;
+}
+
+static void apply_fallback(uint32_t now) {
+    wiz_NetInfo net = fallback_info;
+    memcpy(net.mac, mac, 6);
+    applied = net;
+    setnetinfo(&net);
+
+    fallback_active = 1;
+    state = DHCP_STATE_STATIC;
+    next_ms = now + DHCP_STATIC_RETRY_MS;
+    if (on_change) on_change();
+}
+
+static void bind_lease(const dhcp_reply_t* r, uint32_t now) {
+    wiz_NetInfo net = applied;
+    memcpy(net.ip, r->yiaddr, 4);
+    if (!ip_is_zero(r->mask))   memcpy(net.sn, r->mask, 4);
+    if (!ip_is_zero(r->router)) memcpy(net.gw, r->router, 4);
+    if (!ip_is_zero(r->dns))    memcpy(net.dns, r->dns, 4);
+    if (!ip_is_zero(r->server_id)) memcpy(server_ip, r->server_id, 4);
+
+    lease_ms = secs_to_ms(r->lease_s ? r->lease_s : 3600);
+    t1_ms = r->t1_s ? secs_to_ms(r->t1_s) : lease_ms / 2;
+    t2_ms = r->t2_s ? secs_to_ms(r->t2_s) : lease_ms - lease_ms / 8;
+    if (t2_ms > lease_ms) t2_ms = lease_ms;
+    if (t1_ms > t2_ms) t1_ms = t2_ms;
+
+    bound_ms = now;
+    next_ms = now + t1_ms;
+    state = DHCP_STATE_BOUND;
+    fallback_active = 0;
+
+    // A renewal of the same lease changes nothing on the chip
+    if (memcmp(&applied, &net, sizeof(net)) != 0) {
+        applied = net;
+        setnetinfo(&net);
+        if (on_change) on_change();
+    }
+}
+
+/* Retransmission during RENEWING / REBINDING: half the time left to the
+   deadline, but not more often than DHCP_RENEW_RETRY_MIN_MS */
+static void schedule_renewal(uint32_t now, uint32_t deadline_ms) {
+    uint32_t elapsed = now - bound_ms;
+    uint32_t wait = (deadline_ms > elapsed) ? (deadline_ms - elapsed) / 2 : 0;
+    if (wait < DHCP_RENEW_RETRY_MIN_MS) wait = DHCP_RENEW_RETRY_MIN_MS;
+    if (elapsed + wait > deadline_ms) wait = deadline_ms - elapsed;
+    next_ms = now + wait;
+}
+
+/* --- Receiving --- */
+
+static int parse_reply(uint16_t len, dhcp_reply_t* r) {
+    if (len < DHCP_FIXED_LEN + 4 || buf[0] != DHCP_BOOTREPLY) return -1;
+    if (get32(buf + 4) != xid || memcmp(buf + 28, mac, 6) != 0) return -1;
+    if (memcmp(buf + DHCP_FIXED_LEN, magic, 4) != 0) return -1;
+
+    memset(r, 0, sizeof(*r));
+    memcpy(r->yiaddr, buf + 16, 4);
+
+    uint16_t pos = DHCP_FIXED_LEN + 4;
+    while (pos < len) {
+        uint8_t code = buf[pos++];
+        if (code == OPT_PAD) continue;
+        if (code == OPT_END || pos >= len) break;
+        uint8_t olen = buf[pos++];
+        if (pos + olen > len) return -1;
+        const uint8_t* v = buf + pos;
+
+        switch (code) {
+            case OPT_MSG_TYPE:  if (olen >= 1) r->type = v[0]; break;
+            case OPT_SERVER_ID: if (olen >= 4) memcpy(r->server_id, v, 4); break;
+            case OPT_SUBNET:    if (olen >= 4) memcpy(r->mask, v, 4); break;
+            case OPT_ROUTER:    if (olen >= 4) memcpy(r->router, v, 4); break;
+            case OPT_DNS:       if (olen >= 4) memcpy(r->dns, v, 4); break;
+            case OPT_LEASE:     if (olen >= 4) r->lease_s = get32(v); break;
+            case OPT_T1:        if (olen >= 4) r->t1_s = get32(v); break;
+            case OPT_T2:        if (olen >= 4) r->t2_s = get32(v); break;
+        }
+        pos += olen;
+    }
+    return r->type ? 0 : -1;
+}
+
+static void handle_reply(const dhcp_reply_t* r, uint32_t now) {
+    switch (state) {
+        case DHCP_STATE_SELECTING:
+        case DHCP_STATE_STATIC:
+            if (r->type != DHCP_OFFER || ip_is_zero(r->yiaddr) || ip_is_zero(r->server_id)) break;
+            // Take the first offer and request it right away
+            memcpy(offered_ip, r->yiaddr, 4);
+            memcpy(server_ip, r->server_id, 4);
+            state = DHCP_STATE_REQUESTING;
+            tries = 0;
+            retry_ms = DHCP_RETRY_MS;
+            next_ms = now;
+            break;
+
+        case DHCP_STATE_REQUESTING:
+        case DHCP_STATE_RENEWING:
+        case DHCP_STATE_REBINDING:
+            if (r->type == DHCP_ACK && !ip_is_zero(r->yiaddr)) {
+                bind_lease(r, now);
+            } else if (r->type == DHCP_NAK) {
+                start_ms = now;
+                start_discovery(now);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void receive(uint32_t now) {
+    while (get_socket_rx_size(DHCP_SOCKET) >= 8) {
+        uint8_t hdr[8];  // [ip:4][port:2][len:2]
+        if (recv_socket(DHCP_SOCKET, hdr, sizeof(hdr)) != sizeof(hdr)) return;
+
+        uint16_t dlen = ((uint16_t)hdr[6] << 8) | hdr[7];
+        uint16_t n = dlen < sizeof(buf) ? dlen : sizeof(buf);
+        int got = recv_socket(DHCP_SOCKET, buf, n);
+        if (got < 0) return;
+        if (dlen > got) consume_socket(DHCP_SOCKET, dlen - got);
+
+        dhcp_reply_t r;
+        if (parse_reply(got, &r) == 0) handle_reply(&r, now);
+    }
+}
+
+/* --- Timers --- */
+
+static void on_timer(uint32_t now) {
+    uint32_t elapsed = now - bound_ms;
+
+    switch (state) {
+        case DHCP_STATE_SELECTING:
+            if (!fallback_active && now - start_ms >= DHCP_FALLBACK_MS) {
+                apply_fallback(now);
+                break;
+            }
+            /* fall through */
+        case DHCP_STATE_STATIC:
+            if (send_msg(DHCP_DISCOVER, now) < 0) break;
+            if (state == DHCP_STATE_STATIC) {
+                next_ms = now + DHCP_STATIC_RETRY_MS;
+            } else {
+                next_ms = now + retry_ms;
+                if (retry_ms < DHCP_RETRY_MAX_MS) retry_ms *= 2;
+                // Wake up for the fallback deadline even in a long retry interval
+                if ((int32_t)(next_ms - (start_ms + DHCP_FALLBACK_MS)) > 0) {
+                    next_ms = start_ms + DHCP_FALLBACK_MS;
+                }
+            }
+            break;
+
+        case DHCP_STATE_REQUESTING:
+            if (tries >= DHCP_REQUEST_TRIES) {
+                // Offer went stale, start over with a new transaction
+                start_discovery(now);
+                break;
+            }
+            if (send_msg(DHCP_REQUEST, now) < 0) break;
+            tries++;
+            next_ms = now + retry_ms;
+            if (retry_ms < DHCP_RETRY_MAX_MS) retry_ms *= 2;
+            break;
+
+        case DHCP_STATE_BOUND:
+        case DHCP_STATE_RENEWING:
+        case DHCP_STATE_REBINDING:
+            if (elapsed >= lease_ms) {
+                // Lease lost; the address stays until a new lease or the fallback replaces it
+                start_ms = now;
+                start_discovery(now);
+                break;
+            }
+            if (state == DHCP_STATE_BOUND && elapsed >= t1_ms) start_ms = now;  // secs field
+            if (elapsed >= t2_ms) {
+                state = DHCP_STATE_REBINDING;
+            } else if (elapsed >= t1_ms) {
+                state = DHCP_STATE_RENEWING;
+            }
+            if (state == DHCP_STATE_BOUND) {
+                next_ms = bound_ms + t1_ms;
+                break;
+            }
+            if (send_msg(DHCP_REQUEST, now) < 0) break;
+            schedule_renewal(now, state == DHCP_STATE_RENEWING ? t2_ms : lease_ms);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void dhcp_init(const wiz_NetInfo* fallback, const char* name, dhcp_callback_t cb) {
+    wizchip_getnetinfo(&applied);
+    memset(applied.dns, 0, 4);      // Not kept by the chip
+    memcpy(mac, applied.mac, 6);
+
+    fallback_info = *fallback;
+    hostname[0] = '\0';
+    if (name) {
+        strncpy(hostname, name, sizeof(hostname) - 1);
+        hostname[sizeof(hostname) - 1] = '\0';
+    }
+    on_change = cb;
+
+    xid = get32(mac + 2);
+    fallback_active = 0;
+    state = DHCP_STATE_INIT;
+    start_ms = HAL_GetTick();
+
+    w5500_event_register(DHCP_SOCKET, W5500_Sn_IR_RECV, dhcp_socket_event);
+    dhcp_pending = 1;
+}
+
+void dhcp_process(void) {
+    uint32_t now = HAL_GetTick();
+    uint8_t timer_due = (state == DHCP_STATE_INIT) || due_in(now) == 0;
+    if (!dhcp_pending && !timer_due) return;
+    dhcp_pending = 0;
+
+    if (get_socket_status(DHCP_SOCKET) != W5500_SR_SOCK_UDP) {
+        /* CLOSE + OPEN run from socket_cmd_process(), keep polling until UDP */
+        socket_open_async(DHCP_SOCKET, W5500_Sn_MR_UDP, DHCP_CLIENT_PORT, 0);
+        if (state == DHCP_STATE_INIT) {
+            // The fallback deadline counts from boot, not from the socket opening
+            if (now - start_ms >= DHCP_FALLBACK_MS && !fallback_active) apply_fallback(now);
+            state = fallback_active ? DHCP_STATE_STATIC : DHCP_STATE_INIT;
+        }
+        dhcp_pending = 1;
+        return;
+    }
+
+    if (state == DHCP_STATE_INIT) start_discovery(now);
+
+    receive(now);
+    if (due_in(now) == 0) on_timer(now);
+}
+
+dhcp_state_t dhcp_get_state(void) {
+    return state;
+}
+
+uint32_t dhcp_lease_remaining(void) {
+    if (state != DHCP_STATE_BOUND && state != DHCP_STATE_RENEWING && state != DHCP_STATE_REBINDING) {
+        return 0;
+    }
+    uint32_t elapsed = HAL_GetTick() - bound_ms;
+    return (elapsed < lease_ms) ? (lease_ms - elapsed) / 1000 : 0;
+}
@@ -12,10 +12,14 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <math.h>
 #include "main.h"
 
 static gps_pos_t last_pos;
 static uint32_t last_pos_ts = 0;
+static volatile gps_time_ref_t time_ref;
+static gps_epoch_t epoch;
+static volatile uint32_t epoch_seq = 0;    // Odd while epoch is being written
 
 void gps_init(void) {
     memset(&last_pos, 0, sizeof(last_pos));
@@ -31,11 +35,11 @@ uint32_t gps_get_last_age_ms(void) {
     return (uint32_t)(HAL_GetTick() - last_pos_ts);
 }
 
-void gps_on_new_position(double lat_deg, double lon_deg, uint8_t fix, uint8_t sats,
+void gps_on_new_position(int32_t lat_e7, int32_t lon_e7, uint8_t fix, uint8_t sats,
                          int year,int month,int day,int hour,int min,int sec)
 {
-    last_pos.lat_deg = lat_deg;
-    last_pos.lon_deg = lon_deg;
+    last_pos.lat_e7 = lat_e7;
+    last_pos.lon_e7 = lon_e7;
     last_pos.fix = fix;
     last_pos.sats = sats;
     last_pos.year = year; last_pos.month = month; last_pos.day = day;
@@ -44,6 +48,64 @@ void gps_on_new_position(double lat_deg, double lon_deg, uint8_t fix, uint8_t sa
     last_pos_ts = HAL_GetTick();
 }
 
+/* Called from the UART interrupt: sequence is bumped last so readers can retry */
+void gps_on_new_time(int year,int month,int day,int hour,int min,int sec,int ms, uint32_t cyc)
+{
+    uint32_t t = gps_unix_time(year, month, day, hour, min, sec);
+    if (t == 0) return;
+    time_ref.unix_sec = t;
+    time_ref.ms = ms;
+    time_ref.cyc = cyc;
+    time_ref.seq++;
+}
+
+gps_time_ref_t gps_get_time_ref(void) {
+    gps_time_ref_t r;
+    uint32_t seq;
+    do {
+        seq = time_ref.seq;
+        r.unix_sec = time_ref.unix_sec;
+        r.ms = time_ref.ms;
+        r.cyc = time_ref.cyc;
+        r.seq = seq;
+    } while (seq != time_ref.seq);
+    return r;
+}
+
+/* Called from the UART interrupt once an epoch is complete */
+void gps_on_epoch(const gps_epoch_t* e) {
+    uint32_t seq = epoch_seq + 1;
+    epoch_seq = seq;
+    __COMPILER_BARRIER();
+    epoch = *e;
+    epoch.seq = (seq + 1) / 2;
+    __COMPILER_BARRIER();
+    epoch_seq = seq + 1;
+}
+
+/* Copy of the last epoch, retried if the interrupt replaced it meanwhile */
+void gps_get_epoch(gps_epoch_t* out) {
+    uint32_t seq;
+    do {
+        seq = epoch_seq;
+        __COMPILER_BARRIER();
+        *out = epoch;
+        __COMPILER_BARRIER();
+    } while ((seq & 1) || seq != epoch_seq);
+}
+
+/* Seconds since 1970-01-01 for a proleptic Gregorian UTC date */
+uint32_t gps_unix_time(int y, int m, int d, int hh, int mm, int ss) {
+    if (y < 1970 || m < 1 || m > 12 || d < 1) return 0;
+    y -= m <= 2;
+    int era = y / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    uint32_t days = era * 146097 + doe - 719468;
+    return days * 86400u + hh * 3600 + mm * 60 + ss;
+}
+
 void format_lat_lon(double lat, double lon, char* out, int out_sz, int prec) {
     snprintf(out, out_sz, "%.0*.*f", 0, 0, 0.0); // avoid compiler warnings
     char s_lat[64], s_lon[64];
@@ -0,0 +1,353 @@
+/* history.c - Fixed-RAM telemetry history with minute and hour rollups
+ *
+ * Each series/resolution pair is a ring of fixed-size blocks. A block
+ * holds a start time, an absolute base value and a byte stream of zigzag
+ * varint deltas, one entry per period with no gaps; a missing sample, a
+ * full block or an entry that does not fit starts the next block, and the
+ * oldest block is dropped when the ring is full. Blocks are self-contained,
+ * so /history can send them as stored (binary) or decode them (JSON).
+ *
+ * Rollups are accumulated from the raw samples and written as
+ * avg delta, avg - min, max - avg when the interval is over.
+ */
+
+#include "history.h"
+#include "json_writer.h"
+#include "main.h"
+#include <string.h>
+
+#define HISTORY_BLOCK_DATA  (HISTORY_BLOCK_SIZE - 10)
+#define ENTRY_MAX           15      // Three 5-byte varints
+
+typedef struct {
+    uint32_t t0;            // Uptime seconds of the first entry
+    int32_t  base;          // Value the first delta applies to
+    uint8_t  count;         // Entries
+    uint8_t  used;          // Bytes of data
+    uint8_t  data[HISTORY_BLOCK_DATA];
+} hist_block_t;
+
+_Static_assert(sizeof(hist_block_t) == HISTORY_BLOCK_SIZE, "hist_block_t padding");
+
+typedef struct {
+    hist_block_t* blocks;
+    uint16_t nblocks;
+    uint16_t head;          // Oldest block
+    uint16_t n;             // Blocks in use, the newest one is appended to
+    int32_t  last;          // Value of the newest entry
+} track_t;
+
+/* Samples of the interval being rolled up */
+typedef struct {
+    uint32_t slot;          // t_s / period
+    int64_t  sum;
+    int32_t  min, max;
+    uint16_t n;
+} acc_t;
+
+static const struct {
+    const char* name;
+    uint8_t decimals;
+} series_info[HISTORY_SERIES_COUNT] = {
+    { "t_c", 2 }, { "p_hpa", 2 }, { "rh_pct", 2 }, { "lux", 1 },
+    { "lat", 7 }, { "lon", 7 }, { "fix", 0 }, { "sats", 0 }, { "hdop", 2 },
+};
+
+static const char* const res_names[HISTORY_RES_COUNT] = { "1s", "1m", "1h" };
+static const uint16_t res_period[HISTORY_RES_COUNT] = { 1, 60, 3600 };
+
+static hist_block_t raw_blocks[HISTORY_SERIES_COUNT][HISTORY_RAW_BLOCKS];
+static hist_block_t min_blocks[HISTORY_SERIES_COUNT][HISTORY_1M_BLOCKS];
+static hist_block_t hour_blocks[HISTORY_SERIES_COUNT][HISTORY_1H_BLOCKS];
+static track_t tracks[HISTORY_SERIES_COUNT][HISTORY_RES_COUNT];
+static acc_t accs[HISTORY_SERIES_COUNT][HISTORY_RES_COUNT];    // [HISTORY_RES_1S] unused
+
+/* --- Encoding --- */
+
+static uint8_t put_uvar(uint8_t* p, uint32_t v) {
+    uint8_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static const uint8_t* get_uvar(const uint8_t* p, const uint8_t* end, uint32_t* v) {
+    uint32_t x = 0;
+    for (uint8_t shift = 0; p < end && shift < 35; shift += 7) {
+        uint8_t b = *p++;
+        x |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = x;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* Wrapping difference: exact for any pair of int32 values */
+static uint32_t zigzag(int32_t value, int32_t prev) {
+    uint32_t d = (uint32_t)value - (uint32_t)prev;
+    return (d << 1) ^ (uint32_t)((int32_t)d >> 31);
+}
+
+static int32_t unzigzag(int32_t prev, uint32_t z) {
+    uint32_t d = (z >> 1) ^ (0u - (z & 1));
+    return (int32_t)((uint32_t)prev + d);
+}
+
+static uint8_t fields(history_res_t res) {
+    return res == HISTORY_RES_1S ? 1 : 3;
+}
+
+/* Entry bytes: v[0] value (avg) as delta to prev, rollups then avg - min, max - avg */
+static uint8_t encode(uint8_t* p, uint8_t nf, const int32_t* v, int32_t prev) {
+    uint8_t len = put_uvar(p, zigzag(v[0], prev));
+    if (nf == 3) {
+        len += put_uvar(p + len, (uint32_t)v[0] - (uint32_t)v[1]);
+        len += put_uvar(p + len, (uint32_t)v[2] - (uint32_t)v[0]);
+    }
+    return len;
+}
+
+static void track_add(track_t* tr, uint16_t period, uint8_t nf, uint32_t t, const int32_t* v) {
+    uint8_t tmp[ENTRY_MAX];
+    uint8_t len;
+
+    if (tr->n) {
+        hist_block_t* b = &tr->blocks[(tr->head + tr->n - 1) % tr->nblocks];
+        len = encode(tmp, nf, v, tr->last);
+        if (b->count < 255 && t == b->t0 + (uint32_t)b->count * period &&
+            b->used + len <= HISTORY_BLOCK_DATA) {
+            memcpy(b->data + b->used, tmp, len);
+            b->used += len;
+            b->count++;
+            tr->last = v[0];
+            return;
+        }
+    }
+
+    // Gap, or the newest block is full: start another, dropping the oldest
+    if (tr->n == tr->nblocks) {
+        tr->head = (tr->head + 1) % tr->nblocks;
+        tr->n--;
+    }
+    hist_block_t* b = &tr->blocks[(tr->head + tr->n) % tr->nblocks];
+    tr->n++;
+    len = encode(tmp, nf, v, v[0]);
+    b->t0 = t;
+    b->base = v[0];
+    memcpy(b->data, tmp, len);
+    b->used = len;
+    b->count = 1;
+    tr->last = v[0];
+}
+
+/* Write out a finished interval and start the one t_s falls in */
+static void acc_flush(acc_t* a, track_t* tr, uint16_t period, uint32_t slot) {
+    if (a->n) {
+        int32_t v[3];
+        // Round half away from zero, sum fits 3600 samples of any int32
+        int64_t half = a->sum < 0 ? -(a->n / 2) : a->n / 2;
+        v[0] = (int32_t)((a->sum + half) / a->n);
+        v[1] = a->min;
+        v[2] = a->max;
+        track_add(tr, period, 3, a->slot * period, v);
+    }
+    a->slot = slot;
+    a->sum = 0;
+    a->n = 0;
+}
+
+/* --- API --- */
+
+void history_init(void) {
+    memset(tracks, 0, sizeof(tracks));
+    memset(accs, 0, sizeof(accs));
+    for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        tracks[s][HISTORY_RES_1S].blocks = raw_blocks[s];
+        tracks[s][HISTORY_RES_1S].nblocks = HISTORY_RAW_BLOCKS;
+        tracks[s][HISTORY_RES_1M].blocks = min_blocks[s];
+        tracks[s][HISTORY_RES_1M].nblocks = HISTORY_1M_BLOCKS;
+        tracks[s][HISTORY_RES_1H].blocks = hour_blocks[s];
+        tracks[s][HISTORY_RES_1H].nblocks = HISTORY_1H_BLOCKS;
+    }
+}
+
+void history_add(uint32_t t_s, const int32_t* values, uint16_t mask) {
+    for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        for (uint8_t r = HISTORY_RES_1M; r < HISTORY_RES_COUNT; r++) {
+            uint32_t slot = t_s / res_period[r];
+            acc_t* a = &accs[s][r];
+            if (slot != a->slot) acc_flush(a, &tracks[s][r], res_period[r], slot);
+        }
+        if (!(mask & (1u << s))) continue;
+
+        int32_t v = values[s];
+        track_add(&tracks[s][HISTORY_RES_1S], 1, 1, t_s, &v);
+        for (uint8_t r = HISTORY_RES_1M; r < HISTORY_RES_COUNT; r++) {
+            acc_t* a = &accs[s][r];
+            if (a->n == 0 || v < a->min) a->min = v;
+            if (a->n == 0 || v > a->max) a->max = v;
+            a->sum += v;
+            a->n++;
+        }
+    }
+}
+
+int history_series_id(const char* name) {
+    for (uint8_t s = 0; s < HISTORY_SERIES_COUNT; s++) {
+        if (strcmp(name, series_info[s].name) == 0) return s;
+    }
+    return -1;
+}
+
+int history_res_id(const char* name) {
+    for (uint8_t r = 0; r < HISTORY_RES_COUNT; r++) {
+        if (strcmp(name, res_names[r]) == 0) return r;
+    }
+    return -1;
+}
+
+static uint8_t* put_le(uint8_t* p, uint32_t v, uint8_t n) {
+    for (uint8_t i = 0; i < n; i++) *p++ = (uint8_t)(v >> (8 * i));
+    return p;
+}
+
+static uint16_t render_bin(const track_t* tr, history_series_t series, history_res_t res,
+                           uint32_t since, uint32_t uptime, uint32_t unix_now,
+                           uint8_t* out, uint16_t size) {
+    const uint16_t period = res_period[res];
+    if (size < 24) return 0;
+    uint8_t* p = out + 24;
+    uint8_t* end = out + size;
+    uint16_t blocks = 0;
+    uint8_t more = 0;
+    uint32_t next = since;
+
+    for (uint16_t i = 0; i < tr->n; i++) {
+        const hist_block_t* b = &tr->blocks[(tr->head + i) % tr->nblocks];
+        uint32_t t_end = b->t0 + (uint32_t)b->count * period;
+        if (b->count == 0 || t_end <= since) continue;
+        if (p + 10 + b->used > end) {
+            more = 1;
+            if (next < b->t0) next = b->t0;
+            break;
+        }
+        p = put_le(p, b->t0, 4);
+        p = put_le(p, (uint32_t)b->base, 4);
+        *p++ = b->count;
+        *p++ = b->used;
+        memcpy(p, b->data, b->used);
+        p += b->used;
+        blocks++;
+        next = t_end;
+    }
+
+    uint8_t* h = out;
+    *h++ = 'H';
+    *h++ = 'S';
+    *h++ = 1;
+    *h++ = series;
+    *h++ = res;
+    *h++ = series_info[series].decimals;
+    *h++ = fields(res);
+    *h++ = more;
+    h = put_le(h, period, 2);
+    h = put_le(h, blocks, 2);
+    h = put_le(h, uptime, 4);
+    h = put_le(h, unix_now, 4);
+    put_le(h, next, 4);
+    return p - out;
+}
+
+/* Room kept for one rollup entry and the closing members */
+#define JSON_MARGIN     96
+
+static uint16_t render_json(const track_t* tr, history_series_t series, history_res_t res,
+                            uint32_t since, uint32_t uptime, uint32_t unix_now,
+                            char* out, uint16_t size) {
+    const uint16_t period = res_period[res];
+    const uint8_t dec = series_info[series].decimals;
+    const uint8_t nf = fields(res);
+    uint32_t next = since;
+    uint8_t more = 0;
+
+    json_writer_t w;
+    json_init(&w, out, size);
+    json_obj_begin(&w, NULL);
+    json_str(&w, "series", series_info[series].name);
+    json_str(&w, "res", res_names[res]);
+    json_uint(&w, "period_s", period);
+    json_uint(&w, "decimals", dec);
+    json_uint(&w, "uptime_s", uptime);
+    if (unix_now) json_uint(&w, "unix_s", unix_now);
+    else json_null(&w, "unix_s");
+    json_arr_begin(&w, "runs");
+
+    for (uint16_t i = 0; i < tr->n && !more; i++) {
+        const hist_block_t* b = &tr->blocks[(tr->head + i) % tr->nblocks];
+        if (b->t0 + (uint32_t)b->count * period <= since) continue;
+
+        const uint8_t* p = b->data;
+        const uint8_t* end = b->data + b->used;
+        int32_t v = b->base;
+        uint8_t open = 0;
+        for (uint8_t k = 0; k < b->count && p; k++) {
+            uint32_t z, lo = 0, hi = 0;
+            uint32_t t = b->t0 + (uint32_t)k * period;
+            p = get_uvar(p, end, &z);
+            if (p && nf == 3) p = get_uvar(p, end, &lo);
+            if (p && nf == 3) p = get_uvar(p, end, &hi);
+            if (!p) break;
+            v = unzigzag(v, z);
+            if (t < since) continue;
+
+            if (size - json_len(&w) < JSON_MARGIN) {
+                more = 1;
+                next = t;
+                break;
+            }
+            if (!open) {
+                json_obj_begin(&w, NULL);
+                json_uint(&w, "t", t);
+                json_arr_begin(&w, "v");
+                open = 1;
+            }
+            if (nf == 3) {
+                json_arr_begin(&w, NULL);
+                json_fixed(&w, NULL, (int32_t)((uint32_t)v - lo), dec);
+                json_fixed(&w, NULL, v, dec);
+                json_fixed(&w, NULL, (int32_t)((uint32_t)v + hi), dec);
+                json_arr_end(&w);
+            } else {
+                json_fixed(&w, NULL, v, dec);
+            }
+            next = t + period;
+        }
+        if (open) {
+            json_arr_end(&w);
+            json_obj_end(&w);
+        }
+    }
+
+    json_arr_end(&w);
+    json_uint(&w, "next", next);
+    json_bool(&w, "more", more);
+    json_obj_end(&w);
+    return w.overflow ? 0 : json_len(&w);
+}
+
+uint16_t history_render(history_series_t series, history_res_t res, uint32_t since,
+                        uint8_t format, uint32_t unix_now, char* out, uint16_t size) {
+    if (series >= HISTORY_SERIES_COUNT || res >= HISTORY_RES_COUNT) return 0;
+    const track_t* tr = &tracks[series][res];
+    uint32_t uptime = HAL_GetTick() / 1000;
+
+    if (format == HISTORY_FMT_BIN) {
+        return render_bin(tr, series, res, since, uptime, unix_now, (uint8_t*)out, size);
+    }
+    return render_json(tr, series, res, since, uptime, unix_now, out, size);
+}
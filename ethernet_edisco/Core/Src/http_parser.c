@@ -0,0 +1,255 @@
+/* http_parser.c - incremental HTTP/1.x request parser
+ *
+ * Fed straight from socket RX in whatever chunks arrive. No allocation:
+ * the request line is split into fixed buffers and header lines are kept
+ * one at a time, only Content-Length, Transfer-Encoding, Connection,
+ * Accept-Encoding, If-None-Match and the WebSocket handshake headers are
+ * interpreted. Limits are reported as status codes: 414 for a long target,
+ * 431 for a long header line or header block, 400/505 for anything
+ * malformed, 501 for a chunked (Transfer-Encoding) body.
+ */
+
+#include "http_parser.h"
+#include <string.h>
+#include <ctype.h>
+
+enum {
+    P_START = 0,    // Skipping empty lines before a request
+    P_METHOD,
+    P_PATH,
+    P_VERSION,
+    P_HEADER,
+    P_BODY,
+    P_DONE,
+    P_ERROR
+};
+
+static const struct {
+    const char* name;
+    uint8_t method;
+} methods[] = {
+    { "GET",     HTTP_METHOD_GET },
+    { "HEAD",    HTTP_METHOD_HEAD },
+    { "POST",    HTTP_METHOD_POST },
+    { "PUT",     HTTP_METHOD_PUT },
+    { "DELETE",  HTTP_METHOD_DELETE },
+    { "OPTIONS", HTTP_METHOD_OPTIONS },
+};
+
+static uint8_t fail(http_parser_t* p, uint16_t status) {
+    p->status = status;
+    p->state = P_ERROR;
+    return P_ERROR;
+}
+
+/* Case-insensitive "name:" match, returns the value with leading blanks skipped */
+static const char* header_value(const char* line, uint16_t len, const char* name) {
+    uint16_t n = strlen(name);
+    if (len <= n || line[n] != ':') return NULL;
+    for (uint16_t i = 0; i < n; i++) {
+        if (tolower((unsigned char)line[i]) != name[i]) return NULL;
+    }
+    const char* v = line + n + 1;
+    while (v < line + len && (*v == ' ' || *v == '\t')) v++;
+    return v;
+}
+
+static int value_has(const char* v, const char* end, const char* token) {
+    uint16_t n = strlen(token);
+    for (; v + n <= end; v++) {
+        uint16_t i = 0;
+        while (i < n && tolower((unsigned char)v[i]) == token[i]) i++;
+        if (i == n) return 1;
+    }
+    return 0;
+}
+
+static uint8_t end_of_header(http_parser_t* p) {
+    const char* end = p->line + p->line_len;
+    const char* v;
+
+    if ((v = header_value(p->line, p->line_len, "content-length")) != NULL) {
+        uint32_t cl = 0;
+        if (v == end) return fail(p, 400);
+        for (; v < end && *v != ' ' && *v != '\t'; v++) {
+            if (*v < '0' || *v > '9' || cl > 100000000) return fail(p, 400);
+            cl = cl * 10 + (*v - '0');
+        }
+        // Only blanks may follow the digits
+        for (; v < end; v++) {
+            if (*v != ' ' && *v != '\t') return fail(p, 400);
+        }
+        p->content_length = cl;
+        p->framing |= HTTP_FRAMING_LENGTH;
+    } else if (header_value(p->line, p->line_len, "transfer-encoding") != NULL) {
+        p->framing |= HTTP_FRAMING_CHUNKED;
+    } else if ((v = header_value(p->line, p->line_len, "connection")) != NULL) {
+        if (value_has(v, end, "close")) p->conn_hdr = HTTP_CONN_HDR_CLOSE;
+        else if (value_has(v, end, "keep-alive")) p->conn_hdr = HTTP_CONN_HDR_KEEPALIVE;
+        if (value_has(v, end, "upgrade")) p->conn_upgrade = 1;
+    } else if ((v = header_value(p->line, p->line_len, "accept-encoding")) != NULL) {
+        p->accept_gzip = value_has(v, end, "gzip");
+    } else if ((v = header_value(p->line, p->line_len, "if-none-match")) != NULL) {
+        uint16_t n = end - v;
+        if (n > HTTP_MAX_ETAG) n = 0;  // Too long to match any of ours
+        memcpy(p->if_none_match, v, n);
+        p->if_none_match[n] = '\0';
+    } else if ((v = header_value(p->line, p->line_len, "upgrade")) != NULL) {
+        p->upgrade_ws = value_has(v, end, "websocket");
+    } else if ((v = header_value(p->line, p->line_len, "sec-websocket-key")) != NULL) {
+        uint16_t n = end - v;
+        while (n > 0 && v[n - 1] == ' ') n--;
+        if (n != HTTP_WS_KEY_LEN) n = 0;
+        memcpy(p->ws_key, v, n);
+        p->ws_key[n] = '\0';
+    } else if ((v = header_value(p->line, p->line_len, "sec-websocket-version")) != NULL) {
+        uint16_t ver = 0;
+        for (; v < end && *v >= '0' && *v <= '9' && ver < 1000; v++) ver = ver * 10 + (*v - '0');
+        p->ws_version = (ver <= 255) ? ver : 0;
+    }
+
+    p->line_len = 0;
+    return P_HEADER;
+}
+
+static uint8_t end_of_token(http_parser_t* p) {
+    p->tok[p->tok_len] = '\0';
+
+    if (p->state == P_METHOD) {
+        p->method = HTTP_METHOD_OTHER;
+        for (uint8_t i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+            if (strcmp(p->tok, methods[i].name) == 0) p->method = methods[i].method;
+        }
+        p->tok_len = 0;
+        return P_PATH;
+    }
+
+    // P_VERSION
+    if (strcmp(p->tok, "HTTP/1.1") == 0) p->version = 11;
+    else if (strcmp(p->tok, "HTTP/1.0") == 0) p->version = 10;
+    else if (strncmp(p->tok, "HTTP/", 5) == 0) return fail(p, 505);
+    else return fail(p, 400);
+    return P_HEADER;
+}
+
+void http_parser_reset(http_parser_t* p) {
+    p->state = P_START;
+    p->method = HTTP_METHOD_OTHER;
+    p->version = 0;
+    p->conn_hdr = HTTP_CONN_HDR_NONE;
+    p->accept_gzip = 0;
+    p->conn_upgrade = 0;
+    p->upgrade_ws = 0;
+    p->ws_version = 0;
+    p->if_none_match[0] = '\0';
+    p->ws_key[0] = '\0';
+    p->status = 0;
+    p->cr = 0;
+    p->framing = 0;
+    p->header_bytes = 0;
+    p->content_length = 0;
+    p->body_left = 0;
+    p->tok_len = 0;
+    p->path_len = 0;
+    p->path[0] = '\0';
+    p->line_len = 0;
+}
+
+uint8_t http_parser_started(const http_parser_t* p) {
+    return p->state != P_START;
+}
+
+uint16_t http_parser_feed(http_parser_t* p, const char* data, uint16_t len,
+                          http_parse_result_t* result) {
+    uint16_t i = 0;
+
+    while (i < len && p->state != P_DONE && p->state != P_ERROR) {
+        if (p->state == P_BODY) {
+            // Body is not used by any route, skip it
+            uint32_t n = len - i;
+            if (n > p->body_left) n = p->body_left;
+            p->body_left -= n;
+            i += n;
+            if (p->body_left == 0) p->state = P_DONE;
+            continue;
+        }
+
+        char ch = data[i++];
+
+        // CR only as part of a line end, bare LF line endings are accepted as well
+        if (p->cr) {
+            p->cr = 0;
+            if (ch != '\n') {
+                fail(p, 400);
+                continue;
+            }
+        } else if (ch == '\r') {
+            p->cr = 1;
+            continue;
+        }
+
+        switch (p->state) {
+            case P_START:
+                if (ch == '\n') break;
+                p->state = P_METHOD;
+                /* fall through */
+            case P_METHOD:
+                if (ch == ' ') {
+                    if (p->tok_len == 0) fail(p, 400);
+                    else p->state = end_of_token(p);
+                } else if (ch < 'A' || ch > 'Z' || p->tok_len >= sizeof(p->tok) - 1) {
+                    fail(p, 400);
+                } else {
+                    p->tok[p->tok_len++] = ch;
+                }
+                break;
+
+            case P_PATH:
+                if (ch == ' ') {
+                    if (p->path_len == 0) fail(p, 400);
+                    else p->state = P_VERSION;
+                } else if (ch == '\n' || (p->path_len == 0 && ch != '/') || (unsigned char)ch < 0x21) {
+                    fail(p, 400);  // HTTP/0.9 request or bad target
+                } else if (p->path_len >= HTTP_MAX_PATH) {
+                    fail(p, 414);
+                } else {
+                    p->path[p->path_len++] = ch;
+                    p->path[p->path_len] = '\0';
+                }
+                break;
+
+            case P_VERSION:
+                if (ch == '\n') {
+                    p->state = end_of_token(p);
+                } else if (p->tok_len >= sizeof(p->tok) - 1) {
+                    fail(p, 400);
+                } else {
+                    p->tok[p->tok_len++] = ch;
+                }
+                break;
+
+            case P_HEADER:
+                if (++p->header_bytes > HTTP_MAX_HEADERS_SIZE) {
+                    fail(p, 431);
+                } else if (ch != '\n') {
+                    if (p->line_len >= sizeof(p->line)) fail(p, 431);
+                    else p->line[p->line_len++] = ch;
+                } else if (p->line_len > 0) {
+                    p->state = end_of_header(p);
+                } else if (p->framing & HTTP_FRAMING_CHUNKED) {
+                    // Chunked bodies are not decoded; together with Content-Length
+                    // the framing is ambiguous (request smuggling)
+                    fail(p, (p->framing & HTTP_FRAMING_LENGTH) ? 400 : 501);
+                } else {
+                    // Blank line: head complete
+                    p->body_left = p->content_length;
+                    p->state = p->body_left ? P_BODY : P_DONE;
+                }
+                break;
+        }
+    }
+
+    *result = (p->state == P_DONE) ? HTTP_PARSE_DONE :
+              (p->state == P_ERROR) ? HTTP_PARSE_ERROR : HTTP_PARSE_MORE;
+    return i;
+}
@@ -0,0 +1,602 @@
+/* http_server.c - HTTP server on a pool of W5500 sockets
+ *
+ * Every socket of the pool listens on HTTP_PORT with its own connection
+ * state and buffers, so parallel browser connections are served side by
+ * side. Connections are stepped from the main loop when the W5500 raises
+ * an event for their socket; responses are streamed as TX space frees up
+ * instead of blocking until the whole page is queued.
+ *
+ * Connections are persistent (HTTP/1.1 keep-alive, Content-Length framing).
+ * Requests are parsed incrementally straight out of the W5500 RX buffer:
+ * data is peeked in chunks and only the bytes the parser used are consumed,
+ * so pipelined requests stay queued in the chip until their turn.
+ *
+ * GET /events turns a connection into a Server-Sent Events subscriber. The
+ * latest published frame is kept in one shared buffer and each subscriber
+ * remembers the sequence number it has sent; a frame is only queued when it
+ * fits in Sn_TX_FSR as a whole, so a slow client skips straight to the
+ * newest frame instead of buffering a backlog.
+ *
+ * GET /ws upgrades to a WebSocket; once the 101 response is out the
+ * connection is handed to websocket.c, which is stepped like any other
+ * connection state.
+ */
+
+#include "http_server.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include "web_assets.h"
+#include "websocket.h"
+#include "main.h"
+#include <string.h>
+#include <stdio.h>
+
+#if HTTP_POOL_FIRST + HTTP_POOL_SIZE > 8
+#error "HTTP pool does not fit in the 8 W5500 sockets"
+#endif
+
+typedef enum {
+    HTTP_CONN_OPENING = 0,  // CLOSE/OPEN/LISTEN in progress
+    HTTP_CONN_LISTEN,       // Waiting for a client
+    HTTP_CONN_RECV,         // Collecting the request
+    HTTP_CONN_SEND,         // Streaming the response
+    HTTP_CONN_EVENTS,       // Event stream subscriber
+    HTTP_CONN_WEBSOCKET,    // Upgraded, frames handled by websocket.c
+    HTTP_CONN_CLOSING       // DISCON issued, waiting for CLOSED
+} http_conn_state_t;
+
+typedef struct {
+    uint8_t  sn;
+    uint8_t  state;
+    uint8_t  keep_alive;
+    uint8_t  requests;      // Served on this connection
+    uint8_t  upgrade;       // HTTP_UPGRADE_*, applied once the response is out
+    uint32_t events_seq;    // Last frame sent to this subscriber
+    uint16_t tx_len;
+    uint16_t tx_pos;
+    const uint8_t* body;
+    uint16_t body_len;
+    uint16_t body_pos;
+    uint32_t last_ms;
+    http_parser_t parser;
+    char     tx[HTTP_TX_BUF_SIZE];
+} http_conn_t;
+
+static http_conn_t conns[HTTP_POOL_SIZE];
+static const http_route_t* http_routes;
+static uint8_t http_route_count;
+static char rx_chunk[HTTP_RX_CHUNK];       // Shared, connections are stepped one at a time
+static uint8_t http_pending = 0;  // Bit i: conns[i] needs a step
+
+static char events_frame[HTTP_EVENTS_FRAME_SIZE];
+static uint16_t events_frame_len = 0;
+static uint32_t events_seq = 0;     // Bumped on every new frame, 0 = none yet
+
+static void http_socket_event(uint8_t sn, uint8_t events) {
+    (void)events;
+    http_pending |= 1 << (sn - HTTP_POOL_FIRST);
+}
+
+static const char* status_text(uint16_t status) {
+    switch (status) {
+        case 403: return "403 Forbidden";
+        case 404: return "404 Not Found";
+        case 405: return "405 Method Not Allowed";
+        case 414: return "414 URI Too Long";
+        case 426: return "426 Upgrade Required";
+        case 431: return "431 Request Header Fields Too Large";
+        case 500: return "500 Internal Server Error";
+        case 501: return "501 Not Implemented";
+        case 503: return "503 Service Unavailable";
+        case 505: return "505 HTTP Version Not Supported";
+        default:  return "400 Bad Request";
+    }
+}
+
+uint16_t http_write_error(char* out, uint16_t out_size, uint16_t status,
+                          uint8_t keep_alive, const char* extra) {
+    const char* text = status_text(status);
+    uint16_t body = strlen(text) + 2;
+
+    uint16_t n = http_write_head(out, out_size, text, "text/plain", body, keep_alive, extra);
+    if (n == 0 || n + body > out_size) return 0;
+    memcpy(out + n, text, body - 2);
+    memcpy(out + n + body - 2, "\r\n", 2);
+    return n + body;
+}
+
+uint16_t http_write_head(char* out, uint16_t out_size, const char* status,
+                         const char* content_type, uint32_t content_length,
+                         uint8_t keep_alive, const char* extra) {
+    int n;
+    if (strncmp(status, "304", 3) == 0) {
+        n = snprintf(out, out_size,
+                     "HTTP/1.1 %s\r\n"
+                     "Connection: %s\r\n"
+                     "%s\r\n",
+                     status, keep_alive ? "keep-alive" : "close", extra ? extra : "");
+    } else {
+        n = snprintf(out, out_size,
+                     "HTTP/1.1 %s\r\n"
+                     "Content-Type: %s\r\n"
+                     "Content-Length: %lu\r\n"
+                     "Connection: %s\r\n"
+                     "%s\r\n",
+                     status, content_type, (unsigned long)content_length,
+                     keep_alive ? "keep-alive" : "close", extra ? extra : "");
+    }
+    return (n < 0 || n >= out_size) ? 0 : n;
+}
+
+int http_query_param(const char* path, const char* name, char* out, uint16_t out_size) {
+    const char* q = strchr(path, '?');
+    if (!q || out_size == 0) return -1;
+    uint16_t name_len = strlen(name);
+
+    for (const char* p = q + 1; *p; ) {
+        const char* end = strchr(p, '&');
+        if (!end) end = p + strlen(p);
+        if (strncmp(p, name, name_len) == 0 && (p[name_len] == '=' || p + name_len == end)) {
+            const char* v = p + name_len + (p + name_len < end);
+            uint16_t n = 0;
+            // No percent-decoding: values are plain tokens and numbers
+            while (v < end && n < out_size - 1) out[n++] = *v++;
+            out[n] = '\0';
+            return n;
+        }
+        p = *end ? end + 1 : end;
+    }
+    return -1;
+}
+
+/* If-None-Match holds etag (or "*"), weak comparison as RFC 9110 asks for */
+static int etag_matches(const char* inm, const char* etag) {
+    if (inm[0] == '*') return 1;
+    return strstr(inm, etag) != NULL;
+}
+
+uint16_t http_asset_handler(const http_request_t* req,
+                            char* out, uint16_t out_size,
+                            const uint8_t** body, uint16_t* body_len) {
+    uint16_t path_len = strcspn(req->path, "?");
+    const web_asset_t* a = NULL;
+
+    for (uint8_t i = 0; i < web_asset_count; i++) {
+        const char* ap = web_assets[i].path;
+        if ((path_len == 1 && strcmp(ap, "/index.html") == 0) ||
+            (strlen(ap) == path_len && strncmp(ap, req->path, path_len) == 0)) {
+            a = &web_assets[i];
+            break;
+        }
+    }
+    if (!a) return http_write_error(out, out_size, 404, req->keep_alive, NULL);
+
+    uint8_t gz = req->accept_gzip;
+    const char* etag = gz ? a->gz_etag : a->etag;
+    char extra[128];
+    snprintf(extra, sizeof(extra), "ETag: %s\r\nCache-Control: no-cache\r\nVary: Accept-Encoding\r\n%s",
+             etag, gz ? "Content-Encoding: gzip\r\n" : "");
+
+    if (req->if_none_match[0] && etag_matches(req->if_none_match, etag)) {
+        return http_write_head(out, out_size, "304 Not Modified", NULL, 0, req->keep_alive, extra);
+    }
+
+    *body = gz ? a->gz_data : a->data;
+    *body_len = gz ? a->gz_len : a->len;
+    return http_write_head(out, out_size, "200 OK", a->content_type, *body_len, req->keep_alive, extra);
+}
+
+void http_server_upgrade(uint8_t conn, uint8_t kind) {
+    if (conn < HTTP_POOL_SIZE) conns[conn].upgrade = kind;
+}
+
+void http_server_wake(uint8_t conn) {
+    if (conn < HTTP_POOL_SIZE) http_pending |= 1 << conn;
+}
+
+uint8_t http_server_upgraded(uint8_t kind) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+        if (conns[i].upgrade == kind) n++;
+    }
+    return n;
+}
+
+uint8_t http_events_subscribers(void) {
+    return http_server_upgraded(HTTP_UPGRADE_EVENTS);
+}
+
+uint16_t http_events_handler(const http_request_t* req,
+                             char* out, uint16_t out_size,
+                             const uint8_t** body, uint16_t* body_len) {
+    (void)body; (void)body_len;
+    if (http_events_subscribers() >= HTTP_EVENTS_MAX) {
+        // Keep a few sockets for plain requests
+        return http_write_error(out, out_size, 503, req->keep_alive, NULL);
+    }
+
+    // No Content-Length: the body runs until the connection closes
+    int n = snprintf(out, out_size,
+                     "HTTP/1.1 200 OK\r\n"
+                     "Content-Type: text/event-stream\r\n"
+                     "Cache-Control: no-cache\r\n"
+                     "Access-Control-Allow-Origin: *\r\n"
+                     "Connection: keep-alive\r\n"
+                     "\r\n"
+                     "retry: %u\n\n",
+                     HTTP_EVENTS_RETRY_MS);
+    if (n < 0 || n >= out_size) return 0;
+
+    http_server_upgrade(req->conn, HTTP_UPGRADE_EVENTS);
+    return n;
+}
+
+int http_events_publish(const char* data, uint16_t len) {
+    static const char prefix[] = "data: ";
+    uint16_t n = sizeof(prefix) - 1 + len + 2;
+
+    if (n > sizeof(events_frame) || memchr(data, '\n', len)) return -1;
+
+    // Same payload as last time: nothing changed for the subscribers
+    if (n == events_frame_len &&
+        memcmp(events_frame + sizeof(prefix) - 1, data, len) == 0) return 0;
+
+    memcpy(events_frame, prefix, sizeof(prefix) - 1);
+    memcpy(events_frame + sizeof(prefix) - 1, data, len);
+    memcpy(events_frame + n - 2, "\n\n", 2);
+    events_frame_len = n;
+    events_seq++;
+
+    uint8_t subs = 0;
+    for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+        if (conns[i].state == HTTP_CONN_EVENTS) {
+            http_pending |= 1 << i;
+            subs++;
+        }
+    }
+    return subs;
+}
+
+static const char* method_name(uint8_t method) {
+    switch (method) {
+        case HTTP_METHOD_GET:     return "GET";
+        case HTTP_METHOD_HEAD:    return "HEAD";
+        case HTTP_METHOD_POST:    return "POST";
+        case HTTP_METHOD_PUT:     return "PUT";
+        case HTTP_METHOD_DELETE:  return "DELETE";
+        case HTTP_METHOD_OPTIONS: return "OPTIONS";
+        default:                  return NULL;
+    }
+}
+
+static int route_matches(const char* route, const char* path) {
+    uint16_t n = strlen(route);
+    if (strncmp(path, route, n) != 0) return 0;
+    if (n > 1 && route[n - 1] == '/') return 1;  // Subtree
+    return path[n] == '\0' || path[n] == '?';
+}
+
+/* Run the matching route, or build the 404/405 answer */
+static uint16_t dispatch(http_conn_t* c, const http_request_t* req) {
+    char allow[48] = "";
+    uint8_t path_found = 0;
+
+    for (uint8_t i = 0; i < http_route_count; i++) {
+        const http_route_t* r = &http_routes[i];
+        if (!route_matches(r->path, req->path)) continue;
+        if (r->method == req->method) {
+            return r->handler(req, c->tx, sizeof(c->tx), &c->body, &c->body_len);
+        }
+
+        const char* name = method_name(r->method);
+        if (name && strlen(allow) + strlen(name) + 3 < sizeof(allow)) {
+            if (path_found) strcat(allow, ", ");
+            strcat(allow, name);
+        }
+        path_found = 1;
+    }
+
+    char extra[64];
+    snprintf(extra, sizeof(extra), "Allow: %s\r\n", allow);
+    return http_write_error(c->tx, sizeof(c->tx), path_found ? 405 : 404, req->keep_alive,
+                            path_found ? extra : NULL);
+}
+
+/**
+ * Feed the parser from socket RX, consuming only what it used
+ * @return Parser result
+ */
+static http_parse_result_t conn_parse(http_conn_t* c) {
+    http_parse_result_t res = HTTP_PARSE_MORE;
+    uint16_t avail = get_socket_rx_size(c->sn);
+
+    while (avail > 0 && res == HTTP_PARSE_MORE) {
+        uint16_t n = (avail < sizeof(rx_chunk)) ? avail : sizeof(rx_chunk);
+        int got = peek_socket(c->sn, 0, (uint8_t*)rx_chunk, n);
+        if (got <= 0) break;
+
+        uint16_t used = http_parser_feed(&c->parser, rx_chunk, got, &res);
+        if (used == 0) break;
+        if (consume_socket(c->sn, used) < 0) break;
+
+        avail -= used;
+        c->last_ms = HAL_GetTick();
+    }
+    return res;
+}
+
+/* Queue as much of the response as fits, returns 1 when all of it is out */
+static int conn_send(http_conn_t* c) {
+    while (c->tx_pos < c->tx_len) {
+        int n = send_socket_nb(c->sn, (const uint8_t*)c->tx + c->tx_pos, c->tx_len - c->tx_pos);
+        if (n < 0) return -1;
+        if (n == 0) return 0;
+        c->tx_pos += n;
+    }
+    // The body stays put until the response is done, so it can go out by DMA
+    while (c->body_pos < c->body_len) {
+        int n = send_socket_dma(c->sn, c->body + c->body_pos, c->body_len - c->body_pos);
+        if (n < 0) return -1;
+        if (n == 0) return 0;
+        c->body_pos += n;
+    }
+    return socket_tx_dma_busy(c->sn) ? 0 : 1;
+}
+
+static void conn_close(http_conn_t* c) {
+    if (c->state == HTTP_CONN_WEBSOCKET) websocket_close(c - conns);
+    disconnect_socket(c->sn);
+    c->upgrade = HTTP_UPGRADE_NONE;
+    c->state = HTTP_CONN_CLOSING;
+}
+
+/* Queue the next frame or a heartbeat, returns 1 if the connection must be polled */
+static int conn_events(http_conn_t* c, uint8_t status) {
+    uint32_t now = HAL_GetTick();
+
+    // Subscribers have nothing to say; drop whatever arrives so the window stays open
+    uint16_t rx = get_socket_rx_size(c->sn);
+    if (rx > 0) consume_socket(c->sn, rx);
+
+    if (status == W5500_SR_SOCK_CLOSE_WAIT) {
+        conn_close(c);
+        return 1;
+    }
+
+    const char* out = NULL;
+    uint16_t len = 0;
+    if (c->events_seq != events_seq) {
+        out = events_frame;
+        len = events_frame_len;
+    } else if (now - c->last_ms >= HTTP_EVENTS_HEARTBEAT_MS) {
+        out = ":\n\n";
+        len = 3;
+    } else {
+        return 0;
+    }
+
+    // Whole frames only; a client that cannot take one for too long is dropped
+    if (get_socket_tx_free(c->sn) >= len) {
+        int n = send_socket_nb(c->sn, (const uint8_t*)out, len);
+        if (n < 0) {
+            conn_close(c);
+            return 1;
+        }
+        if (n == len) {
+            if (out == events_frame) c->events_seq = events_seq;
+            c->last_ms = now;
+            return 0;
+        }
+        // n == 0: previous SEND still in flight; n is never partial since len fits in FSR
+    }
+
+    if (now - c->last_ms > HTTP_IDLE_TIMEOUT_MS) conn_close(c);
+    return 1;
+}
+
+/* Hand the connection to websocket.c, returns 1 if it must be polled */
+static int conn_websocket(http_conn_t* c, uint8_t status) {
+    int ret = (status == W5500_SR_SOCK_CLOSE_WAIT) ? -1 : websocket_step(c - conns, c->sn);
+    c->last_ms = HAL_GetTick();  // Heartbeat is websocket.c's business, just keep stepping it
+    if (ret < 0) {
+        conn_close(c);
+        return 1;
+    }
+    return ret;
+}
+
+/* Answer complete requests, returns 1 if the connection must be polled */
+static int conn_serve(http_conn_t* c, uint8_t status) {
+    for (;;) {
+        if (c->state == HTTP_CONN_RECV) {
+            http_parse_result_t res = conn_parse(c);
+            http_parser_t* p = &c->parser;
+
+            if (res == HTTP_PARSE_MORE) {
+                uint32_t limit = http_parser_started(p) ? HTTP_IDLE_TIMEOUT_MS : HTTP_KEEPALIVE_MS;
+                // Peer half-closed with nothing left to answer, or went quiet
+                if (status == W5500_SR_SOCK_CLOSE_WAIT || HAL_GetTick() - c->last_ms > limit) {
+                    conn_close(c);
+                    return 1;
+                }
+                return 0;
+            }
+
+            c->requests++;
+            c->upgrade = HTTP_UPGRADE_NONE;
+            c->body = NULL;
+            c->body_len = 0;
+            c->tx_pos = 0;
+            c->body_pos = 0;
+
+            if (res == HTTP_PARSE_ERROR) {
+                // Framing is lost, answer and close
+                c->keep_alive = 0;
+                c->tx_len = http_write_error(c->tx, sizeof(c->tx), p->status, 0, NULL);
+            } else {
+                uint8_t wants = (p->version == 11) ? (p->conn_hdr != HTTP_CONN_HDR_CLOSE)
+                                                   : (p->conn_hdr == HTTP_CONN_HDR_KEEPALIVE);
+                http_request_t req = {
+                    .conn = c - conns,
+                    .method = p->method,
+                    .path = p->path,
+                    .path_len = p->path_len,
+                    .keep_alive = wants && status == W5500_SR_SOCK_ESTABLISHED &&
+                                  c->requests < HTTP_MAX_REQUESTS,
+                    .accept_gzip = p->accept_gzip,
+                    .if_none_match = p->if_none_match,
+                    .upgrade_ws = p->conn_upgrade && p->upgrade_ws,
+                    .ws_version = p->ws_version,
+                    .ws_key = p->ws_key,
+                };
+                c->keep_alive = req.keep_alive;
+                c->tx_len = dispatch(c, &req);
+            }
+            c->state = HTTP_CONN_SEND;
+        }
+
+        uint16_t before = c->tx_pos + c->body_pos;
+        int ret = conn_send(c);
+        if (c->tx_pos + c->body_pos != before) c->last_ms = HAL_GetTick();
+
+        if (ret == 0) {
+            // No event for "TX space freed", keep polling; drop peers that stopped reading
+            if (HAL_GetTick() - c->last_ms > HTTP_IDLE_TIMEOUT_MS) conn_close(c);
+            return 1;
+        }
+        if (ret < 0) {
+            conn_close(c);
+            return 1;
+        }
+        if (c->upgrade == HTTP_UPGRADE_EVENTS) {
+            // Header is out, start with the latest frame
+            c->state = HTTP_CONN_EVENTS;
+            c->events_seq = 0;
+            return conn_events(c, status);
+        }
+        if (c->upgrade == HTTP_UPGRADE_WEBSOCKET) {
+            c->state = HTTP_CONN_WEBSOCKET;
+            websocket_open(c - conns, c->sn);
+            return conn_websocket(c, status);
+        }
+        if (!c->keep_alive) {
+            conn_close(c);
+            return 1;
+        }
+
+        // Next (possibly pipelined) request
+        http_parser_reset(&c->parser);
+        c->state = HTTP_CONN_RECV;
+        c->last_ms = HAL_GetTick();
+    }
+}
+
+/* Returns 1 if the connection needs to be stepped again without an event */
+static int conn_step(http_conn_t* c) {
+    uint8_t status = get_socket_status(c->sn);
+
+    switch (status) {
+        case W5500_SR_SOCK_CLOSED:
+            if (c->state == HTTP_CONN_WEBSOCKET) websocket_close(c - conns);
+            c->upgrade = HTTP_UPGRADE_NONE;
+            socket_open_async(c->sn, W5500_Sn_MR_TCP, HTTP_PORT, 0);
+            c->state = HTTP_CONN_OPENING;
+            return 1;
+
+        case W5500_SR_SOCK_INIT:
+            socket_cmd_start(c->sn, SOCK_CMD_LISTEN);
+            c->state = HTTP_CONN_OPENING;
+            return 1;
+
+        case W5500_SR_SOCK_LISTEN:
+            c->state = HTTP_CONN_LISTEN;
+            return 0;
+
+        case W5500_SR_SOCK_ESTABLISHED:
+        case W5500_SR_SOCK_CLOSE_WAIT:
+            if (c->state == HTTP_CONN_OPENING || c->state == HTTP_CONN_LISTEN) {
+                c->state = HTTP_CONN_RECV;
+                c->requests = 0;
+                c->upgrade = HTTP_UPGRADE_NONE;
+                http_parser_reset(&c->parser);
+                c->last_ms = HAL_GetTick();
+            }
+
+            if (c->state == HTTP_CONN_CLOSING) {
+                // DISCON in flight; retry if it was refused
+                if (socket_cmd_state(c->sn) != SOCK_ST_BUSY) disconnect_socket(c->sn);
+                return 1;
+            }
+            if (c->state == HTTP_CONN_EVENTS) return conn_events(c, status);
+            if (c->state == HTTP_CONN_WEBSOCKET) return conn_websocket(c, status);
+            return conn_serve(c, status);
+
+        default:
+            // SYNRECV and the FIN/TIME_WAIT teardown states
+            return 1;
+    }
+}
+
+void http_server_init(const http_route_t* routes, uint8_t count) {
+    http_routes = routes;
+    http_route_count = count;
+
+    for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+        http_conn_t* c = &conns[i];
+        c->sn = HTTP_POOL_FIRST + i;
+        c->state = HTTP_CONN_OPENING;
+
+        socket_open_async(c->sn, W5500_Sn_MR_TCP, HTTP_PORT, 0);
+        w5500_event_register(c->sn, W5500_Sn_IR_CON | W5500_Sn_IR_RECV |
+                             W5500_Sn_IR_DISCON | W5500_Sn_IR_TIMEOUT, http_socket_event);
+    }
+    http_pending = (1 << HTTP_POOL_SIZE) - 1;
+}
+
+void http_server_process(void) {
+    if (!http_routes) return;
+
+    for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+        http_conn_t* c = &conns[i];
+        uint8_t bit = 1 << i;
+
+        // Clients in RECV without new data only need the idle timeout check,
+        // idle subscribers and websockets the heartbeat
+        if (!(http_pending & bit)) {
+            uint32_t limit;
+            if (c->state == HTTP_CONN_RECV) {
+                limit = http_parser_started(&c->parser) ? HTTP_IDLE_TIMEOUT_MS : HTTP_KEEPALIVE_MS;
+            } else if (c->state == HTTP_CONN_EVENTS || c->state == HTTP_CONN_WEBSOCKET) {
+                limit = HTTP_EVENTS_HEARTBEAT_MS - 1;
+            } else {
+                continue;
+            }
+            if (HAL_GetTick() - c->last_ms <= limit) continue;
+        }
+
+        http_pending &= ~bit;
+        if (conn_step(c)) http_pending |= bit;
+    }
+}
+
+uint8_t http_server_active(void) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+        uint8_t st = conns[i].state;
+        if (st == HTTP_CONN_RECV || st == HTTP_CONN_SEND ||
+            st == HTTP_CONN_EVENTS || st == HTTP_CONN_WEBSOCKET) n++;
+    }
+    return n;
+}
+
+uint8_t http_server_body_busy(const void* buf, uint16_t len) {
+    const uint8_t* lo = buf;
+    for (uint8_t i = 0; i < HTTP_POOL_SIZE; i++) {
+        const http_conn_t* c = &conns[i];
+        if (c->state == HTTP_CONN_SEND &&
+            (c->body_pos < c->body_len || socket_tx_dma_busy(c->sn)) &&
+            c->body >= lo && c->body < lo + len) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+/* i2c_bus.c - Shared I2C transaction queue
+ *
+ * Drivers never call the HAL for I2C themselves: they queue reads and
+ * writes here and get their callback from the main loop. Queued transfers
+ * run back to back by interrupt/DMA, each completion interrupt starting
+ * the next one, so reads that fall due together go out as one batch.
+ *
+ * A NACK only fails its own transfer (the HAL has sent STOP). A bus or
+ * DMA error, or a transfer still running after I2C_BUS_TIMEOUT_MS, resets
+ * the peripheral and clears a stuck bus (i2c1_bus_recover) before the
+ * next transfer starts.
+ */
+
+#include "i2c_bus.h"
+#include "i2c.h"
+#include <string.h>
+
+#define Q_MASK  (I2C_BUS_QUEUE_LEN - 1)
+
+#if (I2C_BUS_QUEUE_LEN & Q_MASK) != 0
+#error "I2C_BUS_QUEUE_LEN must be a power of two"
+#endif
+
+typedef struct {
+    uint8_t  addr;
+    uint8_t  write;
+    uint8_t  len;
+    int16_t  reg;
+    uint8_t* buf;
+    uint8_t  data[I2C_BUS_MAX_WRITE];
+    i2c_bus_done_t cb;
+    void*    ctx;
+    uint32_t err;
+} xfer_t;
+
+static I2C_HandleTypeDef* bus;
+static xfer_t q[I2C_BUS_QUEUE_LEN];
+static volatile uint8_t q_head = 0;     // Oldest, completion not delivered yet
+static volatile uint8_t q_next = 0;     // Next to start
+static volatile uint8_t q_tail = 0;     // Next free slot
+static volatile uint8_t busy = 0;       // q[q_next] is on the bus
+static volatile uint8_t need_recover = 0;
+static volatile uint32_t started_at = 0;
+static uint8_t present[16];             // Scan result, one bit per address
+static i2c_bus_stats_t stats;
+
+static void start_next(void);
+
+/* Current transfer ended: record it and, unless the bus needs a reset,
+   chain the next one (interrupt or main loop context) */
+static void finish(uint32_t err) {
+    q[q_next & Q_MASK].err = err;
+    q_next++;
+    busy = 0;
+    if (err != HAL_I2C_ERROR_NONE && err != HAL_I2C_ERROR_AF) {
+        need_recover = 1;
+        return;
+    }
+    if (q_next != q_tail) start_next();
+}
+
+static void start_next(void) {
+    xfer_t* x = &q[q_next & Q_MASK];
+    uint16_t a = (uint16_t)x->addr << 1;
+    HAL_StatusTypeDef st;
+
+    busy = 1;
+    started_at = HAL_GetTick();
+    if (x->write) {
+        st = (x->reg == I2C_NO_REG)
+            ? HAL_I2C_Master_Transmit_IT(bus, a, x->data, x->len)
+            : HAL_I2C_Mem_Write_IT(bus, a, x->reg, I2C_MEMADD_SIZE_8BIT, x->data, x->len);
+    } else if (x->len > 1) {
+        st = (x->reg == I2C_NO_REG)
+            ? HAL_I2C_Master_Receive_DMA(bus, a, x->buf, x->len)
+            : HAL_I2C_Mem_Read_DMA(bus, a, x->reg, I2C_MEMADD_SIZE_8BIT, x->buf, x->len);
+    } else {
+        st = (x->reg == I2C_NO_REG)
+            ? HAL_I2C_Master_Receive_IT(bus, a, x->buf, x->len)
+            : HAL_I2C_Mem_Read_IT(bus, a, x->reg, I2C_MEMADD_SIZE_8BIT, x->buf, x->len);
+    }
+    // HAL_BUSY here means SCL/SDA held low: same cure as a bus error
+    if (st != HAL_OK) finish(HAL_I2C_ERROR_BERR);
+}
+
+static void recover(void) {
+    HAL_I2C_DeInit(bus);
+    if (bus->Instance == I2C1) i2c1_bus_recover();
+    HAL_I2C_Init(bus);
+    stats.recoveries++;
+}
+
+static int submit(const xfer_t* x) {
+    if ((uint8_t)(q_tail - q_head) >= I2C_BUS_QUEUE_LEN) {
+        stats.queue_full++;
+        return -1;
+    }
+    q[q_tail & Q_MASK] = *x;
+    q_tail++;   // Visible to the completion interrupt only once the slot is filled
+    return 0;
+}
+
+/* --- API --- */
+
+void i2c_bus_init(I2C_HandleTypeDef* hi2c) {
+    bus = hi2c;
+    q_head = q_next = q_tail = 0;
+    busy = 0;
+    need_recover = 0;
+    memset(present, 0, sizeof(present));
+    memset(&stats, 0, sizeof(stats));
+}
+
+uint8_t i2c_bus_scan(void) {
+    uint8_t n = 0;
+    memset(present, 0, sizeof(present));
+    for (uint8_t a = 0x08; a <= 0x77; a++) {
+        if (HAL_I2C_IsDeviceReady(bus, (uint16_t)a << 1, 1, 2) == HAL_OK) {
+            present[a >> 3] |= 1 << (a & 7);
+            n++;
+        }
+    }
+    return n;
+}
+
+uint8_t i2c_bus_present(uint8_t addr) {
+    return addr < 0x80 && (present[addr >> 3] & (1 << (addr & 7)));
+}
+
+int i2c_bus_read_blocking(uint8_t addr, int16_t reg, uint8_t* buf, uint16_t len) {
+    HAL_StatusTypeDef st = (reg == I2C_NO_REG)
+        ? HAL_I2C_Master_Receive(bus, (uint16_t)addr << 1, buf, len, I2C_BUS_BLOCKING_MS)
+        : HAL_I2C_Mem_Read(bus, (uint16_t)addr << 1, reg, I2C_MEMADD_SIZE_8BIT, buf, len,
+                           I2C_BUS_BLOCKING_MS);
+    return st == HAL_OK ? 0 : -1;
+}
+
+int i2c_bus_write_blocking(uint8_t addr, int16_t reg, const uint8_t* data, uint16_t len) {
+    HAL_StatusTypeDef st = (reg == I2C_NO_REG)
+        ? HAL_I2C_Master_Transmit(bus, (uint16_t)addr << 1, (uint8_t*)data, len, I2C_BUS_BLOCKING_MS)
+        : HAL_I2C_Mem_Write(bus, (uint16_t)addr << 1, reg, I2C_MEMADD_SIZE_8BIT, (uint8_t*)data, len,
+                            I2C_BUS_BLOCKING_MS);
+    return st == HAL_OK ? 0 : -1;
+}
+
+int i2c_bus_read(uint8_t addr, int16_t reg, uint8_t* buf, uint8_t len,
+                 i2c_bus_done_t cb, void* ctx) {
+    xfer_t x = { .addr = addr, .write = 0, .len = len, .reg = reg, .buf = buf, .cb = cb, .ctx = ctx };
+    return submit(&x);
+}
+
+int i2c_bus_write(uint8_t addr, int16_t reg, const uint8_t* data, uint8_t len,
+                  i2c_bus_done_t cb, void* ctx) {
+    if (len > I2C_BUS_MAX_WRITE) return -1;
+    xfer_t x = { .addr = addr, .write = 1, .len = len, .reg = reg, .cb = cb, .ctx = ctx };
+    memcpy(x.data, data, len);
+    return submit(&x);
+}
+
+uint8_t i2c_bus_free(void) {
+    return I2C_BUS_QUEUE_LEN - (uint8_t)(q_tail - q_head);
+}
+
+void i2c_bus_process(void) {
+    if (busy && HAL_GetTick() - started_at > I2C_BUS_TIMEOUT_MS) {
+        recover();      // De-init masks the I2C and DMA interrupts first
+        if (busy) {
+            stats.timeouts++;
+            q[q_next & Q_MASK].err = HAL_I2C_ERROR_TIMEOUT;
+            q_next++;
+            busy = 0;
+        }
+        need_recover = 0;
+    } else if (need_recover) {
+        need_recover = 0;
+        recover();
+    }
+
+    // Completions in submission order, callbacks may queue more
+    while (q_head != q_next) {
+        xfer_t* x = &q[q_head & Q_MASK];
+        uint32_t err = x->err;
+        i2c_bus_done_t cb = x->cb;
+        void* ctx = x->ctx;
+
+        if (err == HAL_I2C_ERROR_NONE) stats.transfers++;
+        else if (err == HAL_I2C_ERROR_AF) stats.nacks++;
+        else if (err != HAL_I2C_ERROR_TIMEOUT) stats.bus_errors++;
+        q_head++;
+        if (cb) cb(ctx, err);
+    }
+
+    if (!busy && !need_recover && q_next != q_tail) start_next();
+}
+
+void i2c_bus_irq_done(uint32_t err) {
+    if (busy) finish(err);
+}
+
+void i2c_bus_get_stats(i2c_bus_stats_t* out) {
+    *out = stats;
+}
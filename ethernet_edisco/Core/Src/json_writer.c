@@ -0,0 +1,168 @@
+/* json_writer.c - allocation-free JSON writer
+ *
+ * Writes into a fixed buffer and flags overflow instead of truncating.
+ * Numbers are fixed-point integers formatted by hand with explicit
+ * precision, no printf and no floating point.
+ */
+
+#include "json_writer.h"
+#include <string.h>
+
+static const uint32_t pow10_u32[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static void put(json_writer_t* w, const char* s, uint16_t n) {
+    if (w->overflow) return;
+    if (n > w->size - w->len) {
+        w->overflow = 1;
+        return;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static void put_char(json_writer_t* w, char c) {
+    put(w, &c, 1);
+}
+
+static void put_escaped(json_writer_t* w, const char* s) {
+    static const char hex[] = "0123456789abcdef";
+
+    put_char(w, '"');
+    while (*s) {
+        const char* run = s;
+        while (*s && *s != '"' && *s != '\\' && (unsigned char)*s >= 0x20) s++;
+        put(w, run, s - run);
+        if (!*s) break;
+
+        char esc[6] = { '\\', *s, 0, 0, 0, 0 };
+        uint8_t n = 2;
+        if ((unsigned char)*s < 0x20) {
+            esc[1] = 'u';
+            esc[2] = '0';
+            esc[3] = '0';
+            esc[4] = hex[(*s >> 4) & 0x0F];
+            esc[5] = hex[*s & 0x0F];
+            n = 6;
+        }
+        put(w, esc, n);
+        s++;
+    }
+    put_char(w, '"');
+}
+
+/* Comma if needed, then "key": */
+static void member(json_writer_t* w, const char* key) {
+    uint16_t bit = 1u << w->depth;
+    if (w->first & bit) w->first &= ~bit;
+    else put_char(w, ',');
+
+    if (key) {
+        put_escaped(w, key);
+        put_char(w, ':');
+    }
+}
+
+/* Decimal digits of v, at least min_digits (zero padded) */
+static void put_u32(json_writer_t* w, uint32_t v, uint8_t min_digits) {
+    char tmp[10];
+    uint8_t n = 0;
+    do {
+        tmp[sizeof(tmp) - 1 - n++] = '0' + v % 10;
+        v /= 10;
+    } while (v || n < min_digits);
+    put(w, tmp + sizeof(tmp) - n, n);
+}
+
+static void put_fixed(json_writer_t* w, uint8_t neg, uint32_t mag, uint8_t decimals) {
+    if (neg) put_char(w, '-');
+    if (decimals == 0) {
+        put_u32(w, mag, 1);
+        return;
+    }
+    put_u32(w, mag / pow10_u32[decimals], 1);
+    put_char(w, '.');
+    put_u32(w, mag % pow10_u32[decimals], decimals);
+}
+
+void json_init(json_writer_t* w, char* buf, uint16_t size) {
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->overflow = 0;
+    w->depth = 0;
+    w->first = 1;
+}
+
+static void nest_begin(json_writer_t* w, const char* key, char c) {
+    member(w, key);
+    put_char(w, c);
+    if (w->depth + 1 >= JSON_MAX_DEPTH) {
+        w->overflow = 1;
+        return;
+    }
+    w->depth++;
+    w->first |= 1u << w->depth;
+}
+
+static void nest_end(json_writer_t* w, char c) {
+    if (w->depth > 0) w->depth--;
+    put_char(w, c);
+}
+
+void json_obj_begin(json_writer_t* w, const char* key) { nest_begin(w, key, '{'); }
+void json_obj_end(json_writer_t* w)                    { nest_end(w, '}'); }
+void json_arr_begin(json_writer_t* w, const char* key) { nest_begin(w, key, '['); }
+void json_arr_end(json_writer_t* w)                    { nest_end(w, ']'); }
+
+void json_str(json_writer_t* w, const char* key, const char* value) {
+    member(w, key);
+    put_escaped(w, value);
+}
+
+void json_int(json_writer_t* w, const char* key, int32_t value) {
+    member(w, key);
+    if (value < 0) put_char(w, '-');
+    put_u32(w, (value < 0) ? 0u - (uint32_t)value : (uint32_t)value, 1);
+}
+
+void json_uint(json_writer_t* w, const char* key, uint32_t value) {
+    member(w, key);
+    put_u32(w, value, 1);
+}
+
+void json_bool(json_writer_t* w, const char* key, uint8_t value) {
+    member(w, key);
+    if (value) put(w, "true", 4);
+    else put(w, "false", 5);
+}
+
+void json_null(json_writer_t* w, const char* key) {
+    member(w, key);
+    put(w, "null", 4);
+}
+
+void json_fixed(json_writer_t* w, const char* key, int32_t value, uint8_t decimals) {
+    if (decimals > 9) decimals = 9;
+    member(w, key);
+    put_fixed(w, value < 0, (value < 0) ? 0u - (uint32_t)value : (uint32_t)value, decimals);
+}
+
+void json_fixed_rounded(json_writer_t* w, const char* key, int32_t value,
+                        uint8_t value_decimals, uint8_t decimals) {
+    if (value_decimals > 9) value_decimals = 9;
+    if (decimals > value_decimals) decimals = value_decimals;
+
+    uint32_t div = pow10_u32[value_decimals - decimals];
+    uint32_t mag = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+    uint32_t q = mag / div;
+    if (div > 1 && mag % div >= div / 2) q++;   // Half away from zero
+
+    member(w, key);
+    put_fixed(w, value < 0, q, decimals);
+}
+
+uint16_t json_len(const json_writer_t* w) {
+    return w->len;
+}
@@ -18,6 +18,7 @@
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "dma.h"
 #include "i2c.h"
 #include "spi.h"
 #include "usart.h"
@@ -27,16 +28,29 @@
 /* USER CODE BEGIN Includes */
 #include "socket.h"
 #include "w5500.h"
+#include "w5500_event.h"
 #include "wizchip_conf.h"
 #include "gps.h"
 #include "nmea.h"
 #include "bme.h"
+#include "bh1750.h"
+#include "sensors.h"
+#include "i2c_bus.h"
+#include "history.h"
 #include "display_ili9341.h"
 #include "cli.h"
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include <time.h>
 #include "mdns.h"
+#include "dhcp.h"
+#include "ntp.h"
+#include "ubx.h"
+#include "http_server.h"
+#include "json_writer.h"
+#include "status_json.h"
+#include "websocket.h"
 
 /* USER CODE END Includes */
 
@@ -47,10 +61,8 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-#define HTTP_SOCKET     0
-#define DHCP_SOCKET     1
 #define MDNS_SOCKET     2
-#define HTTP_PORT       80
+#define DEVICE_HOSTNAME "stm32f411panel"
 #define DATA_BUF_SIZE   2048
 
 /* USER CODE END PD */
@@ -65,16 +77,17 @@
 /* USER CODE BEGIN PV */
 wiz_NetInfo gWIZNETINFO = {
     .mac = {0x00, 0x08, 0xdc, 0xab, 0xcd, 0xef},
-    .ip = {192, 168, 1, 177},      // Static IP fallback
+    .ip = {192, 168, 1, 177},      // Static IP fallback when DHCP gets no lease
     .sn = {255, 255, 255, 0},
     .gw = {192, 168, 1, 1},
     .dns = {8, 8, 8, 8}
 };
 
 uint8_t rx_tx_buf[DATA_BUF_SIZE];
-static uint8_t gps_rx_byte;
+#define GPS_DMA_BUF_SIZE 256
+static uint8_t gps_dma_buf[GPS_DMA_BUF_SIZE];  // Circular, written by DMA2 Stream2
+static uint16_t gps_dma_pos = 0;                // Next byte not yet handed to NMEA
 
-bme280_data_t bme_data = {0};
 gps_pos_t gps_data = {0};
 
 uint8_t net_initialized = 0;
@@ -82,45 +95,8 @@ uint8_t net_initialized = 0;
 static uint32_t gps_last_update = 0;
 static uint32_t env_last_update = 0;
 static uint32_t display_last_update = 0;
-
-const char index_html[] =
-"<!DOCTYPE html><html><head><meta charset='UTF-8'>"
-"<meta name='viewport' content='width=device-width,initial-scale=1'>"
-"<title>STM32 Network Panel</title>"
-"<style>"
-"body{font-family:Arial,sans-serif;background:#f0f0f0;margin:0;padding:20px;}"
-"h1{text-align:center;color:#333;}"
-".container{max-width:800px;margin:0 auto;}"
-".card{background:white;border-radius:8px;padding:20px;margin:15px 0;box-shadow:0 2px 8px rgba(0,0,0,0.1);}"
-".card h2{margin-top:0;color:#007BFF;border-bottom:2px solid #007BFF;padding-bottom:10px;}"
-".row{display:flex;justify-content:space-between;margin:10px 0;}"
-".label{font-weight:bold;color:#555;}"
-".value{font-size:1.3em;color:#007BFF;font-weight:bold;}"
-".stale{color:#ff4444;font-size:0.85em;font-weight:bold;}"
-".badge{display:inline-block;padding:3px 8px;border-radius:4px;font-size:0.8em;font-weight:bold;}"
-".fix-ok{background:#00aa00;color:white;}"
-".fix-no{background:#ff4444;color:white;}"
-"#timestamp{text-align:center;color:#888;font-size:0.9em;margin-top:10px;}"
-"</style></head><body>"
-"<div class='container'>"
-"<h1>STM32 Device Status</h1>"
-"<div class='card'>"
-"<h2>GPS Position</h2>"
-"<div class='row'><span class='label'>Latitude:</span><span class='value'>--</span></div>"
-"<div class='row'><span class='label'>Longitude:</span><span class='value'>--</span></div>"
-"<div class='row'><span class='label'>Fix Status:</span><span class='badge fix-no'>NO FIX</span></div>"
-"<div class='row'><span class='label'>Satellites:</span><span class='value'>--</span></div>"
-"<div class='row'><span class='label'>UTC Time:</span><span class='value'>--</span></div>"
-"</div>"
-"<div class='card'>"
-"<h2>Environment Sensors</h2>"
-"<div class='row'><span class='label'>Temperature:</span><span class='value'>--</span> °C</div>"
-"<div class='row'><span class='label'>Pressure:</span><span class='value'>--</span> hPa</div>"
-"<div class='row'><span class='label'>Humidity:</span><span class='value'>--</span> %</div>"
-"</div>"
-"<div id='timestamp'>Connection error</div>"
-"</div>"
-"</body></html>";
+static uint32_t history_last_s = 0;
+static uint8_t events_stale = 0xFF;
 
 /* USER CODE END PV */
 
@@ -152,6 +128,78 @@ void wiz_spi_writebyte(uint8_t byte) {
     HAL_SPI_Transmit(&hspi2, &byte, 1, HAL_MAX_DELAY);
 }
 
+void wiz_spi_readburst(uint8_t* buf, uint16_t len) {
+    HAL_SPI_Receive(&hspi2, buf, len, HAL_MAX_DELAY);
+}
+
+void wiz_spi_writeburst(const uint8_t* buf, uint16_t len) {
+    HAL_SPI_Transmit(&hspi2, (uint8_t*)buf, len, HAL_MAX_DELAY);
+}
+
+int wiz_spi_dma_start(const uint8_t* tx, uint8_t* rx, uint16_t len) {
+    HAL_StatusTypeDef ret;
+    if (rx) {
+        ret = HAL_SPI_TransmitReceive_DMA(&hspi2, (uint8_t*)tx, rx, len);
+    } else {
+        ret = HAL_SPI_Transmit_DMA(&hspi2, (uint8_t*)tx, len);
+    }
+    return (ret == HAL_OK) ? 0 : -1;
+}
+
+void wiz_spi_dma_abort(void) {
+    HAL_SPI_Abort(&hspi2);
+}
+
+/* SPI2 DMA callbacks for the W5500 burst transport */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
+    if(hspi->Instance == SPI2) {
+        w5500_dma_complete(0);
+    }
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+    if(hspi->Instance == SPI2) {
+        w5500_dma_complete(0);
+    }
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+    if(hspi->Instance == SPI2) {
+        w5500_dma_complete(-1);
+    }
+}
+
+/* I2C1 interrupt/DMA callbacks, each completion starts the next queued transfer */
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if(hi2c->Instance == I2C1) {
+        i2c_bus_irq_done(HAL_I2C_ERROR_NONE);
+    }
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if(hi2c->Instance == I2C1) {
+        i2c_bus_irq_done(HAL_I2C_ERROR_NONE);
+    }
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if(hi2c->Instance == I2C1) {
+        i2c_bus_irq_done(HAL_I2C_ERROR_NONE);
+    }
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if(hi2c->Instance == I2C1) {
+        i2c_bus_irq_done(HAL_I2C_ERROR_NONE);
+    }
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    if(hi2c->Instance == I2C1) {
+        i2c_bus_irq_done(HAL_I2C_GetError(hi2c));
+    }
+}
+
 void network_init(void) {
     // Reset W5500
     HAL_GPIO_WritePin(W5500_RST_GPIO_Port, W5500_RST_Pin, GPIO_PIN_RESET);
@@ -171,104 +219,532 @@ void network_init(void) {
     net_initialized = 1;
 }
 
+/* New lease or static fallback: keep gWIZNETINFO in sync and re-announce */
+static void dhcp_assign_callback(void) {
+    wiz_NetInfo dhcpInfo;
+    wizchip_getnetinfo(&dhcpInfo);
+
+    memcpy(gWIZNETINFO.ip, dhcpInfo.ip, 4);
+    memcpy(gWIZNETINFO.sn, dhcpInfo.sn, 4);
+    memcpy(gWIZNETINFO.gw, dhcpInfo.gw, 4);
+
+    mdns_update_address();
+
+    char buf[40];
+    snprintf(buf, sizeof(buf), "IP: %d.%d.%d.%d %-6s", dhcpInfo.ip[0], dhcpInfo.ip[1],
+             dhcpInfo.ip[2], dhcpInfo.ip[3],
+             (dhcp_get_state() == DHCP_STATE_STATIC) ? "static" : "dhcp");
+    ili9341_draw_text(10, 240, buf, &font6x8, 0x07E0, 0x0000);
+}
+
 /* --- HTTP server --- */
-void http_server_process(void) {
-    uint8_t sn = HTTP_SOCKET;
-    uint8_t status = get_socket_status(sn);
-
-    switch(status) {
-        case W5500_SR_SOCK_ESTABLISHED: {
-            uint16_t size = W5500_READ_REG16(W5500_Sn_RX_RSR0(sn));
-            if(size > 0) {
-                if(size > DATA_BUF_SIZE) size = DATA_BUF_SIZE;
-                recv_socket(sn, rx_tx_buf, size);
-                rx_tx_buf[size] = '\0';
-
-                if(strncmp((char*)rx_tx_buf, "GET /status", 11) == 0) {
-                    char json_buf[600];
-                    uint32_t now = HAL_GetTick();
-                    float gps_age = gps_last_update ? (float)(now - gps_last_update)/1000.0f : 999.9f;
-                    float env_age = env_last_update ? (float)(now - env_last_update)/1000.0f : 999.9f;
-
-                    char time_str[32];
-                    format_utc_time(gps_data.year, gps_data.month, gps_data.day,
-                                   gps_data.hour, gps_data.min, gps_data.sec,
-                                   time_str, sizeof(time_str));
-
-                    snprintf(json_buf, sizeof(json_buf),
-                        "HTTP/1.1 200 OK\r\n"
-                        "Content-Type: application/json\r\n"
-                        "Access-Control-Allow-Origin: *\r\n"
-                        "Connection: close\r\n"
-                        "Cache-Control: no-cache\r\n\r\n"
-                        "{"
-                        "\"proto_ver\":1,"
-                        "\"device_id\":\"bp-411-0007\","
-                        "\"time_utc\":\"%s\","
-                        "\"gps\":{\"lat\":%.6f,\"lon\":%.6f,\"fix\":%d,\"sats\":%d},"
-                        "\"env\":{\"t_c\":%.1f,\"p_hpa\":%.1f,\"rh_pct\":%.1f,\"lux\":0},"
-                        "\"stale_age_s\":{\"gps\":%.1f,\"env\":%.1f}"
-                        "}",
-                        time_str,
-                        gps_data.lat_deg, gps_data.lon_deg, gps_data.fix, gps_data.sats,
-                        bme_data.temperature, bme_data.pressure, bme_data.humidity,
-                        gps_age, env_age
-                    );
-                    send_socket(sn, (uint8_t*)json_buf, strlen(json_buf));
-                } else {
-                    char header[] = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nConnection: close\r\n\r\n";
-                    send_socket(sn, (uint8_t*)header, strlen(header));
-                    send_socket(sn, (uint8_t*)index_html, strlen(index_html));
-                }
-
-                // Disconnect client (keep socket LISTENING)
-                disconnect_socket(sn);
+#define STALE_MS        3000    // Readings older than this are flagged stale
+
+/* Current readings for /status and /events */
+static void current_readings(status_readings_t* r) {
+    r->pos = &gps_data;
+    r->env_tenths[0] = sensors_tenths(SENSOR_TEMP);
+    r->env_tenths[1] = sensors_tenths(SENSOR_PRESS);
+    r->env_tenths[2] = sensors_tenths(SENSOR_HUM);
+    r->env_tenths[3] = sensors_tenths(SENSOR_LUX);
+}
+
+static uint32_t age_ms(uint32_t now, uint32_t last) {
+    return last ? now - last : STATUS_AGE_NEVER;
+}
+
+/* Bit 0: GPS stale, bit 1: environment stale */
+static uint8_t stale_flags(uint32_t now) {
+    uint8_t flags = 0;
+    if (!gps_last_update || now - gps_last_update > STALE_MS) flags |= 1;
+    // Slow BME280 profiles sample less often than STALE_MS
+    if (!env_last_update || now - env_last_update > sensors_stale_ms(SENSOR_TEMP)) flags |= 2;
+    return flags;
+}
+
+/* UTC seconds now, from the last GPS time; 0 if the receiver never had one */
+static uint32_t unix_now(uint32_t now) {
+    if (!gps_last_update || gps_data.year < 2000) return 0;
+    return gps_unix_time(gps_data.year, gps_data.month, gps_data.day,
+                         gps_data.hour, gps_data.min, gps_data.sec) +
+           (now - gps_last_update) / 1000;
+}
+
+static uint8_t sensor_fresh(sensor_qty_t q, uint32_t now, sensor_sample_t* s) {
+    *s = sensors_get(q);
+    return s->last_update && now - s->last_update <= sensors_stale_ms(q);
+}
+
+/* One history sample per second; stale readings are left out as gaps */
+static void history_sample(uint32_t now) {
+    static gps_epoch_t e;
+    int32_t v[HISTORY_SERIES_COUNT] = {0};
+    uint16_t mask = 0;
+    sensor_sample_t s;
+
+    if (sensor_fresh(SENSOR_TEMP, now, &s)) {
+        v[HISTORY_T_C] = s.value;
+        mask |= 1 << HISTORY_T_C;
+    }
+    if (sensor_fresh(SENSOR_PRESS, now, &s)) {
+        v[HISTORY_P_HPA] = s.value;
+        mask |= 1 << HISTORY_P_HPA;
+    }
+    if (sensor_fresh(SENSOR_HUM, now, &s)) {
+        v[HISTORY_RH_PCT] = (s.value * 100 + 512) >> 10;
+        mask |= 1 << HISTORY_RH_PCT;
+    }
+    if (sensor_fresh(SENSOR_LUX, now, &s)) {
+        v[HISTORY_LUX] = (s.value + 50) / 100;
+        mask |= 1 << HISTORY_LUX;
+    }
+
+    if (gps_last_update && now - gps_last_update <= STALE_MS) {
+        v[HISTORY_FIX] = gps_data.fix;
+        v[HISTORY_SATS] = gps_data.sats;
+        mask |= (1 << HISTORY_FIX) | (1 << HISTORY_SATS);
+        if (gps_data.fix) {
+            v[HISTORY_LAT] = gps_data.lat_e7;
+            v[HISTORY_LON] = gps_data.lon_e7;
+            mask |= (1 << HISTORY_LAT) | (1 << HISTORY_LON);
+        }
+        gps_get_epoch(&e);
+        if (e.hdop) {
+            v[HISTORY_HDOP] = e.hdop;
+            mask |= 1 << HISTORY_HDOP;
+        }
+    }
+
+    history_add(now / 1000, v, mask);
+}
+
+/* Publish the readings to /events; unchanged frames are dropped by
+   http_events_publish, and new subscribers start from the last one */
+static void events_update(uint32_t now) {
+    char buf[HTTP_EVENTS_FRAME_SIZE - 8];
+    uint8_t flags = stale_flags(now);
+    status_readings_t r;
+    current_readings(&r);
+
+    json_writer_t w;
+    json_init(&w, buf, sizeof(buf));
+    json_obj_begin(&w, NULL);
+    status_json_readings(&w, &r);
+    json_obj_begin(&w, "stale");
+    json_bool(&w, "gps", flags & 1);
+    json_bool(&w, "env", flags & 2);
+    json_obj_end(&w);
+    json_obj_end(&w);
+
+    if (!w.overflow) http_events_publish(buf, json_len(&w));
+}
+
+/* --- WebSocket telemetry --- */
+/* Binary record pushed on /ws, little endian, 26 bytes:
+ *   0  u8   type (1)
+ *   1  u8   GPS fix
+ *   2  u8   satellites
+ *   3  u8   reserved
+ *   4  i32  latitude, 1e-7 deg
+ *   8  i32  longitude, 1e-7 deg
+ *   12 u32  GPS time, Unix seconds (0 without a date)
+ *   16 i16  temperature, 0.01 C
+ *   18 u16  pressure, 0.1 hPa
+ *   20 u16  humidity, 0.01 %
+ *   22 u16  GPS age, 0.1 s (0xFFFF never / older)
+ *   24 u16  sensor age, 0.1 s (0xFFFF never / older)
+ */
+#define TELEMETRY_RECORD_LEN    26
+
+static uint8_t* put_le(uint8_t* p, uint32_t v, uint8_t n) {
+    while (n--) {
+        *p++ = v;
+        v >>= 8;
+    }
+    return p;
+}
+
+static uint16_t age_ds(uint32_t now, uint32_t last) {
+    if (!last || now - last >= 0xFFFF * 100u) return 0xFFFF;
+    return (now - last) / 100;
+}
+
+static void telemetry_record(uint8_t* rec, uint32_t now) {
+    uint8_t* p = rec;
+    *p++ = 1;
+    *p++ = gps_data.fix;
+    *p++ = gps_data.sats;
+    *p++ = 0;
+    p = put_le(p, gps_data.lat_e7, 4);
+    p = put_le(p, gps_data.lon_e7, 4);
+    p = put_le(p, gps_unix_time(gps_data.year, gps_data.month, gps_data.day,
+                                gps_data.hour, gps_data.min, gps_data.sec), 4);
+    p = put_le(p, (int16_t)sensors_get(SENSOR_TEMP).value, 2);
+    p = put_le(p, (uint16_t)((sensors_get(SENSOR_PRESS).value + 5) / 10), 2);
+    p = put_le(p, (uint16_t)((sensors_get(SENSOR_HUM).value * 100 + 512) >> 10), 2);
+    p = put_le(p, age_ds(now, gps_last_update), 2);
+    put_le(p, age_ds(now, env_last_update), 2);
+}
+
+/* Text messages on /ws are CLI commands */
+static uint16_t ws_command(const char* cmd, char* reply, uint16_t reply_size) {
+    return cli_run(cmd, reply, reply_size);
+}
+
+static uint16_t http_status_handler(const http_request_t* req,
+                                    char* out, uint16_t out_size,
+                                    const uint8_t** body, uint16_t* body_len) {
+    (void)body; (void)body_len;
+    uint32_t now = HAL_GetTick();
+    status_readings_t r;
+    gps_epoch_t epoch;
+    char json_buf[STATUS_JSON_MAX];
+
+    current_readings(&r);
+    gps_get_epoch(&epoch);
+    uint16_t len = status_json(json_buf, sizeof(json_buf), &r, &epoch,
+                               age_ms(now, gps_last_update), age_ms(now, env_last_update));
+    if (len == 0) return http_write_error(out, out_size, 500, req->keep_alive, NULL);
+
+    uint16_t n = http_write_head(out, out_size, "200 OK", "application/json", len,
+                                 req->keep_alive,
+                                 "Access-Control-Allow-Origin: *\r\n"
+                                 "Cache-Control: no-cache\r\n");
+    if (n == 0 || n + len > out_size) {
+        return http_write_error(out, out_size, 500, req->keep_alive, NULL);
+    }
+    memcpy(out + n, json_buf, len);
+    return n + len;
+}
+
+/* Satellites of the last epoch; the body outlives the handler, so it is
+   kept per epoch and only rebuilt when a newer one has been published and
+   no client is still receiving the previous one */
+static uint16_t http_sky_handler(const http_request_t* req,
+                                 char* out, uint16_t out_size,
+                                 const uint8_t** body, uint16_t* body_len) {
+    static char sky_buf[2560];   // GPS_MAX_SATS entries of ~62 bytes + fix quality
+    static uint16_t sky_len = 0;
+    static uint32_t sky_seq = 0;
+    static gps_epoch_t e;
+
+    gps_get_epoch(&e);
+    // While another connection streams sky_buf, it gets the previous epoch
+    if ((sky_len == 0 || e.seq != sky_seq) && !http_server_body_busy(sky_buf, sizeof(sky_buf))) {
+        char time_str[32];
+        format_utc_time(e.year, e.month, e.day, e.hour, e.min, e.sec,
+                        time_str, sizeof(time_str));
+
+        json_writer_t w;
+        json_init(&w, sky_buf, sizeof(sky_buf));
+        json_obj_begin(&w, NULL);
+        json_uint(&w, "epoch", e.seq);
+        json_str(&w, "time_utc", time_str);
+        status_json_fix_quality(&w, &e);
+        json_uint(&w, "parse_us", e.parse_us);
+        json_arr_begin(&w, "sats");
+        for (uint8_t i = 0; i < e.sat_count; i++) {
+            const gps_sat_t* s = &e.sats[i];
+            char gnss[2] = { s->gnss, '\0' };
+            json_obj_begin(&w, NULL);
+            json_str(&w, "gnss", gnss);
+            json_int(&w, "prn", s->prn);
+            json_int(&w, "el", s->elev_deg);
+            json_int(&w, "az", s->azim_deg);
+            json_int(&w, "snr", s->snr_db);
+            json_bool(&w, "used", s->used);
+            json_obj_end(&w);
+        }
+        json_arr_end(&w);
+        json_obj_end(&w);
+        if (w.overflow) return http_write_error(out, out_size, 500, req->keep_alive, NULL);
+        sky_len = json_len(&w);
+        sky_seq = e.seq;
+    }
+
+    *body = (const uint8_t*)sky_buf;
+    *body_len = sky_len;
+    return http_write_head(out, out_size, "200 OK", "application/json", sky_len,
+                           req->keep_alive,
+                           "Access-Control-Allow-Origin: *\r\n"
+                           "Cache-Control: no-cache\r\n");
+}
+
+/* Current BME280 profile with its datasheet figures and the preset names */
+static void json_bme_profile(json_writer_t* w) {
+    bme280_profile_t p;
+    bme280_profile_info_t info;
+    bme280_get_profile(&p);
+    bme280_profile_info(&p, &info);
+
+    json_obj_begin(w, NULL);
+    json_str(w, "name", p.name);
+    json_str(w, "mode", p.mode == BME280_MODE_NORMAL ? "normal" : "forced");
+    json_uint(w, "osrs_t", p.osrs_t);
+    json_uint(w, "osrs_p", p.osrs_p);
+    json_uint(w, "osrs_h", p.osrs_h);
+    json_uint(w, "filter", p.filter);
+    json_uint(w, "standby_us", p.standby_us);
+    json_uint(w, "period_ms", p.period_ms);
+    json_uint(w, "meas_typ_us", info.meas_typ_us);
+    json_uint(w, "meas_max_us", info.meas_max_us);
+    json_fixed(w, "odr_hz", info.odr_mhz, 3);
+    json_fixed(w, "current_ua", info.current_na, 3);
+    json_arr_begin(w, "presets");
+    const bme280_profile_t* q;
+    for (uint8_t i = 0; (q = bme280_preset(i)) != NULL; i++) json_str(w, NULL, q->name);
+    json_arr_end(w);
+    json_obj_end(w);
+}
+
+/* Decimal query parameter into *v, left unchanged when absent; -1 if malformed */
+static int query_uint(const char* path, const char* name, uint32_t* v) {
+    char buf[12];
+    char* end;
+    int n = http_query_param(path, name, buf, sizeof(buf));
+    if (n < 0) return 0;
+    uint32_t x = strtoul(buf, &end, 10);
+    if (n == 0 || *end != '\0') return -1;
+    *v = x;
+    return 0;
+}
+
+/* GET: current profile. POST ?preset=indoor, or any of mode, osrs_t, osrs_p,
+   osrs_h, filter, standby_us, period_ms changing the current profile; 403
+   unless CLI_REMOTE_WRITE, the same switch as the /ws commands */
+static uint16_t http_bme_profile_handler(const http_request_t* req,
+                                         char* out, uint16_t out_size,
+                                         const uint8_t** body, uint16_t* body_len) {
+    (void)body; (void)body_len;
+    if (req->method == HTTP_METHOD_POST) {
+        if (!CLI_REMOTE_WRITE) return http_write_error(out, out_size, 403, req->keep_alive, NULL);
+        char v[16];
+        int err = 0;
+        if (http_query_param(req->path, "preset", v, sizeof(v)) >= 0) {
+            err = bme280_set_preset(v);
+        } else {
+            bme280_profile_t p;
+            bme280_get_profile(&p);
+            uint32_t ot = p.osrs_t, op = p.osrs_p, oh = p.osrs_h, f = p.filter;
+            if (http_query_param(req->path, "mode", v, sizeof(v)) >= 0) {
+                p.mode = strcmp(v, "normal") == 0 ? BME280_MODE_NORMAL :
+                         strcmp(v, "forced") == 0 ? BME280_MODE_FORCED : 0;
             }
-            break;
+            err |= query_uint(req->path, "osrs_t", &ot);
+            err |= query_uint(req->path, "osrs_p", &op);
+            err |= query_uint(req->path, "osrs_h", &oh);
+            err |= query_uint(req->path, "filter", &f);
+            err |= query_uint(req->path, "standby_us", &p.standby_us);
+            err |= query_uint(req->path, "period_ms", &p.period_ms);
+            if ((ot | op | oh | f) > 0xFF) err = -1;
+            p.osrs_t = ot; p.osrs_p = op; p.osrs_h = oh; p.filter = f;
+            if (err == 0) err = bme280_set_profile(&p);
         }
-        case W5500_SR_SOCK_LISTEN:
-            // nothing, just waiting for connection
-            break;
-        case W5500_SR_SOCK_INIT:
-            listen_socket(sn);
-            break;
-        case W5500_SR_SOCK_CLOSED:
-            socket(sn, 0x01, HTTP_PORT, 0);
-            listen_socket(sn);
-            break;
+        if (err < 0) return http_write_error(out, out_size, 400, req->keep_alive, NULL);
     }
+
+    char json_buf[320];
+    json_writer_t w;
+    json_init(&w, json_buf, sizeof(json_buf));
+    json_bme_profile(&w);
+    if (w.overflow) return http_write_error(out, out_size, 500, req->keep_alive, NULL);
+    uint16_t len = json_len(&w);
+
+    uint16_t n = http_write_head(out, out_size, "200 OK", "application/json", len,
+                                 req->keep_alive,
+                                 "Access-Control-Allow-Origin: *\r\n"
+                                 "Cache-Control: no-cache\r\n");
+    if(n + len > out_size) return 0;
+    memcpy(out + n, json_buf, len);
+    return n + len;
 }
 
+/* GET ?series=t_c&res=1s|1m|1h&since=<uptime s>&format=json|bin; a scraper
+   passes the previous response's "next" as since to get what it missed */
+static uint16_t http_history_handler(const http_request_t* req,
+                                     char* out, uint16_t out_size,
+                                     const uint8_t** body, uint16_t* body_len) {
+    static char hist_buf[HISTORY_OUT_SIZE];
+    char v[12];
+    int series = -1, res = HISTORY_RES_1S;
+    uint8_t format = HISTORY_FMT_JSON;
+    uint32_t since = 0;
+    int err = 0;
+
+    if (http_query_param(req->path, "series", v, sizeof(v)) >= 0) series = history_series_id(v);
+    if (http_query_param(req->path, "res", v, sizeof(v)) >= 0) res = history_res_id(v);
+    if (http_query_param(req->path, "format", v, sizeof(v)) >= 0) {
+        if (strcmp(v, "bin") == 0) format = HISTORY_FMT_BIN;
+        else if (strcmp(v, "json") != 0) err = -1;
+    }
+    err |= query_uint(req->path, "since", &since);
+    if (series < 0 || res < 0 || err < 0) {
+        return http_write_error(out, out_size, 400, req->keep_alive, NULL);
+    }
+
+    // The body is sent from hist_buf after this returns; another client
+    // may still be receiving the previous one
+    if (http_server_body_busy(hist_buf, sizeof(hist_buf))) {
+        return http_write_error(out, out_size, 503, req->keep_alive, "Retry-After: 1\r\n");
+    }
+    uint16_t len = history_render(series, res, since, format, unix_now(HAL_GetTick()),
+                                  hist_buf, sizeof(hist_buf));
+    if (len == 0) return http_write_error(out, out_size, 500, req->keep_alive, NULL);
+
+    *body = (const uint8_t*)hist_buf;
+    *body_len = len;
+    return http_write_head(out, out_size, "200 OK",
+                           format == HISTORY_FMT_BIN ? "application/octet-stream" : "application/json",
+                           len, req->keep_alive,
+                           "Access-Control-Allow-Origin: *\r\n"
+                           "Cache-Control: no-cache\r\n");
+}
+
+/* Sensor registry and I2C bus counters */
+static uint16_t http_sensors_handler(const http_request_t* req,
+                                     char* out, uint16_t out_size,
+                                     const uint8_t** body, uint16_t* body_len) {
+    (void)body; (void)body_len;
+    char json_buf[512];
+    json_writer_t w;
+    json_init(&w, json_buf, sizeof(json_buf));
+    json_obj_begin(&w, NULL);
+    json_arr_begin(&w, "sensors");
+    sensor_info_t si;
+    for (uint8_t i = 0; sensors_info(i, &si); i++) {
+        json_obj_begin(&w, NULL);
+        json_str(&w, "name", si.name);
+        json_uint(&w, "addr", si.addr);
+        json_bool(&w, "present", si.present);
+        json_uint(&w, "period_ms", si.period_ms);
+        json_uint(&w, "samples", si.samples);
+        json_uint(&w, "errors", si.errors);
+        json_uint(&w, "decode_cycles", si.decode_cycles);
+        json_obj_end(&w);
+    }
+    json_arr_end(&w);
+    i2c_bus_stats_t bs;
+    i2c_bus_get_stats(&bs);
+    json_obj_begin(&w, "i2c");
+    json_uint(&w, "transfers", bs.transfers);
+    json_uint(&w, "nacks", bs.nacks);
+    json_uint(&w, "bus_errors", bs.bus_errors);
+    json_uint(&w, "timeouts", bs.timeouts);
+    json_uint(&w, "recoveries", bs.recoveries);
+    json_uint(&w, "queue_full", bs.queue_full);
+    json_obj_end(&w);
+    json_obj_end(&w);
+    if (w.overflow) return http_write_error(out, out_size, 500, req->keep_alive, NULL);
+    uint16_t len = json_len(&w);
+
+    uint16_t n = http_write_head(out, out_size, "200 OK", "application/json", len,
+                                 req->keep_alive,
+                                 "Access-Control-Allow-Origin: *\r\n"
+                                 "Cache-Control: no-cache\r\n");
+    if(n + len > out_size) return 0;
+    memcpy(out + n, json_buf, len);
+    return n + len;
+}
+
+static const http_route_t http_routes[] = {
+    { HTTP_METHOD_GET, "/",           http_asset_handler },
+    { HTTP_METHOD_GET, "/index.html", http_asset_handler },
+    { HTTP_METHOD_GET, "/status",     http_status_handler },
+    { HTTP_METHOD_GET, "/gps/sky",    http_sky_handler },
+    { HTTP_METHOD_GET, "/bme/profile", http_bme_profile_handler },
+    { HTTP_METHOD_POST, "/bme/profile", http_bme_profile_handler },
+    { HTTP_METHOD_GET, "/sensors",    http_sensors_handler },
+    { HTTP_METHOD_GET, "/history",    http_history_handler },
+    { HTTP_METHOD_GET, "/events",     http_events_handler },
+    { HTTP_METHOD_GET, "/ws",         websocket_handler },
+};
+
 /* --- Display update --- */
 void display_update(void) {
     char buf[50];
 
-    printf(buf, sizeof(buf), "IP: %d.%d.%d.%d", gWIZNETINFO.ip[0], gWIZNETINFO.ip[1],
+    snprintf(buf, sizeof(buf), "IP: %d.%d.%d.%d", gWIZNETINFO.ip[0], gWIZNETINFO.ip[1],
              gWIZNETINFO.ip[2], gWIZNETINFO.ip[3]);
     ili9341_draw_text(10, 10, buf, &font6x8, 0x07E0, 0x0000);
 
-    printf(buf, sizeof(buf), "GW: %d.%d.%d.%d", gWIZNETINFO.gw[0], gWIZNETINFO.gw[1],
+    snprintf(buf, sizeof(buf), "GW: %d.%d.%d.%d", gWIZNETINFO.gw[0], gWIZNETINFO.gw[1],
              gWIZNETINFO.gw[2], gWIZNETINFO.gw[3]);
     ili9341_draw_text(10, 20, buf, &font6x8, 0xFFFF, 0x0000);
 
-    printf(buf, sizeof(buf), "T: %.1fC  H: %.1f%%  P: %.1f hPa",
-             bme_data.temperature, bme_data.humidity, bme_data.pressure);
+    char t[12], h[12], p[12];
+    sensors_format_tenths(t, sizeof(t), sensors_tenths(SENSOR_TEMP));
+    sensors_format_tenths(h, sizeof(h), sensors_tenths(SENSOR_HUM));
+    sensors_format_tenths(p, sizeof(p), sensors_tenths(SENSOR_PRESS));
+    snprintf(buf, sizeof(buf), "T: %sC  H: %s%%  P: %s hPa", t, h, p);
     ili9341_draw_text(10, 50, buf, &font6x8, 0xFFFF, 0x0000);
 
-    printf(buf, sizeof(buf), "Lat: %.5f  Lon: %.5f", gps_data.lat_deg, gps_data.lon_deg);
+    sensors_format_tenths(t, sizeof(t), sensors_tenths(SENSOR_LUX));
+    snprintf(buf, sizeof(buf), "Light: %s lx", t);
+    ili9341_draw_text(10, 60, buf, &font6x8, 0xFFFF, 0x0000);
+
+    snprintf(buf, sizeof(buf), "Lat: %.5f  Lon: %.5f", gps_data.lat_e7 / 1e7, gps_data.lon_e7 / 1e7);
     ili9341_draw_text(10, 90, buf, &font6x8, 0xFFFF, 0x0000);
 
-    printf(buf, sizeof(buf), "Sats: %d  Fix: %d", gps_data.sats, gps_data.fix);
+    snprintf(buf, sizeof(buf), "Sats: %d  Fix: %d", gps_data.sats, gps_data.fix);
     ili9341_draw_text(10, 110, buf, &font6x8,
                      gps_data.fix >= 2 ? 0x07E0 : 0xF800, 0x0000);
 }
 
 
-/* UART Callback for GPS -----------------------------------------------------*/
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
-    if(huart->Instance == USART1) {
-        nmea_push_chunk(&gps_rx_byte, 1);
-        HAL_UART_Receive_IT(&huart1, &gps_rx_byte, 1);
+/* W5500_INT (PE4) falling edge ----------------------------------------------*/
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    if(GPIO_Pin == W5500_INT_Pin) {
+        w5500_event_irq();
+    }
+#ifdef GPS_PPS_Pin
+    if(GPIO_Pin == GPS_PPS_Pin) {
+        ntp_pps_irq();
+    }
+#endif
+}
+
+/* UART reception for GPS ----------------------------------------------------*/
+static void gps_uart_start(void) {
+    gps_dma_pos = 0;
+    HAL_UARTEx_ReceiveToIdle_DMA(&huart1, gps_dma_buf, GPS_DMA_BUF_SIZE);
+}
+
+/* Receiver speed change for UBX mode: restart reception at the new rate */
+static void gps_uart_set_baud(uint32_t baud) {
+    HAL_UART_AbortReceive(&huart1);
+    huart1.Init.BaudRate = baud;
+    if (HAL_UART_Init(&huart1) != HAL_OK) {
+        Error_Handler();
+    }
+    nmea_set_baudrate(baud);
+    gps_uart_start();
+}
+
+/* Both parsers see every byte: NMEA ignores binary frames, UBX skips text */
+static void gps_rx_span(const uint8_t* buf, uint16_t len) {
+    nmea_push_chunk(buf, len);
+    ubx_push_chunk(buf, len);
+}
+
+/* Line idle, half or full buffer: pos is the DMA write index (1..size) */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t pos) {
+    if(huart->Instance != USART1) return;
+    if(pos == gps_dma_pos) return;
+
+    if(pos > gps_dma_pos) {
+        gps_rx_span(&gps_dma_buf[gps_dma_pos], pos - gps_dma_pos);
+    } else {
+        // DMA wrapped: tail of the buffer, then the start
+        gps_rx_span(&gps_dma_buf[gps_dma_pos], GPS_DMA_BUF_SIZE - gps_dma_pos);
+        gps_rx_span(gps_dma_buf, pos);
+    }
+    gps_dma_pos = (pos == GPS_DMA_BUF_SIZE) ? 0 : pos;
+}
+
+/* Noise, framing or overrun stops DMA reception; the broken sentence fails its checksum */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    if(huart->Instance == USART1 && huart->RxState == HAL_UART_STATE_READY) {
+        gps_uart_start();
     }
 }
 
@@ -378,6 +854,46 @@ int w5500_quick_test(void)
 }
 
 
+/**
+ * W5500 SPI throughput test
+ * Writes/reads 16 B, 256 B and 2 KB frames to the socket 7 TX/RX buffers
+ * and shows KB/s for each size. Socket 7 belongs to the HTTP pool; this
+ * runs before http_server_init() opens it, nothing is sent and OPEN
+ * resets the buffer pointers afterwards.
+ */
+void w5500_spi_benchmark(void)
+{
+    static const uint16_t sizes[3] = {16, 256, 2048};
+    uint32_t wr_kbps[3], rd_kbps[3];
+    char buf[64];
+
+    for (int i = 0; i < 3; i++) {
+        uint32_t bytes = 0;
+        uint32_t start = HAL_GetTick();
+        while (HAL_GetTick() - start < 50) {
+            W5500_WRITE_TXBUF(7, 0, rx_tx_buf, sizes[i]);
+            bytes += sizes[i];
+        }
+        wr_kbps[i] = bytes / (HAL_GetTick() - start);  // bytes/ms == KB/s
+
+        bytes = 0;
+        start = HAL_GetTick();
+        while (HAL_GetTick() - start < 50) {
+            W5500_READ_RXBUF(7, 0, rx_tx_buf, sizes[i]);
+            bytes += sizes[i];
+        }
+        rd_kbps[i] = bytes / (HAL_GetTick() - start);
+    }
+
+    snprintf(buf, sizeof(buf), "SPI WR KB/s 16:%lu 256:%lu 2K:%lu",
+             wr_kbps[0], wr_kbps[1], wr_kbps[2]);
+    ili9341_draw_text(10, 290, buf, &font6x8, 0xFFFF, 0x0000);
+    snprintf(buf, sizeof(buf), "SPI RD KB/s 16:%lu 256:%lu 2K:%lu",
+             rd_kbps[0], rd_kbps[1], rd_kbps[2]);
+    ili9341_draw_text(10, 300, buf, &font6x8, 0xFFFF, 0x0000);
+}
+
+
 /* Display Update ------------------------------------------------------------*/
 /* USER CODE END 0 */
 
@@ -391,6 +907,7 @@ int main(void)
 	    SystemClock_Config();
 
 	    MX_GPIO_Init();
+	    MX_DMA_Init();
 	    MX_I2C1_Init();
 	    MX_SPI1_Init();
 	    MX_SPI2_Init();
@@ -414,56 +931,43 @@ int main(void)
 	        while(1);
 	    }
 
-	    // Set network info
-	    setnetinfo(&gWIZNETINFO);
+	    // No address until DHCP leases one (or falls back to gWIZNETINFO)
+	    wiz_NetInfo boot_info = gWIZNETINFO;
+	    memset(boot_info.ip, 0, 4);
+	    memset(boot_info.gw, 0, 4);
+	    setnetinfo(&boot_info);
+	    w5500_event_init();
 	    net_initialized = 1;
 
-	    //Additional
-	    mdns_init("stm32f411panel");
-	    // Початковий анонс
-		HAL_Delay(500);
-		mdns_process(); // Відкрити сокет
-		HAL_Delay(100);
+	    // All run from the main loop; mDNS waits for the address
+	    dhcp_init(&gWIZNETINFO, DEVICE_HOSTNAME, dhcp_assign_callback);
+	    mdns_init(DEVICE_HOSTNAME);
+	    ntp_init();
 
 	    w5500_diagnostic_test();
+	    w5500_spi_benchmark();
 	    HAL_Delay(2000);
 
-	    uint8_t sn = 0;
-	    int ret = socket(sn, 0x01, 80, 0);  // TCP, port 80
+	    // HTTP pool opens and listens asynchronously from the main loop
+	    websocket_init(ws_command);
+	    http_server_init(http_routes, sizeof(http_routes) / sizeof(http_routes[0]));
 
 	    char buf[50];
-	    if (ret == 0) {
-	        snprintf(buf, sizeof(buf), "Socket OPEN: SUCCESS");
-	        ili9341_draw_text(10, 250, buf, &font6x8, 0x07E0, 0x0000);
-
-	        // Check status
-	        uint8_t status = get_socket_status(sn);
-	        snprintf(buf, sizeof(buf), "Status: 0x%02X", status);
-	        ili9341_draw_text(10, 260, buf, &font6x8, 0xFFFF, 0x0000);
-	        // Should show 0x13 (INIT)
-	    } else {
-	        snprintf(buf, sizeof(buf), "Socket OPEN FAILED: %d", ret);
-	        ili9341_draw_text(10, 250, buf, &font6x8, 0xF800, 0x0000);
-	    }
-
-	    ret = listen_socket(sn);
-	    if (ret == 0) {
-	        snprintf(buf, sizeof(buf), "Socket LISTEN: SUCCESS");
-	        ili9341_draw_text(10, 270, buf, &font6x8, 0x07E0, 0x0000);
-
-	        uint8_t status = get_socket_status(sn);
-	        snprintf(buf, sizeof(buf), "Status: 0x%02X", status);
-	        ili9341_draw_text(10, 280, buf, &font6x8, 0xFFFF, 0x0000);
-	        // Should show 0x14 (LISTEN)
-	    } else {
-	        snprintf(buf, sizeof(buf), "Socket LISTEN FAILED: %d", ret);
-	        ili9341_draw_text(10, 270, buf, &font6x8, 0xF800, 0x0000);
-	    }
-
-	    // Init sensors
-	    bme280_init(&hi2c1);
+	    snprintf(buf, sizeof(buf), "HTTP: sockets %d-%d on :%d", HTTP_POOL_FIRST,
+	             HTTP_POOL_FIRST + HTTP_POOL_SIZE - 1, HTTP_PORT);
+	    ili9341_draw_text(10, 250, buf, &font6x8, 0x07E0, 0x0000);
+
+	    // Init sensors: scan I2C1, then set up every driver whose address answered
+	    i2c_bus_init(&hi2c1);
+	    sensors_register(&bme280_driver);
+	    sensors_register(&bh1750_driver);
+	    sensors_init();
+	    history_init();
 	    nmea_parser_init();
-	    HAL_UART_Receive_IT(&huart1, &gps_rx_byte, 1);
+	    nmea_set_baudrate(huart1.Init.BaudRate);
+	    gps_uart_start();
+	    // Moves the receiver to UBX NAV-PVT if it answers, else NMEA stays
+	    ubx_init(&huart1, gps_uart_set_baud);
 
 	    ili9341_draw_text(10, 70, "System Ready", &font6x8, 0x07E0, 0x0000);
 	    HAL_Delay(200);
@@ -473,25 +977,51 @@ int main(void)
 	            uint32_t now = HAL_GetTick();
 
 	            if(net_initialized) {
+	                w5500_event_process();
+	                socket_cmd_process();
+	                dhcp_process();
 	                http_server_process();
 	                mdns_process();
+	                ntp_process();
 	            }
 
-	            if(nmea_process()) {
+	            uint8_t fresh = 0;
+	            int gps_new = nmea_process();
+	            gps_new |= ubx_process();
+	            if(gps_new) {
 	                nmea_get_position(&gps_data);
 	                gps_last_update = now;
+	                fresh = 1;
+	            }
+
+	            // Sensor triggers and reads, queued on I2C1 and run by interrupt/DMA
+	            i2c_bus_process();
+	            if(sensors_process()) {
+	                env_last_update = now;
+	                fresh = 1;
+	            }
+
+	            // New sample or a reading went stale: update /events and /ws clients
+	            if(fresh || stale_flags(now) != events_stale) {
+	                events_stale = stale_flags(now);
+	                events_update(now);
+	                if(websocket_clients()) {
+	                    uint8_t rec[TELEMETRY_RECORD_LEN];
+	                    telemetry_record(rec, now);
+	                    websocket_publish(rec, sizeof(rec));
+	                }
 	            }
 
-	            if(now - env_last_update > 1000) {
-	                if(bme280_read(&bme_data)) env_last_update = now;
+	            // 1 s samples into the history rings (minute and hour rollups follow)
+	            if(now / 1000 != history_last_s) {
+	                history_last_s = now / 1000;
+	                history_sample(now);
 	            }
 
 	            if(now - display_last_update > 500) {
 	                display_update();
 	                display_last_update = now;
 	            }
-
-	            HAL_Delay(5);
 	        }
 }
 
@@ -1,305 +1,743 @@
-/* mdns.c  - minimal mDNS responder for W5500 + STM32
+/* mdns.c  - mDNS / DNS-SD responder for W5500 + STM32
  *
  * Usage:
  *   mdns_init("stm32f411panel");
- *   // call periodically:
+ *   // call from the main loop:
  *   mdns_process();
+ *   // after the IP address changed:
+ *   mdns_update_address();
  *
- * Notes:
- * - Adaptation for various W5500 driver variants: defines for Sn_MR_* provided here
- * - This responder answers A (type 1) queries for <hostname>.local with the device IP
+ * Advertises <host>.local (A) and the web panel as a DNS-SD service:
+ *   _services._dns-sd._udp.local  PTR  _http._tcp.local
+ *   _http._tcp.local              PTR  <host>._http._tcp.local
+ *   <host>._http._tcp.local       SRV  0 0 MDNS_SERVICE_PORT <host>.local
+ *   <host>._http._tcp.local       TXT  MDNS_SERVICE_TXT
+ *
+ * Follows RFC 6762 where it matters on a busy LAN: the names are probed
+ * (and renamed <host>-2, -3, ... on conflict) and announced before any
+ * query is answered; every question of a query is answered, answers the
+ * querier already lists with enough TTL left are suppressed, a record is
+ * multicast at most once per second, shared (PTR) answers are delayed
+ * 20-120 ms and aggregated, and names in responses are compressed.
+ * QU questions and legacy (port != 5353) queries get a unicast reply.
+ *
+ * Most traffic on the group is not for us, so incoming names are never
+ * decoded: a case-folded hash is taken over the wire labels and compared
+ * with the hashes of our names, and only a hash hit is checked label by
+ * label. Records are encoded once (at init, on rename and on address
+ * change); a response only copies them and links the names.
+ *
+ * Not implemented: simultaneous-probe tie-breaking, waiting for the rest
+ * of a truncated (TC) known-answer list, NSEC negative answers, goodbyes.
  */
 
 #include "mdns.h"
 #include "socket.h"
 #include "w5500.h"
+#include "w5500_event.h"
 #include "wizchip_conf.h"
 #include <string.h>
 #include <stdio.h>
-#include <ctype.h>
-
-#ifndef Sn_MR_TCP
-#define Sn_MR_CLOSE   0x00
-#define Sn_MR_TCP     0x01
-#define Sn_MR_UDP     0x02
-#define Sn_MR_MACRAW  0x04
-#define Sn_MR_UCASTB  0x10
-#define Sn_MR_ND      0x20
-#define Sn_MR_MULTI   0x80
-#endif
-
-static char device_hostname[32] = "stm32-panel";
+
+#define MDNS_MAX_PACKET     1024    // Larger datagrams are read truncated
+
+#define DNS_TYPE_A      1
+#define DNS_TYPE_PTR    12
+#define DNS_TYPE_TXT    16
+#define DNS_TYPE_SRV    33
+#define DNS_TYPE_ANY    255
+#define DNS_CLASS_IN    1
+#define DNS_CLASS_ANY   255
+
+#define PROBE_COUNT         3
+#define PROBE_INTERVAL_MS   250
+#define ANNOUNCE_COUNT      2
+#define ANNOUNCE_INTERVAL_MS 1000
+#define RATE_LIMIT_MS       1000    // Same record multicast at most this often
+#define LEGACY_TTL          10      // TTL cap for legacy unicast answers
+
+#define FNV_OFFSET      2166136261u
+#define FNV_PRIME       16777619u
+
+enum {
+    MDNS_ST_CLOSED = 0,     // Socket to be (re)opened
+    MDNS_ST_OPENING,        // OPEN in flight
+    MDNS_ST_PROBING,
+    MDNS_ST_ANNOUNCING,
+    MDNS_ST_RUNNING
+};
+
+/* Records we answer for, also bit numbers in answer masks */
+enum {
+    REC_A = 0,      // host A ip
+    REC_SRV,        // instance SRV host
+    REC_TXT,        // instance TXT
+    REC_PTR,        // service PTR instance
+    REC_ENUM,       // _services._dns-sd._udp PTR service
+    REC_COUNT
+};
+
+#define REC_ALL         ((1 << REC_COUNT) - 1)
+#define REC_UNIQUE      ((1 << REC_A) | (1 << REC_SRV) | (1 << REC_TXT))
+
+/* Our names as chains of labels sharing their suffixes */
+enum {
+    N_LOCAL = 0,    // local
+    N_TCP,          // _tcp.local
+    N_UDP,          // _udp.local
+    N_SVC,          // _http._tcp.local
+    N_DNSSD,        // _dns-sd._udp.local
+    N_ENUM,         // _services._dns-sd._udp.local
+    N_HOST,         // <host>.local
+    N_INST,         // <host>._http._tcp.local
+    N_COUNT,
+    N_NONE = 0xFF
+};
+
+typedef struct {
+    uint8_t  label[64];     // Length byte + label
+    uint8_t  next;          // Node of the parent name, N_NONE after "local"
+    uint32_t hash;          // name_hash() of the whole name from here
+} mdns_node_t;
+
+/* Record encoded in wire format except for the names */
+typedef struct {
+    uint8_t  owner;         // Node of the owner name
+    uint8_t  target;        // Node ending the rdata (PTR, SRV target), N_NONE otherwise
+    uint16_t type;
+    uint32_t ttl;
+    uint8_t  head[8];       // TYPE, CLASS (with cache-flush for unique records), TTL
+    uint8_t  rdata[32];     // rdata before target: A address, SRV prio/weight/port, TXT strings
+    uint8_t  rdata_len;
+} mdns_record_t;
+
+typedef struct {
+    uint8_t* buf;
+    uint16_t len;
+    uint16_t size;
+    uint8_t  overflow;
+    uint16_t node_off[N_COUNT]; // Where each name was written, 0 = not yet
+} mdns_msg_t;
+
+static const uint8_t mc_ip[4] = {224, 0, 0, 251};
+static const uint8_t mc_mac[6] = {0x01, 0x00, 0x5E, 0x00, 0x00, 0xFB};
+
+static char base_hostname[32] = "stm32-panel";
+static char device_hostname[40];
 static uint8_t my_ip[4] = {0,0,0,0};
 
-/* helper: case-insensitive compare */
-static int my_strcasecmp(const char *s1, const char *s2) {
-    while (*s1 && *s2) {
-        int diff = tolower((unsigned char)*s1) - tolower((unsigned char)*s2);
-        if (diff != 0) return diff;
-        s1++;
-        s2++;
-    }
-    return tolower((unsigned char)*s1) - tolower((unsigned char)*s2);
-}
-
-/* Encode "label.label.local" into DNS wire-format into buf, returns bytes written */
-static uint16_t encode_dns_name(uint8_t* buf, const char* name) {
-    uint16_t pos = 0;
-    const char* start = name;
-    const char* p = name;
-    while (*p) {
-        if (*p == '.') {
-            uint8_t len = p - start;
-            if (len > 0 && len < 64) {
-                buf[pos++] = len;
-                memcpy(&buf[pos], start, len);
-                pos += len;
-            }
-            start = p + 1;
+static mdns_node_t nodes[N_COUNT];
+static mdns_record_t records[REC_COUNT];
+static uint32_t last_multicast[REC_COUNT];
+
+static volatile uint8_t mdns_pending = 1;
+static uint8_t mdns_state = MDNS_ST_CLOSED;
+static uint8_t mdns_step_count = 0;     // Probes / announcements sent
+static uint8_t mdns_conflicts = 0;
+static uint32_t mdns_next_ms = 0;       // Next probe / announcement
+static uint8_t delayed_answers = 0;     // Aggregated multicast response
+static uint8_t delayed_additionals = 0;
+static uint32_t delayed_ms = 0;
+static uint32_t rand_state = 1;
+static uint8_t dest_unicast = 0;        // Sn_DIPR holds a unicast peer, restore the group after SENDOK
+
+static uint8_t pkt[MDNS_MAX_PACKET];    // Received datagram, then the response
+
+static void mdns_socket_event(uint8_t sn, uint8_t events) {
+    (void)sn; (void)events;
+    mdns_pending = 1;
+}
+
+static uint8_t lower(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+static uint32_t hash_step(uint32_t h, uint8_t c) {
+    return (h ^ lower(c)) * FNV_PRIME;
+}
+
+static uint32_t random_ms(uint32_t min, uint32_t max) {
+    rand_state = rand_state * 1103515245u + 12345u;
+    return min + (rand_state >> 16) % (max - min + 1);
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static void set16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+static void set32(uint8_t* p, uint32_t v) {
+    set16(p, v >> 16);
+    set16(p + 2, v & 0xFFFF);
+}
+
+/* --- Names in received messages --- */
+
+/* Hash of the (possibly compressed) name at pos over its wire form with
+   ASCII case folded: length bytes, label bytes and the final zero.
+   Returns the position after the name, 0 if it is malformed. */
+static uint16_t name_hash(const uint8_t* p, uint16_t len, uint16_t pos, uint32_t* hash) {
+    uint32_t h = FNV_OFFSET;
+    uint16_t end = 0;
+    uint8_t jumps = 0;
+
+    while (pos < len) {
+        uint8_t l = p[pos++];
+        if ((l & 0xC0) == 0xC0) {
+            if (pos >= len || ++jumps > 16) return 0;
+            if (!end) end = pos + 1;
+            pos = ((l & 0x3F) << 8) | p[pos];
+            continue;
         }
-        p++;
-    }
-    uint8_t len = p - start;
-    if (len > 0 && len < 64) {
-        buf[pos++] = len;
-        memcpy(&buf[pos], start, len);
-        pos += len;
+        if (l & 0xC0) return 0;
+        h = hash_step(h, l);
+        if (l == 0) {
+            *hash = h;
+            return end ? end : pos;
+        }
+        if (pos + l > len) return 0;
+        for (uint8_t i = 0; i < l; i++) h = hash_step(h, p[pos + i]);
+        pos += l;
     }
-    buf[pos++] = 0;
-    return pos;
-}
-
-/* parse DNS name (supports pointers) */
-static uint16_t parse_dns_name(const uint8_t* packet, uint16_t packet_len,
-                               uint16_t pos, char* name, uint16_t name_max) {
-    uint16_t name_pos = 0;
-    int jumps = 0;
-    uint16_t return_pos = 0;
-
-    while (pos < packet_len && jumps < 20) {
-        uint8_t len = packet[pos++];
-        if (len == 0) break;
-
-        /* pointer */
-        if ((len & 0xC0) == 0xC0) {
-            if (pos >= packet_len) break;
-            uint16_t off = ((len & 0x3F) << 8) | packet[pos++];
-            if (return_pos == 0) return_pos = pos;
-            pos = off;
-            jumps++;
+    return 0;
+}
+
+/* Whether the name at pos (already walked by name_hash) is node n */
+static int name_equals(const uint8_t* p, uint16_t len, uint16_t pos, uint8_t n) {
+    while (pos < len) {
+        uint8_t l = p[pos++];
+        if ((l & 0xC0) == 0xC0) {
+            pos = ((l & 0x3F) << 8) | p[pos];
             continue;
         }
-
-        if (pos + len > packet_len) break;
-        if (name_pos != 0 && name_pos < name_max - 1) {
-            name[name_pos++] = '.';
+        if (n == N_NONE) return l == 0;
+        const uint8_t* label = nodes[n].label;
+        if (l != label[0]) return 0;
+        for (uint8_t i = 0; i < l; i++) {
+            if (lower(p[pos + i]) != lower(label[1 + i])) return 0;
         }
-        for (int i = 0; i < len && name_pos < name_max - 1; ++i) {
-            name[name_pos++] = packet[pos++];
+        pos += l;
+        n = nodes[n].next;
+    }
+    return 0;
+}
+
+/* Records whose owner name is at pos and type matches (ANY matches all) */
+static uint8_t match_records(const uint8_t* p, uint16_t len, uint16_t pos,
+                             uint32_t hash, uint16_t type) {
+    uint8_t mask = 0;
+    uint8_t checked = N_NONE;
+    for (uint8_t r = 0; r < REC_COUNT; r++) {
+        const mdns_record_t* rec = &records[r];
+        if ((type != rec->type && type != DNS_TYPE_ANY) || nodes[rec->owner].hash != hash) continue;
+        if (checked != rec->owner) {
+            if (!name_equals(p, len, pos, rec->owner)) continue;
+            checked = rec->owner;
         }
+        mask |= 1 << r;
     }
-    name[name_pos] = '\0';
-    return (return_pos != 0) ? return_pos : pos;
+    return mask;
 }
 
-/* Compose and send A-record response. If dest_ip is multicast (224.0.0.251) it will be sent to multicast.
-   dest_ip and dest_port are used to program Sn_DIPR0/Sn_DPORT0 before send_socket. */
-static void send_dns_response(uint8_t sn, const uint8_t* dest_ip, uint16_t dest_port,
-                              const uint8_t* query_packet, uint16_t query_len) {
-    uint8_t resp[340];
-    uint16_t pos = 0;
+/* Whether the rdata at p[pos] (rdlen bytes) equals our record r */
+static int rdata_equals(const uint8_t* p, uint16_t len, uint16_t pos, uint16_t rdlen, uint8_t r) {
+    const mdns_record_t* rec = &records[r];
+    uint32_t h;
 
-    /* Transaction ID: copy from query (first 2 bytes) - for mDNS typically 0x0000 but safe to copy */
-    if (query_len >= 2) {
-        resp[pos++] = query_packet[0];
-        resp[pos++] = query_packet[1];
-    } else {
-        resp[pos++] = 0x00;
-        resp[pos++] = 0x00;
+    if (rec->target == N_NONE) {
+        return rdlen == rec->rdata_len && memcmp(p + pos, rec->rdata, rdlen) == 0;
     }
+    if (rdlen <= rec->rdata_len || memcmp(p + pos, rec->rdata, rec->rdata_len) != 0) return 0;
+    pos += rec->rdata_len;
+    return name_hash(p, len, pos, &h) && h == nodes[rec->target].hash &&
+           name_equals(p, len, pos, rec->target);
+}
 
-    /* Flags: Response. For mDNS we set 0x8400 (Authoritative) - but many queries use 0x0000; 0x8400 is OK */
-    if (dest_port == 5353) {
-        resp[pos++] = 0x84;
-        resp[pos++] = 0x00;
+/* --- Names and records --- */
+
+static void set_node(uint8_t n, const char* label, uint8_t next) {
+    uint8_t l = strlen(label);
+    if (l > 63) l = 63;
+    nodes[n].label[0] = l;
+    memcpy(nodes[n].label + 1, label, l);
+    nodes[n].next = next;
+}
+
+static void set_record(uint8_t r, uint8_t owner, uint16_t type, uint32_t ttl, uint8_t target) {
+    mdns_record_t* rec = &records[r];
+    rec->owner = owner;
+    rec->target = target;
+    rec->type = type;
+    rec->ttl = ttl;
+    set16(rec->head, type);
+    set16(rec->head + 2, DNS_CLASS_IN | (((REC_UNIQUE >> r) & 1) ? 0x8000 : 0));
+    set32(rec->head + 4, ttl);
+    rec->rdata_len = 0;
+}
+
+/* Encode names and records for the current host label */
+static void build_records(void) {
+    if (mdns_conflicts == 0) {
+        snprintf(device_hostname, sizeof(device_hostname), "%s", base_hostname);
     } else {
-        resp[pos++] = 0x80;
-        resp[pos++] = 0x00;
+        snprintf(device_hostname, sizeof(device_hostname), "%s-%u", base_hostname,
+                 (unsigned)(mdns_conflicts + 1));
     }
 
-    /* QDCOUNT = 0, ANCOUNT = 1, NSCOUNT = 0, ARCOUNT = 0 */
-    resp[pos++] = 0x00; resp[pos++] = 0x00;
-    resp[pos++] = 0x00; resp[pos++] = 0x01;
-    resp[pos++] = 0x00; resp[pos++] = 0x00;
-    resp[pos++] = 0x00; resp[pos++] = 0x00;
+    set_node(N_LOCAL, "local", N_NONE);
+    set_node(N_TCP,   "_tcp", N_LOCAL);
+    set_node(N_UDP,   "_udp", N_LOCAL);
+    set_node(N_SVC,   "_http", N_TCP);
+    set_node(N_DNSSD, "_dns-sd", N_UDP);
+    set_node(N_ENUM,  "_services", N_DNSSD);
+    set_node(N_HOST,  device_hostname, N_LOCAL);
+    set_node(N_INST,  device_hostname, N_SVC);
+
+    for (uint8_t n = 0; n < N_COUNT; n++) {
+        uint32_t h = FNV_OFFSET;
+        for (uint8_t k = n; k != N_NONE; k = nodes[k].next) {
+            for (uint8_t i = 0; i <= nodes[k].label[0]; i++) h = hash_step(h, nodes[k].label[i]);
+        }
+        nodes[n].hash = hash_step(h, 0);
+    }
 
-    /* Name: <hostname>.local */
-    char fullname[64];
-    if (dest_port == 5353) {
-        snprintf(fullname, sizeof(fullname), "%s.local", device_hostname);
-    } else {
-        snprintf(fullname, sizeof(fullname), "%s", device_hostname);
+    set_record(REC_A,    N_HOST, DNS_TYPE_A,   MDNS_TTL_HOST,  N_NONE);
+    set_record(REC_SRV,  N_INST, DNS_TYPE_SRV, MDNS_TTL_HOST,  N_HOST);
+    set_record(REC_TXT,  N_INST, DNS_TYPE_TXT, MDNS_TTL_OTHER, N_NONE);
+    set_record(REC_PTR,  N_SVC,  DNS_TYPE_PTR, MDNS_TTL_OTHER, N_INST);
+    set_record(REC_ENUM, N_ENUM, DNS_TYPE_PTR, MDNS_TTL_OTHER, N_SVC);
+
+    memcpy(records[REC_A].rdata, my_ip, 4);
+    records[REC_A].rdata_len = 4;
+
+    uint8_t* srv = records[REC_SRV].rdata;
+    set16(srv, 0);      // Priority
+    set16(srv + 2, 0);  // Weight
+    set16(srv + 4, MDNS_SERVICE_PORT);
+    records[REC_SRV].rdata_len = 6;
+
+    uint8_t txt_len = strlen(MDNS_SERVICE_TXT);
+    if (txt_len > sizeof(records[REC_TXT].rdata) - 1) txt_len = sizeof(records[REC_TXT].rdata) - 1;
+    records[REC_TXT].rdata[0] = txt_len;
+    memcpy(records[REC_TXT].rdata + 1, MDNS_SERVICE_TXT, txt_len);
+    records[REC_TXT].rdata_len = txt_len + 1;
+}
+
+static void start_probing(uint32_t now) {
+    build_records();
+    mdns_state = MDNS_ST_PROBING;
+    mdns_step_count = 0;
+    mdns_next_ms = now + random_ms(0, PROBE_INTERVAL_MS);
+    delayed_answers = delayed_additionals = 0;
+}
+
+/* --- Response building --- */
+
+static void put_bytes(mdns_msg_t* m, const void* data, uint16_t len) {
+    if (m->len + len > m->size) {
+        m->overflow = 1;
+        return;
     }
-    pos += encode_dns_name(&resp[pos], fullname);
+    memcpy(m->buf + m->len, data, len);
+    m->len += len;
+}
 
-    /* Type A (0x0001) */
-    resp[pos++] = 0x00;
-    resp[pos++] = 0x01;
+static void put16(mdns_msg_t* m, uint16_t v) {
+    uint8_t b[2] = { v >> 8, v & 0xFF };
+    put_bytes(m, b, 2);
+}
 
-    /* Class IN (0x0001) with cache-flush (0x8001) for mDNS */
-    if (dest_port == 5353) {
-        resp[pos++] = 0x80;
-        resp[pos++] = 0x01;
-    } else {
-        resp[pos++] = 0x00;
-        resp[pos++] = 0x01;
+/* Write name n, pointing at the longest suffix already in the message */
+static void put_name(mdns_msg_t* m, uint8_t n) {
+    for (; n != N_NONE; n = nodes[n].next) {
+        if (m->node_off[n]) {
+            put16(m, 0xC000 | m->node_off[n]);
+            return;
+        }
+        if (m->len < 0x3FFF) m->node_off[n] = m->len;
+        put_bytes(m, nodes[n].label, nodes[n].label[0] + 1);
     }
+    uint8_t zero = 0;
+    put_bytes(m, &zero, 1);
+}
+
+/* flush: keep cache-flush on unique records; ttl_max caps the TTL (legacy unicast) */
+static void put_record(mdns_msg_t* m, uint8_t r, uint8_t flush, uint32_t ttl_max) {
+    const mdns_record_t* rec = &records[r];
+
+    put_name(m, rec->owner);
+    uint16_t head_pos = m->len;
+    put_bytes(m, rec->head, sizeof(rec->head));
+    put16(m, 0);  // RDLENGTH, patched below
+    put_bytes(m, rec->rdata, rec->rdata_len);
+    if (rec->target != N_NONE) put_name(m, rec->target);
+    if (m->overflow) return;
+
+    uint8_t* head = m->buf + head_pos;
+    if (!flush) head[2] &= 0x7F;
+    if (rec->ttl > ttl_max) set32(head + 4, ttl_max);
+    set16(head + 8, m->len - head_pos - 10);
+}
+
+static void msg_init(mdns_msg_t* m, uint16_t id, uint16_t flags) {
+    m->buf = pkt;
+    m->size = sizeof(pkt);
+    m->overflow = 0;
+    memset(m->node_off, 0, sizeof(m->node_off));
+    memset(pkt, 0, 12);
+    set16(pkt, id);
+    set16(pkt + 2, flags);
+    m->len = 12;
+}
 
-    /* TTL 120s */
-    resp[pos++] = 0x00;
-    resp[pos++] = 0x00;
-    resp[pos++] = 0x00;
-    resp[pos++] = 0x78;
+static void msg_counts(mdns_msg_t* m, uint16_t qd, uint16_t an, uint16_t ns, uint16_t ar) {
+    set16(m->buf + 4, qd);
+    set16(m->buf + 6, an);
+    set16(m->buf + 8, ns);
+    set16(m->buf + 10, ar);
+}
 
-    /* RDLENGTH = 4 */
-    resp[pos++] = 0x00;
-    resp[pos++] = 0x04;
+/* Destination for the next SEND: Sn_DIPR0..3 and Sn_DPORT0..1 are adjacent */
+static void set_dest(const uint8_t* ip, uint16_t port) {
+    uint8_t d[6] = { ip[0], ip[1], ip[2], ip[3], port >> 8, port & 0xFF };
+    W5500_WRITE_BUF(W5500_Sn_DIPR0(MDNS_SOCKET), d, sizeof(d));
+}
+
+/* The chip reads Sn_DIPR/Sn_DPORT until SENDOK or TIMEOUT, so the previous
+   datagram has to be out before they change (send_socket() would only wait
+   after the new destination is written) */
+static void msg_send(mdns_msg_t* m, const uint8_t* ip, uint16_t port) {
+    if (m->overflow) return;
+    socket_send_wait(MDNS_SOCKET, 1);
+    set_dest(ip, port);
+    send_socket(MDNS_SOCKET, m->buf, m->len);
+    dest_unicast = (ip != mc_ip);
+}
+
+/* Back to the group address once a unicast reply is out, so that the
+   IGMP leave on CLOSE goes to the group */
+static void restore_dest(void) {
+    if (!dest_unicast || socket_send_wait(MDNS_SOCKET, 0) > 0) return;
+    set_dest(mc_ip, MDNS_PORT);
+    dest_unicast = 0;
+}
+
+static uint8_t count_bits(uint8_t mask) {
+    uint8_t n = 0;
+    for (; mask; mask &= mask - 1) n++;
+    return n;
+}
 
-    /* RDATA = my_ip */
-    memcpy(&resp[pos], my_ip, 4);
-    pos += 4;
+/* Multicast answers (and additionals) from one message */
+static void send_multicast(uint8_t answers, uint8_t additionals) {
+    mdns_msg_t m;
+    uint32_t now = HAL_GetTick();
 
-    /* Program destination IP/port registers for the socket (Sn_DIPR0 / Sn_DPORT0) */
-    for (int i = 0; i < 4; ++i) {
-        W5500_WRITE_REG(W5500_Sn_DIPR0(sn) + i, dest_ip[i]);
+    msg_init(&m, 0, 0x8400);
+    for (uint8_t r = 0; r < REC_COUNT; r++) {
+        if ((answers >> r) & 1) {
+            put_record(&m, r, 1, 0xFFFFFFFF);
+            last_multicast[r] = now;
+        }
+    }
+    for (uint8_t r = 0; r < REC_COUNT; r++) {
+        if ((additionals >> r) & 1) put_record(&m, r, 1, 0xFFFFFFFF);
+    }
+    msg_counts(&m, 0, count_bits(answers), 0, count_bits(additionals));
+    msg_send(&m, mc_ip, MDNS_PORT);
+}
+
+static void put_question(mdns_msg_t* m, uint8_t n, uint16_t type, uint16_t cls) {
+    put_name(m, n);
+    put16(m, type);
+    put16(m, cls);
+}
+
+/* Probe for our unique names: ANY questions plus the proposed records as authority */
+static void send_probe(uint8_t first) {
+    mdns_msg_t m;
+    uint16_t qu = first ? 0x8000 : 0;
+
+    msg_init(&m, 0, 0x0000);
+    put_question(&m, N_HOST, DNS_TYPE_ANY, DNS_CLASS_IN | qu);
+    put_question(&m, N_INST, DNS_TYPE_ANY, DNS_CLASS_IN | qu);
+    put_record(&m, REC_A, 0, 0xFFFFFFFF);
+    put_record(&m, REC_SRV, 0, 0xFFFFFFFF);
+    put_record(&m, REC_TXT, 0, 0xFFFFFFFF);
+    msg_counts(&m, 2, 0, 3, 0);
+    msg_send(&m, mc_ip, MDNS_PORT);
+}
+
+/* --- Query handling --- */
+
+/* Another host's response: a different record under one of our unique names is a conflict */
+static void handle_response(const uint8_t* p, uint16_t len) {
+    uint16_t qd = get16(p + 4);
+    uint16_t rr = get16(p + 6) + get16(p + 8) + get16(p + 10);
+    uint16_t pos = 12;
+    uint32_t hash;
+
+    for (uint16_t i = 0; i < qd; i++) {
+        pos = name_hash(p, len, pos, &hash);
+        if (!pos || pos + 4 > len) return;
+        pos += 4;
     }
-    W5500_WRITE_REG(W5500_Sn_DPORT0(sn), (uint8_t)((dest_port >> 8) & 0xFF));
-    W5500_WRITE_REG(W5500_Sn_DPORT0(sn) + 1, (uint8_t)(dest_port & 0xFF));
 
-    /* Send */
-    send_socket(sn, resp, pos);
+    for (uint16_t i = 0; i < rr; i++) {
+        uint16_t name_pos = pos;
+        pos = name_hash(p, len, pos, &hash);
+        if (!pos || pos + 10 > len) return;
+        uint16_t type = get16(p + pos);
+        uint16_t rdlen = get16(p + pos + 8);
+        pos += 10;
+        if (pos + rdlen > len) return;
+
+        uint8_t mine = match_records(p, len, name_pos, hash, type) & REC_UNIQUE;
+        for (uint8_t r = 0; r < REC_COUNT; r++) {
+            if (((mine >> r) & 1) && !rdata_equals(p, len, pos, rdlen, r)) {
+                // Name taken: pick the next one and probe again
+                mdns_conflicts++;
+                start_probing(HAL_GetTick());
+                return;
+            }
+        }
+        pos += rdlen;
+    }
+}
+
+static void handle_query(const uint8_t* p, uint16_t len, const uint8_t* src_ip, uint16_t src_port) {
+    uint16_t qd = get16(p + 4);
+    uint16_t an = get16(p + 6);
+    uint16_t pos = 12;
+    uint8_t answers = 0, unicast = 0;
+    uint8_t legacy = (src_port != MDNS_PORT);
+    uint8_t first_q = 0;    // Answers to the first question, echoed in legacy replies
+    uint16_t first_type = 0, first_cls = 0;
+    uint32_t hash;
+
+    // Questions
+    for (uint16_t i = 0; i < qd; i++) {
+        uint16_t name_pos = pos;
+        pos = name_hash(p, len, pos, &hash);
+        if (!pos || pos + 4 > len) return;
+        uint16_t type = get16(p + pos);
+        uint16_t cls = get16(p + pos + 2);
+        pos += 4;
+
+        if ((cls & 0x7FFF) != DNS_CLASS_IN && (cls & 0x7FFF) != DNS_CLASS_ANY) continue;
+        uint8_t mask = match_records(p, len, name_pos, hash, type);
+        if (i == 0) {
+            first_q = mask;
+            first_type = type;
+            first_cls = cls & 0x7FFF;
+        }
+        answers |= mask;
+        if (cls & 0x8000) unicast |= mask;
+    }
+    if (!answers) return;
+
+    // Known answers the querier already has with at least half the TTL left
+    for (uint16_t i = 0; i < an; i++) {
+        uint16_t name_pos = pos;
+        pos = name_hash(p, len, pos, &hash);
+        if (!pos || pos + 10 > len) break;
+        uint16_t type = get16(p + pos);
+        uint32_t ttl = ((uint32_t)get16(p + pos + 4) << 16) | get16(p + pos + 6);
+        uint16_t rdlen = get16(p + pos + 8);
+        pos += 10;
+        if (pos + rdlen > len) break;
+
+        uint8_t mask = match_records(p, len, name_pos, hash, type) & answers;
+        for (uint8_t r = 0; r < REC_COUNT; r++) {
+            if (((mask >> r) & 1) && ttl >= records[r].ttl / 2 &&
+                rdata_equals(p, len, pos, rdlen, r)) {
+                answers &= ~(1 << r);
+            }
+        }
+        pos += rdlen;
+    }
+    if (!answers) return;
+
+    // DNS-SD additionals: the instance behind a PTR, the address behind a SRV
+    uint8_t additionals = 0;
+    if (answers & (1 << REC_PTR)) additionals |= (1 << REC_SRV) | (1 << REC_TXT) | (1 << REC_A);
+    if (answers & (1 << REC_SRV)) additionals |= (1 << REC_A);
+    additionals &= ~answers;
+
+    if (legacy || unicast == answers) {
+        // Direct reply; legacy resolvers need the ID, the question and short TTLs
+        mdns_msg_t m;
+        uint16_t qd_out = 0;
+        msg_init(&m, legacy ? get16(p) : 0, 0x8400);
+        if (legacy && first_q) {
+            // The question matched one of our names, so that name can stand in for it
+            for (uint8_t r = 0; r < REC_COUNT; r++) {
+                if ((first_q >> r) & 1) {
+                    put_question(&m, records[r].owner, first_type, first_cls);
+                    qd_out = 1;
+                    break;
+                }
+            }
+        }
+        uint32_t ttl_max = legacy ? LEGACY_TTL : 0xFFFFFFFF;
+        for (uint8_t r = 0; r < REC_COUNT; r++) {
+            if ((answers >> r) & 1) put_record(&m, r, !legacy, ttl_max);
+        }
+        for (uint8_t r = 0; r < REC_COUNT; r++) {
+            if ((additionals >> r) & 1) put_record(&m, r, !legacy, ttl_max);
+        }
+        msg_counts(&m, qd_out, count_bits(answers), 0, count_bits(additionals));
+        msg_send(&m, src_ip, src_port);
+        return;
+    }
+
+    // Multicast: at most once a second per record
+    uint32_t now = HAL_GetTick();
+    for (uint8_t r = 0; r < REC_COUNT; r++) {
+        if (((answers >> r) & 1) && last_multicast[r] && now - last_multicast[r] < RATE_LIMIT_MS) {
+            answers &= ~(1 << r);
+        }
+    }
+    if (!answers) return;
+
+    // Unique answers go out now, shared ones after 20-120 ms so that other
+    // responders' answers can suppress ours; both aggregate into one packet
+    uint32_t due = (answers & ~REC_UNIQUE) ? now + random_ms(20, 120) : now;
+    if (!(delayed_answers | delayed_additionals) || (int32_t)(due - delayed_ms) < 0) delayed_ms = due;
+    delayed_answers |= answers;
+    delayed_additionals |= additionals;
+}
+
+/* Read every queued datagram: W5500 UDP RX holds [ip:4][port:2][len:2][data] */
+static void receive(void) {
+    uint8_t sn = MDNS_SOCKET;
+
+    while (get_socket_rx_size(sn) >= 8) {
+        uint8_t hdr[8];
+        if (recv_socket(sn, hdr, sizeof(hdr)) != sizeof(hdr)) return;
+
+        uint16_t dlen = get16(hdr + 6);
+        uint16_t n = dlen < sizeof(pkt) ? dlen : sizeof(pkt);
+        int got = recv_socket(sn, pkt, n);
+        if (got < 0) return;
+        if (dlen > got) consume_socket(sn, dlen - got);  // Keep datagram boundaries
+
+        if (got < 12) continue;
+        uint16_t flags = get16(pkt + 2);
+        if (flags & 0x7800) continue;  // Opcode must be QUERY
+
+        if (flags & 0x8000) {
+            if (mdns_state > MDNS_ST_OPENING) handle_response(pkt, got);
+        } else if (mdns_state == MDNS_ST_RUNNING || mdns_state == MDNS_ST_ANNOUNCING) {
+            handle_query(pkt, got, hdr, get16(hdr + 4));
+        }
+    }
 }
 
 /* Initialize mdns responder */
 void mdns_init(const char* hostname) {
     if (hostname && hostname[0]) {
         int j = 0;
-        for (int i = 0; hostname[i] && j < (int)(sizeof(device_hostname)-1); ++i) {
+        for (int i = 0; hostname[i] && j < (int)(sizeof(base_hostname)-1); ++i) {
             if (hostname[i] != '.' && hostname[i] != ' ')
-                device_hostname[j++] = hostname[i];
+                base_hostname[j++] = hostname[i];
         }
-        device_hostname[j] = '\0';
+        base_hostname[j] = '\0';
     }
 
     /* read IP */
     wiz_NetInfo net;
     wizchip_getnetinfo(&net);
     memcpy(my_ip, net.ip, 4);
+    rand_state = net.mac[3] << 16 | net.mac[4] << 8 | net.mac[5];
 
-    /* ensure socket closed then open in UDP+MULTI mode bound to 5353 */
-    uint8_t sn = MDNS_SOCKET;
-    close_socket(sn);
-    HAL_Delay(5);
-
-    /* Open socket: UDP with MULTI bit */
-    socket(sn, Sn_MR_UDP | Sn_MR_MULTI, 5353, 0);
-    HAL_Delay(5);
-
-    /* Set multicast destination registers so chip accepts multicast for this socket
-       Multicast IPv4 mDNS address: 224.0.0.251
-       Multicast MAC: 01:00:5E:00:00:FB
-    */
-    uint8_t mc_ip[4] = {224,0,0,251};
-    uint8_t mc_mac[6] = {0x01,0x00,0x5E,0x00,0x00,0xFB};
-
-    /* Some W5500 variants require writing Sn_DHAR0 (destination MAC) + Sn_DIPR0 before listen */
-    for (int i = 0; i < 6; ++i) {
-        W5500_WRITE_REG(W5500_Sn_DHAR0(sn) + i, mc_mac[i]);
-    }
-    for (int i = 0; i < 4; ++i) {
-        W5500_WRITE_REG(W5500_Sn_DIPR0(sn) + i, mc_ip[i]);
-    }
+    mdns_conflicts = 0;
+    build_records();
+    mdns_state = MDNS_ST_CLOSED;
+
+    /* Wake mdns_process() only when a datagram arrives */
+    w5500_event_register(MDNS_SOCKET, W5500_Sn_IR_RECV, mdns_socket_event);
+    mdns_pending = 1;
+}
 
-    /* Listen on socket (starts receiving) */
-    listen_socket(sn);
+void mdns_update_address(void) {
+    wiz_NetInfo net;
+    wizchip_getnetinfo(&net);
+    if (memcmp(my_ip, net.ip, 4) == 0) return;
+
+    memcpy(my_ip, net.ip, 4);
+    memcpy(records[REC_A].rdata, my_ip, 4);
+
+    /* Tell caches about the new address; while probing it goes out with the
+       announcements, before the first address the socket is not open yet */
+    if (mdns_state == MDNS_ST_RUNNING || mdns_state == MDNS_ST_ANNOUNCING) {
+        mdns_state = MDNS_ST_ANNOUNCING;
+        mdns_step_count = 0;
+        mdns_next_ms = HAL_GetTick();
+        memset(last_multicast, 0, sizeof(last_multicast));
+    }
+}
 
-    /* Optional: small delay then basic announcement could be sent from here if desired */
+const char* mdns_hostname(void) {
+    return device_hostname;
 }
 
-/* Call periodically from main loop */
+/* Call from main loop */
 void mdns_process(void) {
+    uint32_t now = HAL_GetTick();
+    uint8_t timer_due = (mdns_state != MDNS_ST_RUNNING) || dest_unicast ||
+                        ((delayed_answers || delayed_additionals) && (int32_t)(now - delayed_ms) >= 0);
+    if (!mdns_pending && !timer_due) return;
+    mdns_pending = 0;
+
+    // Nothing to announce before DHCP (or the fallback) set an address
+    if ((my_ip[0] | my_ip[1] | my_ip[2] | my_ip[3]) == 0) return;
+
     uint8_t sn = MDNS_SOCKET;
-    uint8_t status = get_socket_status(sn);
-
-    /* If socket not ready, try reopen */
-    if (status != W5500_SR_SOCK_UDP && status != W5500_SR_SOCK_ESTABLISHED && status != W5500_SR_SOCK_CLOSE_WAIT && status != W5500_SR_SOCK_INIT && status != W5500_SR_SOCK_LISTEN) {
-        close_socket(sn);
-        HAL_Delay(5);
-        socket(sn, Sn_MR_UDP | Sn_MR_MULTI, 5353, 0);
-        HAL_Delay(5);
-        listen_socket(sn);
+    if (get_socket_status(sn) != W5500_SR_SOCK_UDP) {
+        if (mdns_state != MDNS_ST_OPENING) {
+            /* Group address, port and MAC must be in place before OPEN joins the group */
+            uint8_t d[6] = { mc_ip[0], mc_ip[1], mc_ip[2], mc_ip[3], MDNS_PORT >> 8, MDNS_PORT & 0xFF };
+            W5500_WRITE_BUF(W5500_Sn_DHAR0(sn), mc_mac, sizeof(mc_mac));
+            W5500_WRITE_BUF(W5500_Sn_DIPR0(sn), d, sizeof(d));
+            dest_unicast = 0;
+        }
+        mdns_state = MDNS_ST_OPENING;
+        /* CLOSE + OPEN run from socket_cmd_process(), keep polling until UDP */
+        socket_open_async(sn, W5500_Sn_MR_UDP | W5500_Sn_MR_MFEN, MDNS_PORT, 0);
         return;
     }
 
-    /* Check RX size */
-    uint16_t rx_size = W5500_READ_REG16(W5500_Sn_RX_RSR0(sn));
-    if (rx_size == 0) return;
-
-    if (rx_size > 512) rx_size = 512;
-    uint8_t buf[512];
-    int received = recv_socket(sn, buf, rx_size);
-    if (received <= 12) return; /* too small for DNS header */
+    if (mdns_state == MDNS_ST_OPENING) start_probing(now);
 
-    /* DNS header fields */
-    uint16_t flags = (buf[2] << 8) | buf[3];
-    uint16_t qdcount = (buf[4] << 8) | buf[5];
+    restore_dest();
+    receive();
 
-    /* Only handle queries (QR=0) and qdcount>0 */
-    if ((flags & 0x8000) != 0) return;
-    if (qdcount == 0) return;
-
-    /* parse first question name */
-    uint16_t pos = 12;
-    char qname[128];
-    pos = parse_dns_name(buf, received, pos, qname, sizeof(qname));
-    if (pos + 4 > received) return;
-
-    uint16_t qtype = (buf[pos] << 8) | buf[pos+1];
-    uint16_t qclass = (buf[pos+2] << 8) | buf[pos+3];
-
-    /* We only answer Type A (1) / Class IN (1) queries */
-    if (qtype != 0x0001) return;
-
-    /* Build local variants: "host.local" and "host" */
-    char q_local[128];
-    snprintf(q_local, sizeof(q_local), "%s.local", device_hostname);
-
-    /* Compare requested name with our hostname */
-    if (my_strcasecmp(qname, q_local) == 0 || my_strcasecmp(qname, device_hostname) == 0) {
-        /* Try to get source IP/port from socket registers (works for many W5500 implementations)
-           If not available, fallback to multicast address */
-        uint8_t src_ip[4];
-        uint8_t src_port_h = W5500_READ_REG(W5500_Sn_DIPR0(sn));
-        (void)src_port_h; /* silence potential unused warning */
-
-        /* W5500 stores peer IP/port in Sn_DIPR0/Sn_DPORT0 after recv; read them */
-        for (int i = 0; i < 4; ++i) src_ip[i] = W5500_READ_REG(W5500_Sn_DIPR0(sn) + i);
-        uint8_t src_port_hi = W5500_READ_REG(W5500_Sn_DPORT0(sn));
-        uint8_t src_port_lo = W5500_READ_REG(W5500_Sn_DPORT0(sn) + 1);
-        uint16_t src_port = ((uint16_t)src_port_hi << 8) | src_port_lo;
-
-        /* decide destination: if src_ip is zero or equals our multicast, use multicast */
-        uint8_t mc_ip[4] = {224,0,0,251};
-        int src_is_valid = !(src_ip[0]==0 && src_ip[1]==0 && src_ip[2]==0 && src_ip[3]==0);
-
-        if (src_is_valid) {
-            /* respond unicast to src */
-            send_dns_response(sn, src_ip, src_port, buf, received);
+    if (mdns_state == MDNS_ST_PROBING && (int32_t)(now - mdns_next_ms) >= 0) {
+        if (mdns_step_count < PROBE_COUNT) {
+            send_probe(mdns_step_count == 0);
+            mdns_step_count++;
+            mdns_next_ms = now + PROBE_INTERVAL_MS;
         } else {
-            /* fallback: reply to multicast for mDNS */
-            send_dns_response(sn, mc_ip, 5353, buf, received);
+            // Nobody objected within 250 ms of the last probe
+            mdns_state = MDNS_ST_ANNOUNCING;
+            mdns_step_count = 0;
+            mdns_next_ms = now;
         }
     }
 
-    /* After handling, no explicit disconnect needed for UDP; ready to receive more */
+    if (mdns_state == MDNS_ST_ANNOUNCING && (int32_t)(now - mdns_next_ms) >= 0) {
+        send_multicast(REC_ALL, 0);
+        if (++mdns_step_count >= ANNOUNCE_COUNT) mdns_state = MDNS_ST_RUNNING;
+        mdns_next_ms = now + ANNOUNCE_INTERVAL_MS;
+    }
+
+    if ((delayed_answers || delayed_additionals) && (int32_t)(now - delayed_ms) >= 0) {
+        send_multicast(delayed_answers, delayed_additionals);
+        delayed_answers = delayed_additionals = 0;
+    }
 }
@@ -9,31 +9,58 @@
 #include "nmea.h"
 #include "string.h"
 #include "stdio.h"
-#include "ctype.h"
 #include "gps.h"
+#include "main.h"
 
-#define NMEA_LINE_BUF 1024
-static char linebuf[NMEA_LINE_BUF];
-static size_t linebuf_pos = 0;
+/*
+ * Sentences are validated byte by byte as they arrive from the UART:
+ *
+ *   WAIT_DOLLAR -'$'-> BODY -'*'-> CHECKSUM_HI -> CHECKSUM_LO -> EOL -'\n'-> parse
+ *
+ * Anything unexpected drops the sentence in the state that saw it (and is
+ * counted there); a '$' in any state starts over. Only the body between
+ * '$' and '*' is stored, bounded by the NMEA 0183 limit of 82 characters.
+ */
+#define NMEA_MAX_SENTENCE   82                          // '$' ... "*hh\r\n"
+#define NMEA_MAX_BODY       (NMEA_MAX_SENTENCE - 6)
+#define NMEA_MAX_FIELDS     24  // GSV: talker/type + 19 fields, with room to spare
+
+typedef enum {
+    NMEA_WAIT_DOLLAR = 0,
+    NMEA_BODY,
+    NMEA_CHECKSUM_HI,
+    NMEA_CHECKSUM_LO,
+    NMEA_EOL
+} nmea_state_t;
+
+static nmea_state_t state = NMEA_WAIT_DOLLAR;
+static char linebuf[NMEA_MAX_BODY];
+static uint8_t linebuf_pos = 0;
+static uint8_t field_off[NMEA_MAX_FIELDS];  // Start of each field in linebuf
+static uint8_t field_n = 0;
+static uint8_t cs_calc = 0;                 // XOR of the body so far
+static uint8_t cs_given = 0;
+static uint32_t line_cyc = 0;   // DWT->CYCCNT at the '$' of the current sentence
+static uint32_t byte_cyc = 0;   // Cycles per character on the line
 
 static nmea_stats_t stats;
 
 void nmea_init(void) {
     memset(&stats, 0, sizeof(stats));
-    linebuf_pos = 0;
+    state = NMEA_WAIT_DOLLAR;
 }
 
 /* ----- BEGIN: small compatibility / API shims for main.c ----- */
 /* Add these symbols so existing main.c builds without changing main.c */
 
 static volatile int new_pos_available = 0;
-static gps_pos_t last_pos = {0};
+static void epoch_reset(void);
 
 /* Initialize parser (wrapper) */
 void nmea_parser_init(void) {
     nmea_init();
     new_pos_available = 0;
-    memset(&last_pos, 0, sizeof(last_pos));
+    epoch_reset();
 }
 
 /*
@@ -55,124 +82,374 @@ int nmea_process(void) {
  */
 void nmea_get_position(gps_pos_t *out) {
     if (!out) return;
-    *out = last_pos;
+    *out = gps_get_last_position();
 }
 
 
-static unsigned char hex2int(char c) {
+/* One field of a sentence, pointing into linebuf (not terminated) */
+typedef struct {
+    const char* p;
+    uint8_t len;
+} nmea_field_t;
+
+static int hex2int(char c) {
     if (c>='0' && c<='9') return c-'0';
     if (c>='A' && c<='F') return c-'A'+10;
     if (c>='a' && c<='f') return c-'a'+10;
-    return 0;
+    return -1;
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/* Two decimal digits at p, -1 if either is not a digit */
+static int dig2(const char* p) {
+    if (!is_digit(p[0]) || !is_digit(p[1])) return -1;
+    return (p[0]-'0')*10 + (p[1]-'0');
+}
+
+/* Unsigned integer field, def when empty or not a number */
+static int field_uint(const nmea_field_t* f, int def) {
+    if (f->len == 0) return def;
+    int v = 0;
+    for (uint8_t i = 0; i < f->len; i++) {
+        if (!is_digit(f->p[i])) return (i == 0) ? def : v;
+        v = v*10 + (f->p[i]-'0');
+    }
+    return v;
+}
+
+/* hhmmss[.sss] */
+static bool field_time(const nmea_field_t* f, int* hh, int* mm, int* ss, int* ms) {
+    if (f->len < 6) return false;
+    *hh = dig2(f->p); *mm = dig2(f->p+2); *ss = dig2(f->p+4);
+    if (*hh < 0 || *mm < 0 || *ss < 0) return false;
+    // Optional fraction: .s, .ss or .sss
+    *ms = 0;
+    if (f->len > 6 && f->p[6] == '.') {
+        int scale = 100;
+        for (uint8_t i = 7; i < f->len && is_digit(f->p[i]) && scale; i++, scale /= 10)
+            *ms += (f->p[i]-'0') * scale;
+    }
+    return true;
+}
+
+/* ddmmyy, years 2000-2099 */
+static bool field_date(const nmea_field_t* f, int* dd, int* mon, int* yy) {
+    if (f->len < 6) return false;
+    *dd = dig2(f->p); *mon = dig2(f->p+2); *yy = dig2(f->p+4);
+    if (*dd < 0 || *mon < 0 || *yy < 0) return false;
+    *yy += 2000;
+    return true;
+}
+
+/*
+ * (d)ddmm.mmmmm and N/S/E/W into degrees * 1e7, integer only: minutes are
+ * kept as 1e-5 minute units and scaled by 100/60.
+ */
+static bool field_coord(const nmea_field_t* f, const nmea_field_t* hemi, int32_t* deg_e7) {
+    uint32_t ip = 0, frac = 0, scale = 10000;
+    uint8_t i = 0;
+    for (; i < f->len && is_digit(f->p[i]); i++) ip = ip*10 + (f->p[i]-'0');
+    if (i < 3 || ip > 18000) return false;
+    if (i < f->len && f->p[i] == '.') {
+        for (i++; i < f->len && is_digit(f->p[i]) && scale; i++, scale /= 10)
+            frac += (f->p[i]-'0') * scale;
+    }
+    uint32_t min_e5 = (ip % 100) * 100000 + frac;
+    if (min_e5 >= 6000000) return false;
+    int32_t v = (int32_t)(ip / 100) * 10000000 + (int32_t)((min_e5 * 5 + 1) / 3);
+    if (hemi->len && (hemi->p[0] == 'S' || hemi->p[0] == 'W')) v = -v;
+    *deg_e7 = v;
+    return true;
+}
+
+static bool field_is(const nmea_field_t* f, const char* type) {
+    // Field 0 is talker (2 chars, GP/GN/GL...) + sentence type
+    return f->len == 5 && memcmp(f->p + 2, type, 3) == 0;
+}
+
+/* Non-negative decimal field scaled by 10^decimals ("12.345", 2 -> 1234) */
+static bool field_fixed(const nmea_field_t* f, uint8_t decimals, uint32_t* out) {
+    uint32_t v = 0;
+    uint8_t i = 0, frac = 0, seen = 0;
+    for (; i < f->len && is_digit(f->p[i]); i++, seen++) v = v*10 + (f->p[i]-'0');
+    if (i < f->len && f->p[i] == '.') {
+        for (i++; i < f->len && is_digit(f->p[i]) && frac < decimals; i++, frac++, seen++)
+            v = v*10 + (f->p[i]-'0');
+    }
+    if (!seen) return false;
+    for (; frac < decimals; frac++) v *= 10;
+    *out = v;
+    return true;
+}
+
+/* --- Epoch assembly ---
+ * Sentences of one fix share its time; the first RMC/GGA/ZDA with a new
+ * time publishes what was collected for the previous one (so the sky view
+ * lags by one epoch) and starts over. GSA/GSV/VTG carry no time and are
+ * added to the epoch in progress.
+ */
+static gps_epoch_t work;
+static struct {
+    char gnss;
+    uint8_t prn;
+} work_used[GPS_MAX_USED];
+static uint8_t work_has_time = 0;
+static uint8_t work_dropped = 0;        // New satellites that did not fit in sats
+static uint32_t work_cyc = 0;           // Parse cycles spent on this epoch
+
+static void epoch_reset(void) {
+    memset(&work, 0, sizeof(work));
+    work.course_cdeg = 0xFFFF;
+    work_has_time = 0;
+    work_dropped = 0;
+    work_cyc = 0;
 }
 
-static bool check_nmea_checksum(const char* s) {
-    if (*s != '$') return false;
-    const char* p = strchr(s, '*');
-    if (!p) return false;
-    unsigned char cs = 0;
-    for (const char* q = s+1; q < p; ++q) cs ^= (unsigned char)*q;
-    if (strlen(p) < 3) return false;
-    unsigned char given = (hex2int(p[1]) << 4) | hex2int(p[2]);
-    return cs == given;
+static void epoch_publish(void) {
+    // GSA without a system id (GP/GL talkers, NMEA < 4.10) names its system by talker
+    for (uint8_t i = 0; i < work.sat_count; i++) {
+        gps_sat_t* s = &work.sats[i];
+        for (uint8_t j = 0; j < work.used_count; j++) {
+            if (work_used[j].prn == s->prn &&
+                (work_used[j].gnss == s->gnss || work_used[j].gnss == 'N')) {
+                s->used = 1;
+                break;
+            }
+        }
+    }
+    work.in_view = work.sat_count + work_dropped;
+    work.parse_us = work_cyc / (SystemCoreClock / 1000000);
+    if (work.parse_us > stats.epoch_parse_us_max) stats.epoch_parse_us_max = work.parse_us;
+    if (work.parse_us > NMEA_EPOCH_BUDGET_US) stats.epochs_over_budget++;
+    stats.epochs++;
+    gps_on_epoch(&work);
 }
 
-static double parse_coord_ddmm_to_deg(const char* s) {
-    if (!s || *s=='\0') return 0.0;
-    double v = atof(s);
-    double deg = floor(v / 100.0);
-    double minutes = v - deg*100.0;
-    return deg + minutes/60.0;
+/* Time of a RMC/GGA/ZDA sentence: same fix, or the start of the next one */
+static void epoch_time(int hh, int mm, int ss, int ms) {
+    if (work_has_time && (hh != work.hour || mm != work.min || ss != work.sec || ms != work.ms)) {
+        epoch_publish();
+        epoch_reset();
+    }
+    work.hour = hh; work.min = mm; work.sec = ss; work.ms = ms;
+    work_has_time = 1;
 }
 
-static void handle_nmea_line(const char* line) {
+static gps_sat_t* epoch_sat(char gnss, uint8_t prn) {
+    for (uint8_t i = 0; i < work.sat_count; i++) {
+        if (work.sats[i].gnss == gnss && work.sats[i].prn == prn) return &work.sats[i];
+    }
+    if (work.sat_count >= GPS_MAX_SATS) {
+        work_dropped++;
+        return NULL;
+    }
+    gps_sat_t* s = &work.sats[work.sat_count++];
+    memset(s, 0, sizeof(*s));
+    s->gnss = gnss;
+    s->prn = prn;
+    return s;
+}
+
+/* Talker system letter, "GP" -> 'P' */
+static char talker_gnss(const nmea_field_t* f0) {
+    return f0->p[1];
+}
+
+static void handle_rmc(const nmea_field_t* f, int n) {
+    // 1 time, 2 status, 3-4 lat, 5-6 lon, 7 speed (knots), 8 track, 9 date
+    if (n < 10 || f[2].len == 0 || f[2].p[0] != 'A') return;
+    int32_t lat, lon;
+    int hh, mm, ss, ms, dd, mon, yy;
+    uint32_t v;
+    if (!field_coord(&f[3], &f[4], &lat) || !field_coord(&f[5], &f[6], &lon)) return;
+    if (!field_time(&f[1], &hh, &mm, &ss, &ms) || !field_date(&f[9], &dd, &mon, &yy)) return;
+
+    epoch_time(hh, mm, ss, ms);
+    work.year = yy; work.month = mon; work.day = dd;
+    if (field_fixed(&f[7], 3, &v)) work.speed_cms = v * 1852 / 36000;
+    if (field_fixed(&f[8], 2, &v) && v < 36000) work.course_cdeg = v;
+
+    gps_on_new_position(lat, lon, 1, 0, yy,mon,dd,hh,mm,ss);
+    gps_on_new_time(yy,mon,dd,hh,mm,ss,ms, line_cyc);
+    new_pos_available = 1;
+}
+
+static void handle_gga(const nmea_field_t* f, int n) {
+    // 1 time, 2-3 lat, 4-5 lon, 6 fix quality, 7 satellites
+    if (n < 8) return;
+    int fix = field_uint(&f[6], 0);
+    int sats = field_uint(&f[7], 0);
+    int32_t lat, lon;
+    int hh = 0, mm = 0, ss = 0, ms;
+    if (field_time(&f[1], &hh, &mm, &ss, &ms)) epoch_time(hh, mm, ss, ms);
+    if (fix <= 0) return;
+    if (!field_coord(&f[2], &f[3], &lat) || !field_coord(&f[4], &f[5], &lon)) return;
+
+    // GGA has no date, keep the one RMC/ZDA gave this epoch
+    gps_on_new_position(lat, lon, (uint8_t)fix, (uint8_t)sats,
+                        work.year, work.month, work.day, hh,mm,ss);
+    new_pos_available = 1;
+}
+
+static void handle_gsa(const nmea_field_t* f, int n) {
+    // 1 mode A/M, 2 fix 1/2/3, 3-14 PRNs, 15 PDOP, 16 HDOP, 17 VDOP, 18 system id (4.10)
+    static const char sys_gnss[] = { 'N', 'P', 'L', 'A', 'B', 'Q', 'I' };
+    if (n < 18) return;
+    char gnss = talker_gnss(&f[0]);
+    int sys = (n > 18) ? field_uint(&f[18], 0) : 0;
+    if (sys > 0 && sys < (int)sizeof(sys_gnss)) gnss = sys_gnss[sys];
+
+    uint32_t v;
+    work.fix_mode = field_uint(&f[2], 0);
+    if (field_fixed(&f[15], 2, &v)) work.pdop = v > 0xFFFF ? 0xFFFF : v;
+    if (field_fixed(&f[16], 2, &v)) work.hdop = v > 0xFFFF ? 0xFFFF : v;
+    if (field_fixed(&f[17], 2, &v)) work.vdop = v > 0xFFFF ? 0xFFFF : v;
+
+    for (int i = 3; i <= 14; i++) {
+        int prn = field_uint(&f[i], 0);
+        if (prn <= 0 || work.used_count >= GPS_MAX_USED) continue;
+        work_used[work.used_count].gnss = gnss;
+        work_used[work.used_count].prn = prn;
+        work.used_count++;
+    }
+}
+
+static void handle_gsv(const nmea_field_t* f, int n) {
+    // 1 messages, 2 message number, 3 in view, then prn/elevation/azimuth/SNR x 1..4
+    char gnss = talker_gnss(&f[0]);
+    for (int i = 4; i + 3 < n; i += 4) {
+        int prn = field_uint(&f[i], 0);
+        if (prn <= 0 || prn > 255) continue;
+        gps_sat_t* s = epoch_sat(gnss, prn);
+        if (!s) continue;
+        // The same satellite repeats per signal (NMEA 4.10), keep the strongest
+        int snr = field_uint(&f[i+3], 0);
+        if (snr < s->snr_db) continue;
+        s->elev_deg = field_uint(&f[i+1], 0);
+        s->azim_deg = field_uint(&f[i+2], 0);
+        s->snr_db = snr;
+    }
+}
+
+static void handle_vtg(const nmea_field_t* f, int n) {
+    // 1 true course, T, 3 magnetic, M, 5 knots, N, 7 km/h, K
+    uint32_t v;
+    if (n < 9) return;
+    if (field_fixed(&f[1], 2, &v) && v < 36000) work.course_cdeg = v;
+    if (field_fixed(&f[7], 3, &v)) work.speed_cms = v / 36;
+}
+
+static void handle_zda(const nmea_field_t* f, int n) {
+    // 1 time, 2 day, 3 month, 4 year (4 digits), 5-6 local zone
+    int hh, mm, ss, ms;
+    if (n < 5 || !field_time(&f[1], &hh, &mm, &ss, &ms)) return;
+    int dd = field_uint(&f[2], 0), mon = field_uint(&f[3], 0), yy = field_uint(&f[4], 0);
+    if (!dd || !mon || yy < 2000) return;
+
+    epoch_time(hh, mm, ss, ms);
+    work.year = yy; work.month = mon; work.day = dd;
+}
+
+/* Body complete and checksum verified: split at the recorded commas */
+static void handle_sentence(void) {
+    nmea_field_t f[NMEA_MAX_FIELDS];
+    uint32_t start = DWT->CYCCNT;
+
+    for (uint8_t i = 0; i < field_n; i++) {
+        uint8_t end = (i + 1 < field_n) ? field_off[i+1] - 1 : linebuf_pos;
+        f[i].p = &linebuf[field_off[i]];
+        f[i].len = end - field_off[i];
+    }
+    stats.valid++;
+
+    if (field_is(&f[0], "RMC")) handle_rmc(f, field_n);
+    else if (field_is(&f[0], "GGA")) handle_gga(f, field_n);
+    else if (field_is(&f[0], "GSA")) handle_gsa(f, field_n);
+    else if (field_is(&f[0], "GSV")) handle_gsv(f, field_n);
+    else if (field_is(&f[0], "VTG")) handle_vtg(f, field_n);
+    else if (field_is(&f[0], "ZDA")) handle_zda(f, field_n);
+
+    work_cyc += DWT->CYCCNT - start;
+}
+
+static void sentence_start(uint32_t cyc) {
+    line_cyc = cyc;
+    linebuf_pos = 0;
+    field_off[0] = 0;
+    field_n = 1;
+    cs_calc = 0;
+    state = NMEA_BODY;
     stats.lines++;
-    if (line[0] != '$') return;
-    if (!check_nmea_checksum(line)) {
-        stats.checksum_failed++;
+}
+
+static void push_byte(char c, uint32_t cyc) {
+    if (c == '$') {
+        // Restart from any state: the previous sentence was cut short
+        if (state != NMEA_WAIT_DOLLAR) stats.truncated++;
+        sentence_start(cyc);
         return;
     }
-    stats.valid++;
-    char tmp[256];
-    strncpy(tmp, line, sizeof(tmp)-1);
-    tmp[sizeof(tmp)-1]=0;
-    char* token = strtok(tmp, ",");
-    if (!token) return;
-    if (strcmp(token+3, "RMC")==0) {
-        char* time_s = strtok(NULL, ",");
-        char* status = strtok(NULL, ",");
-        char* lat = strtok(NULL, ",");
-        char* lat_ns = strtok(NULL, ",");
-        char* lon = strtok(NULL, ",");
-        char* lon_ew = strtok(NULL, ",");
-        char* spd = strtok(NULL, ",");
-        char* track = strtok(NULL, ",");
-        char* date_s = strtok(NULL, ",");
-        if (status && status[0]=='A' && lat && lon && date_s && time_s) {
-            double latd = parse_coord_ddmm_to_deg(lat);
-            if (lat_ns && lat_ns[0]=='S') latd = -latd;
-            double lond = parse_coord_ddmm_to_deg(lon);
-            if (lon_ew && lon_ew[0]=='W') lond = -lond;
-            int hh=0,mm=0,ss=0, dd=0,mon=0,yy=0;
-            if (strlen(time_s)>=6) {
-                char buf[5];
-                strncpy(buf, time_s, 2); buf[2]=0; hh=atoi(buf);
-                strncpy(buf, time_s+2,2); buf[2]=0; mm=atoi(buf);
-                strncpy(buf, time_s+4,2); buf[2]=0; ss=atoi(buf);
-            }
-            if (strlen(date_s)>=6) {
-                char b[3];
-                strncpy(b, date_s,2); b[2]=0; dd=atoi(b);
-                strncpy(b, date_s+2,2); b[2]=0; mon=atoi(b);
-                strncpy(b, date_s+4,2); b[2]=0; yy=atoi(b);
-                yy += 2000;
+
+    switch (state) {
+        case NMEA_WAIT_DOLLAR:
+            break;
+
+        case NMEA_BODY:
+            if (c == '*') {
+                state = NMEA_CHECKSUM_HI;
+            } else if (c < 0x20 || c > 0x7E) {
+                stats.bad_char++;
+                state = NMEA_WAIT_DOLLAR;
+            } else if (linebuf_pos >= NMEA_MAX_BODY) {
+                stats.overflow++;
+                state = NMEA_WAIT_DOLLAR;
+            } else {
+                cs_calc ^= (uint8_t)c;
+                linebuf[linebuf_pos++] = c;
+                // Fields past NMEA_MAX_FIELDS are merged into the last one
+                if (c == ',' && field_n < NMEA_MAX_FIELDS) field_off[field_n++] = linebuf_pos;
             }
-            gps_on_new_position(latd, lond, 1, 0, yy,mon,dd,hh,mm,ss);
-        }
-    } else if (strcmp(token+3, "GGA")==0) {
-        char* time_s = strtok(NULL, ",");
-        char* lat = strtok(NULL, ",");
-        char* lat_ns = strtok(NULL, ",");
-        char* lon = strtok(NULL, ",");
-        char* lon_ew = strtok(NULL, ",");
-        char* fix = strtok(NULL, ",");
-        char* sats = strtok(NULL, ",");
-        int fix_i = fix ? atoi(fix) : 0;
-        int sats_i = sats ? atoi(sats) : 0;
-        if (fix_i>0 && lat && lon) {
-            double latd = parse_coord_ddmm_to_deg(lat);
-            if (lat_ns && lat_ns[0]=='S') latd = -latd;
-            double lond = parse_coord_ddmm_to_deg(lon);
-            if (lon_ew && lon_ew[0]=='W') lond = -lond;
-            int hh=0,mm=0,ss=0;
-            if (strlen(time_s)>=6) {
-                char buf[3];
-                buf[2]=0;
-                buf[0]=time_s[0];buf[1]=time_s[1]; hh=atoi(buf);
-                buf[0]=time_s[2];buf[1]=time_s[3]; mm=atoi(buf);
-                buf[0]=time_s[4];buf[1]=time_s[5]; ss=atoi(buf);
+            break;
+
+        case NMEA_CHECKSUM_HI:
+        case NMEA_CHECKSUM_LO: {
+            int v = hex2int(c);
+            if (v < 0) {
+                stats.bad_checksum_hex++;
+                state = NMEA_WAIT_DOLLAR;
+            } else if (state == NMEA_CHECKSUM_HI) {
+                cs_given = v << 4;
+                state = NMEA_CHECKSUM_LO;
+            } else if ((cs_given | v) != cs_calc) {
+                stats.checksum_failed++;
+                state = NMEA_WAIT_DOLLAR;
+            } else {
+                state = NMEA_EOL;
             }
-            gps_on_new_position(latd, lond, (uint8_t)fix_i, (uint8_t)sats_i, 0,0,0,hh,mm,ss);
+            break;
         }
+
+        case NMEA_EOL:
+            if (c == '\r') break;
+            if (c == '\n') handle_sentence();
+            else stats.bad_eol++;
+            state = NMEA_WAIT_DOLLAR;
+            break;
     }
 }
 
+void nmea_set_baudrate(uint32_t baud) {
+    byte_cyc = baud ? SystemCoreClock / baud * 10 : 0;  // 8N1
+}
+
 void nmea_push_chunk(const uint8_t *buf, size_t len) {
+    uint32_t now = DWT->CYCCNT;
     for (size_t i=0;i<len;i++) {
-        char c = (char)buf[i];
-        if (linebuf_pos < (NMEA_LINE_BUF-1)) {
-            linebuf[linebuf_pos++] = c;
-            linebuf[linebuf_pos] = 0;
-        } else {
-            linebuf_pos = 0;
-        }
-        if (c == '\n') {
-            char *start = strchr(linebuf, '$');
-            if (start) {
-                handle_nmea_line(start);
-            }
-            linebuf_pos = 0;
-        }
+        // Time reference for the NTP server, back-dated by the bytes after it
+        push_byte((char)buf[i], now - (uint32_t)(len - i) * byte_cyc);
     }
 }
 
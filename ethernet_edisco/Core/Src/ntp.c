@@ -0,0 +1,272 @@
+/* ntp.c - GPS-disciplined SNTP server (RFC 4330 / RFC 5905 server mode)
+ *
+ * Every timestamp is a DWT cycle count, extended to 64 bits here and
+ * converted to NTP time through the last GPS reference:
+ *
+ *   t(c) = ref_ts + (c - ref_cyc) / freq
+ *
+ * The reference is taken from RMC sentences: nmea.c stamps the '$' that
+ * starts each sentence, and the instant the sentence reports is that stamp
+ * minus NTP_NMEA_DELAY_US. The receiver sends it tens to hundreds of ms
+ * after the second, so without PPS the root dispersion starts at
+ * NTP_NMEA_SPREAD_US. With a PPS input the edge just before a whole-second
+ * sentence replaces the stamp, and consecutive PPS references also measure
+ * the core clock frequency.
+ *
+ * A request is stamped when the W5500 raises INTn for it (w5500_event), not
+ * when the main loop gets round to reading it, and the transmit timestamp
+ * is taken right before the reply goes to the chip. Replies carry LI=3 /
+ * stratum 16 until a GPS time arrives and again once it is older than
+ * NTP_HOLDOVER_S. NMEA carries no leap second warning, LI is 0 otherwise.
+ */
+
+#include "ntp.h"
+#include "gps.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include <string.h>
+
+#define NTP_PACKET_LEN      48
+#define NTP_UNIX_OFFSET     2208988800u     // 1900-01-01 to 1970-01-01
+#define NTP_PRECISION       (-26)           // log2 of one cycle at 96 MHz
+#define NTP_DISP_PPS        1               // 16.16 s: ~15 us base error with PPS
+#define NTP_DISP_NMEA       (NTP_NMEA_SPREAD_US * 65536ull / 1000000)  // 16.16 s
+
+#define NTP_MODE_CLIENT     3
+#define NTP_MODE_SERVER     4
+#define NTP_LI_ALARM        3
+#define NTP_STRATUM_UNSYNC  16
+
+/* 64-bit cycle clock */
+static uint64_t clk64 = 0;
+static uint32_t clk_last = 0;
+
+/* GPS reference */
+static uint32_t ref_seq = 0;        // gps_time_ref_t.seq last taken
+static uint64_t ref_cyc = 0;        // Clock at the reference instant
+static uint64_t ref_ts = 0;         // NTP 32.32 time of the reference instant
+static uint8_t  ref_valid = 0;
+static uint8_t  ref_pps = 0;
+static uint32_t freq = 0;           // Cycles per second
+
+/* PPS */
+static volatile uint32_t pps_cyc = 0;
+static volatile uint8_t pps_new = 0;
+static uint64_t pps_at = 0;         // Last edge, 64-bit
+static uint8_t  pps_seen = 0;
+static uint64_t pps_ref_cyc = 0;    // Previous PPS reference for the frequency estimate
+static uint32_t pps_ref_sec = 0;
+
+/* Socket */
+static volatile uint8_t ntp_pending = 1;
+static uint64_t rx_at = 0;          // INTn stamp for the first queued request
+static uint8_t  rx_at_valid = 0;
+static ntp_stats_t stats;
+
+static uint64_t clock_now(void) {
+    uint32_t c = DWT->CYCCNT;
+    clk64 += (uint32_t)(c - clk_last);
+    clk_last = c;
+    return clk64;
+}
+
+/* 64-bit clock for a cycle stamp taken within the last 44 s */
+static uint64_t clock_past(uint32_t c) {
+    uint64_t now = clock_now();
+    return now - (uint32_t)(clk_last - c);
+}
+
+/* NTP 32.32 timestamp for a clock value, also before the reference */
+static uint64_t ntp_time_at(uint64_t c) {
+    int64_t dt = (int64_t)(c - ref_cyc);
+    int64_t whole = dt / freq;
+    int64_t rem = dt % freq;
+    if (rem < 0) {
+        rem += freq;
+        whole--;
+    }
+    return ref_ts + ((uint64_t)whole << 32) + (((uint64_t)rem << 32) / freq);
+}
+
+static uint32_t ref_age_ms(void) {
+    if (!ref_valid) return UINT32_MAX;
+    uint64_t age = (clock_now() - ref_cyc) * 1000 / freq;
+    return age > UINT32_MAX ? UINT32_MAX : (uint32_t)age;
+}
+
+static uint8_t synced(void) {
+    return ref_valid && ref_age_ms() < NTP_HOLDOVER_S * 1000u;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static void put_ts(uint8_t* p, uint64_t ts) {
+    put32(p, ts >> 32);
+    put32(p + 4, (uint32_t)ts);
+}
+
+/* --- Reference --- */
+
+static void pps_update_freq(uint64_t cyc, uint32_t sec) {
+    uint32_t dsec = sec - pps_ref_sec;
+    if (pps_ref_cyc && dsec >= 1 && dsec <= NTP_HOLDOVER_S) {
+        uint32_t meas = (uint32_t)((cyc - pps_ref_cyc) / dsec);
+        int32_t off = (int32_t)(meas - SystemCoreClock);
+        int32_t tol = SystemCoreClock / 1000000 * NTP_FREQ_TOL_PPM;
+        // Missed or spurious edges give estimates far outside the crystal tolerance
+        if (off > -tol && off < tol) freq += (int32_t)(meas - freq) / 8;
+    }
+    pps_ref_cyc = cyc;
+    pps_ref_sec = sec;
+}
+
+static void update_reference(void) {
+    if (pps_new) {
+        pps_new = 0;
+        pps_at = clock_past(pps_cyc);
+        pps_seen = 1;
+    }
+
+    gps_time_ref_t r = gps_get_time_ref();
+    if (r.seq == 0 || r.seq == ref_seq) return;
+    ref_seq = r.seq;
+
+    uint64_t start = clock_past(r.cyc);
+    uint64_t mark = start - (uint64_t)NTP_NMEA_DELAY_US * freq / 1000000;
+    uint64_t window = (uint64_t)freq * NTP_PPS_WINDOW_MS / 1000;
+
+    // The edge that started this second precedes the sentence reporting it
+    ref_pps = pps_seen && r.ms == 0 && start >= pps_at && start - pps_at < window;
+    ref_cyc = ref_pps ? pps_at : mark;
+    ref_ts = ((uint64_t)(r.unix_sec + NTP_UNIX_OFFSET) << 32) +
+             (((uint64_t)r.ms << 32) / 1000);
+    ref_valid = 1;
+
+    if (ref_pps) pps_update_freq(ref_cyc, r.unix_sec);
+    else pps_ref_cyc = 0;
+}
+
+/* --- Requests --- */
+
+static void reply(const uint8_t* hdr, const uint8_t* req, uint64_t rx) {
+    uint8_t b[NTP_PACKET_LEN];
+    uint8_t ok = synced();
+    uint8_t vn = (req[0] >> 3) & 7;
+
+    memset(b, 0, sizeof(b));
+    b[0] = ((ok ? 0 : NTP_LI_ALARM) << 6) | (vn << 3) | NTP_MODE_SERVER;
+    b[1] = ok ? 1 : NTP_STRATUM_UNSYNC;
+    b[2] = req[2];                  // Poll interval echoed
+    b[3] = (uint8_t)NTP_PRECISION;
+    // Root delay 0: the reference clock is attached
+    if (ok) {
+        uint32_t disp = ref_pps ? NTP_DISP_PPS : NTP_DISP_NMEA;
+        disp += (uint64_t)ref_age_ms() * NTP_DRIFT_PPM * 65536 / 1000000000u;
+        put32(b + 8, disp);
+        memcpy(b + 12, ref_pps ? "PPS" : "GPS", 4);
+    }
+    if (ref_valid) {
+        put_ts(b + 16, ref_ts);
+        put_ts(b + 32, ntp_time_at(rx));
+    }
+    memcpy(b + 24, req + 40, 8);    // Origin = client's transmit timestamp
+
+    // hdr[0..5] is the sender's ip:port, same layout as Sn_DIPR/Sn_DPORT
+    W5500_WRITE_BUF(W5500_Sn_DIPR0(NTP_SOCKET), hdr, 6);
+    if (ref_valid) put_ts(b + 40, ntp_time_at(clock_now()));
+    if (send_socket_nb(NTP_SOCKET, b, sizeof(b)) == sizeof(b)) stats.replies++;
+    else stats.dropped++;
+}
+
+static void receive(void) {
+    while (get_socket_rx_size(NTP_SOCKET) >= 8) {
+        // The chip reads Sn_DIPR until the previous reply got SENDOK or
+        // TIMEOUT: leave the request queued and come back on the next pass
+        if (socket_send_wait(NTP_SOCKET, 0) > 0 ||
+            get_socket_tx_free(NTP_SOCKET) < NTP_PACKET_LEN) {
+            ntp_pending = 1;
+            return;
+        }
+
+        uint8_t hdr[8];  // [ip:4][port:2][len:2]
+        if (recv_socket(NTP_SOCKET, hdr, sizeof(hdr)) != sizeof(hdr)) return;
+
+        // Only the first datagram of an interrupt has its own edge
+        uint64_t rx = rx_at_valid ? rx_at : clock_now();
+        rx_at_valid = 0;
+
+        uint8_t req[NTP_PACKET_LEN];
+        uint16_t dlen = ((uint16_t)hdr[6] << 8) | hdr[7];
+        uint16_t n = dlen < sizeof(req) ? dlen : sizeof(req);
+        int got = recv_socket(NTP_SOCKET, req, n);
+        if (got < 0) return;
+        if (dlen > got) consume_socket(NTP_SOCKET, dlen - got);
+
+        stats.requests++;
+        uint8_t vn = (req[0] >> 3) & 7;
+        if (got < NTP_PACKET_LEN || (req[0] & 7) != NTP_MODE_CLIENT || vn < 1 || vn > 4) {
+            stats.dropped++;
+            continue;
+        }
+        reply(hdr, req, rx);
+    }
+}
+
+static void ntp_socket_event(uint8_t sn, uint8_t events) {
+    (void)sn;
+    (void)events;
+    ntp_pending = 1;
+    // A request left queued behind a busy SEND keeps its own edge
+    if (rx_at_valid) return;
+    rx_at = clock_past(w5500_event_irq_cycles());
+    // A stale edge (line held low by another socket) is worse than "now"
+    rx_at_valid = clock_now() - rx_at < freq;
+}
+
+/* --- API --- */
+
+void ntp_init(void) {
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    clk_last = DWT->CYCCNT;
+    freq = SystemCoreClock;
+    memset(&stats, 0, sizeof(stats));
+
+    w5500_event_register(NTP_SOCKET, W5500_Sn_IR_RECV, ntp_socket_event);
+    ntp_pending = 1;
+}
+
+void ntp_process(void) {
+    clock_now();    // Keeps the 64-bit extension across CYCCNT wraps
+    update_reference();
+
+    if (!ntp_pending) return;
+    ntp_pending = 0;
+
+    if (get_socket_status(NTP_SOCKET) != W5500_SR_SOCK_UDP) {
+        /* CLOSE + OPEN run from socket_cmd_process(), keep polling until UDP */
+        socket_open_async(NTP_SOCKET, W5500_Sn_MR_UDP, NTP_PORT, 0);
+        ntp_pending = 1;
+        return;
+    }
+    receive();
+}
+
+void ntp_pps_irq(void) {
+    pps_cyc = DWT->CYCCNT;
+    pps_new = 1;
+}
+
+void ntp_get_stats(ntp_stats_t* out) {
+    *out = stats;
+    out->synced = synced();
+    out->pps = ref_valid && ref_pps;
+    out->ref_age_ms = ref_age_ms();
+    out->freq_hz = freq;
+}
@@ -0,0 +1,212 @@
+/* sensors.c - Sensor registry and per-device read scheduling
+ *
+ * Each registered driver describes its device with a sensor_schedule_t;
+ * this module runs the schedule through the shared I2C queue (i2c_bus.c)
+ * and keeps one table of the latest fixed-point values, whichever sensor
+ * they came from. Drivers only decode bytes, they never touch the bus
+ * after init.
+ */
+
+#include "sensors.h"
+#include "main.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef enum {
+    PH_IDLE = 0,        // Until next_at
+    PH_TRIGGER,         // Trigger write queued or in flight
+    PH_CONVERT,         // Until conv_at
+    PH_READ             // Data read queued or in flight
+} phase_t;
+
+typedef struct {
+    const sensor_driver_t* drv;
+    sensor_schedule_t sched;
+    uint8_t  addr;
+    uint8_t  present;
+    uint8_t  phase;
+    uint8_t  reinit;        // Failed transfer: reconfigure before the next one
+    uint32_t next_at;
+    uint32_t conv_at;
+    uint8_t  raw[SENSORS_MAX_READ];
+    uint32_t samples;
+    uint32_t errors;
+    uint32_t last_update;
+    uint32_t decode_cycles;
+} slot_t;
+
+static slot_t slots[SENSORS_MAX];
+static uint8_t slot_count = 0;
+static sensor_sample_t table[SENSOR_QTY_COUNT];
+static uint8_t changed = 0;
+
+static void fail(slot_t* s) {
+    s->errors++;
+    s->phase = PH_IDLE;
+    s->next_at = HAL_GetTick() + SENSORS_BACKOFF_MS;
+    s->reinit = 1;
+}
+
+static void trigger_done(void* ctx, uint32_t err) {
+    slot_t* s = ctx;
+    if (err != HAL_I2C_ERROR_NONE) {
+        fail(s);
+        return;
+    }
+    s->conv_at = HAL_GetTick() + s->sched.conv_ms;
+    s->phase = PH_CONVERT;
+}
+
+static void read_done(void* ctx, uint32_t err) {
+    slot_t* s = ctx;
+    if (err != HAL_I2C_ERROR_NONE) {
+        fail(s);
+        return;
+    }
+    s->phase = PH_IDLE;
+
+    sensor_values_t v;
+    memset(&v, 0, sizeof(v));
+    uint32_t c0 = DWT->CYCCNT;
+    int rc = s->drv->decode(s->raw, &v);
+    s->decode_cycles = DWT->CYCCNT - c0;
+    if (rc != 0) {
+        s->errors++;
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+    int8_t index = (int8_t)(s - slots);
+    for (uint8_t q = 0; q < SENSOR_QTY_COUNT; q++) {
+        if (!(v.mask & (1 << q))) continue;
+        table[q].value = v.value[q];
+        table[q].last_update = now;
+        table[q].source = index;
+    }
+    s->samples++;
+    s->last_update = now;
+    changed = 1;
+}
+
+static int queue_read(slot_t* s) {
+    if (i2c_bus_read(s->addr, s->sched.read_reg, s->raw, s->sched.read_len, read_done, s) != 0) {
+        return -1;
+    }
+    s->phase = PH_READ;
+    return 0;
+}
+
+/* --- API --- */
+
+int sensors_register(const sensor_driver_t* drv) {
+    if (slot_count >= SENSORS_MAX) return -1;
+    memset(&slots[slot_count], 0, sizeof(slot_t));
+    slots[slot_count].drv = drv;
+    return slot_count++;
+}
+
+uint8_t sensors_init(void) {
+    uint8_t n = 0;
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t q = 0; q < SENSOR_QTY_COUNT; q++) {
+        table[q].value = 0;
+        table[q].last_update = 0;
+        table[q].source = -1;
+    }
+    changed = 0;
+
+    i2c_bus_scan();
+    for (uint8_t i = 0; i < slot_count; i++) {
+        slot_t* s = &slots[i];
+        s->present = 0;
+        for (uint8_t k = 0; k < 2 && !s->present; k++) {
+            uint8_t a = s->drv->addr[k];
+            if (!a || !i2c_bus_present(a)) continue;
+            if (s->drv->init(a, &s->sched) != 0) continue;
+            if (s->sched.read_len == 0 || s->sched.read_len > SENSORS_MAX_READ) continue;
+            s->addr = a;
+            s->present = 1;
+        }
+        if (!s->present) continue;
+        s->phase = PH_IDLE;
+        s->next_at = now + s->sched.period_ms;
+        n++;
+    }
+    return n;
+}
+
+int sensors_process(void) {
+    uint32_t now = HAL_GetTick();
+
+    for (uint8_t i = 0; i < slot_count; i++) {
+        slot_t* s = &slots[i];
+        if (!s->present) continue;
+
+        if (s->phase == PH_IDLE && (int32_t)(now - s->next_at) >= 0) {
+            // The device may have been reset or power cycled and lost its
+            // settings; the writes are queued ahead of the trigger or read
+            if (s->reinit && s->drv->reconfigure) s->drv->reconfigure();
+            s->reinit = 0;
+            // Queue full: try again on the next pass, the period is not lost
+            if (s->sched.trigger) {
+                uint8_t val = s->sched.trigger_val;
+                if (i2c_bus_write(s->addr, s->sched.trigger_reg, &val, 1, trigger_done, s) != 0) continue;
+                s->phase = PH_TRIGGER;
+            } else if (queue_read(s) != 0) {
+                continue;
+            }
+            s->next_at += s->sched.period_ms;
+            // Fell behind (backoff, long stall): restart the period from now
+            if ((int32_t)(now - s->next_at) >= 0) s->next_at = now + s->sched.period_ms;
+        } else if (s->phase == PH_CONVERT && (int32_t)(now - s->conv_at) >= 0) {
+            queue_read(s);
+        }
+    }
+
+    int r = changed;
+    changed = 0;
+    return r;
+}
+
+sensor_sample_t sensors_get(sensor_qty_t q) {
+    return table[q];
+}
+
+uint32_t sensors_stale_ms(sensor_qty_t q) {
+    int8_t src = table[q].source;
+    if (src < 0) return 1000 + SENSORS_STALE_GRACE_MS;
+    return slots[src].sched.period_ms + SENSORS_STALE_GRACE_MS;
+}
+
+int sensors_info(uint8_t index, sensor_info_t* out) {
+    if (index >= slot_count) return 0;
+    const slot_t* s = &slots[index];
+    out->name = s->drv->name;
+    out->addr = s->addr;
+    out->present = s->present;
+    out->period_ms = s->present ? s->sched.period_ms : 0;
+    out->samples = s->samples;
+    out->errors = s->errors;
+    out->last_update = s->last_update;
+    out->decode_cycles = s->decode_cycles;
+    return 1;
+}
+
+int32_t sensors_tenths(sensor_qty_t q) {
+    int32_t v = table[q].value;
+    switch (q) {
+    case SENSOR_TEMP:  return (v + (v < 0 ? -5 : 5)) / 10;     // 0.01 °C
+    case SENSOR_PRESS: return (v + 5) / 10;                    // Pa, 0.1 hPa = 10 Pa
+    case SENSOR_HUM:   return (v * 10 + 512) >> 10;            // 1/1024 %RH
+    case SENSOR_LUX:   return (v + 50) / 100;                  // 0.001 lx
+    default:           return 0;
+    }
+}
+
+int sensors_format_tenths(char* buf, uint16_t size, int32_t tenths) {
+    uint32_t a = tenths < 0 ? 0u - (uint32_t)tenths : (uint32_t)tenths;
+    int n = snprintf(buf, size, "%s%lu.%lu", tenths < 0 ? "-" : "",
+                     (unsigned long)(a / 10), (unsigned long)(a % 10));
+    return (n < 0 || n >= size) ? 0 : n;
+}
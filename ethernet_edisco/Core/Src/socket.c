@@ -1,9 +1,389 @@
 #include "socket.h"
 #include "w5500.h"
+#include "wizchip_conf.h"
 #include "main.h"
 #include <stdio.h>
 #include <ctype.h>
 
+#define SOCK_COUNT 8
+
+/* Give up on a command if it has not completed within this time */
+static const uint16_t sock_cmd_timeout_ms[SOCK_CMD_COUNT] = {
+    [SOCK_CMD_OPEN]    = 500,
+    [SOCK_CMD_LISTEN]  = 500,
+    [SOCK_CMD_CONNECT] = 3000,
+    [SOCK_CMD_SEND]    = 1000,
+    [SOCK_CMD_RECV]    = 500,
+    [SOCK_CMD_DISCON]  = 1000,
+    [SOCK_CMD_CLOSE]   = 1000,
+};
+
+static const uint8_t sock_cmd_code[SOCK_CMD_COUNT] = {
+    [SOCK_CMD_OPEN]    = W5500_CR_OPEN,
+    [SOCK_CMD_LISTEN]  = W5500_CR_LISTEN,
+    [SOCK_CMD_CONNECT] = W5500_CR_CONNECT,
+    [SOCK_CMD_SEND]    = W5500_CR_SEND,
+    [SOCK_CMD_RECV]    = W5500_CR_RECV,
+    [SOCK_CMD_DISCON]  = W5500_CR_DISCON,
+    [SOCK_CMD_CLOSE]   = W5500_CR_CLOSE,
+};
+
+typedef struct {
+    uint8_t  cmd;           // sock_cmd_t in flight or last finished
+    uint8_t  state;         // sock_cmd_state_t
+    uint8_t  cr_done;       // Chip accepted the command (Sn_CR read back 0)
+    uint8_t  open_mode;     // Sn_MR of an OPEN queued behind CLOSE, 0 = none
+    uint16_t open_port;
+    uint32_t start_ms;
+    uint32_t start_cyc;
+    uint8_t  send_parked;   // SEND still waiting for SENDOK while another command runs
+    uint8_t  send_failed;   // Last SEND never got SENDOK, reported once
+    uint32_t send_ms;
+    uint32_t send_cyc;
+    volatile uint8_t tx_dma;    // tx_dma_state_t, set by the DMA interrupt
+    uint16_t tx_dma_wr;         // Sn_TX_WR once the DMA copy is in
+} sock_slot_t;
+
+/* send_socket_dma() copy into the TX buffer */
+typedef enum {
+    TX_DMA_IDLE = 0,
+    TX_DMA_RUNNING,
+    TX_DMA_COPIED,          // SEND still to be issued
+    TX_DMA_FAILED
+} tx_dma_state_t;
+
+static sock_slot_t sock_slot[SOCK_COUNT];
+static sock_cmd_stats_t sock_stats[SOCK_CMD_COUNT];
+
+/**
+ * Cycle counter used for latency stats, enabled on first use
+ */
+static uint32_t cyc_now(void)
+{
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    return DWT->CYCCNT;
+}
+
+static void stats_record(uint8_t cmd, uint32_t start_cyc, uint8_t failed)
+{
+    sock_cmd_stats_t* st = &sock_stats[cmd];
+    uint32_t us = (cyc_now() - start_cyc) / (SystemCoreClock / 1000000);
+
+    st->count++;
+    if (failed) st->failures++;
+    st->last_us = us;
+    if (us > st->max_us) st->max_us = us;
+    st->total_us += us;
+}
+
+/**
+ * Write Sn_CR and start tracking the command
+ */
+static void cmd_issue(uint8_t sn, uint8_t cmd)
+{
+    sock_slot_t* s = &sock_slot[sn];
+
+    if (cmd == SOCK_CMD_OPEN) {
+        // Set mode and source port, drop stale interrupt flags
+        W5500_WRITE_REG(W5500_Sn_MR(sn), s->open_mode);
+        W5500_WRITE_REG(W5500_Sn_PORT0(sn), (s->open_port >> 8) & 0xFF);
+        W5500_WRITE_REG(W5500_Sn_PORT0(sn) + 1, s->open_port & 0xFF);
+        W5500_WRITE_REG(W5500_Sn_IR(sn), 0xFF);
+        s->open_mode = 0;
+        s->send_parked = 0;
+        s->send_failed = 0;
+    }
+
+    s->cmd = cmd;
+    s->state = SOCK_ST_BUSY;
+    s->cr_done = 0;
+    s->start_ms = HAL_GetTick();
+    s->start_cyc = cyc_now();
+
+    W5500_WRITE_REG(W5500_Sn_CR(sn), sock_cmd_code[cmd]);
+
+    // The register write waited for any DMA copy, whose data is now void
+    if (cmd == SOCK_CMD_OPEN || cmd == SOCK_CMD_DISCON || cmd == SOCK_CMD_CLOSE) {
+        s->tx_dma = TX_DMA_IDLE;
+    }
+}
+
+static void cmd_finish(uint8_t sn, uint8_t state)
+{
+    sock_slot_t* s = &sock_slot[sn];
+
+    s->state = state;
+    stats_record(s->cmd, s->start_cyc, state == SOCK_ST_FAILED);
+
+    if (s->cmd == SOCK_CMD_SEND && state == SOCK_ST_FAILED) s->send_failed = 1;
+
+    // OPEN queued by socket_open_async() runs once CLOSE is through
+    if (s->cmd == SOCK_CMD_CLOSE && s->open_mode) {
+        if (state == SOCK_ST_DONE) {
+            cmd_issue(sn, SOCK_CMD_OPEN);
+        } else {
+            s->open_mode = 0;
+        }
+    }
+}
+
+/**
+ * Check SENDOK / TIMEOUT for a SEND
+ * @return 1 done, -1 failed, 0 still in flight
+ */
+static int send_check(uint8_t sn, uint8_t sr)
+{
+    uint8_t ir = W5500_READ_REG(W5500_Sn_IR(sn));
+
+    if (ir & W5500_Sn_IR_SENDOK) {
+        W5500_WRITE_REG(W5500_Sn_IR(sn), W5500_Sn_IR_SENDOK);
+        return 1;
+    }
+    if (ir & W5500_Sn_IR_TIMEOUT) {
+        // TCP drops to CLOSED and the event handler owns the flag, UDP (ARP
+        // timeout) stays open and the flag would fail every later send
+        if (sr == W5500_SR_SOCK_UDP) W5500_WRITE_REG(W5500_Sn_IR(sn), W5500_Sn_IR_TIMEOUT);
+        return -1;
+    }
+    if (sr == W5500_SR_SOCK_CLOSED) return -1;
+    return 0;
+}
+
+/**
+ * Busy SEND with Sn_CR already cleared keeps waiting for SENDOK in the
+ * background so that the slot is free for the next command
+ */
+static void send_park(uint8_t sn)
+{
+    sock_slot_t* s = &sock_slot[sn];
+
+    s->send_parked = 1;
+    s->send_ms = s->start_ms;
+    s->send_cyc = s->start_cyc;
+    s->state = SOCK_ST_DONE;
+}
+
+static void send_poll_parked(uint8_t sn, uint8_t sr)
+{
+    sock_slot_t* s = &sock_slot[sn];
+    int r = send_check(sn, sr);
+
+    if (r == 0 && HAL_GetTick() - s->send_ms <= sock_cmd_timeout_ms[SOCK_CMD_SEND]) return;
+
+    s->send_parked = 0;
+    stats_record(SOCK_CMD_SEND, s->send_cyc, r <= 0);
+    if (r <= 0) s->send_failed = 1;
+}
+
+static void write_reg16(uint16_t addr, uint16_t val);
+
+/**
+ * DMA copy finished (interrupt context), the SEND is issued from the poll
+ */
+static void tx_dma_done(void* ctx, int status)
+{
+    sock_slot_t* s = ctx;
+    s->tx_dma = (status == 0) ? TX_DMA_COPIED : TX_DMA_FAILED;
+}
+
+/**
+ * Commit a finished DMA copy: move Sn_TX_WR and issue SEND
+ */
+static void tx_dma_finish(uint8_t sn)
+{
+    sock_slot_t* s = &sock_slot[sn];
+    uint8_t st = s->tx_dma;
+
+    if (st == TX_DMA_RUNNING) return;
+    s->tx_dma = TX_DMA_IDLE;
+
+    if (st == TX_DMA_COPIED) {
+        write_reg16(W5500_Sn_TX_WR0(sn), s->tx_dma_wr);
+        if (socket_cmd_start(sn, SOCK_CMD_SEND) == 0) return;
+    }
+    s->send_failed = 1;
+}
+
+/**
+ * Advance the command state machine of one socket
+ */
+int socket_cmd_poll(uint8_t sn)
+{
+    sock_slot_t* s = &sock_slot[sn];
+
+    if (s->tx_dma) tx_dma_finish(sn);
+    if (!s->send_parked && s->state != SOCK_ST_BUSY) return s->state;
+
+    uint8_t sr = W5500_READ_REG(W5500_Sn_SR(sn));
+
+    if (s->send_parked) send_poll_parked(sn, sr);
+    if (s->state != SOCK_ST_BUSY) return s->state;
+
+    uint8_t timed_out = (HAL_GetTick() - s->start_ms > sock_cmd_timeout_ms[s->cmd]);
+
+    if (!s->cr_done) {
+        if (W5500_READ_REG(W5500_Sn_CR(sn)) != 0) {
+            if (timed_out) cmd_finish(sn, SOCK_ST_FAILED);
+            return s->state;
+        }
+        s->cr_done = 1;
+        sr = W5500_READ_REG(W5500_Sn_SR(sn));
+    }
+
+    int r = 0;  // 1 done, -1 failed, 0 pending
+    switch (s->cmd) {
+        case SOCK_CMD_OPEN:
+            r = (sr == W5500_SR_SOCK_INIT || sr == W5500_SR_SOCK_UDP ||
+                 sr == W5500_SR_SOCK_MACRAW) ? 1 : -1;
+            break;
+        case SOCK_CMD_LISTEN:
+            // A SYN may already have moved it past LISTEN
+            r = (sr == W5500_SR_SOCK_CLOSED || sr == W5500_SR_SOCK_INIT) ? -1 : 1;
+            break;
+        case SOCK_CMD_CONNECT:
+            if (sr == W5500_SR_SOCK_ESTABLISHED) r = 1;
+            else if (sr == W5500_SR_SOCK_CLOSED) r = -1;
+            break;
+        case SOCK_CMD_SEND:
+            r = send_check(sn, sr);
+            break;
+        case SOCK_CMD_RECV:
+            r = 1;
+            break;
+        case SOCK_CMD_DISCON:
+        case SOCK_CMD_CLOSE:
+            if (sr == W5500_SR_SOCK_CLOSED) r = 1;
+            break;
+    }
+
+    if (r > 0) {
+        if (s->cmd == SOCK_CMD_CLOSE) W5500_WRITE_REG(W5500_Sn_IR(sn), 0xFF);
+        cmd_finish(sn, SOCK_ST_DONE);
+    } else if (r < 0) {
+        cmd_finish(sn, SOCK_ST_FAILED);
+    } else if (timed_out) {
+        if (s->cmd == SOCK_CMD_DISCON) {
+            // Peer never answered the FIN, drop the connection hard
+            stats_record(SOCK_CMD_DISCON, s->start_cyc, 1);
+            cmd_issue(sn, SOCK_CMD_CLOSE);
+        } else {
+            cmd_finish(sn, SOCK_ST_FAILED);
+        }
+    }
+
+    return s->state;
+}
+
+/**
+ * Make the slot free for cmd, parking or overriding what is in flight
+ */
+static int cmd_claim(uint8_t sn, uint8_t cmd)
+{
+    sock_slot_t* s = &sock_slot[sn];
+
+    if (s->state == SOCK_ST_BUSY && s->cmd == SOCK_CMD_SEND) {
+        // The chip clears Sn_CR within microseconds, past that point the
+        // SEND only waits for SENDOK and can carry on in the background
+        while (socket_cmd_poll(sn) == SOCK_ST_BUSY && !s->cr_done);
+        if (s->state == SOCK_ST_BUSY) send_park(sn);
+    }
+
+    if (cmd == SOCK_CMD_SEND && s->send_parked) return -1;  // One SEND in flight at a time
+
+    if (s->state == SOCK_ST_BUSY) {
+        if (cmd != SOCK_CMD_CLOSE && cmd != SOCK_CMD_OPEN) return -1;
+
+        // CLOSE/OPEN override anything, wait only for Sn_CR to be writable
+        uint32_t start = HAL_GetTick();
+        while (W5500_READ_REG(W5500_Sn_CR(sn)) != 0) {
+            if (HAL_GetTick() - start > sock_cmd_timeout_ms[SOCK_CMD_CLOSE]) return -1;
+        }
+        s->open_mode = 0;
+        cmd_finish(sn, SOCK_ST_FAILED);
+    }
+
+    return 0;
+}
+
+/**
+ * Issue a socket command without waiting for it
+ */
+int socket_cmd_start(uint8_t sn, sock_cmd_t cmd)
+{
+    if (sn >= SOCK_COUNT || cmd >= SOCK_CMD_COUNT || cmd == SOCK_CMD_OPEN) return -1;
+    if (cmd_claim(sn, cmd) < 0) return -1;
+
+    sock_slot[sn].open_mode = 0;
+    cmd_issue(sn, cmd);
+    return 0;
+}
+
+/**
+ * CLOSE if needed, then OPEN, without waiting
+ */
+int socket_open_async(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flags)
+{
+    if (sn >= SOCK_COUNT) return -1;
+
+    // Already on its way, callers retry this every pass while SR is CLOSED
+    sock_slot_t* s = &sock_slot[sn];
+    if (s->state == SOCK_ST_BUSY &&
+        (s->cmd == SOCK_CMD_OPEN || (s->cmd == SOCK_CMD_CLOSE && s->open_mode))) {
+        return 0;
+    }
+
+    uint8_t cmd =(W5500_READ_REG(W5500_Sn_SR(sn)) == W5500_SR_SOCK_CLOSED) ?
+                  SOCK_CMD_OPEN : SOCK_CMD_CLOSE;
+    if (cmd_claim(sn, cmd) < 0) return -1;
+
+    sock_slot[sn].open_mode = protocol | flags;
+    sock_slot[sn].open_port = port;
+    cmd_issue(sn, cmd);
+    return 0;
+}
+
+/**
+ * Poll every socket with a command in flight
+ */
+void socket_cmd_process(void)
+{
+    for (uint8_t sn = 0; sn < SOCK_COUNT; sn++) {
+        if (sock_slot[sn].state == SOCK_ST_BUSY || sock_slot[sn].send_parked ||
+            sock_slot[sn].tx_dma) {
+            socket_cmd_poll(sn);
+        }
+    }
+}
+
+/**
+ * State of the last command issued on a socket
+ */
+sock_cmd_state_t socket_cmd_state(uint8_t sn)
+{
+    return (sn < SOCK_COUNT) ? (sock_cmd_state_t)sock_slot[sn].state : SOCK_ST_IDLE;
+}
+
+/**
+ * Latency counters for one command type
+ */
+const sock_cmd_stats_t* socket_cmd_stats(sock_cmd_t cmd)
+{
+    return (cmd < SOCK_CMD_COUNT) ? &sock_stats[cmd] : NULL;
+}
+
+/**
+ * Drive the command to completion (bounded by its timeout)
+ */
+static int cmd_wait(uint8_t sn)
+{
+    int st;
+    while ((st = socket_cmd_poll(sn)) == SOCK_ST_BUSY);
+    return (st == SOCK_ST_DONE) ? 0 : -1;
+}
 
 /**
  * Open a socket
@@ -15,34 +395,14 @@
  */
 int socket(uint8_t sn, uint8_t protocol, uint16_t port, uint8_t flags)
 {
-    // Close socket if it's already open
-    uint8_t status = W5500_READ_REG(W5500_Sn_SR(sn));
-    if (status != W5500_SR_SOCK_CLOSED) {
-        close_socket(sn);
-    }
-
-    // Set socket mode register (TCP/UDP)
-    W5500_WRITE_REG(W5500_Sn_MR(sn), protocol | flags);
-
-    // Set source port
-    W5500_WRITE_REG(W5500_Sn_PORT0(sn), (port >> 8) & 0xFF);
-    W5500_WRITE_REG(W5500_Sn_PORT0(sn) + 1, port & 0xFF);
-
-    // Send OPEN command
-    W5500_WRITE_REG(W5500_Sn_CR(sn), W5500_CR_OPEN);
+    if (socket_open_async(sn, protocol, port, flags) < 0) return -1;
 
-    // Wait for command to complete (max 500ms)
-    uint32_t timeout = HAL_GetTick() + 500;
-    while (W5500_READ_REG(W5500_Sn_CR(sn)) != 0) {
-        if (HAL_GetTick() > timeout) {
-            return -1;  // Timeout
-        }
-        HAL_Delay(1);
+    // A chained CLOSE finishes first, OPEN is issued from the poll
+    while (socket_cmd_poll(sn) == SOCK_ST_BUSY || sock_slot[sn].cmd != SOCK_CMD_OPEN) {
+        if (sock_slot[sn].state == SOCK_ST_FAILED) return -1;
     }
 
-    // Verify socket opened successfully
-    status = W5500_READ_REG(W5500_Sn_SR(sn));
-    if (status != W5500_SR_SOCK_INIT && status != W5500_SR_SOCK_UDP) {
+    if (sock_slot[sn].state != SOCK_ST_DONE) {
         return -2;  // Socket not in expected state
     }
 
@@ -60,23 +420,8 @@ int listen_socket(uint8_t sn)
         return -1;  // Socket not initialized
     }
 
-    // Send LISTEN command
-    W5500_WRITE_REG(W5500_Sn_CR(sn), W5500_CR_LISTEN);
-
-    // Wait for command to complete (max 500ms)
-    uint32_t timeout = HAL_GetTick() + 500;
-    while (W5500_READ_REG(W5500_Sn_CR(sn)) != 0) {
-        if (HAL_GetTick() > timeout) {
-            return -2;  // Timeout
-        }
-        HAL_Delay(1);
-    }
-
-    // Verify socket is listening
-    status = W5500_READ_REG(W5500_Sn_SR(sn));
-    if (status != W5500_SR_SOCK_LISTEN) {
-        return -3;  // Socket not listening
-    }
+    if (socket_cmd_start(sn, SOCK_CMD_LISTEN) < 0) return -2;
+    if (cmd_wait(sn) < 0) return -3;  // Socket not listening
 
     return 0;
 }
@@ -103,15 +448,113 @@ int connect_socket(uint8_t sn, const uint8_t* addr, uint16_t port)
     W5500_WRITE_REG(W5500_Sn_DPORT0(sn), (port >> 8) & 0xFF);
     W5500_WRITE_REG(W5500_Sn_DPORT0(sn) + 1, port & 0xFF);
 
-    // Send CONNECT command
-    W5500_WRITE_REG(W5500_Sn_CR(sn), W5500_CR_CONNECT);
+    // Send CONNECT command, socket_cmd_state() reports when ESTABLISHED
+    return socket_cmd_start(sn, SOCK_CMD_CONNECT);
+}
+
+/**
+ * Read a 16-bit size register that the chip may update between the two bytes
+ */
+static uint16_t read_reg16_stable(uint16_t addr)
+{
+    uint16_t prev = W5500_READ_REG16(addr);
+    for (int i = 0; i < 4; i++) {
+        uint16_t val = W5500_READ_REG16(addr);
+        if (val == prev) break;
+        prev = val;
+    }
+    return prev;
+}
+
+/**
+ * Write a 16-bit pointer register in one SPI frame
+ */
+static void write_reg16(uint16_t addr, uint16_t val)
+{
+    uint8_t b[2] = { (val >> 8) & 0xFF, val & 0xFF };
+    W5500_WRITE_BUF(addr, b, 2);
+}
+
+/**
+ * Copy into the TX ring at ptr, split into at most two bursts at the wrap point
+ */
+static void tx_write_wrapped(uint8_t sn, uint16_t ptr, const uint8_t* buf, uint16_t len)
+{
+    uint16_t size = wizchip_txbuf_size(sn);
+    uint16_t offset = ptr & (size - 1);
+    uint16_t first = size - offset;
+
+    if (len <= first) {
+        W5500_WRITE_TXBUF(sn, offset, buf, len);
+    } else {
+        W5500_WRITE_TXBUF(sn, offset, buf, first);
+        W5500_WRITE_TXBUF(sn, 0, buf + first, len - first);
+    }
+}
+
+/**
+ * Copy out of the RX ring at ptr, split into at most two bursts at the wrap point
+ */
+static void rx_read_wrapped(uint8_t sn, uint16_t ptr, uint8_t* buf, uint16_t len)
+{
+    uint16_t size = wizchip_rxbuf_size(sn);
+    uint16_t offset = ptr & (size - 1);
+    uint16_t first = size - offset;
+
+    if (len <= first) {
+        W5500_READ_RXBUF(sn, offset, buf, len);
+    } else {
+        W5500_READ_RXBUF(sn, offset, buf, first);
+        W5500_READ_RXBUF(sn, 0, buf + first, len - first);
+    }
+}
+
+/**
+ * Wait for the previous SEND on this socket to finish
+ * @return 0 done, 1 still sending (block == 0 only), -1 error/timeout
+ */
+static int wait_send_complete(uint8_t sn, uint8_t block)
+{
+    sock_slot_t* s = &sock_slot[sn];
 
-    // Wait for command to complete
-    while (W5500_READ_REG(W5500_Sn_CR(sn)) != 0);
+    for (;;) {
+        socket_cmd_poll(sn);
+        if (!s->send_parked && !s->tx_dma &&
+            !(s->cmd == SOCK_CMD_SEND && s->state == SOCK_ST_BUSY)) break;
+        if (!block) return 1;
+    }
 
+    if (s->send_failed) {
+        s->send_failed = 0;
+        return -1;  // Peer gone, data will never be sent
+    }
     return 0;
 }
 
+/**
+ * Wait for the last SEND to finish
+ */
+int socket_send_wait(uint8_t sn, uint8_t block)
+{
+    if (sn >= SOCK_COUNT) return -1;
+    return wait_send_complete(sn, block);
+}
+
+/**
+ * Queue len bytes (len <= Sn_TX_FSR) and issue SEND
+ */
+static int send_chunk(uint8_t sn, const uint8_t* buf, uint16_t len)
+{
+    uint16_t ptr = W5500_READ_REG16(W5500_Sn_TX_WR0(sn));
+
+    tx_write_wrapped(sn, ptr, buf, len);
+    write_reg16(W5500_Sn_TX_WR0(sn), ptr + len);
+
+    if (socket_cmd_start(sn, SOCK_CMD_SEND) < 0) return -1;
+
+    return len;
+}
+
 /**
  * Send data through socket
  */
@@ -119,43 +562,114 @@ int send_socket(uint8_t sn, const uint8_t* buf, uint16_t len)
 {
     if (len == 0) return 0;
 
-    // Get current TX write pointer
-    uint16_t ptr = W5500_READ_REG16(W5500_Sn_TX_WR0(sn));
+    uint8_t status = W5500_READ_REG(W5500_Sn_SR(sn));
+    uint8_t is_udp = (status == W5500_SR_SOCK_UDP);
 
-    // Calculate physical address in TX buffer
-    // TX buffer base: 0x8000 + (socket_num * 0x0800)
-    uint16_t offset = ptr & 0x07FF;  // Mask to 2KB buffer size
-    uint16_t addr = 0x8000 + (sn * 0x0800) + offset;
+    // A datagram cannot be split, it must fit the TX buffer in one go
+    if (is_udp && len > wizchip_txbuf_size(sn)) return -3;
 
-    // Write data to TX buffer
-    W5500_WRITE_BUF(addr, buf, len);
+    uint16_t sent = 0;
+    uint32_t start = HAL_GetTick();
+    while (sent < len) {
+        if (status != W5500_SR_SOCK_ESTABLISHED && status != W5500_SR_SOCK_CLOSE_WAIT &&
+            status != W5500_SR_SOCK_UDP) {
+            return sent ? sent : -2;  // Connection gone
+        }
 
-    // Update TX write pointer
-    ptr += len;
-    W5500_WRITE_REG(W5500_Sn_TX_WR0(sn), (ptr >> 8) & 0xFF);
-    W5500_WRITE_REG(W5500_Sn_TX_WR0(sn) + 1, ptr & 0xFF);
+        if (wait_send_complete(sn, 1) < 0) return -1;
 
-    // Send SEND command
-    W5500_WRITE_REG(W5500_Sn_CR(sn), W5500_CR_SEND);
+        uint16_t remaining = len - sent;
+        uint16_t free = get_socket_tx_free(sn);
+        uint16_t chunk = (remaining < free) ? remaining : free;
 
-    // Wait for SEND command to complete
-    uint32_t timeout = HAL_GetTick() + 1000;
-    while (W5500_READ_REG(W5500_Sn_CR(sn)) != 0) {
-        if (HAL_GetTick() > timeout) {
-            return -1;  // Timeout
+        if (chunk == 0 || (is_udp && chunk < remaining)) {
+            // TX buffer full, wait for the peer to ACK
+            if (HAL_GetTick() - start > 1000) return sent ? sent : -1;
+            status = W5500_READ_REG(W5500_Sn_SR(sn));
+            continue;
         }
+
+        int ret = send_chunk(sn, buf + sent, chunk);
+        if (ret < 0) return sent ? sent : ret;
+
+        sent += ret;
+        start = HAL_GetTick();
+    }
+
+    return sent;
+}
+
+/**
+ * Send as much as fits in Sn_TX_FSR right now
+ */
+int send_socket_nb(uint8_t sn, const uint8_t* buf, uint16_t len)
+{
+    if (len == 0) return 0;
+
+    int busy = wait_send_complete(sn, 0);
+    if (busy < 0) return -1;
+    if (busy > 0) return 0;
+
+    uint16_t free = get_socket_tx_free(sn);
+    if (len > free) len = free;
+    if (len == 0) return 0;
+
+    return send_chunk(sn, buf, len);
+}
+
+/**
+ * Like send_socket_nb(), the copy into the TX buffer runs by DMA
+ */
+int send_socket_dma(uint8_t sn, const uint8_t* buf, uint16_t len)
+{
+    sock_slot_t* s = &sock_slot[sn];
+
+    if (len < W5500_DMA_MIN_LEN) return send_socket_nb(sn, buf, len);
+
+    int busy = wait_send_complete(sn, 0);
+    if (busy < 0) return -1;
+    if (busy > 0) return 0;
+
+    uint16_t free = get_socket_tx_free(sn);
+    if (len > free) len = free;
+
+    // One transfer ends at the wrap point, the rest goes with the next SEND
+    uint16_t ptr = W5500_READ_REG16(W5500_Sn_TX_WR0(sn));
+    uint16_t size = wizchip_txbuf_size(sn);
+    uint16_t offset = ptr & (size - 1);
+    if (len > size - offset) len = size - offset;
+    if (len < W5500_DMA_MIN_LEN) return len ? send_chunk(sn, buf, len) : 0;
+
+    // The interrupt may come before W5500_WRITE_TXBUF_DMA() returns
+    s->tx_dma_wr = ptr + len;
+    s->tx_dma = TX_DMA_RUNNING;
+    if (W5500_WRITE_TXBUF_DMA(sn, offset, buf, len, tx_dma_done, s) < 0) {
+        s->tx_dma = TX_DMA_IDLE;
+        return send_chunk(sn, buf, len);
     }
 
     return len;
 }
 
+/**
+ * A send_socket_dma() copy is still reading the caller's buffer
+ */
+uint8_t socket_tx_dma_busy(uint8_t sn)
+{
+    if (sn >= SOCK_COUNT) return 0;
+
+    sock_slot_t* s = &sock_slot[sn];
+    if (s->tx_dma) tx_dma_finish(sn);
+    return s->tx_dma == TX_DMA_RUNNING;
+}
+
 /**
  * Receive data from socket
  */
 int recv_socket(uint8_t sn, uint8_t* buf, uint16_t len)
 {
     // Check received size
-    uint16_t recv_size = W5500_READ_REG16(W5500_Sn_RX_RSR0(sn));
+    uint16_t recv_size = get_socket_rx_size(sn);
     if (recv_size == 0) return 0;
 
     // Limit to requested length
@@ -163,77 +677,79 @@ int recv_socket(uint8_t sn, uint8_t* buf, uint16_t len)
         recv_size = len;
     }
 
-    // Get current RX read pointer
     uint16_t ptr = W5500_READ_REG16(W5500_Sn_RX_RD0(sn));
+    rx_read_wrapped(sn, ptr, buf, recv_size);
 
-    // Calculate physical address in RX buffer
-    // RX buffer base: 0xC000 + (socket_num * 0x0800)
-    uint16_t offset = ptr & 0x07FF;  // Mask to 2KB buffer size
-    uint16_t addr = 0xC000 + (sn * 0x0800) + offset;
-
-    // Read data from RX buffer
-    W5500_READ_BUF(addr, buf, recv_size);
+    if (consume_socket(sn, recv_size) < 0) return -1;
 
-    // Update RX read pointer
-    ptr += recv_size;
-    W5500_WRITE_REG(W5500_Sn_RX_RD0(sn), (ptr >> 8) & 0xFF);
-    W5500_WRITE_REG(W5500_Sn_RX_RD0(sn) + 1, ptr & 0xFF);
+    return recv_size;
+}
 
-    // Send RECV command to update RX buffer
-    W5500_WRITE_REG(W5500_Sn_CR(sn), W5500_CR_RECV);
+/**
+ * Read RX data without consuming it
+ */
+int peek_socket(uint8_t sn, uint16_t offset, uint8_t* buf, uint16_t len)
+{
+    uint16_t avail = get_socket_rx_size(sn);
+    if (offset >= avail) return 0;
+    if (len > avail - offset) len = avail - offset;
+    if (len == 0) return 0;
 
-    // Wait for command to complete
-    while (W5500_READ_REG(W5500_Sn_CR(sn)) != 0);
+    uint16_t ptr = W5500_READ_REG16(W5500_Sn_RX_RD0(sn));
+    rx_read_wrapped(sn, ptr + offset, buf, len);
 
-    return recv_size;
+    return len;
 }
 
 /**
- * Disconnect socket
+ * Drop len bytes from the head of the RX buffer
  */
-int disconnect_socket(uint8_t sn)
+int consume_socket(uint8_t sn, uint16_t len)
 {
-    // Send DISCON command
-    W5500_WRITE_REG(W5500_Sn_CR(sn), W5500_CR_DISCON);
+    if (len == 0) return 0;
 
-    // Wait for command to complete (max 1 second)
-    uint32_t timeout = HAL_GetTick() + 1000;
-    while (W5500_READ_REG(W5500_Sn_CR(sn)) != 0) {
-        if (HAL_GetTick() > timeout) {
-            return -1;
-        }
-    }
+    uint16_t ptr = W5500_READ_REG16(W5500_Sn_RX_RD0(sn));
+    write_reg16(W5500_Sn_RX_RD0(sn), ptr + len);
 
-    return 0;
+    // Send RECV command to release the space
+    if (socket_cmd_start(sn, SOCK_CMD_RECV) < 0) return -1;
+    if (cmd_wait(sn) < 0) return -1;
+
+    return len;
 }
 
 /**
- * Close socket
+ * Free space in the socket TX buffer
  */
-int close_socket(uint8_t sn)
+uint16_t get_socket_tx_free(uint8_t sn)
 {
-    // Send CLOSE command
-    W5500_WRITE_REG(W5500_Sn_CR(sn), W5500_CR_CLOSE);
+    return read_reg16_stable(W5500_Sn_TX_FSR0(sn));
+}
 
-    // Wait for command to complete (max 1 second)
-    uint32_t timeout = HAL_GetTick() + 1000;
-    while (W5500_READ_REG(W5500_Sn_CR(sn)) != 0) {
-        if (HAL_GetTick() > timeout) {
-            return -1;
-        }
-    }
+/**
+ * Bytes waiting in the socket RX buffer
+ */
+uint16_t get_socket_rx_size(uint8_t sn)
+{
+    return read_reg16_stable(W5500_Sn_RX_RSR0(sn));
+}
 
-    // Wait until socket status is CLOSED
-    timeout = HAL_GetTick() + 1000;
-    while (W5500_READ_REG(W5500_Sn_SR(sn)) != W5500_SR_SOCK_CLOSED) {
-        if (HAL_GetTick() > timeout) {
-            return -2;
-        }
-        HAL_Delay(1);
-    }
+/**
+ * Disconnect socket
+ */
+int disconnect_socket(uint8_t sn)
+{
+    // Send DISCON command, the poll escalates to CLOSE if the peer stalls
+    return socket_cmd_start(sn, SOCK_CMD_DISCON);
+}
 
-    // Clear interrupt flags
-    W5500_WRITE_REG(W5500_Sn_IR(sn), 0xFF);
+/**
+ * Close socket
+ */
+int close_socket(uint8_t sn)
+{
+    if (socket_cmd_start(sn, SOCK_CMD_CLOSE) < 0) return -1;
+    if (cmd_wait(sn) < 0) return -2;
 
     return 0;
 }
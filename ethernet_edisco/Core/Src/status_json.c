@@ -0,0 +1,87 @@
+/* status_json.c - proto_ver 1 /status and /events documents
+ *
+ * Positions stay in the receiver's 1e-7 degree integers and ages in
+ * milliseconds up to the writer, which prints them as fixed point in the
+ * proto_ver 1 precision: 6 decimals for lat/lon, 1 for ages.
+ */
+
+#include "status_json.h"
+#include <math.h>
+#include <stddef.h>
+
+#define AGE_NEVER_TENTHS    9999    // Shown as 999.9 s
+
+static const char* const env_keys[4] = { "t_c", "p_hpa", "rh_pct", "lux" };
+
+// Seconds with one decimal, as printf("%.1f") showed the float seconds
+// proto_ver 1 was written with: the decimal value of the float, exact binary
+// ties to even. Only the division is floating point (single, in hardware).
+static int32_t age_tenths(uint32_t age_ms) {
+    if (age_ms == STATUS_AGE_NEVER) return AGE_NEVER_TENTHS;
+    if (age_ms == 0) return 0;
+
+    // s = m * 2^(e - 24) with a 24-bit integer m; 0.001 <= s < 2^23, so
+    // the shift is 1..33
+    int e;
+    float s = (float)age_ms / 1000.0f;
+    uint32_t m = (uint32_t)ldexpf(frexpf(s, &e), 24);
+    uint8_t shift = 24 - e;
+
+    // Tenths are 10 * m >> shift, the bits shifted out decide the rounding
+    uint64_t t = (uint64_t)m * 10;
+    uint64_t half = 1ull << (shift - 1);
+    uint64_t rem = t & ((half << 1) - 1);
+    uint32_t q = t >> shift;
+    if (rem > half || (rem == half && (q & 1))) q++;
+    return q;
+}
+
+void status_json_readings(json_writer_t* w, const status_readings_t* r) {
+    const gps_pos_t* p = r->pos;
+    char time_str[32];
+    format_utc_time(p->year, p->month, p->day, p->hour, p->min, p->sec,
+                    time_str, sizeof(time_str));
+
+    json_str(w, "time_utc", time_str);
+    json_obj_begin(w, "gps");
+    json_fixed_rounded(w, "lat", p->lat_e7, 7, 6);
+    json_fixed_rounded(w, "lon", p->lon_e7, 7, 6);
+    json_int(w, "fix", p->fix);
+    json_int(w, "sats", p->sats);
+    json_obj_end(w);
+    json_obj_begin(w, "env");
+    for (uint8_t i = 0; i < 4; i++) json_fixed(w, env_keys[i], r->env_tenths[i], 1);
+    json_obj_end(w);
+}
+
+void status_json_fix_quality(json_writer_t* w, const gps_epoch_t* e) {
+    json_obj_begin(w, "fix_quality");
+    json_int(w, "mode", e->fix_mode);
+    json_fixed(w, "pdop", e->pdop, 2);
+    json_fixed(w, "hdop", e->hdop, 2);
+    json_fixed(w, "vdop", e->vdop, 2);
+    if (e->course_cdeg == 0xFFFF) json_null(w, "course_deg");
+    else json_fixed(w, "course_deg", e->course_cdeg, 2);
+    json_fixed(w, "speed_mps", e->speed_cms, 2);
+    json_int(w, "in_view", e->in_view);
+    json_int(w, "used", e->used_count);
+    json_obj_end(w);
+}
+
+uint16_t status_json(char* buf, uint16_t size, const status_readings_t* r,
+                     const gps_epoch_t* e, uint32_t gps_age_ms, uint32_t env_age_ms) {
+    json_writer_t w;
+    json_init(&w, buf, size);
+    json_obj_begin(&w, NULL);
+    json_int(&w, "proto_ver", 1);
+    json_str(&w, "device_id", "bp-411-0007");
+    status_json_readings(&w, r);
+    status_json_fix_quality(&w, e);
+    json_obj_begin(&w, "stale_age_s");
+    json_fixed(&w, "gps", age_tenths(gps_age_ms), 1);
+    json_fixed(&w, "env", age_tenths(env_age_ms), 1);
+    json_obj_end(&w);
+    json_obj_end(&w);
+
+    return w.overflow ? 0 : json_len(&w);
+}
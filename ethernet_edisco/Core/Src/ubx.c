@@ -0,0 +1,395 @@
+/* ubx.c - u-blox UBX protocol: receiver setup and NAV-PVT input
+ *
+ * The receiver starts in its default NMEA mode at 9600 baud. ubx_process()
+ * then, without blocking:
+ *
+ *   1. enables NAV-PVT (CFG-MSG) and waits for ACK-ACK, which also proves
+ *      the receiver speaks UBX; no answer or a NAK keeps NMEA,
+ *   2. switches the receiver port to UBX_BAUD with UBX-only output (CFG-PRT,
+ *      its ACK is lost in the speed change) and follows with USART1,
+ *   3. sets the navigation rate (CFG-RATE), whose ACK confirms the new speed.
+ *
+ * If step 3 or later NAV-PVT reception fails, the rate, message and port
+ * settings are reverted (sent blind at UBX_BAUD) and USART1 returns to
+ * 9600, so the NMEA path takes over again. A receiver that was running UBX
+ * and went silent (power cycled: settings are in its RAM) is probed again.
+ *
+ * Frames are parsed byte by byte from the UART interrupt with the Fletcher
+ * checksum; NAV-PVT fills the same gps_pos_t, time reference and epoch
+ * snapshot as RMC/GGA.
+ */
+
+#include "ubx.h"
+#include "gps.h"
+#include <string.h>
+
+#define UBX_SYNC1           0xB5
+#define UBX_SYNC2           0x62
+
+#define UBX_CLASS_NAV       0x01
+#define UBX_CLASS_ACK       0x05
+#define UBX_CLASS_CFG       0x06
+#define UBX_NAV_PVT         0x07
+#define UBX_ACK_NAK         0x00
+#define UBX_ACK_ACK         0x01
+#define UBX_CFG_PRT         0x00
+#define UBX_CFG_MSG         0x01
+#define UBX_CFG_RATE        0x08
+
+#define UBX_PVT_LEN         92
+#define UBX_PROTO_UBX       0x01
+#define UBX_PROTO_NMEA      0x02
+
+typedef enum {
+    ST_DISABLED = 0,
+    ST_NMEA,            // Final: NMEA input
+    ST_BOOT,            // Waiting UBX_START_DELAY_MS
+    ST_PROBE,           // CFG-MSG (NAV-PVT on) sent at 9600
+    ST_PORT,            // CFG-PRT sent, switch USART1 once it is out
+    ST_RATE,            // CFG-RATE sent at UBX_BAUD
+    ST_RUN,
+    ST_REVERT           // Restoring the receiver defaults
+} ubx_state_t;
+
+/* Frame parser (interrupt) */
+typedef enum {
+    RX_SYNC1 = 0, RX_SYNC2, RX_CLASS, RX_ID, RX_LEN1, RX_LEN2, RX_PAYLOAD, RX_CK_A, RX_CK_B
+} ubx_rx_state_t;
+
+static ubx_rx_state_t rx_state = RX_SYNC1;
+static uint8_t rx_class, rx_id;
+static uint16_t rx_len, rx_pos;
+static uint8_t rx_ck_a, rx_ck_b;
+static uint8_t rx_buf[UBX_MAX_PAYLOAD];
+static uint32_t rx_cyc;             // DWT->CYCCNT at the first sync byte
+static uint32_t byte_cyc = 0;       // Cycles per character at the current speed
+
+/* Interrupt -> main loop */
+static volatile uint8_t ack_new = 0;
+static volatile uint8_t ack_ok, ack_class, ack_id;
+static volatile uint8_t pvt_new = 0;
+static volatile uint8_t pos_new = 0;
+
+/* Configuration (main loop) */
+static UART_HandleTypeDef* uart = NULL;
+static ubx_set_baud_t set_baud = NULL;
+static ubx_state_t state = ST_DISABLED;
+static uint32_t state_ms = 0;
+static uint8_t tries = 0;
+static uint8_t revert_step = 0;
+static uint8_t was_running = 0;
+static uint8_t tx_buf[8 + 20];      // Largest command: CFG-PRT
+static ubx_stats_t stats;
+
+static uint16_t get_u16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t get_u32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static void put_u16(uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put_u32(uint8_t* p, uint32_t v) { put_u16(p, v); put_u16(p + 2, v >> 16); }
+
+static void speed(uint32_t baud) {
+    byte_cyc = SystemCoreClock / baud * 10;  // 8N1
+    set_baud(baud);
+}
+
+/* --- Receiving --- */
+
+static void handle_pvt(const uint8_t* p) {
+    uint32_t start = DWT->CYCCNT;
+    uint8_t valid = p[11];
+    uint8_t fix_type = p[20];
+    uint8_t flags = p[21];
+    int year = get_u16(p + 4), month = p[6], day = p[7];
+    int hour = p[8], min = p[9], sec = p[10];
+    int32_t nano = (int32_t)get_u32(p + 16);
+    int ms = nano > 0 ? nano / 1000000 : 0;
+
+    stats.pvt++;
+    pvt_new = 1;
+
+    if ((valid & 0x03) == 0x03) {
+        // validDate and validTime: the solution's own time, for NTP
+        gps_on_new_time(year, month, day, hour, min, sec, ms, rx_cyc);
+    }
+    if ((flags & 0x01) && fix_type >= 2 && fix_type <= 4) {
+        // Same meaning as GGA fix quality: 1 GNSS, 2 differential
+        uint8_t quality = (flags & 0x02) ? 2 : 1;
+        gps_on_new_position((int32_t)get_u32(p + 28), (int32_t)get_u32(p + 24),
+                            quality, p[23], year, month, day, hour, min, sec);
+        pos_new = 1;
+    }
+
+    gps_epoch_t e;
+    memset(&e, 0, sizeof(e));
+    e.year = year; e.month = month; e.day = day;
+    e.hour = hour; e.min = min; e.sec = sec; e.ms = ms;
+    e.fix_mode = (fix_type >= 2 && fix_type <= 4) ? (fix_type == 2 ? 2 : 3) : 1;
+    e.pdop = get_u16(p + 76);
+    int32_t speed_mms = (int32_t)get_u32(p + 60);
+    int32_t head = (int32_t)get_u32(p + 64);   // 1e-5 deg
+    e.speed_cms = speed_mms > 0 ? speed_mms / 10 : 0;
+    e.course_cdeg = (head >= 0 && head < 36000000) ? head / 1000 : 0xFFFF;
+    e.used_count = p[23];
+    e.parse_us = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000);
+    gps_on_epoch(&e);
+}
+
+static void handle_frame(void) {
+    stats.frames++;
+    if (rx_class == UBX_CLASS_NAV && rx_id == UBX_NAV_PVT && rx_len == UBX_PVT_LEN) {
+        handle_pvt(rx_buf);
+    } else if (rx_class == UBX_CLASS_ACK && rx_len == 2) {
+        ack_class = rx_buf[0];
+        ack_id = rx_buf[1];
+        ack_ok = (rx_id == UBX_ACK_ACK);
+        ack_new = 1;
+    }
+}
+
+static void push_byte(uint8_t c, uint32_t cyc) {
+    switch (rx_state) {
+        case RX_SYNC1:
+            if (c == UBX_SYNC1) {
+                rx_cyc = cyc;
+                rx_state = RX_SYNC2;
+            }
+            return;
+        case RX_SYNC2:
+            rx_state = (c == UBX_SYNC2) ? RX_CLASS : (c == UBX_SYNC1 ? RX_SYNC2 : RX_SYNC1);
+            if (c == UBX_SYNC1) rx_cyc = cyc;
+            return;
+        case RX_CK_A:
+            rx_state = (c == rx_ck_a) ? RX_CK_B : RX_SYNC1;
+            if (rx_state == RX_SYNC1) stats.checksum_failed++;
+            return;
+        case RX_CK_B:
+            rx_state = RX_SYNC1;
+            if (c != rx_ck_b) stats.checksum_failed++;
+            else handle_frame();
+            return;
+        default:
+            break;
+    }
+
+    // Class, id, length and payload are covered by the checksum
+    rx_ck_a += c;
+    rx_ck_b += rx_ck_a;
+    switch (rx_state) {
+        case RX_CLASS:
+            rx_class = c;
+            rx_ck_a = c;
+            rx_ck_b = c;
+            rx_state = RX_ID;
+            break;
+        case RX_ID:
+            rx_id = c;
+            rx_state = RX_LEN1;
+            break;
+        case RX_LEN1:
+            rx_len = c;
+            rx_state = RX_LEN2;
+            break;
+        case RX_LEN2:
+            rx_len |= (uint16_t)c << 8;
+            rx_pos = 0;
+            if (rx_len > UBX_MAX_PAYLOAD) {
+                // Not one we decode (or a corrupt length): look for the next sync
+                stats.too_long++;
+                rx_state = RX_SYNC1;
+            } else {
+                rx_state = rx_len ? RX_PAYLOAD : RX_CK_A;
+            }
+            break;
+        case RX_PAYLOAD:
+            rx_buf[rx_pos] = c;
+            if (++rx_pos == rx_len) rx_state = RX_CK_A;
+            break;
+        default:
+            break;
+    }
+}
+
+void ubx_push_chunk(const uint8_t* buf, size_t len) {
+    uint32_t now = DWT->CYCCNT;
+    for (size_t i = 0; i < len; i++) {
+        push_byte(buf[i], now - (uint32_t)(len - i) * byte_cyc);
+    }
+}
+
+/* --- Commands --- */
+
+/* Queue one frame, -1 while the previous one is still going out */
+static int send(uint8_t cls, uint8_t id, const uint8_t* payload, uint16_t len) {
+    if (uart->gState != HAL_UART_STATE_READY || len + 8 > sizeof(tx_buf)) return -1;
+
+    tx_buf[0] = UBX_SYNC1;
+    tx_buf[1] = UBX_SYNC2;
+    tx_buf[2] = cls;
+    tx_buf[3] = id;
+    put_u16(tx_buf + 4, len);
+    memcpy(tx_buf + 6, payload, len);
+
+    uint8_t a = 0, b = 0;
+    for (uint16_t i = 2; i < 6 + len; i++) {
+        a += tx_buf[i];
+        b += a;
+    }
+    tx_buf[6 + len] = a;
+    tx_buf[7 + len] = b;
+    return HAL_UART_Transmit_IT(uart, tx_buf, len + 8) == HAL_OK ? 0 : -1;
+}
+
+static int send_cfg_msg(uint8_t cls, uint8_t id, uint8_t rate) {
+    uint8_t p[3] = { cls, id, rate };
+    return send(UBX_CLASS_CFG, UBX_CFG_MSG, p, sizeof(p));
+}
+
+static int send_cfg_prt(uint32_t baud, uint16_t out_proto) {
+    uint8_t p[20];
+    memset(p, 0, sizeof(p));
+    p[0] = 1;                                   // UART1
+    put_u32(p + 4, 0x000008D0);                 // 8N1
+    put_u32(p + 8, baud);
+    put_u16(p + 12, UBX_PROTO_UBX | UBX_PROTO_NMEA);
+    put_u16(p + 14, out_proto);
+    return send(UBX_CLASS_CFG, UBX_CFG_PRT, p, sizeof(p));
+}
+
+static int send_cfg_rate(uint16_t ms) {
+    uint8_t p[6];
+    put_u16(p, ms);
+    put_u16(p + 2, 1);                          // One solution per measurement
+    put_u16(p + 4, 1);                          // Aligned to GPS time
+    return send(UBX_CLASS_CFG, UBX_CFG_RATE, p, sizeof(p));
+}
+
+/* ACK or NAK for a CFG message: 1 / 0, -1 if none arrived */
+static int take_ack(uint8_t id) {
+    if (!ack_new) return -1;
+    ack_new = 0;
+    if (ack_class != UBX_CLASS_CFG || ack_id != id) return -1;
+    return ack_ok;
+}
+
+static void enter(ubx_state_t s, uint32_t now) {
+    state = s;
+    state_ms = now;
+    tries = 0;
+}
+
+static void fall_back(uint32_t now) {
+    stats.fallbacks++;
+    revert_step = 0;
+    enter(ST_REVERT, now);
+}
+
+/* --- API --- */
+
+void ubx_init(UART_HandleTypeDef* huart, ubx_set_baud_t cb) {
+    uart = huart;
+    set_baud = cb;
+    byte_cyc = SystemCoreClock / UBX_NMEA_BAUD * 10;
+    memset(&stats, 0, sizeof(stats));
+    was_running = 0;
+    enter(UBX_ENABLE ? ST_BOOT : ST_DISABLED, HAL_GetTick());
+}
+
+int ubx_process(void) {
+    uint32_t now = HAL_GetTick();
+    uint32_t elapsed = now - state_ms;
+    int ack;
+
+    switch (state) {
+        case ST_BOOT:
+            if (elapsed < UBX_START_DELAY_MS) break;
+            ack_new = 0;
+            if (send_cfg_msg(UBX_CLASS_NAV, UBX_NAV_PVT, 1) == 0) enter(ST_PROBE, now);
+            break;
+
+        case ST_PROBE:
+            ack = take_ack(UBX_CFG_MSG);
+            if (ack == 1) {
+                if (send_cfg_prt(UBX_BAUD, UBX_PROTO_UBX) == 0) enter(ST_PORT, now);
+            } else if (ack == 0) {
+                enter(ST_NMEA, now);            // UBX, but no NAV-PVT (u-blox 6)
+            } else if (elapsed >= UBX_ACK_TIMEOUT_MS) {
+                if (tries + 1 >= UBX_RETRIES) {
+                    enter(ST_NMEA, now);        // Not a u-blox receiver
+                } else if (send_cfg_msg(UBX_CLASS_NAV, UBX_NAV_PVT, 1) == 0) {
+                    tries++;
+                    state_ms = now;
+                }
+            }
+            break;
+
+        case ST_PORT:
+            // The receiver changes speed right after the frame; give it a moment
+            if (uart->gState != HAL_UART_STATE_READY || elapsed < 50) break;
+            speed(UBX_BAUD);
+            ack_new = 0;
+            if (send_cfg_rate(UBX_RATE_MS) == 0) enter(ST_RATE, now);
+            break;
+
+        case ST_RATE:
+            ack = take_ack(UBX_CFG_RATE);
+            if (ack == 1) {
+                was_running = 1;
+                pvt_new = 0;
+                enter(ST_RUN, now);
+            } else if (ack == 0) {
+                fall_back(now);
+            } else if (elapsed >= UBX_ACK_TIMEOUT_MS) {
+                if (tries + 1 >= UBX_RETRIES) {
+                    fall_back(now);             // Receiver did not follow to UBX_BAUD
+                } else if (send_cfg_rate(UBX_RATE_MS) == 0) {
+                    tries++;
+                    state_ms = now;
+                }
+            }
+            break;
+
+        case ST_RUN:
+            if (pvt_new) {
+                pvt_new = 0;
+                state_ms = now;
+            } else if (elapsed >= UBX_PVT_TIMEOUT_MS) {
+                fall_back(now);
+            }
+            break;
+
+        case ST_REVERT:
+            // Blind at UBX_BAUD: 1 Hz, NAV-PVT off, port back to 9600 NMEA
+            if (revert_step == 0 && send_cfg_rate(1000) == 0) revert_step++;
+            else if (revert_step == 1 && send_cfg_msg(UBX_CLASS_NAV, UBX_NAV_PVT, 0) == 0) revert_step++;
+            else if (revert_step == 2 && send_cfg_prt(UBX_NMEA_BAUD, UBX_PROTO_NMEA) == 0) revert_step++;
+            else if (revert_step == 3 && uart->gState == HAL_UART_STATE_READY) {
+                speed(UBX_NMEA_BAUD);
+                // A receiver that ran UBX before most likely restarted: set it up again
+                enter(was_running ? ST_BOOT : ST_NMEA, now);
+                was_running = 0;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (pos_new) {
+        pos_new = 0;
+        return 1;
+    }
+    return 0;
+}
+
+ubx_mode_t ubx_get_mode(void) {
+    switch (state) {
+        case ST_RUN:      return UBX_MODE_UBX;
+        case ST_DISABLED:
+        case ST_NMEA:     return UBX_MODE_NMEA;
+        default:          return UBX_MODE_CONFIGURING;
+    }
+}
+
+ubx_stats_t ubx_get_stats(void) {
+    return stats;
+}
@@ -1,4 +1,6 @@
 #include "w5500.h"
+#include "main.h"
+#include <string.h>
 
 /* ==== W5500 SPI Frame Format ====
    [Address High] [Address Low] [Control Phase] [Data...]
@@ -21,6 +23,8 @@
 #define BSB_S1_TX_BUF      0x06
 #define BSB_S1_RX_BUF      0x07
 // ... and so on for sockets 2-7
+#define BSB_Sn_TX_BUF(n)   (BSB_S0_TX_BUF + ((n) * 4))
+#define BSB_Sn_RX_BUF(n)   (BSB_S0_RX_BUF + ((n) * 4))
 
 /**
  * Get Block Select Bits based on address
@@ -71,60 +75,132 @@ static uint16_t get_addr_offset(uint16_t addr)
     return addr;
 }
 
+/* ==== DMA state ====
+   Only TX buffer writes go out by DMA, from the caller's buffer; the header
+   is clocked out blocking under the same chip select first. */
+#define W5500_HDR_LEN      3
+
+static volatile uint8_t dma_busy = 0;
+static w5500_dma_done_t dma_done = NULL;
+static void* dma_ctx = NULL;
+
 /**
- * Low-level W5500 write
+ * Build the 3-byte SPI frame header for offset within block bsb
  */
-static void w5500_write(uint16_t addr, const uint8_t* buf, uint16_t len)
+static void w5500_build_header(uint8_t* hdr, uint8_t bsb, uint16_t offset, uint8_t rw)
 {
-    uint8_t bsb = get_bsb(addr);
-    uint16_t offset = get_addr_offset(addr);
+    // Address (16-bit, MSB first) + control byte
+    hdr[0] = (offset >> 8) & 0xFF;
+    hdr[1] = offset & 0xFF;
+    hdr[2] = (bsb << 3) | rw;
+}
 
-    uint8_t control = (bsb << 3) | W5500_WRITE;
+/**
+ * Wait for an in-flight DMA frame, abort it if it hangs
+ */
+static void w5500_dma_wait(void)
+{
+    uint32_t start = HAL_GetTick();
+    while (dma_busy) {
+        if (HAL_GetTick() - start > W5500_DMA_TIMEOUT_MS) {
+            wiz_spi_dma_abort();
+            w5500_dma_complete(-1);
+        }
+    }
+}
 
-    wizchip_select();
+/**
+ * Start a TX buffer write by DMA, done() runs from the completion interrupt
+ */
+int W5500_WRITE_TXBUF_DMA(uint8_t sn, uint16_t offset, const uint8_t* buf, uint16_t len,
+                          w5500_dma_done_t done, void* ctx)
+{
+    uint8_t hdr[W5500_HDR_LEN];
 
-    // Send address (16-bit, MSB first)
-    wiz_spi_writebyte((offset >> 8) & 0xFF);
-    wiz_spi_writebyte(offset & 0xFF);
+    if (len < W5500_DMA_MIN_LEN || len > W5500_DMA_MAX_LEN) return -1;
+    if (dma_busy) return -2;
 
-    // Send control byte
-    wiz_spi_writebyte(control);
+    w5500_build_header(hdr, BSB_Sn_TX_BUF(sn), offset, W5500_WRITE);
+    dma_done = done;
+    dma_ctx = ctx;
+    dma_busy = 1;
 
-    // Send data
-    for (uint16_t i = 0; i < len; i++) {
-        wiz_spi_writebyte(buf[i]);
+    wizchip_select();
+    wiz_spi_writeburst(hdr, W5500_HDR_LEN);
+    if (wiz_spi_dma_start(buf, NULL, len) != 0) {
+        wizchip_deselect();
+        dma_done = NULL;
+        dma_busy = 0;
+        return -3;  // Peripheral busy or DMA error
     }
 
-    wizchip_deselect();
+    return 0;
 }
 
 /**
- * Low-level W5500 read
+ * DMA frame finished (called from interrupt context)
  */
-static void w5500_read(uint16_t addr, uint8_t* buf, uint16_t len)
+void w5500_dma_complete(int status)
 {
-    uint8_t bsb = get_bsb(addr);
-    uint16_t offset = get_addr_offset(addr);
+    w5500_dma_done_t done = dma_done;
 
-    uint8_t control = (bsb << 3) | W5500_READ;
+    if (!dma_busy) return;  // Late interrupt after a timeout abort
 
-    wizchip_select();
+    wizchip_deselect();
+    dma_done = NULL;
+    dma_busy = 0;
+
+    if (done) done(dma_ctx, status);
+}
 
-    // Send address (16-bit, MSB first)
-    wiz_spi_writebyte((offset >> 8) & 0xFF);
-    wiz_spi_writebyte(offset & 0xFF);
+/**
+ * Low-level W5500 write
+ */
+static void w5500_write_block(uint8_t bsb, uint16_t offset, const uint8_t* buf, uint16_t len)
+{
+    uint8_t frame[W5500_HDR_LEN + W5500_DMA_MIN_LEN];
 
-    // Send control byte
-    wiz_spi_writebyte(control);
+    w5500_dma_wait();
+    w5500_build_header(frame, bsb, offset, W5500_WRITE);
 
-    // Read data
-    for (uint16_t i = 0; i < len; i++) {
-        buf[i] = wiz_spi_readbyte();
+    // Short frames go out as a single burst
+    wizchip_select();
+    if (len <= W5500_DMA_MIN_LEN) {
+        memcpy(&frame[W5500_HDR_LEN], buf, len);
+        wiz_spi_writeburst(frame, W5500_HDR_LEN + len);
+    } else {
+        wiz_spi_writeburst(frame, W5500_HDR_LEN);
+        wiz_spi_writeburst(buf, len);
     }
+    wizchip_deselect();
+}
 
+/**
+ * Low-level W5500 read
+ */
+static void w5500_read_block(uint8_t bsb, uint16_t offset, uint8_t* buf, uint16_t len)
+{
+    uint8_t hdr[W5500_HDR_LEN];
+
+    w5500_dma_wait();
+    w5500_build_header(hdr, bsb, offset, W5500_READ);
+
+    wizchip_select();
+    wiz_spi_writeburst(hdr, W5500_HDR_LEN);
+    wiz_spi_readburst(buf, len);
     wizchip_deselect();
 }
 
+static void w5500_write(uint16_t addr, const uint8_t* buf, uint16_t len)
+{
+    w5500_write_block(get_bsb(addr), get_addr_offset(addr), buf, len);
+}
+
+static void w5500_read(uint16_t addr, uint8_t* buf, uint16_t len)
+{
+    w5500_read_block(get_bsb(addr), get_addr_offset(addr), buf, len);
+}
+
 /* ===== Public API ===== */
 
 uint8_t W5500_READ_REG(uint16_t addr)
@@ -155,3 +231,13 @@ void W5500_READ_BUF(uint16_t addr, uint8_t* buf, uint16_t len)
 {
     w5500_read(addr, buf, len);
 }
+
+void W5500_WRITE_TXBUF(uint8_t sn, uint16_t offset, const uint8_t* buf, uint16_t len)
+{
+    w5500_write_block(BSB_Sn_TX_BUF(sn), offset, buf, len);
+}
+
+void W5500_READ_RXBUF(uint8_t sn, uint16_t offset, uint8_t* buf, uint16_t len)
+{
+    w5500_read_block(BSB_Sn_RX_BUF(sn), offset, buf, len);
+}
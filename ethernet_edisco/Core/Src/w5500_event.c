@@ -0,0 +1,101 @@
+/*
+ * w5500_event.c - interrupt-driven socket event dispatch
+ *
+ * The W5500 pulls INTn low while any unmasked Sn_IR bit is set. The EXTI
+ * handler only raises a flag, the SPI work happens in w5500_event_process()
+ * from the main loop so it never collides with a transfer in progress.
+ */
+
+#include "w5500_event.h"
+#include "w5500.h"
+#include "main.h"
+#include <string.h>
+
+typedef struct {
+    w5500_event_cb_t cb;
+    uint8_t mask;
+} w5500_event_slot_t;
+
+static w5500_event_slot_t slots[8];
+static uint8_t simr = 0;
+static volatile uint8_t irq_pending = 0;
+static volatile uint32_t irq_count = 0;
+static volatile uint32_t irq_cyc = 0;     // DWT->CYCCNT at the last edge
+
+void w5500_event_init(void)
+{
+    memset(slots, 0, sizeof(slots));
+    simr = 0;
+
+    W5500_WRITE_REG(W5500_IMR, 0x00);   // No common (IP conflict/unreachable) interrupts
+    W5500_WRITE_REG(W5500_SIMR, 0x00);
+    for (uint8_t sn = 0; sn < 8; sn++) {
+        W5500_WRITE_REG(W5500_Sn_IMR(sn), 0x00);
+        W5500_WRITE_REG(W5500_Sn_IR(sn), 0xFF);
+    }
+
+    // Catch anything that was already pending before the edge detector was armed
+    irq_pending = 1;
+}
+
+void w5500_event_register(uint8_t sn, uint8_t mask, w5500_event_cb_t cb)
+{
+    if (sn >= 8) return;
+
+    if (cb == NULL) mask = 0;
+    slots[sn].cb = cb;
+    slots[sn].mask = mask;
+
+    if (mask) simr |= (1 << sn);
+    else      simr &= ~(1 << sn);
+
+    W5500_WRITE_REG(W5500_Sn_IMR(sn), mask);
+    W5500_WRITE_REG(W5500_SIMR, simr);
+}
+
+void w5500_event_irq(void)
+{
+    irq_cyc = DWT->CYCCNT;
+    irq_pending = 1;
+    irq_count++;
+}
+
+int w5500_event_process(void)
+{
+    if (!irq_pending) return 0;
+    irq_pending = 0;
+
+    int handled = 0;
+    uint8_t sir = W5500_READ_REG(W5500_SIR) & simr;
+
+    for (uint8_t sn = 0; sir; sn++, sir >>= 1) {
+        if (!(sir & 0x01)) continue;
+
+        // Only clear the bits we own: SENDOK is polled by socket.c
+        uint8_t ir = W5500_READ_REG(W5500_Sn_IR(sn)) & slots[sn].mask;
+        if (ir) W5500_WRITE_REG(W5500_Sn_IR(sn), ir);  // Write-1-to-clear
+
+        if (ir && slots[sn].cb) {
+            slots[sn].cb(sn, ir);
+            handled++;
+        }
+    }
+
+    // EXTI is edge triggered: if a new event arrived while we were clearing,
+    // INTn is still low and no further edge will come, so go round again.
+    if (HAL_GPIO_ReadPin(W5500_INT_GPIO_Port, W5500_INT_Pin) == GPIO_PIN_RESET) {
+        irq_pending = 1;
+    }
+
+    return handled;
+}
+
+uint32_t w5500_event_irq_count(void)
+{
+    return irq_count;
+}
+
+uint32_t w5500_event_irq_cycles(void)
+{
+    return irq_cyc;
+}
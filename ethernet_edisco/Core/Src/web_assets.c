@@ -0,0 +1,322 @@
+/* web_assets.c - generated by tools/gen_assets.py from web/, do not edit */
+
+#include "web_assets.h"
+
+static const uint8_t index_html_raw[3481] = {
+    0x3c, 0x21, 0x44, 0x4f, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a,
+    0x3c, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a, 0x3c, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x0a, 0x3c, 0x6d,
+    0x65, 0x74, 0x61, 0x20, 0x63, 0x68, 0x61, 0x72, 0x73, 0x65, 0x74, 0x3d, 0x27, 0x55, 0x54, 0x46,
+    0x2d, 0x38, 0x27, 0x3e, 0x0a, 0x3c, 0x6d, 0x65, 0x74, 0x61, 0x20, 0x6e, 0x61, 0x6d, 0x65, 0x3d,
+    0x27, 0x76, 0x69, 0x65, 0x77, 0x70, 0x6f, 0x72, 0x74, 0x27, 0x20, 0x63, 0x6f, 0x6e, 0x74, 0x65,
+    0x6e, 0x74, 0x3d, 0x27, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3d, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65,
+    0x2d, 0x77, 0x69, 0x64, 0x74, 0x68, 0x2c, 0x69, 0x6e, 0x69, 0x74, 0x69, 0x61, 0x6c, 0x2d, 0x73,
+    0x63, 0x61, 0x6c, 0x65, 0x3d, 0x31, 0x27, 0x3e, 0x0a, 0x3c, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e,
+    0x53, 0x54, 0x4d, 0x33, 0x32, 0x20, 0x4e, 0x65, 0x74, 0x77, 0x6f, 0x72, 0x6b, 0x20, 0x50, 0x61,
+    0x6e, 0x65, 0x6c, 0x3c, 0x2f, 0x74, 0x69, 0x74, 0x6c, 0x65, 0x3e, 0x0a, 0x3c, 0x73, 0x74, 0x79,
+    0x6c, 0x65, 0x3e, 0x62, 0x6f, 0x64, 0x79, 0x7b, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x66, 0x61, 0x6d,
+    0x69, 0x6c, 0x79, 0x3a, 0x41, 0x72, 0x69, 0x61, 0x6c, 0x2c, 0x73, 0x61, 0x6e, 0x73, 0x2d, 0x73,
+    0x65, 0x72, 0x69, 0x66, 0x3b, 0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x3a,
+    0x23, 0x66, 0x30, 0x66, 0x30, 0x66, 0x30, 0x3b, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x3a, 0x30,
+    0x3b, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x32, 0x30, 0x70, 0x78, 0x3b, 0x7d, 0x68,
+    0x31, 0x7b, 0x74, 0x65, 0x78, 0x74, 0x2d, 0x61, 0x6c, 0x69, 0x67, 0x6e, 0x3a, 0x63, 0x65, 0x6e,
+    0x74, 0x65, 0x72, 0x3b, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x23, 0x33, 0x33, 0x33, 0x3b, 0x7d,
+    0x2e, 0x63, 0x6f, 0x6e, 0x74, 0x61, 0x69, 0x6e, 0x65, 0x72, 0x7b, 0x6d, 0x61, 0x78, 0x2d, 0x77,
+    0x69, 0x64, 0x74, 0x68, 0x3a, 0x38, 0x30, 0x30, 0x70, 0x78, 0x3b, 0x6d, 0x61, 0x72, 0x67, 0x69,
+    0x6e, 0x3a, 0x30, 0x20, 0x61, 0x75, 0x74, 0x6f, 0x3b, 0x7d, 0x2e, 0x63, 0x61, 0x72, 0x64, 0x7b,
+    0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x3a, 0x77, 0x68, 0x69, 0x74, 0x65,
+    0x3b, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a, 0x38,
+    0x70, 0x78, 0x3b, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x32, 0x30, 0x70, 0x78, 0x3b,
+    0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x3a, 0x31, 0x35, 0x70, 0x78, 0x20, 0x30, 0x3b, 0x62, 0x6f,
+    0x78, 0x2d, 0x73, 0x68, 0x61, 0x64, 0x6f, 0x77, 0x3a, 0x30, 0x20, 0x32, 0x70, 0x78, 0x20, 0x38,
+    0x70, 0x78, 0x20, 0x72, 0x67, 0x62, 0x61, 0x28, 0x30, 0x2c, 0x30, 0x2c, 0x30, 0x2c, 0x30, 0x2e,
+    0x31, 0x29, 0x3b, 0x7d, 0x2e, 0x63, 0x61, 0x72, 0x64, 0x20, 0x68, 0x32, 0x7b, 0x6d, 0x61, 0x72,
+    0x67, 0x69, 0x6e, 0x2d, 0x74, 0x6f, 0x70, 0x3a, 0x30, 0x3b, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a,
+    0x23, 0x30, 0x30, 0x37, 0x42, 0x46, 0x46, 0x3b, 0x62, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x2d, 0x62,
+    0x6f, 0x74, 0x74, 0x6f, 0x6d, 0x3a, 0x32, 0x70, 0x78, 0x20, 0x73, 0x6f, 0x6c, 0x69, 0x64, 0x20,
+    0x23, 0x30, 0x30, 0x37, 0x42, 0x46, 0x46, 0x3b, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6e, 0x67, 0x2d,
+    0x62, 0x6f, 0x74, 0x74, 0x6f, 0x6d, 0x3a, 0x31, 0x30, 0x70, 0x78, 0x3b, 0x7d, 0x2e, 0x72, 0x6f,
+    0x77, 0x7b, 0x64, 0x69, 0x73, 0x70, 0x6c, 0x61, 0x79, 0x3a, 0x66, 0x6c, 0x65, 0x78, 0x3b, 0x6a,
+    0x75, 0x73, 0x74, 0x69, 0x66, 0x79, 0x2d, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3a, 0x73,
+    0x70, 0x61, 0x63, 0x65, 0x2d, 0x62, 0x65, 0x74, 0x77, 0x65, 0x65, 0x6e, 0x3b, 0x6d, 0x61, 0x72,
+    0x67, 0x69, 0x6e, 0x3a, 0x31, 0x30, 0x70, 0x78, 0x20, 0x30, 0x3b, 0x7d, 0x2e, 0x6c, 0x61, 0x62,
+    0x65, 0x6c, 0x7b, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x77, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3a, 0x62,
+    0x6f, 0x6c, 0x64, 0x3b, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x23, 0x35, 0x35, 0x35, 0x3b, 0x7d,
+    0x2e, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x7b, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x73, 0x69, 0x7a, 0x65,
+    0x3a, 0x31, 0x2e, 0x33, 0x65, 0x6d, 0x3b, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x23, 0x30, 0x30,
+    0x37, 0x42, 0x46, 0x46, 0x3b, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x77, 0x65, 0x69, 0x67, 0x68, 0x74,
+    0x3a, 0x62, 0x6f, 0x6c, 0x64, 0x3b, 0x7d, 0x2e, 0x73, 0x74, 0x61, 0x6c, 0x65, 0x7b, 0x63, 0x6f,
+    0x6c, 0x6f, 0x72, 0x3a, 0x23, 0x66, 0x66, 0x34, 0x34, 0x34, 0x34, 0x3b, 0x66, 0x6f, 0x6e, 0x74,
+    0x2d, 0x73, 0x69, 0x7a, 0x65, 0x3a, 0x30, 0x2e, 0x38, 0x35, 0x65, 0x6d, 0x3b, 0x66, 0x6f, 0x6e,
+    0x74, 0x2d, 0x77, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3a, 0x62, 0x6f, 0x6c, 0x64, 0x3b, 0x7d, 0x2e,
+    0x62, 0x61, 0x64, 0x67, 0x65, 0x7b, 0x64, 0x69, 0x73, 0x70, 0x6c, 0x61, 0x79, 0x3a, 0x69, 0x6e,
+    0x6c, 0x69, 0x6e, 0x65, 0x2d, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x3b, 0x70, 0x61, 0x64, 0x64, 0x69,
+    0x6e, 0x67, 0x3a, 0x33, 0x70, 0x78, 0x20, 0x38, 0x70, 0x78, 0x3b, 0x62, 0x6f, 0x72, 0x64, 0x65,
+    0x72, 0x2d, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3a, 0x34, 0x70, 0x78, 0x3b, 0x66, 0x6f, 0x6e,
+    0x74, 0x2d, 0x73, 0x69, 0x7a, 0x65, 0x3a, 0x30, 0x2e, 0x38, 0x65, 0x6d, 0x3b, 0x66, 0x6f, 0x6e,
+    0x74, 0x2d, 0x77, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3a, 0x62, 0x6f, 0x6c, 0x64, 0x3b, 0x7d, 0x2e,
+    0x66, 0x69, 0x78, 0x2d, 0x6f, 0x6b, 0x7b, 0x62, 0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e,
+    0x64, 0x3a, 0x23, 0x30, 0x30, 0x61, 0x61, 0x30, 0x30, 0x3b, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a,
+    0x77, 0x68, 0x69, 0x74, 0x65, 0x3b, 0x7d, 0x2e, 0x66, 0x69, 0x78, 0x2d, 0x6e, 0x6f, 0x7b, 0x62,
+    0x61, 0x63, 0x6b, 0x67, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x3a, 0x23, 0x66, 0x66, 0x34, 0x34, 0x34,
+    0x34, 0x3b, 0x63, 0x6f, 0x6c, 0x6f, 0x72, 0x3a, 0x77, 0x68, 0x69, 0x74, 0x65, 0x3b, 0x7d, 0x23,
+    0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x7b, 0x74, 0x65, 0x78, 0x74, 0x2d, 0x61,
+    0x6c, 0x69, 0x67, 0x6e, 0x3a, 0x63, 0x65, 0x6e, 0x74, 0x65, 0x72, 0x3b, 0x63, 0x6f, 0x6c, 0x6f,
+    0x72, 0x3a, 0x23, 0x38, 0x38, 0x38, 0x3b, 0x66, 0x6f, 0x6e, 0x74, 0x2d, 0x73, 0x69, 0x7a, 0x65,
+    0x3a, 0x30, 0x2e, 0x39, 0x65, 0x6d, 0x3b, 0x6d, 0x61, 0x72, 0x67, 0x69, 0x6e, 0x2d, 0x74, 0x6f,
+    0x70, 0x3a, 0x31, 0x30, 0x70, 0x78, 0x3b, 0x7d, 0x3c, 0x2f, 0x73, 0x74, 0x79, 0x6c, 0x65, 0x3e,
+    0x0a, 0x3c, 0x2f, 0x68, 0x65, 0x61, 0x64, 0x3e, 0x0a, 0x3c, 0x62, 0x6f, 0x64, 0x79, 0x3e, 0x0a,
+    0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x63, 0x6f, 0x6e, 0x74,
+    0x61, 0x69, 0x6e, 0x65, 0x72, 0x27, 0x3e, 0x0a, 0x3c, 0x68, 0x31, 0x3e, 0x53, 0x54, 0x4d, 0x33,
+    0x32, 0x20, 0x44, 0x65, 0x76, 0x69, 0x63, 0x65, 0x20, 0x53, 0x74, 0x61, 0x74, 0x75, 0x73, 0x3c,
+    0x2f, 0x68, 0x31, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d,
+    0x27, 0x63, 0x61, 0x72, 0x64, 0x27, 0x3e, 0x0a, 0x3c, 0x68, 0x32, 0x3e, 0x47, 0x50, 0x53, 0x20,
+    0x50, 0x6f, 0x73, 0x69, 0x74, 0x69, 0x6f, 0x6e, 0x3c, 0x2f, 0x68, 0x32, 0x3e, 0x0a, 0x3c, 0x64,
+    0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x72, 0x6f, 0x77, 0x27, 0x3e, 0x0a,
+    0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x6c, 0x61, 0x62,
+    0x65, 0x6c, 0x27, 0x3e, 0x4c, 0x61, 0x74, 0x69, 0x74, 0x75, 0x64, 0x65, 0x3a, 0x3c, 0x2f, 0x73,
+    0x70, 0x61, 0x6e, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x69, 0x64, 0x3d, 0x27, 0x6c,
+    0x61, 0x74, 0x27, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x76, 0x61, 0x6c, 0x75, 0x65,
+    0x27, 0x3e, 0x2d, 0x2d, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e, 0x3e, 0x0a, 0x3c, 0x2f, 0x64, 0x69,
+    0x76, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x72,
+    0x6f, 0x77, 0x27, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73,
+    0x3d, 0x27, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x27, 0x3e, 0x4c, 0x6f, 0x6e, 0x67, 0x69, 0x74, 0x75,
+    0x64, 0x65, 0x3a, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e,
+    0x20, 0x69, 0x64, 0x3d, 0x27, 0x6c, 0x6f, 0x6e, 0x27, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d,
+    0x27, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x27, 0x3e, 0x2d, 0x2d, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e,
+    0x3e, 0x0a, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c,
+    0x61, 0x73, 0x73, 0x3d, 0x27, 0x72, 0x6f, 0x77, 0x27, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e,
+    0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x27, 0x3e, 0x46,
+    0x69, 0x78, 0x20, 0x53, 0x74, 0x61, 0x74, 0x75, 0x73, 0x3a, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e,
+    0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x69, 0x64, 0x3d, 0x27, 0x66, 0x69, 0x78, 0x27,
+    0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x62, 0x61, 0x64, 0x67, 0x65, 0x20, 0x66, 0x69,
+    0x78, 0x2d, 0x6e, 0x6f, 0x27, 0x3e, 0x4e, 0x4f, 0x20, 0x46, 0x49, 0x58, 0x3c, 0x2f, 0x73, 0x70,
+    0x61, 0x6e, 0x3e, 0x0a, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20,
+    0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x72, 0x6f, 0x77, 0x27, 0x3e, 0x0a, 0x3c, 0x73, 0x70,
+    0x61, 0x6e, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x27,
+    0x3e, 0x53, 0x61, 0x74, 0x65, 0x6c, 0x6c, 0x69, 0x74, 0x65, 0x73, 0x3a, 0x3c, 0x2f, 0x73, 0x70,
+    0x61, 0x6e, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x69, 0x64, 0x3d, 0x27, 0x73, 0x61,
+    0x74, 0x73, 0x27, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x76, 0x61, 0x6c, 0x75, 0x65,
+    0x27, 0x3e, 0x2d, 0x2d, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e, 0x3e, 0x0a, 0x3c, 0x2f, 0x64, 0x69,
+    0x76, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x72,
+    0x6f, 0x77, 0x27, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73,
+    0x3d, 0x27, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x27, 0x3e, 0x55, 0x54, 0x43, 0x20, 0x54, 0x69, 0x6d,
+    0x65, 0x3a, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20,
+    0x69, 0x64, 0x3d, 0x27, 0x75, 0x74, 0x63, 0x27, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27,
+    0x76, 0x61, 0x6c, 0x75, 0x65, 0x27, 0x3e, 0x2d, 0x2d, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e, 0x3e,
+    0x0a, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x69, 0x64, 0x3d,
+    0x27, 0x67, 0x70, 0x73, 0x5f, 0x73, 0x74, 0x61, 0x6c, 0x65, 0x27, 0x20, 0x63, 0x6c, 0x61, 0x73,
+    0x73, 0x3d, 0x27, 0x73, 0x74, 0x61, 0x6c, 0x65, 0x27, 0x3e, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e,
+    0x0a, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61,
+    0x73, 0x73, 0x3d, 0x27, 0x63, 0x61, 0x72, 0x64, 0x27, 0x3e, 0x0a, 0x3c, 0x68, 0x32, 0x3e, 0x45,
+    0x6e, 0x76, 0x69, 0x72, 0x6f, 0x6e, 0x6d, 0x65, 0x6e, 0x74, 0x20, 0x53, 0x65, 0x6e, 0x73, 0x6f,
+    0x72, 0x73, 0x3c, 0x2f, 0x68, 0x32, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61,
+    0x73, 0x73, 0x3d, 0x27, 0x72, 0x6f, 0x77, 0x27, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20,
+    0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x27, 0x3e, 0x54, 0x65,
+    0x6d, 0x70, 0x65, 0x72, 0x61, 0x74, 0x75, 0x72, 0x65, 0x3a, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e,
+    0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x69, 0x64, 0x3d, 0x27, 0x74, 0x65, 0x6d, 0x70,
+    0x27, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x27, 0x3e,
+    0x2d, 0x2d, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e, 0x3e, 0x20, 0xc2, 0xb0, 0x43, 0x3c, 0x2f, 0x64,
+    0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27,
+    0x72, 0x6f, 0x77, 0x27, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x63, 0x6c, 0x61, 0x73,
+    0x73, 0x3d, 0x27, 0x6c, 0x61, 0x62, 0x65, 0x6c, 0x27, 0x3e, 0x50, 0x72, 0x65, 0x73, 0x73, 0x75,
+    0x72, 0x65, 0x3a, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e,
+    0x20, 0x69, 0x64, 0x3d, 0x27, 0x70, 0x72, 0x65, 0x73, 0x73, 0x27, 0x20, 0x63, 0x6c, 0x61, 0x73,
+    0x73, 0x3d, 0x27, 0x76, 0x61, 0x6c, 0x75, 0x65, 0x27, 0x3e, 0x2d, 0x2d, 0x3c, 0x2f, 0x73, 0x70,
+    0x61, 0x6e, 0x3e, 0x20, 0x68, 0x50, 0x61, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x64,
+    0x69, 0x76, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x72, 0x6f, 0x77, 0x27, 0x3e, 0x0a,
+    0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x6c, 0x61, 0x62,
+    0x65, 0x6c, 0x27, 0x3e, 0x48, 0x75, 0x6d, 0x69, 0x64, 0x69, 0x74, 0x79, 0x3a, 0x3c, 0x2f, 0x73,
+    0x70, 0x61, 0x6e, 0x3e, 0x0a, 0x3c, 0x73, 0x70, 0x61, 0x6e, 0x20, 0x69, 0x64, 0x3d, 0x27, 0x68,
+    0x75, 0x6d, 0x27, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x76, 0x61, 0x6c, 0x75, 0x65,
+    0x27, 0x3e, 0x2d, 0x2d, 0x3c, 0x2f, 0x73, 0x70, 0x61, 0x6e, 0x3e, 0x20, 0x25, 0x3c, 0x2f, 0x64,
+    0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x69, 0x64, 0x3d, 0x27, 0x65, 0x6e, 0x76,
+    0x5f, 0x73, 0x74, 0x61, 0x6c, 0x65, 0x27, 0x20, 0x63, 0x6c, 0x61, 0x73, 0x73, 0x3d, 0x27, 0x73,
+    0x74, 0x61, 0x6c, 0x65, 0x27, 0x3e, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x2f, 0x64,
+    0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x64, 0x69, 0x76, 0x20, 0x69, 0x64, 0x3d, 0x27, 0x74, 0x69, 0x6d,
+    0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x27, 0x3e, 0x43, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x69,
+    0x6f, 0x6e, 0x20, 0x65, 0x72, 0x72, 0x6f, 0x72, 0x3c, 0x2f, 0x64, 0x69, 0x76, 0x3e, 0x0a, 0x3c,
+    0x2f, 0x64, 0x69, 0x76, 0x3e, 0x0a, 0x3c, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x3e, 0x0a, 0x66,
+    0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x24, 0x28, 0x69, 0x64, 0x29, 0x7b, 0x72, 0x65,
+    0x74, 0x75, 0x72, 0x6e, 0x20, 0x64, 0x6f, 0x63, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x2e, 0x67, 0x65,
+    0x74, 0x45, 0x6c, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x42, 0x79, 0x49, 0x64, 0x28, 0x69, 0x64, 0x29,
+    0x3b, 0x7d, 0x0a, 0x66, 0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x73, 0x68, 0x6f, 0x77,
+    0x28, 0x64, 0x29, 0x7b, 0x0a, 0x24, 0x28, 0x27, 0x6c, 0x61, 0x74, 0x27, 0x29, 0x2e, 0x74, 0x65,
+    0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x64, 0x2e, 0x67, 0x70, 0x73, 0x2e,
+    0x6c, 0x61, 0x74, 0x2e, 0x74, 0x6f, 0x46, 0x69, 0x78, 0x65, 0x64, 0x28, 0x35, 0x29, 0x3b, 0x0a,
+    0x24, 0x28, 0x27, 0x6c, 0x6f, 0x6e, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6f, 0x6e,
+    0x74, 0x65, 0x6e, 0x74, 0x3d, 0x64, 0x2e, 0x67, 0x70, 0x73, 0x2e, 0x6c, 0x6f, 0x6e, 0x2e, 0x74,
+    0x6f, 0x46, 0x69, 0x78, 0x65, 0x64, 0x28, 0x35, 0x29, 0x3b, 0x0a, 0x24, 0x28, 0x27, 0x73, 0x61,
+    0x74, 0x73, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74,
+    0x3d, 0x64, 0x2e, 0x67, 0x70, 0x73, 0x2e, 0x73, 0x61, 0x74, 0x73, 0x3b, 0x0a, 0x24, 0x28, 0x27,
+    0x75, 0x74, 0x63, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e,
+    0x74, 0x3d, 0x64, 0x2e, 0x74, 0x69, 0x6d, 0x65, 0x5f, 0x75, 0x74, 0x63, 0x3b, 0x0a, 0x6c, 0x65,
+    0x74, 0x20, 0x66, 0x69, 0x78, 0x3d, 0x24, 0x28, 0x27, 0x66, 0x69, 0x78, 0x27, 0x29, 0x3b, 0x0a,
+    0x69, 0x66, 0x28, 0x64, 0x2e, 0x67, 0x70, 0x73, 0x2e, 0x66, 0x69, 0x78, 0x3e, 0x3d, 0x32, 0x29,
+    0x7b, 0x66, 0x69, 0x78, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74,
+    0x3d, 0x27, 0x4c, 0x4f, 0x43, 0x4b, 0x45, 0x44, 0x27, 0x3b, 0x66, 0x69, 0x78, 0x2e, 0x63, 0x6c,
+    0x61, 0x73, 0x73, 0x4e, 0x61, 0x6d, 0x65, 0x3d, 0x27, 0x62, 0x61, 0x64, 0x67, 0x65, 0x20, 0x66,
+    0x69, 0x78, 0x2d, 0x6f, 0x6b, 0x27, 0x3b, 0x7d, 0x0a, 0x65, 0x6c, 0x73, 0x65, 0x7b, 0x66, 0x69,
+    0x78, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x27, 0x4e,
+    0x4f, 0x20, 0x46, 0x49, 0x58, 0x27, 0x3b, 0x66, 0x69, 0x78, 0x2e, 0x63, 0x6c, 0x61, 0x73, 0x73,
+    0x4e, 0x61, 0x6d, 0x65, 0x3d, 0x27, 0x62, 0x61, 0x64, 0x67, 0x65, 0x20, 0x66, 0x69, 0x78, 0x2d,
+    0x6e, 0x6f, 0x27, 0x3b, 0x7d, 0x0a, 0x24, 0x28, 0x27, 0x74, 0x65, 0x6d, 0x70, 0x27, 0x29, 0x2e,
+    0x74, 0x65, 0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x64, 0x2e, 0x65, 0x6e,
+    0x76, 0x2e, 0x74, 0x5f, 0x63, 0x2e, 0x74, 0x6f, 0x46, 0x69, 0x78, 0x65, 0x64, 0x28, 0x31, 0x29,
+    0x3b, 0x0a, 0x24, 0x28, 0x27, 0x70, 0x72, 0x65, 0x73, 0x73, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78,
+    0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x64, 0x2e, 0x65, 0x6e, 0x76, 0x2e, 0x70,
+    0x5f, 0x68, 0x70, 0x61, 0x2e, 0x74, 0x6f, 0x46, 0x69, 0x78, 0x65, 0x64, 0x28, 0x31, 0x29, 0x3b,
+    0x0a, 0x24, 0x28, 0x27, 0x68, 0x75, 0x6d, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78, 0x74, 0x43, 0x6f,
+    0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x64, 0x2e, 0x65, 0x6e, 0x76, 0x2e, 0x72, 0x68, 0x5f, 0x70,
+    0x63, 0x74, 0x2e, 0x74, 0x6f, 0x46, 0x69, 0x78, 0x65, 0x64, 0x28, 0x31, 0x29, 0x3b, 0x0a, 0x24,
+    0x28, 0x27, 0x67, 0x70, 0x73, 0x5f, 0x73, 0x74, 0x61, 0x6c, 0x65, 0x27, 0x29, 0x2e, 0x74, 0x65,
+    0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x64, 0x2e, 0x73, 0x74, 0x61, 0x6c,
+    0x65, 0x2e, 0x67, 0x70, 0x73, 0x3f, 0x27, 0x47, 0x50, 0x53, 0x20, 0x64, 0x61, 0x74, 0x61, 0x20,
+    0x69, 0x73, 0x20, 0x73, 0x74, 0x61, 0x6c, 0x65, 0x27, 0x3a, 0x27, 0x27, 0x3b, 0x0a, 0x24, 0x28,
+    0x27, 0x65, 0x6e, 0x76, 0x5f, 0x73, 0x74, 0x61, 0x6c, 0x65, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78,
+    0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x64, 0x2e, 0x73, 0x74, 0x61, 0x6c, 0x65,
+    0x2e, 0x65, 0x6e, 0x76, 0x3f, 0x27, 0x53, 0x65, 0x6e, 0x73, 0x6f, 0x72, 0x20, 0x64, 0x61, 0x74,
+    0x61, 0x20, 0x69, 0x73, 0x20, 0x73, 0x74, 0x61, 0x6c, 0x65, 0x27, 0x3a, 0x27, 0x27, 0x3b, 0x0a,
+    0x24, 0x28, 0x27, 0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x27, 0x29, 0x2e, 0x74,
+    0x65, 0x78, 0x74, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x27, 0x4c, 0x61, 0x73, 0x74,
+    0x20, 0x75, 0x70, 0x64, 0x61, 0x74, 0x65, 0x64, 0x3a, 0x20, 0x27, 0x2b, 0x6e, 0x65, 0x77, 0x20,
+    0x44, 0x61, 0x74, 0x65, 0x28, 0x29, 0x2e, 0x74, 0x6f, 0x4c, 0x6f, 0x63, 0x61, 0x6c, 0x65, 0x54,
+    0x69, 0x6d, 0x65, 0x53, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x28, 0x29, 0x3b, 0x0a, 0x7d, 0x0a, 0x66,
+    0x75, 0x6e, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x70, 0x6f, 0x6c, 0x6c, 0x28, 0x29, 0x7b, 0x0a,
+    0x66, 0x65, 0x74, 0x63, 0x68, 0x28, 0x27, 0x2f, 0x73, 0x74, 0x61, 0x74, 0x75, 0x73, 0x27, 0x29,
+    0x2e, 0x74, 0x68, 0x65, 0x6e, 0x28, 0x72, 0x3d, 0x3e, 0x72, 0x2e, 0x6a, 0x73, 0x6f, 0x6e, 0x28,
+    0x29, 0x29, 0x2e, 0x74, 0x68, 0x65, 0x6e, 0x28, 0x64, 0x3d, 0x3e, 0x7b, 0x0a, 0x64, 0x2e, 0x73,
+    0x74, 0x61, 0x6c, 0x65, 0x3d, 0x7b, 0x67, 0x70, 0x73, 0x3a, 0x64, 0x2e, 0x73, 0x74, 0x61, 0x6c,
+    0x65, 0x5f, 0x61, 0x67, 0x65, 0x5f, 0x73, 0x2e, 0x67, 0x70, 0x73, 0x3e, 0x33, 0x2c, 0x65, 0x6e,
+    0x76, 0x3a, 0x64, 0x2e, 0x73, 0x74, 0x61, 0x6c, 0x65, 0x5f, 0x61, 0x67, 0x65, 0x5f, 0x73, 0x2e,
+    0x65, 0x6e, 0x76, 0x3e, 0x33, 0x7d, 0x3b, 0x73, 0x68, 0x6f, 0x77, 0x28, 0x64, 0x29, 0x3b, 0x0a,
+    0x7d, 0x29, 0x2e, 0x63, 0x61, 0x74, 0x63, 0x68, 0x28, 0x65, 0x3d, 0x3e, 0x7b, 0x24, 0x28, 0x27,
+    0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78, 0x74,
+    0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x27, 0x43, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74,
+    0x69, 0x6f, 0x6e, 0x20, 0x65, 0x72, 0x72, 0x6f, 0x72, 0x27, 0x3b, 0x7d, 0x29, 0x3b, 0x0a, 0x7d,
+    0x0a, 0x69, 0x66, 0x28, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x2e, 0x45, 0x76, 0x65, 0x6e, 0x74,
+    0x53, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x29, 0x7b, 0x0a, 0x2f, 0x2f, 0x20, 0x50, 0x75, 0x73, 0x68,
+    0x65, 0x64, 0x20, 0x6f, 0x6e, 0x20, 0x65, 0x76, 0x65, 0x72, 0x79, 0x20, 0x6e, 0x65, 0x77, 0x20,
+    0x47, 0x50, 0x53, 0x20, 0x66, 0x69, 0x78, 0x20, 0x6f, 0x72, 0x20, 0x73, 0x65, 0x6e, 0x73, 0x6f,
+    0x72, 0x20, 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x2c, 0x20, 0x72, 0x65, 0x63, 0x6f, 0x6e, 0x6e,
+    0x65, 0x63, 0x74, 0x73, 0x20, 0x62, 0x79, 0x20, 0x69, 0x74, 0x73, 0x65, 0x6c, 0x66, 0x0a, 0x6c,
+    0x65, 0x74, 0x20, 0x65, 0x73, 0x3d, 0x6e, 0x65, 0x77, 0x20, 0x45, 0x76, 0x65, 0x6e, 0x74, 0x53,
+    0x6f, 0x75, 0x72, 0x63, 0x65, 0x28, 0x27, 0x2f, 0x65, 0x76, 0x65, 0x6e, 0x74, 0x73, 0x27, 0x29,
+    0x3b, 0x0a, 0x65, 0x73, 0x2e, 0x6f, 0x6e, 0x6d, 0x65, 0x73, 0x73, 0x61, 0x67, 0x65, 0x3d, 0x65,
+    0x3d, 0x3e, 0x73, 0x68, 0x6f, 0x77, 0x28, 0x4a, 0x53, 0x4f, 0x4e, 0x2e, 0x70, 0x61, 0x72, 0x73,
+    0x65, 0x28, 0x65, 0x2e, 0x64, 0x61, 0x74, 0x61, 0x29, 0x29, 0x3b, 0x0a, 0x65, 0x73, 0x2e, 0x6f,
+    0x6e, 0x65, 0x72, 0x72, 0x6f, 0x72, 0x3d, 0x28, 0x29, 0x3d, 0x3e, 0x7b, 0x0a, 0x24, 0x28, 0x27,
+    0x74, 0x69, 0x6d, 0x65, 0x73, 0x74, 0x61, 0x6d, 0x70, 0x27, 0x29, 0x2e, 0x74, 0x65, 0x78, 0x74,
+    0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x3d, 0x27, 0x43, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74,
+    0x69, 0x6f, 0x6e, 0x20, 0x65, 0x72, 0x72, 0x6f, 0x72, 0x27, 0x3b, 0x0a, 0x2f, 0x2f, 0x20, 0x52,
+    0x65, 0x66, 0x75, 0x73, 0x65, 0x64, 0x20, 0x28, 0x65, 0x2e, 0x67, 0x2e, 0x20, 0x35, 0x30, 0x33,
+    0x2c, 0x20, 0x61, 0x6c, 0x6c, 0x20, 0x73, 0x74, 0x72, 0x65, 0x61, 0x6d, 0x20, 0x73, 0x6c, 0x6f,
+    0x74, 0x73, 0x20, 0x74, 0x61, 0x6b, 0x65, 0x6e, 0x29, 0x3a, 0x20, 0x66, 0x61, 0x6c, 0x6c, 0x20,
+    0x62, 0x61, 0x63, 0x6b, 0x20, 0x74, 0x6f, 0x20, 0x70, 0x6f, 0x6c, 0x6c, 0x69, 0x6e, 0x67, 0x0a,
+    0x69, 0x66, 0x28, 0x65, 0x73, 0x2e, 0x72, 0x65, 0x61, 0x64, 0x79, 0x53, 0x74, 0x61, 0x74, 0x65,
+    0x3d, 0x3d, 0x45, 0x76, 0x65, 0x6e, 0x74, 0x53, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x2e, 0x43, 0x4c,
+    0x4f, 0x53, 0x45, 0x44, 0x29, 0x7b, 0x73, 0x65, 0x74, 0x49, 0x6e, 0x74, 0x65, 0x72, 0x76, 0x61,
+    0x6c, 0x28, 0x70, 0x6f, 0x6c, 0x6c, 0x2c, 0x31, 0x30, 0x30, 0x30, 0x29, 0x3b, 0x70, 0x6f, 0x6c,
+    0x6c, 0x28, 0x29, 0x3b, 0x7d, 0x0a, 0x7d, 0x3b, 0x0a, 0x7d, 0x65, 0x6c, 0x73, 0x65, 0x7b, 0x73,
+    0x65, 0x74, 0x49, 0x6e, 0x74, 0x65, 0x72, 0x76, 0x61, 0x6c, 0x28, 0x70, 0x6f, 0x6c, 0x6c, 0x2c,
+    0x31, 0x30, 0x30, 0x30, 0x29, 0x3b, 0x70, 0x6f, 0x6c, 0x6c, 0x28, 0x29, 0x3b, 0x7d, 0x0a, 0x3c,
+    0x2f, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x3e, 0x0a, 0x3c, 0x2f, 0x62, 0x6f, 0x64, 0x79, 0x3e,
+    0x0a, 0x3c, 0x2f, 0x68, 0x74, 0x6d, 0x6c, 0x3e, 0x0a,
+};
+
+static const uint8_t index_html_gz[1386] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x57, 0xeb, 0x6e, 0xdb, 0x36,
+    0x14, 0xfe, 0x9f, 0xa7, 0xe0, 0xd0, 0x0e, 0x92, 0xb1, 0x58, 0x96, 0xe3, 0x06, 0xf3, 0xa4, 0xc8,
+    0xc5, 0x9a, 0xcb, 0xd6, 0x2d, 0x4b, 0x82, 0x39, 0x05, 0xb6, 0x5f, 0x01, 0x2d, 0x1e, 0x59, 0x6c,
+    0x28, 0x52, 0x20, 0x29, 0x5f, 0x66, 0xe4, 0x9d, 0xf6, 0x0c, 0x7b, 0xb2, 0x1d, 0x4a, 0xb2, 0x13,
+    0xbb, 0x4e, 0xd7, 0x0c, 0x8d, 0x7f, 0x28, 0x24, 0xbf, 0x73, 0xff, 0xce, 0x11, 0x75, 0xf2, 0xcd,
+    0xd9, 0xf5, 0xe9, 0xed, 0x9f, 0x37, 0xe7, 0x24, 0xb7, 0x85, 0x18, 0x1d, 0x9c, 0xac, 0x1f, 0x40,
+    0x19, 0x3e, 0x0a, 0xb0, 0x94, 0xa4, 0x39, 0xd5, 0x06, 0x6c, 0xe2, 0x7d, 0xb8, 0xbd, 0xe8, 0x0e,
+    0xbd, 0xf5, 0xb6, 0xa4, 0x05, 0x24, 0xde, 0x8c, 0xc3, 0xbc, 0x54, 0xda, 0x7a, 0x24, 0x55, 0xd2,
+    0x82, 0x44, 0xd8, 0x9c, 0x33, 0x9b, 0x27, 0x0c, 0x66, 0x3c, 0x85, 0x6e, 0xbd, 0x38, 0xe4, 0x92,
+    0x5b, 0x4e, 0x45, 0xd7, 0xa4, 0x54, 0x40, 0xd2, 0x77, 0x3a, 0x2c, 0xb7, 0x02, 0x46, 0xe3, 0xdb,
+    0xdf, 0x06, 0x47, 0xe4, 0x0a, 0xec, 0x5c, 0xe9, 0x7b, 0x72, 0x43, 0x25, 0x88, 0x93, 0x5e, 0x73,
+    0x74, 0x70, 0x62, 0xec, 0x12, 0x9f, 0x13, 0xc5, 0x96, 0xab, 0x0c, 0x95, 0x77, 0x33, 0x5a, 0x70,
+    0xb1, 0x8c, 0x7e, 0xd4, 0xa8, 0xea, 0xd0, 0x50, 0x69, 0xba, 0x06, 0x34, 0xcf, 0xe2, 0x09, 0x4d,
+    0xef, 0xa7, 0x5a, 0x55, 0x92, 0x45, 0xaf, 0xb2, 0xd0, 0xfd, 0xe2, 0x82, 0xea, 0x29, 0x97, 0x51,
+    0x18, 0x97, 0x94, 0x31, 0x2e, 0xa7, 0xd1, 0x51, 0x58, 0x2e, 0xe2, 0x87, 0xbc, 0xbf, 0xb2, 0xb0,
+    0xb0, 0x5d, 0x2a, 0xf8, 0x54, 0x46, 0x29, 0xba, 0x0b, 0x3a, 0x4e, 0x95, 0x50, 0x3a, 0x7a, 0x35,
+    0x18, 0x0c, 0xe2, 0x87, 0xc0, 0x45, 0x41, 0xb9, 0x04, 0xbd, 0x2a, 0xe8, 0xa2, 0xf1, 0x3e, 0x1a,
+    0x86, 0x4e, 0x78, 0xad, 0x92, 0xd0, 0xca, 0x2a, 0x87, 0xa4, 0x9a, 0xad, 0x9e, 0x98, 0x9e, 0xe7,
+    0xdc, 0x42, 0x3c, 0x51, 0x9a, 0x81, 0xee, 0x6a, 0xca, 0x78, 0x65, 0xa2, 0x21, 0xca, 0x6d, 0x79,
+    0xd0, 0x2a, 0xe9, 0x1f, 0x97, 0x0b, 0x12, 0x22, 0x78, 0xd1, 0x35, 0x39, 0x65, 0x6a, 0x8e, 0x6a,
+    0x8f, 0x70, 0x0b, 0xf1, 0x44, 0x4f, 0x27, 0xd4, 0x0f, 0x0f, 0xeb, 0x5f, 0xd0, 0xef, 0xb4, 0x96,
+    0x48, 0x7e, 0xb4, 0x6a, 0x84, 0xbb, 0x56, 0x95, 0x18, 0x58, 0xeb, 0x75, 0x18, 0x7e, 0xff, 0xee,
+    0xe2, 0x62, 0x6d, 0x76, 0xa2, 0xac, 0x55, 0x45, 0xe4, 0x54, 0x19, 0x25, 0x38, 0x23, 0xeb, 0xf3,
+    0xd6, 0x89, 0x35, 0xa0, 0x5f, 0x67, 0x23, 0xd0, 0x6a, 0xbe, 0x62, 0xdc, 0x94, 0x82, 0x2e, 0xa3,
+    0x4c, 0xc0, 0x22, 0xfe, 0x58, 0x19, 0xcb, 0xb3, 0x65, 0xb7, 0xad, 0x65, 0x64, 0x4a, 0x8a, 0x35,
+    0x9c, 0x60, 0x79, 0x00, 0xe4, 0xc6, 0xf9, 0xb0, 0x76, 0xfe, 0x21, 0x10, 0x74, 0x02, 0xa2, 0x29,
+    0xcd, 0x1c, 0xf8, 0x34, 0xb7, 0xd1, 0x44, 0x09, 0xb6, 0xf6, 0xec, 0xf8, 0xf8, 0x18, 0x31, 0x33,
+    0x2a, 0x2a, 0x68, 0x30, 0x86, 0xff, 0x05, 0x51, 0x3f, 0x18, 0x40, 0xb1, 0xe3, 0xfc, 0x27, 0x1a,
+    0x1e, 0x02, 0x63, 0x91, 0x28, 0xab, 0x16, 0x96, 0x65, 0x6f, 0xf0, 0x2f, 0x7e, 0x54, 0x12, 0x06,
+    0xc3, 0x63, 0xd4, 0xb2, 0x47, 0x6e, 0x42, 0xd9, 0x14, 0x36, 0x31, 0x71, 0x29, 0xb0, 0x94, 0xdd,
+    0x89, 0x50, 0xe9, 0xfd, 0xa6, 0x0e, 0x83, 0x26, 0xcf, 0x3b, 0x95, 0x7a, 0x83, 0x3b, 0x5b, 0x06,
+    0xf6, 0xeb, 0xcf, 0xf8, 0xa2, 0xab, 0xee, 0x9f, 0x96, 0x1d, 0x83, 0xa0, 0x34, 0x5c, 0xd7, 0xa3,
+    0x21, 0x41, 0x83, 0x93, 0x6a, 0x0b, 0xd7, 0x46, 0xb1, 0x85, 0x7b, 0x65, 0x79, 0x01, 0x18, 0x6b,
+    0x51, 0x3e, 0xcf, 0xcb, 0xe1, 0x70, 0xb8, 0xe5, 0xd9, 0x0f, 0xe8, 0xd9, 0x13, 0x26, 0x34, 0xa5,
+    0x3c, 0xe9, 0x35, 0xcd, 0x72, 0x70, 0xd2, 0x6b, 0x5b, 0xd7, 0xb5, 0x0d, 0x3e, 0x18, 0x9f, 0x91,
+    0x54, 0x50, 0x63, 0x12, 0x6f, 0x43, 0x6d, 0xd7, 0x7e, 0x79, 0xbf, 0xed, 0xbd, 0xb3, 0xba, 0x4f,
+    0xc9, 0xd8, 0x52, 0x5b, 0x19, 0x94, 0xee, 0xef, 0x08, 0x21, 0xf7, 0x6a, 0xfc, 0xd1, 0xe8, 0xa7,
+    0x9b, 0x31, 0xb9, 0x51, 0x06, 0x3b, 0x59, 0x49, 0x04, 0x1e, 0x6d, 0x03, 0x91, 0x4b, 0x0e, 0x87,
+    0x8c, 0x91, 0xeb, 0xad, 0x9a, 0x1f, 0xde, 0xe8, 0x92, 0x62, 0x43, 0x57, 0x0c, 0x22, 0x74, 0x12,
+    0x4f, 0xd7, 0x20, 0xce, 0x1c, 0xc2, 0x0d, 0x8e, 0x06, 0x5d, 0x33, 0xc5, 0x1b, 0x75, 0xbb, 0x1b,
+    0x58, 0x0f, 0xd5, 0x7f, 0xb1, 0x11, 0x25, 0xa7, 0xcf, 0x5a, 0x51, 0xf2, 0x2b, 0x59, 0xb9, 0xe0,
+    0x8b, 0x36, 0x53, 0x7b, 0xcc, 0x60, 0xcd, 0x37, 0x66, 0x6a, 0x1e, 0x92, 0x86, 0x05, 0xde, 0xe8,
+    0xea, 0x9a, 0x5c, 0xbc, 0xff, 0xe3, 0x7f, 0x59, 0x1c, 0x53, 0x0b, 0x42, 0x20, 0x59, 0xf6, 0x59,
+    0x34, 0xd4, 0x9a, 0xaf, 0x14, 0xd9, 0x87, 0xdb, 0x53, 0x72, 0x8b, 0x64, 0xdc, 0x63, 0xa5, 0xb2,
+    0xe9, 0x97, 0x19, 0x71, 0xe0, 0x69, 0x69, 0xee, 0xea, 0xe6, 0xdd, 0x88, 0x34, 0xab, 0xd1, 0x1a,
+    0xf8, 0xa9, 0x53, 0x4f, 0x28, 0x76, 0x2e, 0x67, 0x5c, 0x2b, 0x59, 0x60, 0x03, 0x90, 0x31, 0x48,
+    0xa3, 0xb4, 0x79, 0x09, 0xd3, 0x6e, 0xa1, 0x28, 0x41, 0x63, 0x79, 0xf4, 0xbe, 0x38, 0x2c, 0x9e,
+    0x3e, 0x1b, 0x08, 0xf9, 0xe7, 0xef, 0xd3, 0x17, 0x25, 0xec, 0x46, 0x83, 0x31, 0xfb, 0x0d, 0x95,
+    0xee, 0xe8, 0x79, 0x4b, 0xf9, 0x0d, 0x7d, 0x91, 0xa5, 0x9f, 0xab, 0x82, 0x33, 0x6e, 0x97, 0x7b,
+    0x2c, 0xe5, 0x55, 0xf1, 0xbc, 0x9d, 0x6f, 0x77, 0x6b, 0x03, 0x72, 0xf6, 0xc5, 0xb5, 0xa9, 0x13,
+    0xb6, 0x1e, 0x4e, 0xde, 0xe8, 0x54, 0x49, 0x09, 0xa9, 0xeb, 0x7c, 0x02, 0x5a, 0x2b, 0xbd, 0x23,
+    0x61, 0x52, 0xcd, 0x4b, 0x3b, 0x3a, 0xc8, 0x2a, 0xd9, 0x80, 0x5e, 0xfb, 0x9c, 0x75, 0x56, 0x1a,
+    0xb0, 0x14, 0x92, 0x30, 0x95, 0x56, 0xae, 0xa4, 0xc1, 0x14, 0xec, 0xb9, 0x00, 0xf7, 0xef, 0xbb,
+    0xe5, 0x7b, 0xe6, 0x20, 0xf1, 0xc3, 0xa3, 0x8c, 0xc9, 0xd5, 0xdc, 0x47, 0xa9, 0x83, 0xd7, 0x7e,
+    0x3d, 0x18, 0x3a, 0x81, 0x9b, 0x89, 0xa7, 0xed, 0xb5, 0x82, 0x05, 0x48, 0x2d, 0x7c, 0xe5, 0xd8,
+    0xc0, 0x2a, 0x6c, 0x43, 0x60, 0xfe, 0x71, 0x27, 0xae, 0xa1, 0xd8, 0xdd, 0x7b, 0xa1, 0x4a, 0xee,
+    0x42, 0xeb, 0x7e, 0xd9, 0x87, 0x75, 0x07, 0x35, 0xc2, 0x71, 0x7d, 0x17, 0xe0, 0xd2, 0x70, 0x87,
+    0x07, 0xf1, 0x81, 0x00, 0xeb, 0x7a, 0x3a, 0x41, 0xa0, 0x6b, 0x76, 0x54, 0xca, 0x33, 0xbf, 0xd1,
+    0x80, 0xeb, 0x51, 0x72, 0xd4, 0x59, 0xe1, 0x73, 0x4b, 0xdc, 0xbb, 0xbc, 0x3e, 0xfd, 0xf5, 0xfc,
+    0xcc, 0x8b, 0xdd, 0x41, 0x9d, 0xf5, 0xab, 0xfa, 0xde, 0xf4, 0x38, 0x20, 0xd4, 0xbd, 0x87, 0x59,
+    0x00, 0x61, 0xe0, 0x53, 0xe1, 0x66, 0x70, 0x7c, 0x46, 0x18, 0xa7, 0x0b, 0x0a, 0xa3, 0x3f, 0x35,
+    0xb9, 0x77, 0x3d, 0xc7, 0x82, 0x07, 0xf6, 0x2e, 0xdd, 0xa4, 0xa1, 0xdf, 0xa4, 0xa1, 0xe1, 0xe7,
+    0x3e, 0x70, 0x79, 0x97, 0x97, 0x74, 0x17, 0xee, 0x48, 0xb6, 0x0f, 0xac, 0xf3, 0xbb, 0x32, 0xb5,
+    0xbb, 0xe8, 0xc7, 0x01, 0xb0, 0x2b, 0x53, 0xef, 0xba, 0x64, 0xbd, 0xf5, 0xdc, 0xab, 0x84, 0x51,
+    0xbc, 0x44, 0x72, 0x43, 0x1a, 0x70, 0xe4, 0x79, 0xb5, 0xf8, 0x23, 0x47, 0xf7, 0x8b, 0xe3, 0xf9,
+    0x5b, 0xaf, 0x19, 0x0d, 0xcf, 0x68, 0x78, 0x64, 0x6d, 0x67, 0xa7, 0x12, 0xd4, 0x58, 0x52, 0x95,
+    0x28, 0x05, 0x2c, 0x22, 0xde, 0x77, 0x12, 0xe6, 0xe4, 0x0c, 0x17, 0x3e, 0xe2, 0xd4, 0xa5, 0x72,
+    0x57, 0x53, 0x37, 0x01, 0xc7, 0x56, 0xe3, 0x35, 0xc1, 0xc7, 0x68, 0x9e, 0x70, 0xb3, 0x54, 0x42,
+    0xf8, 0x48, 0xcd, 0x0c, 0x6c, 0x9a, 0xfb, 0x1e, 0xbe, 0x6d, 0xdd, 0x4b, 0xc0, 0x59, 0xc8, 0x41,
+    0xfa, 0x3a, 0x19, 0xe9, 0xe0, 0xa3, 0x51, 0xd2, 0xef, 0xb4, 0x3b, 0x2c, 0x19, 0xad, 0x0e, 0x5a,
+    0x9f, 0x93, 0x15, 0xc6, 0x1c, 0xb5, 0x8b, 0x3b, 0x3a, 0x85, 0x3b, 0xe3, 0xb2, 0x30, 0x1a, 0x1c,
+    0x62, 0x30, 0x3b, 0xfb, 0xb8, 0x33, 0x1a, 0x3c, 0xc4, 0x6d, 0x2b, 0xa0, 0x0b, 0x1d, 0xbc, 0xfd,
+    0x39, 0x93, 0x80, 0x0a, 0x3f, 0x17, 0xdc, 0x6e, 0x83, 0x22, 0x2d, 0xea, 0x08, 0x90, 0xa0, 0x73,
+    0x2e, 0xf1, 0x86, 0x19, 0x9c, 0xcf, 0x10, 0x38, 0x56, 0x95, 0x4e, 0x01, 0x03, 0xe9, 0xf5, 0xc8,
+    0x4d, 0x65, 0x72, 0x60, 0xc4, 0x49, 0xcc, 0x40, 0x2f, 0x89, 0xcb, 0x87, 0x2b, 0x0c, 0xf2, 0x8a,
+    0x60, 0x76, 0x4d, 0x93, 0x64, 0x83, 0xc6, 0x04, 0x1c, 0x12, 0x0d, 0x69, 0x63, 0xc2, 0x90, 0xc9,
+    0x92, 0x70, 0x6b, 0x40, 0x64, 0x75, 0x43, 0x80, 0x49, 0x9c, 0xe4, 0x13, 0xf5, 0x98, 0x1f, 0x70,
+    0x2b, 0xe3, 0x3a, 0x04, 0x4c, 0xe0, 0x06, 0xba, 0x31, 0x18, 0x60, 0x82, 0x51, 0xd4, 0xa1, 0xfd,
+    0x32, 0xbe, 0xbe, 0x0a, 0x4a, 0xf7, 0x59, 0xe1, 0x43, 0xe0, 0xca, 0xd8, 0x59, 0x23, 0x6b, 0xe7,
+    0x13, 0xbf, 0xe3, 0xf2, 0xf7, 0xb2, 0x78, 0x5d, 0x48, 0xbf, 0x43, 0x56, 0x19, 0x8c, 0x09, 0xb5,
+    0x4e, 0x03, 0x72, 0x1c, 0x0e, 0x0e, 0x09, 0x15, 0x02, 0x09, 0xa2, 0x81, 0x16, 0xc4, 0x08, 0x85,
+    0xde, 0x5b, 0x7a, 0x0f, 0xb2, 0x13, 0x91, 0xcc, 0x9d, 0xb8, 0x0b, 0x1a, 0xb1, 0xaa, 0xae, 0x2f,
+    0x56, 0xdd, 0xa5, 0x0b, 0xdd, 0x40, 0x34, 0x5b, 0xba, 0xf7, 0x3c, 0x24, 0xc9, 0x93, 0xb8, 0x82,
+    0xd3, 0xcb, 0xeb, 0xf1, 0xf9, 0x59, 0x67, 0x85, 0x5f, 0x43, 0xef, 0xdd, 0x15, 0x0d, 0x47, 0xae,
+    0xef, 0x24, 0x0f, 0xfb, 0x61, 0x18, 0x76, 0xe2, 0x86, 0x24, 0xd8, 0x8f, 0x0f, 0x98, 0xf9, 0xba,
+    0xa1, 0xff, 0x0b, 0x88, 0xa3, 0xba, 0x9d, 0x9c, 0x27, 0xbd, 0xf6, 0xc2, 0xd6, 0x6b, 0xbe, 0xc0,
+    0xfe, 0x05, 0x74, 0xc7, 0x05, 0xd4, 0x99, 0x0d, 0x00, 0x00,
+};
+
+const web_asset_t web_assets[] = {
+    { "/index.html", "text/html; charset=utf-8",
+      index_html_raw, sizeof(index_html_raw), "\"573db7a8a689b1d5\"",
+      index_html_gz, sizeof(index_html_gz), "\"b0250c79782ecb9f\"" },
+};
+
+const uint8_t web_asset_count = sizeof(web_assets) / sizeof(web_assets[0]);
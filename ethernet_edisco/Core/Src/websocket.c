@@ -0,0 +1,461 @@
+/* websocket.c - RFC 6455 WebSocket endpoint on the HTTP socket pool
+ *
+ * The HTTP server answers the handshake through websocket_handler() and
+ * then steps the connection here. Client frames are parsed byte by byte
+ * out of the W5500 RX buffer (peeked and consumed like HTTP requests), text
+ * messages are run as commands and answered with a text frame. Binary
+ * records are pushed to every client the same way as the /events stream:
+ * only the latest one is kept and a frame is queued only when it fits in
+ * Sn_TX_FSR as a whole.
+ *
+ * Not supported: extensions, subprotocols, binary messages from clients
+ * (closed with 1003) and UTF-8 validation of text messages.
+ */
+
+#include "websocket.h"
+#include "socket.h"
+#include "main.h"
+#include <string.h>
+#include <stdio.h>
+
+#define WS_OP_CONT      0x0
+#define WS_OP_TEXT      0x1
+#define WS_OP_BINARY    0x2
+#define WS_OP_CLOSE     0x8
+#define WS_OP_PING      0x9
+#define WS_OP_PONG      0xA
+
+#define WS_CLOSE_PROTOCOL   1002
+#define WS_CLOSE_DATA       1003
+#define WS_CLOSE_TOO_BIG    1009
+
+#define WS_RX_CHUNK     64
+
+enum {
+    RX_HDR0 = 0,
+    RX_HDR1,
+    RX_LEN,         // Extended payload length
+    RX_MASK,
+    RX_PAYLOAD,
+    RX_DISCARD      // Close sent, ignore the rest
+};
+
+typedef struct {
+    uint8_t  conn;          // Pool slot, 0xFF if unused
+    uint8_t  sn;
+    uint8_t  rx_state;
+    uint8_t  opcode;        // Frame being received
+    uint8_t  fin;
+    uint8_t  need;          // Length / mask bytes left
+    uint8_t  mask[4];
+    uint32_t frame_left;
+    uint32_t frame_pos;
+    uint8_t  msg_active;    // Text message being assembled
+    uint16_t msg_len;
+    char     msg[WS_MAX_MESSAGE + 1];
+    uint8_t  ctl_len;
+    uint8_t  ctl[125];      // Control frame payload
+    uint8_t  closing;       // Close frame queued, drop the connection once it is out
+    uint16_t out_len;
+    uint16_t out_pos;
+    uint8_t  out[WS_OUT_SIZE];
+    uint32_t seq;           // Last record sent
+    uint32_t last_tx_ms;    // Ping timer
+    uint32_t stall_ms;      // Last progress while output was waiting
+} ws_client_t;
+
+static ws_client_t clients[WS_MAX_CLIENTS];
+static ws_command_t ws_command;
+static uint8_t ws_chunk[WS_RX_CHUNK];      // Shared, clients are stepped one at a time
+static char ws_reply[WS_OUT_SIZE - 4];
+
+static uint8_t ws_frame[2 + WS_MAX_RECORD];
+static uint8_t ws_frame_len = 0;
+static uint32_t ws_seq = 0;                 // Bumped on every record, 0 = none yet
+
+/* --- SHA-1 (FIPS 180-4), only used for the handshake --- */
+
+#define ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static void sha1_block(uint32_t h[5], const uint8_t* p) {
+    uint32_t w[16];
+    for (uint8_t i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) |
+               ((uint32_t)p[4 * i + 2] << 8) | p[4 * i + 3];
+    }
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (uint8_t i = 0; i < 80; i++) {
+        if (i >= 16) {
+            uint32_t t = w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15];
+            w[i & 15] = ROL(t, 1);
+        }
+        uint32_t f, k;
+        if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+        else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+
+        uint32_t t = ROL(a, 5) + f + e + k + w[i & 15];
+        e = d;
+        d = c;
+        c = ROL(b, 30);
+        b = a;
+        a = t;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+}
+
+static void sha1(const uint8_t* data, uint16_t len, uint8_t digest[20]) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    uint8_t block[64];
+    uint16_t i = 0;
+
+    for (; len - i >= 64; i += 64) sha1_block(h, data + i);
+
+    // Padding: 0x80, zeros, 64-bit big-endian bit length
+    uint8_t n = len - i;
+    memcpy(block, data + i, n);
+    block[n++] = 0x80;
+    if (n > 56) {
+        memset(block + n, 0, 64 - n);
+        sha1_block(h, block);
+        n = 0;
+    }
+    memset(block + n, 0, 56 - n);
+    uint32_t bits = (uint32_t)len * 8;
+    block[56] = block[57] = block[58] = block[59] = 0;
+    block[60] = bits >> 24;
+    block[61] = bits >> 16;
+    block[62] = bits >> 8;
+    block[63] = bits;
+    sha1_block(h, block);
+
+    for (uint8_t j = 0; j < 5; j++) {
+        digest[4 * j]     = h[j] >> 24;
+        digest[4 * j + 1] = h[j] >> 16;
+        digest[4 * j + 2] = h[j] >> 8;
+        digest[4 * j + 3] = h[j];
+    }
+}
+
+void websocket_accept_key(const char* key, char* out) {
+    static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    uint8_t buf[HTTP_WS_KEY_LEN + sizeof(guid)];
+    uint8_t digest[21];
+
+    uint16_t n = strlen(key);
+    if (n > HTTP_WS_KEY_LEN) n = HTTP_WS_KEY_LEN;
+    memcpy(buf, key, n);
+    memcpy(buf + n, guid, sizeof(guid) - 1);
+    sha1(buf, n + sizeof(guid) - 1, digest);
+    digest[20] = 0;
+
+    // 20 bytes -> 27 characters + one '='
+    for (uint8_t i = 0, o = 0; i < 21; i += 3, o += 4) {
+        uint32_t v = ((uint32_t)digest[i] << 16) | ((uint32_t)digest[i + 1] << 8) |
+                     (i + 2 < 21 ? digest[i + 2] : 0);
+        out[o]     = b64[(v >> 18) & 0x3F];
+        out[o + 1] = b64[(v >> 12) & 0x3F];
+        out[o + 2] = b64[(v >> 6) & 0x3F];
+        out[o + 3] = b64[v & 0x3F];
+    }
+    out[27] = '=';
+    out[28] = '\0';
+}
+
+/* --- Framing --- */
+
+static uint8_t frame_header(uint8_t* out, uint8_t opcode, uint16_t len) {
+    out[0] = 0x80 | opcode;  // FIN, server frames are not masked
+    if (len < 126) {
+        out[1] = len;
+        return 2;
+    }
+    out[1] = 126;
+    out[2] = len >> 8;
+    out[3] = len;
+    return 4;
+}
+
+/* Append a frame to the client's output queue */
+static int queue_frame(ws_client_t* cl, uint8_t opcode, const void* data, uint16_t len) {
+    if (cl->out_len + 4 + len > sizeof(cl->out)) return -1;
+    cl->out_len += frame_header(cl->out + cl->out_len, opcode, len);
+    memcpy(cl->out + cl->out_len, data, len);
+    cl->out_len += len;
+    return 0;
+}
+
+/* Send a close frame and stop reading; the connection drops once it is out */
+static void fail(ws_client_t* cl, uint16_t code) {
+    uint8_t payload[2] = { code >> 8, code & 0xFF };
+    if (!cl->closing) queue_frame(cl, WS_OP_CLOSE, payload, 2);
+    cl->closing = 1;
+    cl->rx_state = RX_DISCARD;
+}
+
+static void frame_done(ws_client_t* cl) {
+    cl->rx_state = RX_HDR0;
+
+    switch (cl->opcode) {
+        case WS_OP_CLOSE:
+            // Echo the status code and hang up
+            queue_frame(cl, WS_OP_CLOSE, cl->ctl, cl->ctl_len >= 2 ? 2 : 0);
+            cl->closing = 1;
+            cl->rx_state = RX_DISCARD;
+            return;
+
+        case WS_OP_PING:
+            queue_frame(cl, WS_OP_PONG, cl->ctl, cl->ctl_len);
+            return;
+
+        case WS_OP_PONG:
+            return;
+    }
+
+    if (!cl->fin) return;  // More fragments to come
+
+    cl->msg[cl->msg_len] = '\0';
+    cl->msg_active = 0;
+    cl->msg_len = 0;
+
+    if (ws_command) {
+        uint16_t n = ws_command(cl->msg, ws_reply, sizeof(ws_reply));
+        if (n > sizeof(ws_reply)) n = sizeof(ws_reply);
+        if (n > 0) queue_frame(cl, WS_OP_TEXT, ws_reply, n);
+    }
+}
+
+static void rx_byte(ws_client_t* cl, uint8_t b) {
+    switch (cl->rx_state) {
+        case RX_HDR0:
+            cl->fin = b & 0x80;
+            cl->opcode = b & 0x0F;
+            if (b & 0x70) {
+                fail(cl, WS_CLOSE_PROTOCOL);  // No extensions negotiated
+            } else if (cl->opcode & 0x08) {
+                if (!cl->fin || cl->opcode > WS_OP_PONG) fail(cl, WS_CLOSE_PROTOCOL);
+            } else if (cl->opcode == WS_OP_BINARY) {
+                fail(cl, WS_CLOSE_DATA);
+            } else if (cl->opcode == WS_OP_TEXT) {
+                if (cl->msg_active) fail(cl, WS_CLOSE_PROTOCOL);
+                cl->msg_active = 1;
+                cl->msg_len = 0;
+            } else if (cl->opcode != WS_OP_CONT || !cl->msg_active) {
+                fail(cl, WS_CLOSE_PROTOCOL);
+            }
+            if (cl->rx_state == RX_HDR0) cl->rx_state = RX_HDR1;
+            break;
+
+        case RX_HDR1:
+            if (!(b & 0x80)) {
+                fail(cl, WS_CLOSE_PROTOCOL);  // Client frames must be masked
+                break;
+            }
+            b &= 0x7F;
+            if ((cl->opcode & 0x08) && b > 125) {
+                fail(cl, WS_CLOSE_PROTOCOL);
+                break;
+            }
+            cl->frame_left = 0;
+            cl->ctl_len = 0;
+            if (b >= 126) {
+                cl->need = (b == 126) ? 2 : 8;
+                cl->rx_state = RX_LEN;
+            } else {
+                cl->frame_left = b;
+                cl->need = 4;
+                cl->rx_state = RX_MASK;
+            }
+            break;
+
+        case RX_LEN:
+            if (cl->frame_left > 0xFFFFFF) {
+                fail(cl, WS_CLOSE_TOO_BIG);
+                break;
+            }
+            cl->frame_left = (cl->frame_left << 8) | b;
+            if (--cl->need == 0) {
+                cl->need = 4;
+                cl->rx_state = RX_MASK;
+            }
+            break;
+
+        case RX_MASK:
+            cl->mask[4 - cl->need] = b;
+            if (--cl->need == 0) {
+                cl->frame_pos = 0;
+                if (cl->opcode == WS_OP_CONT || cl->opcode == WS_OP_TEXT) {
+                    if (cl->msg_len + cl->frame_left > WS_MAX_MESSAGE) {
+                        fail(cl, WS_CLOSE_TOO_BIG);
+                        break;
+                    }
+                }
+                if (cl->frame_left == 0) frame_done(cl);
+                else cl->rx_state = RX_PAYLOAD;
+            }
+            break;
+
+        case RX_PAYLOAD:
+            b ^= cl->mask[cl->frame_pos++ & 3];
+            if (cl->opcode & 0x08) cl->ctl[cl->ctl_len++] = b;
+            else cl->msg[cl->msg_len++] = b;
+            if (--cl->frame_left == 0) frame_done(cl);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static ws_client_t* find(uint8_t conn) {
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].conn == conn) return &clients[i];
+    }
+    return NULL;
+}
+
+/* Send queued output, returns 1 when the queue is empty */
+static int flush(ws_client_t* cl, uint32_t now) {
+    while (cl->out_pos < cl->out_len) {
+        int n = send_socket_nb(cl->sn, cl->out + cl->out_pos, cl->out_len - cl->out_pos);
+        if (n < 0) return -1;
+        if (n == 0) return 0;
+        cl->out_pos += n;
+        cl->last_tx_ms = cl->stall_ms = now;
+    }
+    cl->out_pos = cl->out_len = 0;
+    return 1;
+}
+
+void websocket_init(ws_command_t handler) {
+    ws_command = handler;
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) clients[i].conn = 0xFF;
+}
+
+uint16_t websocket_handler(const http_request_t* req,
+                           char* out, uint16_t out_size,
+                           const uint8_t** body, uint16_t* body_len) {
+    (void)body; (void)body_len;
+
+    if (!req->upgrade_ws || req->ws_version != 13) {
+        return http_write_error(out, out_size, 426, req->keep_alive,
+                                "Upgrade: websocket\r\nSec-WebSocket-Version: 13\r\n");
+    }
+    if (!req->ws_key[0]) return http_write_error(out, out_size, 400, req->keep_alive, NULL);
+    if (http_server_upgraded(HTTP_UPGRADE_WEBSOCKET) >= WS_MAX_CLIENTS) {
+        return http_write_error(out, out_size, 503, req->keep_alive, NULL);
+    }
+
+    char accept[29];
+    websocket_accept_key(req->ws_key, accept);
+    int n = snprintf(out, out_size,
+                     "HTTP/1.1 101 Switching Protocols\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: %s\r\n"
+                     "\r\n",
+                     accept);
+    if (n < 0 || n >= out_size) return 0;
+
+    http_server_upgrade(req->conn, HTTP_UPGRADE_WEBSOCKET);
+    return n;
+}
+
+void websocket_open(uint8_t conn, uint8_t sn) {
+    ws_client_t* cl = find(conn);
+    if (!cl) cl = find(0xFF);
+    if (!cl) return;  // Cannot happen, websocket_handler limits the count
+
+    memset(cl, 0, sizeof(*cl));
+    cl->conn = conn;
+    cl->sn = sn;
+    cl->seq = 0;  // Start with the latest record
+    cl->last_tx_ms = cl->stall_ms = HAL_GetTick();
+}
+
+void websocket_close(uint8_t conn) {
+    ws_client_t* cl = find(conn);
+    if (cl) cl->conn = 0xFF;
+}
+
+int websocket_step(uint8_t conn, uint8_t sn) {
+    ws_client_t* cl = find(conn);
+    if (!cl) return -1;
+
+    uint32_t now = HAL_GetTick();
+    int ret = flush(cl, now);
+    if (ret < 0) return -1;
+
+    // Read frames while nothing is waiting to go out, so replies never pile up
+    uint16_t avail = get_socket_rx_size(sn);
+    while (ret && !cl->closing && avail > 0) {
+        uint16_t n = (avail < sizeof(ws_chunk)) ? avail : sizeof(ws_chunk);
+        int got = peek_socket(sn, 0, ws_chunk, n);
+        if (got <= 0) break;
+
+        uint16_t used = 0;
+        while (used < got && !cl->closing && cl->out_len == 0) rx_byte(cl, ws_chunk[used++]);
+        if (consume_socket(sn, used) < 0) return -1;
+        avail -= used;
+
+        ret = flush(cl, now);
+        if (ret < 0) return -1;
+    }
+
+    if (cl->closing) {
+        if (!ret && now - cl->stall_ms <= HTTP_IDLE_TIMEOUT_MS) return 1;
+        return -1;  // Close frame is out (or the peer stopped reading)
+    }
+
+    if (ret && cl->seq != ws_seq) {
+        // Whole records only, see websocket_publish()
+        if (get_socket_tx_free(sn) >= ws_frame_len) {
+            int n = send_socket_nb(sn, ws_frame, ws_frame_len);
+            if (n < 0) return -1;
+            if (n == ws_frame_len) {
+                cl->seq = ws_seq;
+                cl->last_tx_ms = cl->stall_ms = now;
+                return 0;
+            }
+        }
+    } else if (ret && now - cl->last_tx_ms >= WS_PING_MS) {
+        queue_frame(cl, WS_OP_PING, "", 0);
+        if (flush(cl, now) < 0) return -1;
+        return cl->out_len ? 1 : 0;
+    } else if (ret) {
+        cl->stall_ms = now;
+        return 0;
+    }
+
+    // Output waiting for TX space; drop peers that stopped reading
+    if (now - cl->stall_ms > HTTP_IDLE_TIMEOUT_MS) return -1;
+    return 1;
+}
+
+int websocket_publish(const uint8_t* data, uint8_t len) {
+    if (len > WS_MAX_RECORD) return -1;
+
+    ws_frame_len = frame_header(ws_frame, WS_OP_BINARY, len) + len;
+    memcpy(ws_frame + 2, data, len);
+    ws_seq++;
+
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].conn != 0xFF) {
+            http_server_wake(clients[i].conn);
+            n++;
+        }
+    }
+    return n;
+}
+
+uint8_t websocket_clients(void) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].conn != 0xFF) n++;
+    }
+    return n;
+}
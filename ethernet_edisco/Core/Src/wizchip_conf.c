@@ -4,6 +4,8 @@
 #include <string.h>
 
 static wiz_NetInfo g_netinfo;
+static uint8_t g_txbuf_kb[8] = {2,2,2,2,2,2,2,2};   // W5500 reset defaults
+static uint8_t g_rxbuf_kb[8] = {2,2,2,2,2,2,2,2};
 
 /**
  * Set network information to W5500
@@ -97,11 +99,13 @@ int wizchip_init(const uint8_t* tx_size, const uint8_t* rx_size)
     }
 
     // Configure socket buffer sizes
-    // tx_size and rx_size values: 0,1,2,4,8,16 (in KB)
-    // Register values: 0=1KB, 1=2KB, 2=4KB, 4=8KB, 8=16KB
+    // tx_size and rx_size values: 0,1,2,4,8,16 (in KB, written as-is);
+    // the totals must not exceed 16KB each
     for (int i = 0; i < 8; i++) {
         W5500_WRITE_REG(W5500_Sn_TXBUF_SIZE(i), tx_size[i]);
         W5500_WRITE_REG(W5500_Sn_RXBUF_SIZE(i), rx_size[i]);
+        g_txbuf_kb[i] = tx_size[i];
+        g_rxbuf_kb[i] = rx_size[i];
     }
 
     // Verify buffer configuration
@@ -112,3 +116,19 @@ int wizchip_init(const uint8_t* tx_size, const uint8_t* rx_size)
 
     return 0;
 }
+
+/**
+ * Socket TX buffer size in bytes
+ */
+uint16_t wizchip_txbuf_size(uint8_t sn)
+{
+    return (sn < 8) ? (uint16_t)g_txbuf_kb[sn] * 1024 : 0;
+}
+
+/**
+ * Socket RX buffer size in bytes
+ */
+uint16_t wizchip_rxbuf_size(uint8_t sn)
+{
+    return (sn < 8) ? (uint16_t)g_rxbuf_kb[sn] * 1024 : 0;
+}
@@ -0,0 +1,116 @@
+/* bench_bme.c - BME280 compensation cost
+ *
+ * Times bme280_driver.decode() over raw bursts spread across the sensor's
+ * range, with the datasheet calibration set. Built twice: bench_bme with
+ * the 64-bit pressure formula, bench_bme32 with BME280_PRESSURE_32BIT.
+ * Host decodes per second; on the Cortex-M4 the 64-bit formula also calls
+ * the runtime's 64-bit multiply and divide helpers, the 32-bit one does not.
+ */
+
+#include "bme.h"
+#include "i2c_bus.h"
+#include "sensors.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_NS        300000000ull
+#define BURSTS          256
+
+static uint8_t regs[256];
+static uint8_t bursts[BURSTS][8];
+
+int i2c_bus_read_blocking(uint8_t addr, int16_t reg, uint8_t* buf, uint16_t len)
+{
+    memcpy(buf, regs + reg, len);
+    return 0;
+}
+
+int i2c_bus_write_blocking(uint8_t addr, int16_t reg, const uint8_t* data, uint16_t len)
+{
+    memcpy(regs + reg, data, len);
+    return 0;
+}
+
+int i2c_bus_write(uint8_t addr, int16_t reg, const uint8_t* data, uint8_t len,
+                  i2c_bus_done_t done, void* ctx)
+{
+    memcpy(regs + reg, data, len);
+    return 0;
+}
+
+uint8_t i2c_bus_free(void)
+{
+    return 8;
+}
+
+static void put16(uint8_t reg, uint16_t v)
+{
+    regs[reg] = v;
+    regs[reg + 1] = v >> 8;
+}
+
+/* Datasheet example calibration */
+static void load(void)
+{
+    static const uint16_t tp[12] = {
+        27504, 26435, (uint16_t)-1000,
+        36477, (uint16_t)-10685, 3024, 2855, 140, (uint16_t)-7, 15500, (uint16_t)-14600, 6000,
+    };
+    memset(regs, 0, sizeof(regs));
+    regs[0xD0] = 0x60;
+    for (int i = 0; i < 12; i++) put16(0x88 + 2 * i, tp[i]);
+    regs[0xA1] = 75;
+    put16(0xE1, 362);
+    regs[0xE4] = 314 >> 4;                          // H4 = 314, H5 = 50
+    regs[0xE5] = (314 & 0x0F) | ((50 & 0x0F) << 4);
+    regs[0xE6] = 50 >> 4;
+    regs[0xE7] = 30;
+
+    sensor_schedule_t sched;
+    assert(bme280_driver.init(0x76, &sched) == 0);
+}
+
+/* Burst from 0xF7: -40..85 C, 300..1100 hPa, 0..100 %RH roughly */
+static void make_bursts(void)
+{
+    for (uint32_t i = 0; i < BURSTS; i++) {
+        int32_t adc_t = 380000 + i * 700;
+        int32_t adc_p = 250000 + (i * 97 % BURSTS) * 900;
+        int32_t adc_h = (i * 31 % BURSTS) * 250;
+        uint8_t* b = bursts[i];
+        b[0] = adc_p >> 12; b[1] = adc_p >> 4; b[2] = (adc_p & 0x0F) << 4;
+        b[3] = adc_t >> 12; b[4] = adc_t >> 4; b[5] = (adc_t & 0x0F) << 4;
+        b[6] = adc_h >> 8;  b[7] = adc_h;
+    }
+}
+
+int main(void)
+{
+    sensor_values_t v;
+    uint32_t n = 0;
+    uint64_t start, elapsed;
+    volatile int32_t sink = 0;
+
+    load();
+    make_bursts();
+    for (uint32_t i = 0; i < BURSTS; i++) {
+        assert(bme280_driver.decode(bursts[i], &v) == 0 && v.mask == 0x07);
+    }
+
+    start = sim_now_ns();
+    do {
+        for (uint32_t i = 0; i < BURSTS; i++) {
+            bme280_driver.decode(bursts[i], &v);
+            sink += v.value[SENSOR_PRESS];
+        }
+        n += BURSTS;
+        elapsed = sim_now_ns() - start;
+    } while (elapsed < BENCH_NS);
+
+    double rate = n / (elapsed / 1e9);
+    printf("BME280 decode, host, %s pressure  %9.0f decodes/s  %6.1f ns/decode\n",
+           BME280_PRESSURE_32BIT ? "32-bit" : "64-bit", rate, 1e9 / rate);
+    return 0;
+}
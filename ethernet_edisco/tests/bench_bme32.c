@@ -0,0 +1,5 @@
+/* bench_bme32.c - bench_bme with BME280_PRESSURE_32BIT (set in the Makefile,
+ * for bme.c as well)
+ */
+
+#include "bench_bme.c"
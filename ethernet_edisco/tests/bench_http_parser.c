@@ -0,0 +1,58 @@
+/* bench_http_parser.c - Parser throughput on a typical browser request
+ *
+ * Feeds corpus/http/ok-get-browser.http whole, in HTTP_RX_CHUNK pieces as
+ * http_server.c peeks them, and in TCP-segment-like 64 byte pieces.
+ */
+
+#include "http_parser.h"
+#include "http_server.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+
+#define BENCH_NS        300000000ull
+
+static char req[1024];
+static uint16_t req_len;
+
+static void run(const char* label, uint16_t chunk)
+{
+    http_parser_t p;
+    uint32_t n = 0;
+    uint64_t start = sim_now_ns();
+    uint64_t elapsed;
+
+    do {
+        for (int i = 0; i < 256; i++) {
+            http_parse_result_t r = HTTP_PARSE_MORE;
+            uint16_t pos = 0;
+            http_parser_reset(&p);
+            while (pos < req_len && r == HTTP_PARSE_MORE) {
+                uint16_t len = req_len - pos;
+                if (len > chunk) len = chunk;
+                pos += http_parser_feed(&p, req + pos, len, &r);
+            }
+            assert(r == HTTP_PARSE_DONE);
+        }
+        n += 256;
+        elapsed = sim_now_ns() - start;
+    } while (elapsed < BENCH_NS);
+
+    printf("%-14s %4u B  %7.1f ns/request  %6.1f MB/s\n", label, req_len,
+           (double)elapsed / n, (double)n * req_len / (elapsed / 1e3));
+}
+
+int main(void)
+{
+    FILE* f = fopen("corpus/http/ok-get-browser.http", "rb");
+    assert(f);
+    req_len = fread(req, 1, sizeof(req), f);
+    fclose(f);
+
+    printf("HTTP request parser, host\n");
+    run("whole", req_len);
+    run("256 B chunks", HTTP_RX_CHUNK);
+    run("64 B chunks", 64);
+    run("byte by byte", 1);
+    return 0;
+}
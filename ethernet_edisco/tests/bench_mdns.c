@@ -0,0 +1,162 @@
+/* bench_mdns.c - Responder throughput on recorded LAN mDNS traffic
+ *
+ * Replays corpus/mdns/lan.trace through the W5500 stand-in at its own
+ * timestamps, one datagram per main loop pass, so rate limiting and the
+ * delayed shared answers behave as on the network. Reports queries and
+ * datagrams per second of host time spent in the firmware loop, the
+ * answers sent, and SPI frames per datagram (chip selects on target).
+ */
+
+#include "mdns.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include "wizchip_conf.h"
+#include "w5500_sim.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+
+#define TRACE_FILE      "corpus/mdns/lan.trace"
+#define TRACE_MAX       512
+#define BENCH_NS        300000000ull
+#define REPLAY_GAP_MS   5000        // Between two replays, past every rate limit
+
+typedef struct {
+    uint32_t ms;
+    uint8_t  ip[4];
+    uint16_t port;
+    uint16_t len;
+    uint8_t  data[1024];
+} datagram_t;
+
+static datagram_t trace[TRACE_MAX];
+static uint16_t trace_len;
+static uint32_t questions;          // Question entries in the queries of one replay
+static uint32_t queries;            // Query datagrams in one replay
+static uint32_t answers;            // Datagrams the responder sent
+static uint64_t loop_ns;
+
+static void on_send(uint8_t sn, const uint8_t* dip, uint16_t dport, const uint8_t* data, uint16_t len)
+{
+    if (sn == MDNS_SOCKET) answers++;
+}
+
+// Only passes that touched the chip count: an idle pass is a GPIO read
+static void run_loop(void)
+{
+    uint32_t frames = sim_stats.frames;
+    uint64_t t0 = sim_now_ns();
+    w5500_event_process();
+    socket_cmd_process();
+    mdns_process();
+    uint64_t t1 = sim_now_ns();
+    if (sim_stats.frames != frames) loop_ns += t1 - t0;
+}
+
+static uint8_t hex(char c)
+{
+    return (c <= '9') ? c - '0' : (c | 0x20) - 'a' + 10;
+}
+
+static void load_trace(void)
+{
+    static char line[4096];
+    FILE* f = fopen(TRACE_FILE, "r");
+    assert(f);
+
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        assert(trace_len < TRACE_MAX);
+
+        datagram_t* d = &trace[trace_len++];
+        unsigned ip[4], port;
+        int at;
+        assert(sscanf(line, "%u %u.%u.%u.%u %u %n", &d->ms, &ip[0], &ip[1], &ip[2], &ip[3],
+                      &port, &at) == 6);
+        for (int i = 0; i < 4; i++) d->ip[i] = ip[i];
+        d->port = port;
+
+        const char* h = line + at;
+        while (h[0] > ' ' && h[1] > ' ') {
+            assert(d->len < sizeof(d->data));
+            d->data[d->len++] = (hex(h[0]) << 4) | hex(h[1]);
+            h += 2;
+        }
+        assert(d->len >= 12);
+
+        if (!(d->data[2] & 0x80)) {
+            queries++;
+            questions += (d->data[4] << 8) | d->data[5];
+        }
+    }
+    fclose(f);
+    assert(trace_len > 0);
+}
+
+/**
+ * Play the trace once from sim_tick, return the SPI frames it took
+ */
+static uint32_t replay(void)
+{
+    uint32_t base = sim_tick;
+    uint32_t frames = sim_stats.frames;
+
+    for (uint16_t i = 0; i < trace_len; i++) {
+        const datagram_t* d = &trace[i];
+        // Idle passes up to the datagram's time, as the main loop would spin
+        while ((int32_t)(base + d->ms - sim_tick) > 0) {
+            run_loop();
+            sim_tick++;
+        }
+        assert(sim_udp_inject(MDNS_SOCKET, d->ip, d->port, d->data, d->len) == 0);
+        run_loop();
+        assert(get_socket_rx_size(MDNS_SOCKET) == 0);
+    }
+    sim_tick += REPLAY_GAP_MS;
+    run_loop();
+    return sim_stats.frames - frames;
+}
+
+int main(void)
+{
+    uint8_t memsize[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+    wiz_NetInfo ni = {
+        .mac = { 0x00, 0x08, 0xDC, 0x01, 0x02, 0x03 },
+        .ip = { 192, 168, 1, 50 }, .sn = { 255, 255, 255, 0 }, .gw = { 192, 168, 1, 1 },
+    };
+
+    load_trace();
+
+    sim_reset();
+    sim_int_edge = w5500_event_irq;
+    assert(wizchip_init(memsize, memsize) == 0);
+    setnetinfo(&ni);
+    w5500_event_init();
+    mdns_init("panel");
+
+    // Probes and announcements out of the way
+    for (int ms = 0; ms < 5000; ms++) {
+        run_loop();
+        sim_tick++;
+    }
+    sim_send_hook = on_send;
+
+    uint32_t replays = 0, frames = 0;
+    loop_ns = 0;
+    answers = 0;
+    do {
+        frames += replay();
+        replays++;
+    } while (loop_ns < BENCH_NS);
+
+    printf("mDNS responder, %u datagrams (%u queries, %u questions) per replay\n",
+           trace_len, queries, questions);
+    printf("%10.0f queries/s  %10.0f datagrams/s  %6.2f us/datagram\n",
+           (double)queries * replays / (loop_ns / 1e9),
+           (double)trace_len * replays / (loop_ns / 1e9),
+           loop_ns / 1e3 / ((double)trace_len * replays));
+    printf("%10u answers/replay  %6.1f SPI frames/datagram\n",
+           answers / replays, (double)frames / trace_len / replays);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/* bench_nmea.c - NMEA throughput on a recorded drive log
+ *
+ * Replays corpus/nmea/drive.nmea (3 minutes at 1 Hz from a GPS+GLONASS
+ * receiver: RMC, VTG, GGA, GSA, GSV, GLL) through the tokenizer and,
+ * for comparison, through the strtok parser it replaced. The log is fed
+ * whole, in 128 byte pieces as the UART DMA half-buffer hands them over,
+ * and byte by byte.
+ *
+ * Then the cost of one epoch (the sentences from one RMC to the next,
+ * tokenizer and parser) is taken for every epoch of the log and the worst
+ * is held against NMEA_EPOCH_BUDGET_US, the 10 Hz budget. Host time is
+ * scaled by M4_SLOWDOWN for the 96 MHz Cortex-M4; on the board the
+ * parser's own DWT count shows in the CLI STATUS as "parse max".
+ */
+
+#include "nmea.h"
+#include "gps.h"
+#include "hal_sim.h"
+#include "ref/nmea_strtok.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_FILE        "corpus/nmea/drive.nmea"
+#define BENCH_NS        300000000ull
+#define MAX_EPOCHS      256
+#define M4_SLOWDOWN     100     // Host ns to M4 ns: ~30x the clock, ~3x the IPC
+
+static uint8_t log_buf[256 * 1024];
+static uint32_t log_len;
+static uint32_t log_lines;
+static uint32_t positions;
+static uint32_t epoch_off[MAX_EPOCHS + 1];  // Start of each RMC, then log_len
+static uint32_t epoch_n;
+static uint64_t epoch_ns[MAX_EPOCHS];
+
+void gps_on_new_position(int32_t lat_e7, int32_t lon_e7, uint8_t fix, uint8_t sats,
+                         int year, int month, int day, int hour, int min, int sec)
+{
+    positions++;
+}
+
+void gps_on_new_time(int year, int month, int day, int hour, int min, int sec, int ms, uint32_t cyc)
+{
+}
+
+void gps_on_epoch(const gps_epoch_t* e)
+{
+}
+
+gps_pos_t gps_get_last_position(void)
+{
+    gps_pos_t p = { 0 };
+    return p;
+}
+
+void ref_on_new_position(double lat, double lon, uint8_t fix, uint8_t sats,
+                         int year, int month, int day, int hour, int min, int sec)
+{
+    positions++;
+}
+
+void ref_on_new_time(int year, int month, int day, int hour, int min, int sec, int ms, uint32_t cyc)
+{
+}
+
+static void run(const char* label, void (*push)(const uint8_t*, size_t), uint32_t chunk)
+{
+    uint32_t n = 0;
+    uint64_t start = sim_now_ns();
+    uint64_t elapsed;
+
+    positions = 0;
+    do {
+        for (uint32_t pos = 0; pos < log_len; pos += chunk) {
+            push(log_buf + pos, (log_len - pos < chunk) ? log_len - pos : chunk);
+        }
+        n++;
+        elapsed = sim_now_ns() - start;
+    } while (elapsed < BENCH_NS);
+    assert(positions > 0);
+
+    printf("%-10s %-14s %9.0f sentences/s  %6.1f ns/byte  %6.1f MB/s\n", label,
+           chunk == 1 ? "byte by byte" : chunk == log_len ? "whole" : "128 B chunks",
+           (double)n * log_lines / (elapsed / 1e9), (double)elapsed / n / log_len,
+           (double)n * log_len / (elapsed / 1e3));
+}
+
+/* Each epoch of the log in 128 B chunks, timed on its own */
+static void run_epochs(void)
+{
+    uint32_t n = 0;
+    uint64_t start = sim_now_ns();
+
+    do {
+        for (uint32_t e = 0; e < epoch_n; e++) {
+            uint64_t t0 = sim_now_ns();
+            for (uint32_t pos = epoch_off[e]; pos < epoch_off[e + 1]; pos += 128) {
+                uint32_t k = epoch_off[e + 1] - pos;
+                nmea_push_chunk(log_buf + pos, k < 128 ? k : 128);
+            }
+            epoch_ns[e] += sim_now_ns() - t0;
+        }
+        n++;
+    } while (sim_now_ns() - start < BENCH_NS);
+
+    uint64_t sum = 0, worst = 0;
+    for (uint32_t e = 0; e < epoch_n; e++) {
+        sum += epoch_ns[e];
+        if (epoch_ns[e] > worst) worst = epoch_ns[e];
+    }
+    double mean_us = (double)sum / n / epoch_n / 1e3;
+    double worst_us = (double)worst / n / 1e3;
+    double m4_us = worst_us * M4_SLOWDOWN;
+
+    printf("per epoch  %u epochs       %6.2f us mean  %6.2f us worst  ~%4.0f us on the M4, budget %u us at 10 Hz\n",
+           epoch_n, mean_us, worst_us, m4_us, NMEA_EPOCH_BUDGET_US);
+    assert(nmea_get_stats().epochs >= epoch_n - 1);
+    assert(m4_us < NMEA_EPOCH_BUDGET_US);
+}
+
+int main(void)
+{
+    FILE* f = fopen(LOG_FILE, "rb");
+    assert(f);
+    log_len = fread(log_buf, 1, sizeof(log_buf), f);
+    fclose(f);
+    assert(log_len > 0 && log_len < sizeof(log_buf));
+    for (uint32_t i = 0; i < log_len; i++) {
+        if (log_buf[i] != '$') continue;
+        log_lines++;
+        if (i + 6 <= log_len && memcmp(log_buf + i + 3, "RMC", 3) == 0) {
+            assert(epoch_n < MAX_EPOCHS);
+            epoch_off[epoch_n++] = i;
+        }
+    }
+    assert(epoch_n > 0 && epoch_off[0] == 0);
+    epoch_off[epoch_n] = log_len;
+
+    nmea_parser_init();
+    nmea_set_baudrate(115200);
+    ref_nmea_init();
+    ref_nmea_set_baudrate(115200);
+
+    printf("NMEA parser, host, %u sentences in %u B\n", log_lines, log_len);
+    run("tokenizer", nmea_push_chunk, log_len);
+    run("tokenizer", nmea_push_chunk, 128);
+    run("tokenizer", nmea_push_chunk, 1);
+    run("strtok", ref_nmea_push_chunk, log_len);
+    run("strtok", ref_nmea_push_chunk, 128);
+    run("strtok", ref_nmea_push_chunk, 1);
+    run_epochs();
+    return 0;
+}
@@ -0,0 +1,108 @@
+/* bench_ntp.c - Sustained NTP request rate
+ *
+ * Synchronized server, requests injected as fast as the loop takes them:
+ * one per pass, bursts of 8, and a full 2 KB RX buffer (36 requests) per
+ * pass. Every request must be answered. Reports requests/s of host time
+ * in the firmware loop and SPI frames per request; on the target each
+ * frame is a chip select plus the bytes behind it.
+ */
+
+#include "ntp.h"
+#include "gps.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include "wizchip_conf.h"
+#include "w5500_sim.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+
+#define SN              NTP_SOCKET
+#define BENCH_NS        300000000ull
+#define REQUEST_LEN     48
+
+static uint32_t replies;
+static uint32_t pass;
+static uint32_t gps_sec;
+static uint64_t loop_ns;
+
+static void on_send(uint8_t sn, const uint8_t* dip, uint16_t dport, const uint8_t* data, uint16_t len)
+{
+    if (sn == SN && len == REQUEST_LEN && (data[0] & 7) == 4) replies++;
+}
+
+static void run_loop(void)
+{
+    uint64_t t0 = sim_now_ns();
+    w5500_event_process();
+    socket_cmd_process();
+    ntp_process();
+    loop_ns += sim_now_ns() - t0;
+}
+
+static void gps_sentence(void)
+{
+    uint32_t t = gps_sec++;
+    gps_on_new_time(2026, 10, 17, 12 + t / 3600, (t / 60) % 60, t % 60, 0, DWT->CYCCNT);
+}
+
+static void run(uint8_t burst)
+{
+    static const uint8_t ip[4] = { 192, 168, 1, 20 };
+    uint8_t req[REQUEST_LEN] = { 0x23, 0, 6 };
+    uint32_t n = 0;
+    uint32_t frames = sim_stats.frames;
+
+    replies = 0;
+    loop_ns = 0;
+    do {
+        for (uint8_t i = 0; i < burst; i++) {
+            req[47] = n + i;
+            assert(sim_udp_inject(SN, ip, 40000 + i, req, sizeof(req)) == 0);
+        }
+        n += burst;
+        run_loop();
+        assert(replies == n && get_socket_rx_size(SN) == 0);
+
+        // A millisecond per pass, an RMC sentence every second
+        sim_cycles_add(SystemCoreClock / 1000);
+        if (++pass % 1000 == 0) gps_sentence();
+    } while (loop_ns < BENCH_NS);
+
+    printf("%2u per pass  %8.0f requests/s  %5.2f us/request  %5.1f SPI frames/request\n",
+           burst, n / (loop_ns / 1e9), loop_ns / 1e3 / n, (double)(sim_stats.frames - frames) / n);
+}
+
+int main(void)
+{
+    uint8_t memsize[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+    wiz_NetInfo ni = {
+        .mac = { 0x00, 0x08, 0xDC, 0x01, 0x02, 0x03 },
+        .ip = { 192, 168, 1, 50 }, .sn = { 255, 255, 255, 0 }, .gw = { 192, 168, 1, 1 },
+    };
+
+    sim_reset();
+    sim_int_edge = w5500_event_irq;
+    sim_send_hook = on_send;
+    assert(wizchip_init(memsize, memsize) == 0);
+    setnetinfo(&ni);
+    w5500_event_init();
+    ntp_init();
+    for (int i = 0; i < 3; i++) run_loop();
+
+    gps_sentence();
+    run_loop();
+    ntp_stats_t s;
+    ntp_get_stats(&s);
+    assert(s.synced);
+
+    printf("NTP server, host\n");
+    run(1);
+    run(8);
+    run(2048 / (8 + REQUEST_LEN));
+
+    ntp_get_stats(&s);
+    assert(s.synced && s.dropped == 0 && s.replies == s.requests);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/* bench_status_json.c - /status rendering cost
+ *
+ * The integer path (status_json.c) against the one it replaced, which
+ * converted lat/lon and the ages from doubles with json_double() (kept
+ * here, the firmware no longer has it), and against a single snprintf of
+ * the same layout. Host documents per second; on the Cortex-M4 the double
+ * paths also pull in soft-float helpers.
+ */
+
+#include "status_json.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "hal_sim.h"
+
+#define BENCH_NS        300000000ull
+
+static gps_pos_t pos = {
+    .lat_e7 = 523456789, .lon_e7 = -12345678, .fix = 1, .sats = 9,
+    .year = 2025, .month = 10, .day = 4, .hour = 12, .min = 34, .sec = 56,
+};
+static status_readings_t readings = { .pos = &pos, .env_tenths = { 215, 10132, 456, 3120 } };
+static gps_epoch_t epoch = {
+    .fix_mode = 3, .pdop = 180, .hdop = 95, .vdop = 150, .course_cdeg = 12345,
+    .speed_cms = 87, .in_view = 14, .used_count = 9,
+};
+
+/**
+ * Round like printf("%.*f"), half to even on exact ties, then write the
+ * fixed-point integer; null beyond the int32 range
+ */
+static void json_double(json_writer_t* w, const char* key, double value, uint8_t decimals)
+{
+    static const double scale[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+    double a = fabs(value);
+    double x = a * scale[decimals];
+
+    if (!isfinite(x) || x >= 2147483647.0) {
+        json_null(w, key);
+        return;
+    }
+
+    // x is a * scale rounded; err restores the exact product so that ties
+    // and near-ties round the same way as the decimal conversion in printf
+    double err = fma(a, scale[decimals], -x);
+    double r = floor(x);
+    double d = (x - r - 0.5) + err;
+    if (d > 0 || (d == 0 && fmod(r, 2.0) != 0)) r += 1;
+
+    json_fixed(w, key, signbit(value) ? -(int32_t)r : (int32_t)r, decimals);
+}
+
+static uint16_t render_int(char* buf, uint16_t size)
+{
+    return status_json(buf, size, &readings, &epoch, 1234, 567);
+}
+
+// Previous rendering: doubles for lat/lon and ages
+static uint16_t render_double(char* buf, uint16_t size)
+{
+    double lat = pos.lat_e7 / 1e7, lon = pos.lon_e7 / 1e7;
+    float gps_age = 1234 / 1000.0f, env_age = 567 / 1000.0f;
+    char time_str[32];
+    format_utc_time(pos.year, pos.month, pos.day, pos.hour, pos.min, pos.sec,
+                    time_str, sizeof(time_str));
+
+    json_writer_t w;
+    json_init(&w, buf, size);
+    json_obj_begin(&w, NULL);
+    json_int(&w, "proto_ver", 1);
+    json_str(&w, "device_id", "bp-411-0007");
+    json_str(&w, "time_utc", time_str);
+    json_obj_begin(&w, "gps");
+    json_double(&w, "lat", lat, 6);
+    json_double(&w, "lon", lon, 6);
+    json_int(&w, "fix", pos.fix);
+    json_int(&w, "sats", pos.sats);
+    json_obj_end(&w);
+    json_obj_begin(&w, "env");
+    json_fixed(&w, "t_c", readings.env_tenths[0], 1);
+    json_fixed(&w, "p_hpa", readings.env_tenths[1], 1);
+    json_fixed(&w, "rh_pct", readings.env_tenths[2], 1);
+    json_fixed(&w, "lux", readings.env_tenths[3], 1);
+    json_obj_end(&w);
+    status_json_fix_quality(&w, &epoch);
+    json_obj_begin(&w, "stale_age_s");
+    json_double(&w, "gps", gps_age, 1);
+    json_double(&w, "env", env_age, 1);
+    json_obj_end(&w);
+    json_obj_end(&w);
+    return w.overflow ? 0 : json_len(&w);
+}
+
+static uint16_t render_printf(char* buf, uint16_t size)
+{
+    char time_str[32];
+    format_utc_time(pos.year, pos.month, pos.day, pos.hour, pos.min, pos.sec,
+                    time_str, sizeof(time_str));
+    int n = snprintf(buf, size,
+        "{\"proto_ver\":1,\"device_id\":\"bp-411-0007\",\"time_utc\":\"%s\","
+        "\"gps\":{\"lat\":%.6f,\"lon\":%.6f,\"fix\":%d,\"sats\":%d},"
+        "\"env\":{\"t_c\":%.1f,\"p_hpa\":%.1f,\"rh_pct\":%.1f,\"lux\":%.1f},"
+        "\"fix_quality\":{\"mode\":%d,\"pdop\":%.2f,\"hdop\":%.2f,\"vdop\":%.2f,"
+        "\"course_deg\":%.2f,\"speed_mps\":%.2f,\"in_view\":%d,\"used\":%d},"
+        "\"stale_age_s\":{\"gps\":%.1f,\"env\":%.1f}}",
+        time_str, pos.lat_e7 / 1e7, pos.lon_e7 / 1e7, pos.fix, pos.sats,
+        readings.env_tenths[0] / 10.0, readings.env_tenths[1] / 10.0,
+        readings.env_tenths[2] / 10.0, readings.env_tenths[3] / 10.0,
+        epoch.fix_mode, epoch.pdop / 100.0, epoch.hdop / 100.0, epoch.vdop / 100.0,
+        epoch.course_cdeg / 100.0, epoch.speed_cms / 100.0, epoch.in_view, epoch.used_count,
+        1.234, 0.567);
+    return (n > 0 && n < size) ? n : 0;
+}
+
+static double run(const char* name, uint16_t (*render)(char*, uint16_t))
+{
+    char buf[STATUS_JSON_MAX];
+    uint32_t n = 0;
+    uint64_t start = sim_now_ns(), elapsed;
+    volatile uint16_t sink = 0;
+
+    do {
+        for (int i = 0; i < 256; i++) sink += render(buf, sizeof(buf));
+        n += 256;
+        elapsed = sim_now_ns() - start;
+    } while (elapsed < BENCH_NS);
+
+    double rate = n / (elapsed / 1e9);
+    printf("%-8s %4u B  %9.0f docs/s  %6.0f ns/doc\n", name, render(buf, sizeof(buf)), rate, 1e9 / rate);
+    return rate;
+}
+
+int main(void)
+{
+    printf("/status document, host\n");
+    double ints = run("integer", render_int);
+    double dbl = run("double", render_double);
+    run("snprintf", render_printf);
+    printf("integer path %.2fx the double path\n", ints / dbl);
+    return 0;
+}
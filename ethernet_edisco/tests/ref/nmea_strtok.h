@@ -0,0 +1,28 @@
+#ifndef _NMEA_STRTOK_H_
+#define _NMEA_STRTOK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Counters of the old parser, a subset of nmea_stats_t */
+typedef struct {
+    uint32_t lines;
+    uint32_t valid;
+    uint32_t checksum_failed;
+} ref_nmea_stats_t;
+
+void ref_nmea_init(void);
+void ref_nmea_set_baudrate(uint32_t baud);
+void ref_nmea_push_chunk(const uint8_t* buf, size_t len);
+ref_nmea_stats_t ref_nmea_get_stats(void);
+
+/**
+ * Provided by the program using the reference, as gps_on_*() with the
+ * coordinates still in floating-point degrees
+ */
+void ref_on_new_position(double lat, double lon, uint8_t fix, uint8_t sats,
+                         int year, int month, int day, int hour, int min, int sec);
+void ref_on_new_time(int year, int month, int day, int hour, int min, int sec, int ms, uint32_t cyc);
+
+#endif /* _NMEA_STRTOK_H_ */
@@ -0,0 +1,86 @@
+/* hal_sim.c - HAL tick, GPIO and DWT stand-ins for host tests */
+
+#include "hal_sim.h"
+#include "w5500_sim.h"
+#include "main.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+
+uint32_t SystemCoreClock = 96000000;
+
+uint32_t sim_tick = 0;
+uint32_t sim_tick_step = 0;
+void (*sim_tick_hook)(void) = NULL;
+uint32_t sim_resets = 0;
+
+/**
+ * DWT and CoreDebug are plain memory-mapped registers; back the
+ * 0xE0000000 private peripheral page with RAM before main() runs
+ */
+__attribute__((constructor))
+static void map_core_peripherals(void)
+{
+    void* p = mmap((void*)0xE0000000, 0x10000, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p != (void*)0xE0000000) {
+        fprintf(stderr, "hal_sim: cannot map the DWT page at 0xE0000000\n");
+        exit(2);
+    }
+}
+
+void sim_cycles_add(uint32_t cycles)
+{
+    DWT->CYCCNT += cycles;
+}
+
+uint64_t sim_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * INTn stays high in programs built without the W5500 stand-in
+ */
+__attribute__((weak))
+uint8_t sim_int_asserted(void)
+{
+    return 0;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    if (sim_tick_hook) sim_tick_hook();
+    uint32_t t = sim_tick;
+    sim_tick += sim_tick_step;
+    return t;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    sim_tick += Delay;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+    // INTn is active low
+    if (GPIOx == W5500_INT_GPIO_Port && GPIO_Pin == W5500_INT_Pin) {
+        return sim_int_asserted() ? GPIO_PIN_RESET : GPIO_PIN_SET;
+    }
+    return GPIO_PIN_SET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    (void)GPIOx;
+    (void)GPIO_Pin;
+    (void)PinState;
+}
+
+void HAL_NVIC_SystemReset(void)
+{
+    sim_resets++;
+}
@@ -0,0 +1,35 @@
+#ifndef _HAL_SIM_H_
+#define _HAL_SIM_H_
+
+#include <stdint.h>
+
+/* Host replacements for the few HAL/CMSIS pieces the network and parser
+   modules use: the millisecond tick, GPIO (W5500_INT reads the simulated
+   INTn line), system reset and the DWT/CoreDebug registers, which are
+   backed by RAM mapped at their Cortex-M addresses. */
+
+/* HAL_GetTick() value. Time only moves when a test moves it, or by
+   sim_tick_step on every HAL_GetTick() call for code that spins on it. */
+extern uint32_t sim_tick;
+extern uint32_t sim_tick_step;
+
+/**
+ * Called on every HAL_GetTick(), e.g. to let the peer ACK while
+ * send_socket() waits for TX space
+ */
+extern void (*sim_tick_hook)(void);
+
+/* HAL_NVIC_SystemReset() calls, the firmware carries on running */
+extern uint32_t sim_resets;
+
+/**
+ * Advance DWT->CYCCNT, the stand-in for time spent in code
+ */
+void sim_cycles_add(uint32_t cycles);
+
+/**
+ * Monotonic host clock for benchmarks
+ */
+uint64_t sim_now_ns(void);
+
+#endif /* _HAL_SIM_H_ */
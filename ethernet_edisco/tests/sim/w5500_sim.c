@@ -0,0 +1,513 @@
+/* w5500_sim.c - Register-level W5500 stand-in for host tests
+ *
+ * Implements the wizchip SPI hooks from wizchip_conf.h. Each chip select
+ * starts a frame: two address bytes and the control byte (BSB, RWB), then
+ * data bytes that read or write the selected block with auto-increment,
+ * the same VDM framing w5500.c builds.
+ */
+
+#include "w5500_sim.h"
+#include "w5500.h"
+#include "wizchip_conf.h"
+#include <string.h>
+
+// Socket register offsets within a block
+#define SR_MR       0x00
+#define SR_CR       0x01
+#define SR_IR       0x02
+#define SR_SR       0x03
+#define SR_DIPR     0x0C
+#define SR_DPORT    0x10
+#define SR_RXSIZE   0x1E
+#define SR_TXSIZE   0x1F
+#define SR_TX_FSR   0x20
+#define SR_TX_RD    0x22
+#define SR_TX_WR    0x24
+#define SR_RX_RSR   0x26
+#define SR_RX_RD    0x28
+#define SR_RX_WR    0x2A
+#define SR_IMR      0x2C
+#define SR_ACKED    0x3E    // Unused offset: TX_RD the peer has acknowledged up to
+
+uint8_t sim_common[0x40];
+uint8_t sim_sreg[SIM_SOCKETS][0x40];
+uint8_t sim_wire[SIM_SOCKETS][SIM_WIRE_MAX];
+uint32_t sim_wire_len[SIM_SOCKETS];
+sim_stats_t sim_stats;
+
+void (*sim_send_hook)(uint8_t sn, const uint8_t* dip, uint16_t dport,
+                      const uint8_t* data, uint16_t len) = NULL;
+void (*sim_int_edge)(void) = NULL;
+void (*sim_select_hook)(void) = NULL;
+
+static uint8_t tx_mem[SIM_SOCKETS][SIM_BUF_MAX];
+static uint8_t rx_mem[SIM_SOCKETS][SIM_BUF_MAX];
+
+static uint8_t hold_sendok[SIM_SOCKETS];
+static uint8_t sending[SIM_SOCKETS];
+static uint8_t hold_ack[SIM_SOCKETS];
+
+static uint8_t int_level = 0;
+
+// DMA transfer whose completion interrupt is held back
+static uint8_t dma_hold = 0;
+static const uint8_t* dma_tx = NULL;
+static uint8_t* dma_rx = NULL;
+static uint16_t dma_len = 0;
+static uint8_t dma_open = 0;
+
+// Current SPI frame
+static uint8_t hdr[3];
+static uint8_t hdr_len = 0;
+static uint16_t addr = 0;
+
+/* ---- Registers ---- */
+
+static uint16_t buf_size(uint8_t kb)
+{
+    return (uint16_t)kb * 1024;
+}
+
+uint8_t sim_reg(uint8_t sn, uint8_t off)
+{
+    return sim_sreg[sn][off];
+}
+
+uint16_t sim_reg16(uint8_t sn, uint8_t off)
+{
+    return (sim_sreg[sn][off] << 8) | sim_sreg[sn][off + 1];
+}
+
+void sim_set_reg(uint8_t sn, uint8_t off, uint8_t val)
+{
+    sim_sreg[sn][off] = val;
+}
+
+void sim_set_reg16(uint8_t sn, uint8_t off, uint16_t val)
+{
+    sim_sreg[sn][off] = val >> 8;
+    sim_sreg[sn][off + 1] = val & 0xFF;
+}
+
+static uint8_t sir_value(void)
+{
+    uint8_t sir = 0;
+    for (uint8_t sn = 0; sn < SIM_SOCKETS; sn++) {
+        if (sim_sreg[sn][SR_IR] & sim_sreg[sn][SR_IMR]) sir |= 1 << sn;
+    }
+    return sir;
+}
+
+uint8_t sim_int_asserted(void)
+{
+    return (sir_value() & sim_common[W5500_SIMR]) != 0 ||
+           (sim_common[W5500_IR] & sim_common[W5500_IMR]) != 0;
+}
+
+/**
+ * Re-evaluate INTn after anything that touched flags or masks
+ */
+static void update_int(void)
+{
+    uint8_t level = sim_int_asserted();
+    uint8_t edge = level && !int_level;
+
+    int_level = level;
+    if (edge && sim_int_edge) sim_int_edge();
+}
+
+void sim_raise(uint8_t sn, uint8_t ir)
+{
+    sim_sreg[sn][SR_IR] |= ir;
+    update_int();
+}
+
+/**
+ * Register and buffer state after RST or MR.RST
+ */
+static void chip_reset(void)
+{
+    memset(sim_common, 0, sizeof(sim_common));
+    memset(sim_sreg, 0, sizeof(sim_sreg));
+    memset(tx_mem, 0, sizeof(tx_mem));
+    memset(rx_mem, 0, sizeof(rx_mem));
+    memset(sending, 0, sizeof(sending));
+
+    sim_common[0x19] = 0x07;    // RTR 200 ms
+    sim_common[0x1A] = 0xD0;
+    sim_common[0x1B] = 0x08;    // RCR
+    sim_common[0x2E] = 0xBF;    // PHYCFGR: link up, 100 full duplex
+    sim_common[0x39] = 0x04;    // VERSIONR
+    for (uint8_t sn = 0; sn < SIM_SOCKETS; sn++) {
+        sim_sreg[sn][SR_RXSIZE] = 2;
+        sim_sreg[sn][SR_TXSIZE] = 2;
+        sim_sreg[sn][SR_IMR] = 0xFF;
+    }
+    int_level = 0;
+}
+
+void sim_reset(void)
+{
+    chip_reset();
+    memset(sim_wire_len, 0, sizeof(sim_wire_len));
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    memset(hold_sendok, 0, sizeof(hold_sendok));
+    memset(hold_ack, 0, sizeof(hold_ack));
+    hdr_len = 0;
+    dma_hold = 0;
+    dma_open = 0;
+}
+
+/* ---- Commands ---- */
+
+static void do_send(uint8_t sn)
+{
+    uint8_t* r = sim_sreg[sn];
+    uint16_t size = buf_size(r[SR_TXSIZE]);
+    uint16_t rd = sim_reg16(sn, SR_TX_RD);
+    uint16_t wr = sim_reg16(sn, SR_TX_WR);
+    uint16_t len = wr - rd;
+    static uint8_t frame[SIM_BUF_MAX];
+
+    if (sending[sn]) sim_stats.dest_race++;     // Overwrites the frame in flight
+    sim_stats.sends++;
+
+    for (uint16_t i = 0; i < len; i++) {
+        frame[i] = tx_mem[sn][(uint16_t)(rd + i) & (size - 1)];
+        sim_wire[sn][sim_wire_len[sn]++ % SIM_WIRE_MAX] = frame[i];
+    }
+    if (sim_send_hook) {
+        sim_send_hook(sn, &r[SR_DIPR], sim_reg16(sn, SR_DPORT), frame, len);
+    }
+
+    // UDP frees the buffer at once, TCP when the peer ACKs
+    if (r[SR_SR] == W5500_SR_SOCK_UDP || !hold_ack[sn]) {
+        sim_set_reg16(sn, SR_TX_RD, wr);
+    }
+    sim_set_reg16(sn, SR_ACKED, wr);
+
+    if (hold_sendok[sn]) {
+        sending[sn] = 1;
+    } else {
+        sim_raise(sn, W5500_Sn_IR_SENDOK);
+    }
+}
+
+static void do_command(uint8_t sn, uint8_t cmd)
+{
+    uint8_t* r = sim_sreg[sn];
+
+    switch (cmd) {
+        case W5500_CR_OPEN:
+            switch (r[SR_MR] & 0x0F) {
+                case W5500_Sn_MR_TCP:    r[SR_SR] = W5500_SR_SOCK_INIT; break;
+                case W5500_Sn_MR_UDP:    r[SR_SR] = W5500_SR_SOCK_UDP; break;
+                case W5500_Sn_MR_MACRAW: r[SR_SR] = W5500_SR_SOCK_MACRAW; break;
+                default:                 r[SR_SR] = W5500_SR_SOCK_CLOSED; break;
+            }
+            sim_set_reg16(sn, SR_TX_RD, 0);
+            sim_set_reg16(sn, SR_TX_WR, 0);
+            sim_set_reg16(sn, SR_RX_RD, 0);
+            sim_set_reg16(sn, SR_RX_WR, 0);
+            sending[sn] = 0;
+            break;
+        case W5500_CR_LISTEN:
+            if (r[SR_SR] == W5500_SR_SOCK_INIT) r[SR_SR] = W5500_SR_SOCK_LISTEN;
+            break;
+        case W5500_CR_CONNECT:
+            if (r[SR_SR] == W5500_SR_SOCK_INIT) {
+                r[SR_SR] = W5500_SR_SOCK_ESTABLISHED;
+                sim_raise(sn, W5500_Sn_IR_CON);
+            }
+            break;
+        case W5500_CR_DISCON:
+            // Peer answers the FIN at once
+            if (r[SR_SR] != W5500_SR_SOCK_CLOSED) {
+                r[SR_SR] = W5500_SR_SOCK_CLOSED;
+                sim_raise(sn, W5500_Sn_IR_DISCON);
+            }
+            break;
+        case W5500_CR_CLOSE:
+            r[SR_SR] = W5500_SR_SOCK_CLOSED;
+            sending[sn] = 0;
+            break;
+        case W5500_CR_SEND:
+        case W5500_CR_SEND_MAC:
+            do_send(sn);
+            break;
+        default:
+            break;
+    }
+}
+
+/* ---- Network side ---- */
+
+void sim_tcp_connect(uint8_t sn)
+{
+    sim_sreg[sn][SR_SR] = W5500_SR_SOCK_ESTABLISHED;
+    sim_raise(sn, W5500_Sn_IR_CON);
+}
+
+void sim_tcp_peer_close(uint8_t sn)
+{
+    sim_sreg[sn][SR_SR] = W5500_SR_SOCK_CLOSE_WAIT;
+    sim_raise(sn, W5500_Sn_IR_DISCON);
+}
+
+static uint16_t rx_free(uint8_t sn)
+{
+    return buf_size(sim_sreg[sn][SR_RXSIZE]) -
+           (uint16_t)(sim_reg16(sn, SR_RX_WR) - sim_reg16(sn, SR_RX_RD));
+}
+
+static void rx_append(uint8_t sn, const uint8_t* p, uint16_t len)
+{
+    uint16_t size = buf_size(sim_sreg[sn][SR_RXSIZE]);
+    uint16_t wr = sim_reg16(sn, SR_RX_WR);
+
+    for (uint16_t i = 0; i < len; i++) {
+        rx_mem[sn][(uint16_t)(wr + i) & (size - 1)] = p[i];
+    }
+    sim_set_reg16(sn, SR_RX_WR, wr + len);
+}
+
+uint16_t sim_tcp_inject(uint8_t sn, const void* data, uint16_t len)
+{
+    uint16_t free = rx_free(sn);
+
+    if (len > free) len = free;
+    if (len == 0) return 0;
+    rx_append(sn, data, len);
+    sim_raise(sn, W5500_Sn_IR_RECV);
+    return len;
+}
+
+int sim_udp_inject(uint8_t sn, const uint8_t* sip, uint16_t sport, const void* data, uint16_t len)
+{
+    uint8_t h[8] = { sip[0], sip[1], sip[2], sip[3],
+                     sport >> 8, sport & 0xFF, len >> 8, len & 0xFF };
+
+    if (rx_free(sn) < len + 8) return -1;
+    rx_append(sn, h, 8);
+    rx_append(sn, data, len);
+    sim_raise(sn, W5500_Sn_IR_RECV);
+    return 0;
+}
+
+void sim_hold_sendok(uint8_t sn, uint8_t hold)
+{
+    hold_sendok[sn] = hold;
+    if (!hold) sim_send_done(sn);
+}
+
+void sim_send_done(uint8_t sn)
+{
+    if (!sending[sn]) return;
+    sending[sn] = 0;
+    sim_raise(sn, W5500_Sn_IR_SENDOK);
+}
+
+void sim_send_timeout(uint8_t sn)
+{
+    if (!sending[sn]) return;
+    sending[sn] = 0;
+    sim_raise(sn, W5500_Sn_IR_TIMEOUT);
+}
+
+uint8_t sim_send_pending(uint8_t sn)
+{
+    return sending[sn];
+}
+
+void sim_hold_ack(uint8_t sn, uint8_t hold)
+{
+    hold_ack[sn] = hold;
+    if (!hold) sim_tcp_ack(sn);
+}
+
+void sim_tcp_ack(uint8_t sn)
+{
+    sim_set_reg16(sn, SR_TX_RD, sim_reg16(sn, SR_ACKED));
+}
+
+/* ---- SPI frame decoding ---- */
+
+static uint8_t read_byte(void)
+{
+    uint8_t bsb = hdr[2] >> 3;
+    uint16_t off = addr++;
+
+    if (bsb == 0) {
+        if (off == W5500_SIR) return sir_value();
+        return (off < 0x40) ? sim_common[off] : 0;
+    }
+
+    uint8_t sn = (bsb - 1) >> 2;
+    uint8_t* r = sim_sreg[sn];
+    switch ((bsb - 1) & 0x03) {
+        case 0:
+            if (off >= 0x40) return 0;
+            if (off == SR_CR) return 0;     // Commands are accepted at once
+            if (off == SR_TX_FSR || off == SR_TX_FSR + 1) {
+                uint16_t fsr = buf_size(r[SR_TXSIZE]) -
+                               (uint16_t)(sim_reg16(sn, SR_TX_WR) - sim_reg16(sn, SR_TX_RD));
+                return (off == SR_TX_FSR) ? fsr >> 8 : fsr & 0xFF;
+            }
+            if (off == SR_RX_RSR || off == SR_RX_RSR + 1) {
+                uint16_t rsr = sim_reg16(sn, SR_RX_WR) - sim_reg16(sn, SR_RX_RD);
+                return (off == SR_RX_RSR) ? rsr >> 8 : rsr & 0xFF;
+            }
+            return r[off];
+        case 1:
+            return tx_mem[sn][off & (buf_size(r[SR_TXSIZE]) - 1)];
+        case 2:
+            return rx_mem[sn][off & (buf_size(r[SR_RXSIZE]) - 1)];
+        default:
+            return 0;
+    }
+}
+
+static void write_byte(uint8_t val)
+{
+    uint8_t bsb = hdr[2] >> 3;
+    uint16_t off = addr++;
+
+    if (bsb == 0) {
+        if (off >= 0x40) return;
+        if (off == W5500_MR && (val & 0x80)) {
+            chip_reset();                   // Software reset, RST clears itself
+        } else if (off == W5500_IR) {
+            sim_common[off] &= ~val;        // Write 1 to clear
+        } else if (off != W5500_SIR) {
+            sim_common[off] = val;
+        }
+        update_int();
+        return;
+    }
+
+    uint8_t sn = (bsb - 1) >> 2;
+    uint8_t* r = sim_sreg[sn];
+    switch ((bsb - 1) & 0x03) {
+        case 0:
+            if (off >= 0x40) return;
+            if (off == SR_CR) {
+                do_command(sn, val);
+            } else if (off == SR_IR) {
+                r[SR_IR] &= ~val;
+            } else {
+                if (off >= SR_DIPR && off < SR_DPORT + 2 && sending[sn]) sim_stats.dest_race++;
+                r[off] = val;
+            }
+            update_int();
+            break;
+        case 1:
+            tx_mem[sn][off & (buf_size(r[SR_TXSIZE]) - 1)] = val;
+            break;
+        case 2:
+            rx_mem[sn][off & (buf_size(r[SR_RXSIZE]) - 1)] = val;
+            break;
+    }
+}
+
+static void feed(uint8_t val)
+{
+    sim_stats.bytes++;
+    if (hdr_len < 3) {
+        hdr[hdr_len++] = val;
+        if (hdr_len == 3) addr = (hdr[0] << 8) | hdr[1];
+        return;
+    }
+    if (hdr[2] & 0x04) write_byte(val);
+}
+
+static uint8_t clock_in(void)
+{
+    sim_stats.bytes++;
+    return read_byte();
+}
+
+/* ---- wizchip hooks ---- */
+
+void wizchip_select(void)
+{
+    sim_stats.hook_calls++;
+    sim_stats.frames++;
+    if (dma_open) sim_stats.dma_overlap++;
+    hdr_len = 0;
+    if (sim_select_hook) sim_select_hook();
+}
+
+void wizchip_deselect(void)
+{
+    sim_stats.hook_calls++;
+}
+
+uint8_t wiz_spi_readbyte(void)
+{
+    sim_stats.hook_calls++;
+    return clock_in();
+}
+
+void wiz_spi_writebyte(uint8_t byte)
+{
+    sim_stats.hook_calls++;
+    feed(byte);
+}
+
+void wiz_spi_readburst(uint8_t* buf, uint16_t len)
+{
+    sim_stats.hook_calls++;
+    for (uint16_t i = 0; i < len; i++) buf[i] = clock_in();
+}
+
+void wiz_spi_writeburst(const uint8_t* buf, uint16_t len)
+{
+    sim_stats.hook_calls++;
+    for (uint16_t i = 0; i < len; i++) feed(buf[i]);
+}
+
+int wiz_spi_dma_start(const uint8_t* tx, uint8_t* rx, uint16_t len)
+{
+    sim_stats.hook_calls++;
+    sim_stats.dma_frames++;
+
+    dma_tx = tx;
+    dma_rx = rx;
+    dma_len = len;
+    dma_open = 1;
+    if (!dma_hold) sim_dma_irq();
+    return 0;
+}
+
+void wiz_spi_dma_abort(void)
+{
+    sim_stats.hook_calls++;
+    dma_open = 0;
+}
+
+void sim_hold_dma(uint8_t hold)
+{
+    dma_hold = hold;
+    if (!hold) sim_dma_irq();
+}
+
+uint8_t sim_dma_pending(void)
+{
+    return dma_open;
+}
+
+void sim_dma_irq(void)
+{
+    if (!dma_open) return;
+
+    // The bytes are clocked when the interrupt is due, so a buffer the
+    // caller changes too early shows up on the wire
+    for (uint16_t i = 0; i < dma_len; i++) {
+        if (dma_rx) dma_rx[i] = clock_in();
+        else        feed(dma_tx[i]);
+    }
+    dma_open = 0;
+
+    // Transfer complete interrupt
+    w5500_dma_complete(0);
+}
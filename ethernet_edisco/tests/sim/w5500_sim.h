@@ -0,0 +1,122 @@
+#ifndef _W5500_SIM_H_
+#define _W5500_SIM_H_
+
+#include <stdint.h>
+
+/* Host stand-in for the W5500, wired in behind the wizchip SPI hooks
+   (wizchip_conf.h) so the driver, socket layer and protocol modules run
+   unmodified. Registers, socket buffers, commands and the INTn line are
+   modelled; the network side is driven by the test through sim_*() calls.
+
+   What the chip would put on the wire is captured per socket: the raw
+   stream in sim_wire[] and every SEND through sim_send_hook, which sees
+   Sn_DIPR/Sn_DPORT as they were when the command was issued. */
+
+#define SIM_SOCKETS         8
+#define SIM_BUF_MAX         16384
+#define SIM_WIRE_MAX        65536
+
+/* Raw register file: common block and one 64-byte block per socket */
+extern uint8_t sim_common[0x40];
+extern uint8_t sim_sreg[SIM_SOCKETS][0x40];
+
+/* TCP byte stream (or UDP payloads back to back) sent per socket */
+extern uint8_t  sim_wire[SIM_SOCKETS][SIM_WIRE_MAX];
+extern uint32_t sim_wire_len[SIM_SOCKETS];
+
+typedef struct {
+    uint32_t frames;            // Chip selects
+    uint32_t hook_calls;        // wizchip SPI hook calls (HAL calls on target)
+    uint32_t dma_frames;
+    uint32_t dma_overlap;       // Chip selects while a DMA transfer was still open
+    uint32_t bytes;             // Bytes clocked over SPI, headers included
+    uint32_t sends;             // SEND commands
+    uint32_t dest_race;         // Sn_DIPR/Sn_DPORT written or SEND issued before SENDOK
+} sim_stats_t;
+
+extern sim_stats_t sim_stats;
+
+/**
+ * Called for every SEND. For UDP, dip/dport are the datagram's destination.
+ */
+extern void (*sim_send_hook)(uint8_t sn, const uint8_t* dip, uint16_t dport,
+                             const uint8_t* data, uint16_t len);
+
+/**
+ * Falling edge on INTn, point it at w5500_event_irq() to emulate the EXTI line
+ */
+extern void (*sim_int_edge)(void);
+
+/**
+ * Called at every chip select, before the frame: lets a test change chip
+ * state between two SPI accesses of the code under test
+ */
+extern void (*sim_select_hook)(void);
+
+/**
+ * Power-on state: all registers cleared, 2 KB buffers, nothing captured
+ */
+void sim_reset(void);
+
+uint8_t  sim_reg(uint8_t sn, uint8_t off);
+uint16_t sim_reg16(uint8_t sn, uint8_t off);
+void     sim_set_reg(uint8_t sn, uint8_t off, uint8_t val);
+void     sim_set_reg16(uint8_t sn, uint8_t off, uint16_t val);
+
+/**
+ * Set Sn_IR flags as the chip would (SIR and INTn follow the masks)
+ */
+void sim_raise(uint8_t sn, uint8_t ir);
+
+/**
+ * INTn level: 1 while an unmasked interrupt is pending (pin reads low)
+ */
+uint8_t sim_int_asserted(void);
+
+/**
+ * A peer connected to a LISTEN socket: ESTABLISHED + CON
+ */
+void sim_tcp_connect(uint8_t sn);
+
+/**
+ * The peer sent FIN: CLOSE_WAIT + DISCON
+ */
+void sim_tcp_peer_close(uint8_t sn);
+
+/**
+ * Append TCP data to the RX buffer and raise RECV
+ * @return Bytes stored (RX buffer may be full)
+ */
+uint16_t sim_tcp_inject(uint8_t sn, const void* data, uint16_t len);
+
+/**
+ * Append one UDP datagram with its 8-byte W5500 header and raise RECV
+ * @return 0, -1 if it does not fit
+ */
+int sim_udp_inject(uint8_t sn, const uint8_t* sip, uint16_t sport, const void* data, uint16_t len);
+
+/**
+ * While held, SEND copies data out but SENDOK waits for sim_send_done(),
+ * like a UDP send stuck in ARP or a slow TCP segment
+ */
+void sim_hold_sendok(uint8_t sn, uint8_t hold);
+void sim_send_done(uint8_t sn);
+void sim_send_timeout(uint8_t sn);     // ARP failed: TIMEOUT instead of SENDOK
+uint8_t sim_send_pending(uint8_t sn);
+
+/**
+ * While held, sent TCP data stays unacknowledged and Sn_TX_FSR does not
+ * recover until sim_tcp_ack()
+ */
+void sim_hold_ack(uint8_t sn, uint8_t hold);
+void sim_tcp_ack(uint8_t sn);
+
+/**
+ * DMA transfers complete at once unless held: then the data moves and the
+ * completion interrupt fires at sim_dma_irq(), e.g. from sim_tick_hook
+ */
+void    sim_hold_dma(uint8_t hold);
+void    sim_dma_irq(void);
+uint8_t sim_dma_pending(void);
+
+#endif /* _W5500_SIM_H_ */
@@ -0,0 +1,146 @@
+/* test_bme.c - BME280 compensation against golden vectors
+ *
+ * The driver reads its calibration from a register map kept here
+ * (i2c_bus_*() are stubbed) and decodes raw bursts into T/P/H. Expected
+ * values come from the Bosch reference formulas (datasheet section 4.2.3)
+ * evaluated on the unshifted calibration words, so the shifts bme.c
+ * applies once at init and the 12-bit H4/H5 sign extension are checked
+ * along with the arithmetic. Built twice: test_bme with the 64-bit
+ * pressure formula, test_bme32 with BME280_PRESSURE_32BIT.
+ */
+
+#include "bme.h"
+#include "i2c_bus.h"
+#include "sensors.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static uint8_t regs[256];
+
+int i2c_bus_read_blocking(uint8_t addr, int16_t reg, uint8_t* buf, uint16_t len)
+{
+    memcpy(buf, regs + reg, len);
+    return 0;
+}
+
+int i2c_bus_write_blocking(uint8_t addr, int16_t reg, const uint8_t* data, uint16_t len)
+{
+    memcpy(regs + reg, data, len);
+    return 0;
+}
+
+int i2c_bus_write(uint8_t addr, int16_t reg, const uint8_t* data, uint8_t len,
+                  i2c_bus_done_t done, void* ctx)
+{
+    memcpy(regs + reg, data, len);
+    return 0;
+}
+
+uint8_t i2c_bus_free(void)
+{
+    return 8;
+}
+
+/* Calibration words as the datasheet names them */
+typedef struct {
+    uint16_t t1; int16_t t2, t3;
+    uint16_t p1; int16_t p2, p3, p4, p5, p6, p7, p8, p9;
+    uint8_t  h1; int16_t h2; uint8_t h3; int16_t h4, h5; int8_t h6;
+} calib_t;
+
+/* Datasheet example set; H3-H6 also in a variant with H4/H5 below zero */
+static const calib_t cal_pos = {
+    27504, 26435, -1000,
+    36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+    75, 362, 0, 314, 50, 30,
+};
+static const calib_t cal_neg = {
+    27504, 26435, -1000,
+    36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+    75, 362, 4, -5, -30, -12,
+};
+
+static void put16(uint8_t reg, uint16_t v)
+{
+    regs[reg] = v;
+    regs[reg + 1] = v >> 8;
+}
+
+static void load(const calib_t* c)
+{
+    memset(regs, 0, sizeof(regs));
+    regs[0xD0] = 0x60;
+    put16(0x88, c->t1); put16(0x8A, c->t2); put16(0x8C, c->t3);
+    put16(0x8E, c->p1); put16(0x90, c->p2); put16(0x92, c->p3);
+    put16(0x94, c->p4); put16(0x96, c->p5); put16(0x98, c->p6);
+    put16(0x9A, c->p7); put16(0x9C, c->p8); put16(0x9E, c->p9);
+    regs[0xA1] = c->h1;
+    put16(0xE1, c->h2);
+    regs[0xE3] = c->h3;
+    // H4 = E4[7:0] E5[3:0], H5 = E6[7:0] E5[7:4], both 12-bit signed
+    regs[0xE4] = (c->h4 >> 4) & 0xFF;
+    regs[0xE5] = (c->h4 & 0x0F) | ((c->h5 & 0x0F) << 4);
+    regs[0xE6] = (c->h5 >> 4) & 0xFF;
+    regs[0xE7] = c->h6;
+
+    sensor_schedule_t sched;
+    assert(bme280_driver.init(0x76, &sched) == 0);
+}
+
+/* Burst from 0xF7: pressure and temperature 20 bits, humidity 16 */
+static int decode(int32_t adc_t, int32_t adc_p, int32_t adc_h, sensor_values_t* out)
+{
+    uint8_t b[8] = {
+        adc_p >> 12, adc_p >> 4, (adc_p & 0x0F) << 4,
+        adc_t >> 12, adc_t >> 4, (adc_t & 0x0F) << 4,
+        adc_h >> 8, adc_h,
+    };
+    memset(out, 0, sizeof(*out));
+    return bme280_driver.decode(b, out);
+}
+
+typedef struct {
+    const calib_t* cal;
+    int32_t adc_t, adc_p, adc_h;
+    int32_t t_cdeg;
+    int32_t p64_pa, p32_pa;
+    int32_t h_q10;          // 1/1024 %RH
+} golden_t;
+
+static const golden_t golden[] = {
+    { &cal_pos, 519888, 415148, 30000,  2508, 100653, 100656,  55953 },   // 25.08 C, 54.6 %
+    { &cal_neg, 519888, 415148,  9500,  2508, 100653, 100656,  55125 },   // 53.8 %
+    { &cal_neg, 400000, 350000,  4000, -1264, 105492, 105494,  23462 },   // -12.64 C, 22.9 %
+    { &cal_pos, 519888, 415148,     0,  2508, 100653, 100656,      0 },   // Clamped at 0 %
+    { &cal_pos, 519888, 415148, 65535,  2508, 100653, 100656, 102400 },   // and at 100 %
+};
+
+int main(void)
+{
+    sensor_values_t v;
+
+    for (size_t i = 0; i < sizeof(golden) / sizeof(golden[0]); i++) {
+        const golden_t* g = &golden[i];
+        int32_t p = BME280_PRESSURE_32BIT ? g->p32_pa : g->p64_pa;
+        load(g->cal);
+        assert(decode(g->adc_t, g->adc_p, g->adc_h, &v) == 0);
+        assert(v.mask == ((1 << SENSOR_TEMP) | (1 << SENSOR_PRESS) | (1 << SENSOR_HUM)));
+        if (v.value[SENSOR_TEMP] != g->t_cdeg || v.value[SENSOR_PRESS] != p ||
+            v.value[SENSOR_HUM] != g->h_q10) {
+            fprintf(stderr, "vector %u: want T %d P %d H %d\n", (unsigned)i, g->t_cdeg, p, g->h_q10);
+            return 1;
+        }
+    }
+
+    // Channels that never converted keep the reset value and are left out
+    load(&cal_pos);
+    assert(decode(519888, 0x80000, 30000, &v) == 0);
+    assert(v.mask == ((1 << SENSOR_TEMP) | (1 << SENSOR_HUM)));
+    assert(decode(519888, 415148, 0x8000, &v) == 0);
+    assert(v.mask == ((1 << SENSOR_TEMP) | (1 << SENSOR_PRESS)));
+    assert(decode(0x80000, 415148, 30000, &v) == -1);
+
+    printf("test_bme%s: ok\n", BME280_PRESSURE_32BIT ? "32" : "");
+    return 0;
+}
@@ -0,0 +1,5 @@
+/* test_bme32.c - test_bme with BME280_PRESSURE_32BIT (set in the Makefile,
+ * for bme.c as well)
+ */
+
+#include "test_bme.c"
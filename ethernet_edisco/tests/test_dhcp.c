@@ -0,0 +1,331 @@
+/* test_dhcp.c - DHCP client against a scripted server on the W5500 stand-in
+ *
+ * The server side answers the client's last datagram with OFFER, ACK or
+ * NAK as each case scripts it, or stays silent. Covers acquisition,
+ * RENEWING at T1 (unicast to the server), REBINDING at T2 (broadcast),
+ * lease expiry, NAK, the static fallback and its periodic DISCOVER, and
+ * the destination registers while a SEND is slow to complete: the client
+ * must not switch Sn_DIPR between the server and broadcast before the
+ * previous datagram got SENDOK or TIMEOUT.
+ */
+
+#include "dhcp.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include "wizchip_conf.h"
+#include "w5500_sim.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SN              DHCP_SOCKET
+#define STEP_MS         50      // Tick advance per main loop pass
+
+typedef struct {
+    uint8_t  dip[4];
+    uint16_t dport;
+    uint16_t len;
+    uint8_t  data[600];
+} datagram_t;
+
+static datagram_t last;         // Client's latest datagram
+static uint32_t sent_count;
+static uint32_t changes;        // Address change callbacks
+
+static const uint8_t server[4] = { 192, 168, 1, 1 };
+static const uint8_t bcast[4] = { 255, 255, 255, 255 };
+
+static void on_send(uint8_t sn, const uint8_t* dip, uint16_t dport, const uint8_t* data, uint16_t len)
+{
+    if (sn != SN) return;
+    assert(len <= sizeof(last.data));
+    memcpy(last.dip, dip, 4);
+    last.dport = dport;
+    last.len = len;
+    memcpy(last.data, data, len);
+    sent_count++;
+}
+
+static void on_change(void)
+{
+    changes++;
+}
+
+static void run_loop(int passes)
+{
+    for (int i = 0; i < passes; i++) {
+        w5500_event_process();
+        socket_cmd_process();
+        dhcp_process();
+        sim_tick += STEP_MS;
+    }
+}
+
+static uint32_t get32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * Option of the client's last datagram, length or -1
+ */
+static int option(uint8_t code, uint8_t* out)
+{
+    uint16_t pos = 240;
+    while (pos < last.len && last.data[pos] != 255) {
+        if (last.data[pos] == 0) {
+            pos++;
+            continue;
+        }
+        uint8_t len = last.data[pos + 1];
+        if (last.data[pos] == code) {
+            if (out) memcpy(out, last.data + pos + 2, len);
+            return len;
+        }
+        pos += 2 + len;
+    }
+    return -1;
+}
+
+/**
+ * Message type of the client's last datagram, after checking its framing
+ */
+static uint8_t last_type(void)
+{
+    uint8_t type;
+    assert(last.len >= 300 && last.data[0] == 1 && get32(last.data + 236) == 0x63825363);
+    assert(last.dport == 67 && option(53, &type) == 1);
+    return type;
+}
+
+/**
+ * Run until the client sends, return the message type, 0 if it stayed quiet
+ */
+static uint8_t run_until_sent(uint32_t max_ms)
+{
+    uint32_t count = sent_count;
+    uint32_t end = sim_tick + max_ms;
+    while ((int32_t)(sim_tick - end) < 0) {
+        run_loop(1);
+        if (sent_count != count) return last_type();
+    }
+    return 0;
+}
+
+static uint8_t* put32(uint8_t* p, uint8_t code, uint32_t v)
+{
+    p[0] = code;
+    p[1] = 4;
+    p[2] = v >> 24;
+    p[3] = v >> 16;
+    p[4] = v >> 8;
+    p[5] = v;
+    return p + 6;
+}
+
+/**
+ * Server reply to the client's last datagram, same xid and chaddr
+ * @param lease, t1 Seconds, 0 leaves the option out
+ */
+static void reply(uint8_t type, const uint8_t* yiaddr, uint32_t lease, uint32_t t1)
+{
+    uint8_t b[300] = { 0 };
+    b[0] = 2;
+    b[1] = 1;
+    b[2] = 6;
+    memcpy(b + 4, last.data + 4, 4);
+    memcpy(b + 16, yiaddr, 4);
+    memcpy(b + 28, last.data + 28, 6);
+    memcpy(b + 236, "\x63\x82\x53\x63", 4);
+
+    uint8_t* p = b + 240;
+    *p++ = 53; *p++ = 1; *p++ = type;
+    *p++ = 54; *p++ = 4; memcpy(p, server, 4); p += 4;
+    *p++ = 1;  *p++ = 4; memcpy(p, "\xff\xff\xff\x00", 4); p += 4;
+    *p++ = 3;  *p++ = 4; memcpy(p, server, 4); p += 4;
+    *p++ = 6;  *p++ = 4; memcpy(p, "\x01\x01\x01\x01", 4); p += 4;
+    if (lease) p = put32(p, 51, lease);
+    if (t1) p = put32(p, 58, t1);
+    *p = 255;
+
+    assert(sim_udp_inject(SN, server, 67, b, sizeof(b)) == 0);
+}
+
+static uint8_t sipr_is(const uint8_t* ip)
+{
+    return memcmp(&sim_common[0x0F], ip, 4) == 0;
+}
+
+static uint8_t dest_is(const uint8_t* ip)
+{
+    return memcmp(&sim_sreg[SN][0x0C], ip, 4) == 0 && sim_reg16(SN, 0x10) == 67;
+}
+
+static void test_acquire(const uint8_t* yi)
+{
+    uint8_t b[64];
+
+    assert(run_until_sent(1000) == 1);
+    assert(memcmp(last.dip, bcast, 4) == 0);
+    assert(sim_reg(SN, 0x03) == W5500_SR_SOCK_UDP && sim_reg16(SN, 0x04) == 68);
+    assert(last.data[10] == 0x80 && option(12, b) == 5 && memcmp(b, "panel", 5) == 0);
+    assert(option(61, b) == 7);
+
+    // Retransmission after DHCP_RETRY_MS
+    uint32_t t0 = sim_tick;
+    assert(run_until_sent(5000) == 1);
+    assert(sim_tick - t0 >= DHCP_RETRY_MS && sim_tick - t0 < DHCP_RETRY_MS + 500);
+
+    // An OFFER for another transaction is ignored
+    last.data[4] ^= 1;
+    reply(2, yi, 0, 0);
+    run_loop(3);
+    assert(dhcp_get_state() == DHCP_STATE_SELECTING);
+    last.data[4] ^= 1;
+
+    reply(2, yi, 0, 0);
+    assert(run_until_sent(200) == 3 && dhcp_get_state() == DHCP_STATE_REQUESTING);
+    assert(option(50, b) == 4 && memcmp(b, yi, 4) == 0);
+    assert(option(54, b) == 4 && memcmp(b, server, 4) == 0);
+
+    // ACK, 100 s lease: T1 at 50 s, T2 at 87.5 s
+    reply(5, yi, 100, 0);
+    run_loop(3);
+    assert(dhcp_get_state() == DHCP_STATE_BOUND && changes == 1 && sipr_is(yi));
+    assert(sim_common[0x01] == 192 && sim_common[0x05] == 255);
+    assert(dhcp_lease_remaining() > 95 && dhcp_lease_remaining() <= 100);
+}
+
+static void test_renew_rebind(const uint8_t* yi)
+{
+    uint8_t b[64];
+
+    // Quiet until T1, then a unicast REQUEST from the leased address
+    assert(run_until_sent(49000) == 0);
+    assert(run_until_sent(2000) == 3 && dhcp_get_state() == DHCP_STATE_RENEWING);
+    assert(memcmp(last.dip, server, 4) == 0 && memcmp(last.data + 12, yi, 4) == 0);
+    assert(last.data[10] == 0 && option(50, b) < 0);
+
+    // Renewed with the same lease: no address change
+    reply(5, yi, 100, 0);
+    run_loop(3);
+    assert(dhcp_get_state() == DHCP_STATE_BOUND && changes == 1);
+
+    // Server gone: RENEWING, then REBINDING by broadcast at T2, then the
+    // lease runs out and discovery starts over on the old address
+    assert(run_until_sent(51000) == 3 && dhcp_get_state() == DHCP_STATE_RENEWING);
+    while (dhcp_get_state() == DHCP_STATE_RENEWING) run_until_sent(1000);
+    assert(dhcp_get_state() == DHCP_STATE_REBINDING);
+    assert(last_type() == 3 && memcmp(last.dip, bcast, 4) == 0 && memcmp(last.data + 12, yi, 4) == 0);
+
+    while (dhcp_get_state() == DHCP_STATE_REBINDING) run_until_sent(1000);
+    assert(dhcp_get_state() == DHCP_STATE_SELECTING && sipr_is(yi));
+}
+
+static void test_fallback(void)
+{
+    static const uint8_t fb_ip[4] = { 192, 168, 1, 177 };
+
+    // Nobody answers for DHCP_FALLBACK_MS
+    while (dhcp_get_state() == DHCP_STATE_SELECTING) run_loop(1);
+    assert(dhcp_get_state() == DHCP_STATE_STATIC && changes == 2 && sipr_is(fb_ip));
+    assert(dhcp_lease_remaining() == 0);
+
+    // Still DISCOVERing, once every DHCP_STATIC_RETRY_MS
+    uint32_t t0 = sim_tick;
+    assert(run_until_sent(DHCP_STATIC_RETRY_MS + 1000) == 1);
+    assert(sim_tick - t0 >= DHCP_STATIC_RETRY_MS - 1000);
+}
+
+static void test_nak(void)
+{
+    static const uint8_t yi[4] = { 192, 168, 1, 43 };
+    static const uint8_t fb_ip[4] = { 192, 168, 1, 177 };
+
+    // NAK for the REQUEST: back to DISCOVER right away, fallback kept
+    reply(2, yi, 0, 0);
+    assert(run_until_sent(200) == 3);
+    reply(6, yi, 0, 0);
+    assert(run_until_sent(200) == 1);
+    assert(dhcp_get_state() == DHCP_STATE_STATIC && sipr_is(fb_ip));
+
+    // Then a lease with T1 from option 58
+    reply(2, yi, 0, 0);
+    assert(run_until_sent(200) == 3);
+    reply(5, yi, 3600, 600);
+    run_loop(3);
+    assert(dhcp_get_state() == DHCP_STATE_BOUND && changes == 3 && sipr_is(yi));
+    assert(dhcp_lease_remaining() > 3590 && dhcp_lease_remaining() <= 3600);
+    assert(run_until_sent(599000) == 0);
+    assert(run_until_sent(2000) == 3 && dhcp_get_state() == DHCP_STATE_RENEWING);
+
+    // NAK while RENEWING: the address is gone, start over
+    reply(6, yi, 0, 0);
+    assert(run_until_sent(200) == 1 && dhcp_get_state() == DHCP_STATE_SELECTING);
+}
+
+static void test_slow_send(void)
+{
+    static const uint8_t yi[4] = { 192, 168, 1, 44 };
+    uint32_t races = sim_stats.dest_race;
+
+    // A DISCOVER the chip has not finished: the REQUEST for the OFFER waits
+    sim_hold_sendok(SN, 1);
+    assert(run_until_sent(DHCP_RETRY_MAX_MS) == 1 && sim_send_pending(SN));
+    reply(2, yi, 0, 0);
+    uint32_t count = sent_count;
+    run_loop(5);
+    assert(dhcp_get_state() == DHCP_STATE_REQUESTING && sent_count == count);
+    sim_send_done(SN);
+    assert(run_until_sent(200) == 3 && memcmp(last.dip, bcast, 4) == 0);
+    sim_send_done(SN);
+    reply(5, yi, 3600, 600);
+    run_loop(3);
+    assert(dhcp_get_state() == DHCP_STATE_BOUND && sipr_is(yi));
+
+    // Unicast REQUEST at T1 stuck in ARP, NAK through a relay meanwhile:
+    // the broadcast DISCOVER keeps off Sn_DIPR until the chip gives up
+    assert(run_until_sent(601000) == 3 && dhcp_get_state() == DHCP_STATE_RENEWING);
+    assert(memcmp(last.dip, server, 4) == 0 && sim_send_pending(SN));
+    reply(6, yi, 0, 0);
+    count = sent_count;
+    run_loop(5);
+    assert(dhcp_get_state() == DHCP_STATE_SELECTING && sent_count == count && dest_is(server));
+    sim_send_timeout(SN);
+    assert(run_until_sent(200) == 1 && memcmp(last.dip, bcast, 4) == 0);
+
+    sim_send_done(SN);
+    sim_hold_sendok(SN, 0);
+    assert(sim_stats.dest_race == races);
+    printf("slow SEND: no destination change in flight\n");
+}
+
+int main(void)
+{
+    static const uint8_t yi[4] = { 192, 168, 1, 42 };
+    uint8_t memsize[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+    wiz_NetInfo boot = { .mac = { 0x00, 0x08, 0xDC, 0xAB, 0xCD, 0xEF } };
+    wiz_NetInfo fallback = {
+        .ip = { 192, 168, 1, 177 }, .sn = { 255, 255, 255, 0 }, .gw = { 192, 168, 1, 1 },
+        .dns = { 8, 8, 8, 8 },
+    };
+
+    sim_reset();
+    sim_int_edge = w5500_event_irq;
+    sim_send_hook = on_send;
+    assert(wizchip_init(memsize, memsize) == 0);
+    setnetinfo(&boot);
+    w5500_event_init();
+    dhcp_init(&fallback, "panel", on_change);
+
+    test_acquire(yi);
+    test_renew_rebind(yi);
+    test_fallback();
+    test_nak();
+    test_slow_send();
+
+    printf("test_dhcp: ok\n");
+    return 0;
+}
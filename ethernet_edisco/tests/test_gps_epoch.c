@@ -0,0 +1,188 @@
+/* test_gps_epoch.c - Epoch assembly from RMC/GGA/GSA/GSV/VTG/ZDA
+ *
+ * Sentences go through nmea.c into the real gps.c, and the epoch
+ * gps_get_epoch() hands to /gps/sky and /status is compared field by
+ * field with the values the sentences carry. An epoch is published when
+ * the next fix time arrives, so every case feeds one more time than it
+ * checks.
+ */
+
+#include "nmea.h"
+#include "gps.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void feed(const char* body)
+{
+    char b[128];
+    uint8_t cs = 0;
+    for (const char* p = body; *p; p++) cs ^= (uint8_t)*p;
+    int n = sprintf(b, "$%s*%02X\r\n", body, cs);
+    nmea_push_chunk((const uint8_t*)b, n);
+}
+
+static void feedf(const char* fmt, const char* t)
+{
+    char b[128];
+    snprintf(b, sizeof(b), fmt, t);
+    feed(b);
+}
+
+/* One second of a GPS+GLONASS receiver in NMEA 4.10 */
+static void full_epoch(const char* t)
+{
+    feedf("GNRMC,%s,A,4807.038,N,01131.000,E,10.0,084.4,170926,,,A", t);
+    feed("GNVTG,084.4,T,,M,10.0,N,18.52,K,A");
+    feedf("GNGGA,%s,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,", t);
+    feed("GNGSA,A,3,04,05,09,,,,,,,,,,2.50,1.30,2.10,1");
+    feed("GNGSA,A,3,65,,,,,,,,,,,,2.50,1.30,2.10,2");
+    feed("GPGSV,2,1,05,04,45,120,40,05,10,300,30,09,80,010,45,12,05,200,,1");
+    feed("GPGSV,2,2,05,25,20,020,22,1");
+    feed("GLGSV,1,1,01,65,33,150,35,1");
+    feedf("GNZDA,%s,17,09,2026,00,00", t);
+}
+
+static gps_epoch_t published(void)
+{
+    gps_epoch_t e;
+    gps_get_epoch(&e);
+    return e;
+}
+
+typedef struct {
+    char gnss;
+    uint8_t prn;
+    int8_t elev;
+    uint16_t azim;
+    uint8_t snr;
+    uint8_t used;
+} sat_case_t;
+
+static void check_sats(const gps_epoch_t* e, const sat_case_t* want, uint8_t n)
+{
+    assert(e->sat_count == n);
+    for (uint8_t i = 0; i < n; i++) {
+        const gps_sat_t* s = &e->sats[i];
+        if (s->gnss != want[i].gnss || s->prn != want[i].prn || s->elev_deg != want[i].elev ||
+            s->azim_deg != want[i].azim || s->snr_db != want[i].snr || s->used != want[i].used) {
+            fprintf(stderr, "sat %u: got %c%u el %d az %u snr %u used %u\n", i, s->gnss, s->prn,
+                    s->elev_deg, s->azim_deg, s->snr_db, s->used);
+            abort();
+        }
+    }
+}
+
+static void test_full(void)
+{
+    static const sat_case_t sats[] = {
+        { 'P',  4, 45, 120, 40, 1 },
+        { 'P',  5, 10, 300, 30, 1 },
+        { 'P',  9, 80,  10, 45, 1 },
+        { 'P', 12,  5, 200,  0, 0 },
+        { 'P', 25, 20,  20, 22, 0 },
+        { 'L', 65, 33, 150, 35, 1 },   // GSA system id 2 is GLONASS
+    };
+
+    uint32_t seq = published().seq;
+    full_epoch("120000.00");
+    assert(published().seq == seq);     // Held until the next time
+    full_epoch("120000.10");
+
+    gps_epoch_t e = published();
+    assert(e.seq == seq + 1);
+    assert(e.year == 2026 && e.month == 9 && e.day == 17);
+    assert(e.hour == 12 && e.min == 0 && e.sec == 0 && e.ms == 0);
+    assert(e.fix_mode == 3 && e.pdop == 250 && e.hdop == 130 && e.vdop == 210);
+    assert(e.course_cdeg == 8440 && e.speed_cms == 514);       // 18.52 km/h
+    assert(e.in_view == 6 && e.used_count == 4);
+    check_sats(&e, sats, 6);
+
+    // GGA's fix and satellite count, with the date RMC gave this epoch
+    gps_pos_t p = gps_get_last_position();
+    assert(p.valid && p.fix == 1 && p.sats == 8 && p.lat_e7 == 481173000 && p.lon_e7 == 115166667);
+    assert(p.year == 2026 && p.month == 9 && p.day == 17 && p.sec == 0);
+
+    // The sub-second part alone is a new epoch
+    full_epoch("120000.20");
+    e = published();
+    assert(e.seq == seq + 2 && e.ms == 100);
+}
+
+static void test_partial(void)
+{
+    // ZDA alone sets time and date; nothing left over from the last epoch
+    feed("GNZDA,120001.00,18,09,2026,00,00");
+    feed("GPGSA,A,2,07,,,,,,,,,,,,3.10,2.90,1.00");
+    feed("GPGSV,1,1,01,07,60,090,38");
+    feed("GNZDA,120002.00,18,09,2026,00,00");
+
+    static const sat_case_t sats[] = { { 'P', 7, 60, 90, 38, 1 } };  // GP talker, no system id
+    gps_epoch_t e = published();
+    assert(e.year == 2026 && e.day == 18 && e.sec == 1);
+    assert(e.fix_mode == 2 && e.pdop == 310 && e.hdop == 290 && e.vdop == 100);
+    assert(e.course_cdeg == 0xFFFF && e.speed_cms == 0);
+    check_sats(&e, sats, 1);
+
+    // RMC without VTG still gives course and speed (knots)
+    feed("GPRMC,120003.00,A,4807.038,N,01131.000,E,1.5,270.0,180926,,,A");
+    feed("GNZDA,120003.00,18,09,2026,00,00");
+    feed("GPRMC,120004.00,A,4807.038,N,01131.000,E,1.5,270.0,180926,,,A");
+    e = published();
+    assert(e.sec == 3 && e.course_cdeg == 27000 && e.speed_cms == 77);
+    assert(e.fix_mode == 0 && e.sat_count == 0 && e.used_count == 0);
+}
+
+static void test_signals(void)
+{
+    // NMEA 4.10 repeats a satellite per signal: the strongest one is kept.
+    // A GN GSA without a system id matches the PRN in any system.
+    feed("GNRMC,120010.00,A,4807.038,N,01131.000,E,0.0,,180926,,,A");
+    feed("GNGSA,A,3,11,,,,,,,,,,,,1.00,1.00,1.00");
+    feed("GPGSV,1,1,02,11,50,100,30,14,10,010,20,1");
+    feed("GPGSV,1,1,02,11,50,100,41,14,10,010,,8");
+    feed("GAGSV,1,1,01,11,20,220,33,7");
+    feed("GNRMC,120011.00,A,4807.038,N,01131.000,E,0.0,,180926,,,A");
+
+    static const sat_case_t sats[] = {
+        { 'P', 11, 50, 100, 41, 1 },
+        { 'P', 14, 10,  10, 20, 0 },
+        { 'A', 11, 20, 220, 33, 1 },
+    };
+    gps_epoch_t e = published();
+    assert(e.used_count == 1 && e.in_view == 3);
+    check_sats(&e, sats, 3);
+}
+
+static void test_overflow(void)
+{
+    // More satellites than GPS_MAX_SATS: the rest is only counted in view
+    char b[96];
+    feed("GNRMC,120020.00,A,4807.038,N,01131.000,E,0.0,,180926,,,A");
+    for (int prn = 1; prn <= 40; prn += 4) {
+        snprintf(b, sizeof(b), "GPGSV,10,%d,40,%02d,10,010,30,%02d,20,020,30,%02d,30,030,30,%02d,40,040,30",
+                 prn / 4 + 1, prn, prn + 1, prn + 2, prn + 3);
+        feed(b);
+    }
+    feed("GNRMC,120021.00,A,4807.038,N,01131.000,E,0.0,,180926,,,A");
+
+    gps_epoch_t e = published();
+    assert(e.sat_count == GPS_MAX_SATS && e.in_view == 40);
+    assert(e.sats[0].prn == 1 && e.sats[GPS_MAX_SATS - 1].prn == GPS_MAX_SATS);
+    assert(nmea_get_stats().epoch_parse_us_max >= e.parse_us);
+}
+
+int main(void)
+{
+    gps_init();
+    nmea_parser_init();
+
+    test_full();
+    test_partial();
+    test_signals();
+    test_overflow();
+
+    printf("test_gps_epoch: ok\n");
+    return 0;
+}
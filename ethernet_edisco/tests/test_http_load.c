@@ -0,0 +1,279 @@
+/* test_http_load.c - HTTP pool under 1, 4 and 8 concurrent clients
+ *
+ * Each client opens a connection to the first free listening socket,
+ * sends keep-alive GETs and closes after every tenth request; clients
+ * beyond the five pool sockets wait for one to listen again, as a
+ * browser retrying a refused SYN would. Every response is checked, then
+ * requests/s (host time spent in the firmware loop) and p50/p99/max
+ * latency are reported, in main loop passes and host microseconds. The
+ * latency runs to the last response byte from the request, or from the
+ * connection attempt for the first request on a connection. The 4 client
+ * level runs again with DMA completions held back until the end of the
+ * pass, or until the driver spins on HAL_GetTick() waiting for the bus,
+ * so body copies overlap the rest of the loop as on the target.
+ */
+
+#define _GNU_SOURCE     // memmem
+#include "http_server.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include "wizchip_conf.h"
+#include "w5500_sim.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REQUESTS_PER_LEVEL  4000
+#define REQUESTS_PER_CONN   10
+#define MAX_CLIENTS         8
+
+static uint8_t big_body[3000];
+
+static uint16_t small_handler(const http_request_t* req, char* out, uint16_t out_size,
+                              const uint8_t** body, uint16_t* body_len)
+{
+    static const char text[] = "hello";
+    *body = (const uint8_t*)text;
+    *body_len = 5;
+    return http_write_head(out, out_size, "200 OK", "text/plain", 5, req->keep_alive, NULL);
+}
+
+// Larger than the 2 KB TX buffer: streamed over several SENDs
+static uint16_t big_handler(const http_request_t* req, char* out, uint16_t out_size,
+                            const uint8_t** body, uint16_t* body_len)
+{
+    *body = big_body;
+    *body_len = sizeof(big_body);
+    return http_write_head(out, out_size, "200 OK", "application/octet-stream",
+                           sizeof(big_body), req->keep_alive, NULL);
+}
+
+static const http_route_t routes[] = {
+    { HTTP_METHOD_GET, "/small", small_handler },
+    { HTTP_METHOD_GET, "/big",   big_handler },
+};
+
+typedef enum {
+    CL_CONNECTING = 0,      // Waiting for a listening socket
+    CL_WAITING,             // Request sent, reading the response
+    CL_CLOSING              // Sent Connection: close, waiting for the FIN
+} client_state_t;
+
+typedef struct {
+    uint8_t  state;
+    uint8_t  sn;
+    uint8_t  big;
+    uint16_t on_conn;       // Requests sent on this connection
+    uint32_t served;
+    uint32_t start_pass;
+    uint64_t start_ns;
+    uint32_t connect_pass;  // Since when the client wants a connection
+    uint64_t connect_ns;
+} client_t;
+
+static client_t clients[MAX_CLIENTS];
+static uint32_t lat_pass[REQUESTS_PER_LEVEL + MAX_CLIENTS];
+static uint32_t lat_us[REQUESTS_PER_LEVEL + MAX_CLIENTS];
+static uint32_t done;
+static uint32_t pass;
+static uint64_t loop_ns;
+static uint8_t dma_deferred;
+static uint32_t dma_overlaps;
+
+static void dma_irq_on_tick(void)
+{
+    if (sim_dma_pending()) dma_overlaps++;
+    sim_dma_irq();
+}
+
+static void run_loop(void)
+{
+    uint64_t t0 = sim_now_ns();
+    w5500_event_process();
+    socket_cmd_process();
+    http_server_process();
+    loop_ns += sim_now_ns() - t0;
+    if (dma_deferred && sim_dma_pending()) {
+        // Handlers must not reuse the body while it is being copied out
+        assert(http_server_body_busy(big_body, sizeof(big_body)));
+        dma_overlaps++;
+        sim_dma_irq();
+    }
+    sim_tick++;
+    pass++;
+}
+
+static uint8_t socket_taken(uint8_t sn, uint8_t n)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        if (clients[i].state != CL_CONNECTING && clients[i].sn == sn) return 1;
+    }
+    return 0;
+}
+
+static void send_request(client_t* c)
+{
+    char req[96];
+    uint8_t last = (++c->on_conn == REQUESTS_PER_CONN);
+
+    c->big = (done % 4) == 3;
+    int n = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: dev\r\n%s\r\n",
+                     c->big ? "/big" : "/small", last ? "Connection: close\r\n" : "");
+    sim_wire_len[c->sn] = 0;    // The previous response was read in full
+    // The first request also waited for a free socket
+    c->start_pass = (c->on_conn == 1) ? c->connect_pass : pass;
+    c->start_ns = (c->on_conn == 1) ? c->connect_ns : sim_now_ns();
+    assert(sim_tcp_inject(c->sn, req, n) == n);
+    c->state = CL_WAITING;
+}
+
+/**
+ * Whole response on the wire?
+ */
+static uint8_t response_complete(const client_t* c)
+{
+    const char* r = (const char*)sim_wire[c->sn];
+    uint32_t len = sim_wire_len[c->sn];
+    uint32_t body = c->big ? sizeof(big_body) : 5;
+
+    const char* end = memmem(r, len, "\r\n\r\n", 4);
+    if (!end) return 0;
+    uint32_t head = end + 4 - r;
+    if (len < head + body) return 0;
+
+    assert(len == head + body);
+    assert(memcmp(r, "HTTP/1.1 200 OK\r\n", 17) == 0);
+    if (c->big) assert(memcmp(end + 4, big_body, body) == 0);
+    else        assert(memcmp(end + 4, "hello", 5) == 0);
+    return 1;
+}
+
+/**
+ * Longest-waiting client without a connection, NULL if none
+ */
+static client_t* next_to_connect(uint8_t n)
+{
+    client_t* best = NULL;
+    for (uint8_t i = 0; i < n; i++) {
+        if (clients[i].state != CL_CONNECTING) continue;
+        if (!best || (int32_t)(clients[i].connect_pass - best->connect_pass) < 0) best = &clients[i];
+    }
+    return best;
+}
+
+static void step_clients(uint8_t n)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        client_t* c = &clients[i];
+
+        if (c->state == CL_WAITING && response_complete(c)) {
+            if (done < REQUESTS_PER_LEVEL + MAX_CLIENTS) {
+                lat_pass[done] = pass - c->start_pass;
+                lat_us[done] = (uint32_t)((sim_now_ns() - c->start_ns) / 1000);
+            }
+            done++;
+            c->served++;
+            if (c->on_conn == REQUESTS_PER_CONN) c->state = CL_CLOSING;
+            else send_request(c);
+        } else if (c->state == CL_CLOSING &&
+                   sim_reg(c->sn, 0x03) != W5500_SR_SOCK_ESTABLISHED) {
+            c->state = CL_CONNECTING;
+            c->connect_pass = pass;
+            c->connect_ns = sim_now_ns();
+        }
+    }
+
+    // Listening sockets go to waiting clients in arrival order
+    for (uint8_t sn = HTTP_POOL_FIRST; sn < HTTP_POOL_FIRST + HTTP_POOL_SIZE; sn++) {
+        if (sim_reg(sn, 0x03) != W5500_SR_SOCK_LISTEN || socket_taken(sn, n)) continue;
+        client_t* c = next_to_connect(n);
+        if (!c) break;
+        c->sn = sn;
+        c->on_conn = 0;
+        sim_tcp_connect(sn);
+        send_request(c);
+    }
+}
+
+static int cmp_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(uint32_t* v, uint32_t n, uint32_t pct)
+{
+    qsort(v, n, sizeof(v[0]), cmp_u32);
+    return v[(n - 1) * pct / 100];
+}
+
+static void run_level(uint8_t n)
+{
+    memset(clients, 0, sizeof(clients));
+    for (uint8_t i = 0; i < n; i++) {
+        clients[i].connect_pass = pass;
+        clients[i].connect_ns = sim_now_ns();
+    }
+    done = 0;
+    loop_ns = 0;
+    uint32_t first_pass = pass;
+
+    while (done < REQUESTS_PER_LEVEL) {
+        step_clients(n);
+        run_loop();
+        assert(pass - first_pass < REQUESTS_PER_LEVEL * 50);    // Stalled
+    }
+
+    // Let the last connections finish so the next level starts clean
+    for (uint8_t i = 0; i < n; i++) {
+        if (clients[i].state == CL_WAITING) clients[i].state = CL_CLOSING;
+        if (clients[i].state != CL_CONNECTING) sim_tcp_peer_close(clients[i].sn);
+    }
+    for (int i = 0; i < 20; i++) run_loop();
+    assert(http_server_active() == 0);
+    for (uint8_t i = 0; i < n; i++) assert(clients[i].served > 0);
+
+    uint32_t m = (done < REQUESTS_PER_LEVEL + MAX_CLIENTS) ? done : REQUESTS_PER_LEVEL + MAX_CLIENTS;
+    double rps = done / (loop_ns / 1e9);
+    printf("%u client%s%s: %6u req  %7.0f req/s  passes p50 %u p99 %u max %u"
+           "  host us p50 %u p99 %u max %u\n",
+           n, n == 1 ? " " : "s", dma_deferred ? ", DMA held" : "", done, rps,
+           percentile(lat_pass, m, 50), percentile(lat_pass, m, 99), percentile(lat_pass, m, 100),
+           percentile(lat_us, m, 50), percentile(lat_us, m, 99), percentile(lat_us, m, 100));
+}
+
+int main(void)
+{
+    uint8_t memsize[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+
+    for (uint16_t i = 0; i < sizeof(big_body); i++) big_body[i] = (uint8_t)(i * 13);
+
+    sim_reset();
+    sim_int_edge = w5500_event_irq;
+    assert(wizchip_init(memsize, memsize) == 0);
+    w5500_event_init();
+    http_server_init(routes, sizeof(routes) / sizeof(routes[0]));
+    for (int i = 0; i < 5; i++) run_loop();
+    for (uint8_t sn = HTTP_POOL_FIRST; sn < HTTP_POOL_FIRST + HTTP_POOL_SIZE; sn++) {
+        assert(sim_reg(sn, 0x03) == W5500_SR_SOCK_LISTEN);
+    }
+
+    printf("HTTP pool load, %u sockets\n", HTTP_POOL_SIZE);
+    run_level(1);
+    run_level(4);
+    run_level(8);
+
+    sim_hold_dma(1);
+    sim_tick_hook = dma_irq_on_tick;
+    dma_deferred = 1;
+    run_level(4);
+    sim_tick_hook = NULL;
+    sim_hold_dma(0);
+    assert(dma_overlaps > 0 && sim_stats.dma_overlap == 0);
+
+    printf("test_http_load: ok\n");
+    return 0;
+}
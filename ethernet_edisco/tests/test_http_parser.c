@@ -0,0 +1,357 @@
+/* test_http_parser.c - Request parser against the corpus, split feeds and fuzzing
+ *
+ * corpus/http/<expect>-<name>.http holds raw requests; <expect> is "ok"
+ * when every request in the file must parse, else the status the first
+ * one must fail with. Each file is parsed whole, in every fixed chunk
+ * size and split at every offset, and all of them must agree. The same
+ * files seed a mutation fuzzer that checks the parser's bounds and that
+ * chunking never changes the outcome.
+ */
+
+#include "http_parser.h"
+#include <assert.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CORPUS_DIR      "corpus/http"
+#define CORPUS_MAX      64
+#define SAMPLE_MAX      4096
+#define TRACE_MAX       8
+#define FUZZ_ROUNDS     100000
+
+typedef struct {
+    char     name[64];
+    uint8_t  data[SAMPLE_MAX];
+    uint16_t len;
+} sample_t;
+
+// What the parser reported for one request
+typedef struct {
+    uint8_t  result;
+    uint16_t status;
+    uint8_t  method;
+    uint8_t  version;
+    uint8_t  conn_hdr;
+    uint8_t  accept_gzip;
+    uint8_t  upgrade_ws;
+    uint16_t consumed;      // Bytes of the input belonging to this request
+    char     path[HTTP_MAX_PATH + 1];
+} outcome_t;
+
+typedef struct {
+    uint8_t   count;
+    outcome_t out[TRACE_MAX];
+} trace_t;
+
+static sample_t corpus[CORPUS_MAX];
+static uint8_t corpus_len = 0;
+
+static void load_corpus(void)
+{
+    DIR* d = opendir(CORPUS_DIR);
+    assert(d);
+
+    struct dirent* e;
+    while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] == '.') continue;
+        assert(corpus_len < CORPUS_MAX);
+
+        sample_t* s = &corpus[corpus_len++];
+        char path[128];
+        snprintf(path, sizeof(path), CORPUS_DIR "/%s", e->d_name);
+        snprintf(s->name, sizeof(s->name), "%s", e->d_name);
+
+        FILE* f = fopen(path, "rb");
+        assert(f);
+        s->len = fread(s->data, 1, sizeof(s->data), f);
+        fclose(f);
+    }
+    closedir(d);
+    assert(corpus_len > 0);
+}
+
+static void check_invariants(const http_parser_t* p, http_parse_result_t r)
+{
+    assert(p->path_len <= HTTP_MAX_PATH && p->path[p->path_len] == '\0');
+    assert(p->line_len <= HTTP_MAX_HEADER_LINE);
+    assert(p->tok_len < sizeof(p->tok));
+    assert(p->header_bytes <= HTTP_MAX_HEADERS_SIZE + 1);
+    assert(strlen(p->if_none_match) <= HTTP_MAX_ETAG);
+    assert(strlen(p->ws_key) <= HTTP_WS_KEY_LEN);
+    if (r == HTTP_PARSE_ERROR) {
+        assert(p->status == 400 || p->status == 414 || p->status == 431 || p->status == 501 ||
+               p->status == 505);
+    } else {
+        assert(p->status == 0);
+    }
+}
+
+/**
+ * Parse every request in data, feeding at most the next split[] bytes per
+ * call (cycling through split, 0 = everything left), like the server does
+ * with whatever arrived on the socket
+ */
+static void parse(const uint8_t* data, uint16_t len, const uint16_t* split, uint16_t nsplit,
+                  trace_t* t)
+{
+    http_parser_t p;
+    uint16_t pos = 0, start = 0, k = 0;
+
+    memset(t, 0, sizeof(*t));
+    http_parser_reset(&p);
+
+    while (pos < len && t->count < TRACE_MAX) {
+        uint16_t n = len - pos;
+        uint16_t want = split[k++ % nsplit];
+        if (want && want < n) n = want;
+
+        http_parse_result_t r;
+        uint16_t used = http_parser_feed(&p, (const char*)data + pos, n, &r);
+        assert(used <= n);
+        check_invariants(&p, r);
+        pos += used;
+
+        if (r == HTTP_PARSE_MORE) {
+            assert(used == n);      // Short of a full request everything is taken
+            continue;
+        }
+
+        outcome_t* o = &t->out[t->count++];
+        o->result = r;
+        o->status = p.status;
+        o->method = p.method;
+        o->version = p.version;
+        o->conn_hdr = p.conn_hdr;
+        o->accept_gzip = p.accept_gzip;
+        o->upgrade_ws = p.upgrade_ws;
+        o->consumed = pos - start;
+        strcpy(o->path, p.path);
+        start = pos;
+
+        if (r == HTTP_PARSE_ERROR) return;
+        http_parser_reset(&p);
+    }
+
+    // Unfinished request at the end of the input
+    if (pos > start && t->count < TRACE_MAX) {
+        outcome_t* o = &t->out[t->count++];
+        o->result = HTTP_PARSE_MORE;
+        o->consumed = pos - start;
+    }
+}
+
+static void parse_whole(const uint8_t* data, uint16_t len, trace_t* t)
+{
+    static const uint16_t all = 0;
+    parse(data, len, &all, 1, t);
+}
+
+static void assert_same(const trace_t* a, const trace_t* b, const char* name, const char* how)
+{
+    if (memcmp(a, b, sizeof(*a)) == 0) return;
+    fprintf(stderr, "%s: %s changes the outcome\n", name, how);
+    abort();
+}
+
+static void test_corpus_expectations(void)
+{
+    for (uint8_t i = 0; i < corpus_len; i++) {
+        const sample_t* s = &corpus[i];
+        trace_t t;
+        parse_whole(s->data, s->len, &t);
+        assert(t.count > 0);
+
+        if (strncmp(s->name, "ok-", 3) == 0) {
+            uint16_t total = 0;
+            for (uint8_t k = 0; k < t.count; k++) {
+                if (t.out[k].result != HTTP_PARSE_DONE) {
+                    fprintf(stderr, "%s: request %u not accepted (%u)\n", s->name, k, t.out[k].status);
+                    abort();
+                }
+                total += t.out[k].consumed;
+            }
+            assert(total == s->len);
+        } else {
+            uint16_t status = atoi(s->name);
+            if (t.out[0].result != HTTP_PARSE_ERROR || t.out[0].status != status) {
+                fprintf(stderr, "%s: got result %u status %u\n", s->name, t.out[0].result, t.out[0].status);
+                abort();
+            }
+        }
+    }
+}
+
+static void test_split_feeding(void)
+{
+    for (uint8_t i = 0; i < corpus_len; i++) {
+        const sample_t* s = &corpus[i];
+        trace_t whole, t;
+        parse_whole(s->data, s->len, &whole);
+
+        // Fixed chunk sizes, 1 is byte at a time
+        for (uint16_t chunk = 1; chunk <= s->len; chunk++) {
+            parse(s->data, s->len, &chunk, 1, &t);
+            assert_same(&whole, &t, s->name, "chunk size");
+        }
+
+        // Two chunks, split at every offset
+        for (uint16_t at = 1; at < s->len; at++) {
+            uint16_t split[2] = { at, 0 };
+            parse(s->data, s->len, split, 2, &t);
+            assert_same(&whole, &t, s->name, "split point");
+        }
+    }
+}
+
+static const sample_t* find(const char* name)
+{
+    for (uint8_t i = 0; i < corpus_len; i++) {
+        if (strcmp(corpus[i].name, name) == 0) return &corpus[i];
+    }
+    fprintf(stderr, "corpus file %s missing\n", name);
+    abort();
+}
+
+static void test_parsed_fields(void)
+{
+    trace_t t;
+    const sample_t* s;
+
+    s = find("ok-get-browser.http");
+    parse_whole(s->data, s->len, &t);
+    assert(t.count == 1 && t.out[0].method == HTTP_METHOD_GET && t.out[0].version == 11);
+    assert(strcmp(t.out[0].path, "/status?fmt=json") == 0);
+    assert(t.out[0].conn_hdr == HTTP_CONN_HDR_KEEPALIVE && t.out[0].accept_gzip);
+
+    s = find("ok-pipelined.http");
+    parse_whole(s->data, s->len, &t);
+    assert(t.count == 3);
+    assert(strcmp(t.out[0].path, "/a") == 0 && t.out[1].method == HTTP_METHOD_POST);
+    assert(strcmp(t.out[2].path, "/c") == 0 && t.out[2].conn_hdr == HTTP_CONN_HDR_CLOSE);
+
+    s = find("ok-websocket.http");
+    parse_whole(s->data, s->len, &t);
+    assert(t.out[0].upgrade_ws);
+
+    s = find("ok-http10.http");
+    parse_whole(s->data, s->len, &t);
+    assert(t.out[0].version == 10);
+
+    // The 414 comes at the first byte past the limit, not at the end of the line
+    s = find("414-path-over-limit.http");
+    parse_whole(s->data, s->len, &t);
+    assert(t.out[0].consumed == 4 + HTTP_MAX_PATH + 1);
+
+    // A CR that does not end a line fails at the byte after it, "/st\ratus" is not "/status"
+    s = find("400-cr-in-path.http");
+    parse_whole(s->data, s->len, &t);
+    assert(t.out[0].consumed == 9);
+
+    // Blanks after the Content-Length digits are not part of the body length
+    s = find("ok-content-length-trailing-blank.http");
+    parse_whole(s->data, s->len, &t);
+    assert(t.count == 1 && t.out[0].method == HTTP_METHOD_POST);
+}
+
+/* ---- Fuzzer ---- */
+
+static uint32_t rng = 12345;
+
+static uint32_t rnd(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// Bytes the grammar cares about, picked often so mutations reach deep states
+static const char interesting[] = " \r\n:/?GETPOSHT1.0-\t";
+
+static uint16_t mutate(uint8_t* buf, uint16_t len)
+{
+    int edits = 1 + rnd() % 6;
+    for (int e = 0; e < edits; e++) {
+        uint16_t at = len ? rnd() % len : 0;
+        switch (rnd() % 6) {
+            case 0:     // Flip a bit
+                if (len) buf[at] ^= 1 << (rnd() % 8);
+                break;
+            case 1:     // Replace with an interesting byte
+                if (len) buf[at] = interesting[rnd() % (sizeof(interesting) - 1)];
+                break;
+            case 2:     // Insert a run
+                if (len < SAMPLE_MAX - 64) {
+                    uint16_t n = 1 + rnd() % 64;
+                    memmove(buf + at + n, buf + at, len - at);
+                    uint8_t c = (rnd() & 1) ? rnd() : interesting[rnd() % (sizeof(interesting) - 1)];
+                    memset(buf + at, c, n);
+                    len += n;
+                }
+                break;
+            case 3:     // Delete a run
+                if (len) {
+                    uint16_t n = 1 + rnd() % (len - at);
+                    memmove(buf + at, buf + at + n, len - at - n);
+                    len -= n;
+                }
+                break;
+            case 4:     // Truncate
+                len = at;
+                break;
+            case 5:     // Splice another corpus file in
+                {
+                    const sample_t* o = &corpus[rnd() % corpus_len];
+                    uint16_t n = o->len;
+                    if (at + n > SAMPLE_MAX) n = SAMPLE_MAX - at;
+                    memcpy(buf + at, o->data, n);
+                    if (at + n > len) len = at + n;
+                }
+                break;
+        }
+    }
+    return len;
+}
+
+static void test_fuzz(void)
+{
+    static uint8_t buf[SAMPLE_MAX];
+    uint32_t errors = 0, done = 0;
+
+    for (uint32_t round = 0; round < FUZZ_ROUNDS; round++) {
+        const sample_t* s = &corpus[rnd() % corpus_len];
+        memcpy(buf, s->data, s->len);
+        uint16_t len = mutate(buf, s->len);
+
+        trace_t whole, t;
+        parse_whole(buf, len, &whole);
+
+        uint16_t split[4];
+        for (int k = 0; k < 4; k++) split[k] = 1 + rnd() % 300;
+        parse(buf, len, split, 4, &t);
+        assert_same(&whole, &t, s->name, "random split of a mutated sample");
+
+        for (uint8_t k = 0; k < whole.count; k++) {
+            if (whole.out[k].result == HTTP_PARSE_ERROR) errors++;
+            if (whole.out[k].result == HTTP_PARSE_DONE) done++;
+        }
+    }
+
+    printf("fuzz: %u rounds, %u requests accepted, %u rejected\n", FUZZ_ROUNDS, done, errors);
+    assert(done > 0 && errors > 0);
+}
+
+int main(void)
+{
+    load_corpus();
+
+    test_corpus_expectations();
+    test_split_feeding();
+    test_parsed_fields();
+    test_fuzz();
+
+    printf("test_http_parser: ok (%u corpus files)\n", corpus_len);
+    return 0;
+}
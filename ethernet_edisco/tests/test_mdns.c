@@ -0,0 +1,227 @@
+/* test_mdns.c - mDNS responder on the W5500 stand-in
+ *
+ * Probing and announcing, multicast and unicast answers, and the
+ * destination registers around a SEND that is slow to complete: a reply
+ * must not move Sn_DIPR/Sn_DPORT while the chip is still sending the
+ * previous datagram, and the group address comes back only after the
+ * unicast reply got SENDOK or TIMEOUT.
+ */
+
+#include "mdns.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include "wizchip_conf.h"
+#include "w5500_sim.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SN              MDNS_SOCKET
+#define MAX_SENT        16
+
+typedef struct {
+    uint8_t  dip[4];
+    uint16_t dport;
+    uint16_t len;
+    uint8_t  data[1024];
+} datagram_t;
+
+static datagram_t sent[MAX_SENT];
+static uint8_t sent_count;
+
+static const uint8_t group[4] = { 224, 0, 0, 251 };
+static const uint8_t peer[4] = { 192, 168, 1, 20 };
+
+static void on_send(uint8_t sn, const uint8_t* dip, uint16_t dport, const uint8_t* data, uint16_t len)
+{
+    if (sn != SN) return;
+    assert(sent_count < MAX_SENT && len <= sizeof(sent[0].data));
+    datagram_t* d = &sent[sent_count++];
+    memcpy(d->dip, dip, 4);
+    d->dport = dport;
+    d->len = len;
+    memcpy(d->data, data, len);
+}
+
+static void run_loop(int passes)
+{
+    for (int i = 0; i < passes; i++) {
+        w5500_event_process();
+        socket_cmd_process();
+        mdns_process();
+        sim_tick++;
+    }
+}
+
+static uint16_t get16(const uint8_t* p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+static uint16_t put_name(uint8_t* b, const char* name)
+{
+    uint16_t o = 0;
+    while (*name) {
+        const char* dot = strchr(name, '.');
+        uint8_t l = dot ? dot - name : strlen(name);
+        b[o++] = l;
+        memcpy(b + o, name, l);
+        o += l;
+        name += l;
+        if (*name == '.') name++;
+    }
+    b[o++] = 0;
+    return o;
+}
+
+static uint16_t query(uint8_t* b, uint16_t id, const char* name, uint16_t type, uint16_t cls)
+{
+    memset(b, 0, 12);
+    b[0] = id >> 8;
+    b[1] = id;
+    b[5] = 1;
+    uint16_t o = 12 + put_name(b + 12, name);
+    b[o++] = type >> 8;
+    b[o++] = type;
+    b[o++] = cls >> 8;
+    b[o++] = cls;
+    return o;
+}
+
+static void inject_query(uint16_t sport, uint16_t id, const char* name, uint16_t type, uint16_t cls)
+{
+    uint8_t b[256];
+    uint16_t n = query(b, id, name, type, cls);
+    assert(sim_udp_inject(SN, peer, sport, b, n) == 0);
+}
+
+static uint8_t dest_is(const uint8_t* ip, uint16_t port)
+{
+    return memcmp(&sim_sreg[SN][0x0C], ip, 4) == 0 && sim_reg16(SN, 0x10) == port;
+}
+
+static void test_startup(void)
+{
+    run_loop(3);
+    assert(sim_reg(SN, 0x03) == W5500_SR_SOCK_UDP && dest_is(group, MDNS_PORT));
+
+    // Three probes 250 ms apart, then two announcements a second apart
+    for (int ms = 0; ms < 4000; ms++) run_loop(1);
+    assert(sent_count == 5);
+    for (uint8_t i = 0; i < 5; i++) {
+        assert(memcmp(sent[i].dip, group, 4) == 0 && sent[i].dport == MDNS_PORT);
+        assert(get16(sent[i].data + 2) == (i < 3 ? 0x0000 : 0x8400));
+    }
+    sent_count = 0;
+}
+
+static void test_answers(void)
+{
+    // Unique record: answered on the group right away
+    sim_tick += 1500;
+    inject_query(MDNS_PORT, 0, "PANEL.local", 1, 1);
+    run_loop(2);
+    assert(sent_count == 1 && memcmp(sent[0].dip, group, 4) == 0);
+    assert(get16(sent[0].data + 6) == 1);
+
+    // QU question: unicast reply, then the group is back in Sn_DIPR
+    sim_tick += 1500;
+    inject_query(MDNS_PORT, 0, "panel.local", 1, 0x8001);
+    run_loop(2);
+    assert(sent_count == 2 && memcmp(sent[1].dip, peer, 4) == 0 && sent[1].dport == MDNS_PORT);
+    assert(dest_is(group, MDNS_PORT));
+
+    // Legacy query: reply to the source port with the id echoed
+    inject_query(40000, 0x1234, "panel._http._tcp.local", 33, 1);
+    run_loop(2);
+    assert(sent_count == 3 && sent[2].dport == 40000 && get16(sent[2].data) == 0x1234);
+
+    // Not our name
+    inject_query(MDNS_PORT, 0, "other.local", 1, 1);
+    run_loop(200);
+    assert(sent_count == 3);
+    sent_count = 0;
+}
+
+static uint32_t release_after;
+
+// The held SEND completes after a number of HAL_GetTick() calls
+static void release_later(void)
+{
+    if (release_after && --release_after == 0) sim_send_done(SN);
+}
+
+static void test_slow_send(void)
+{
+    uint32_t races = sim_stats.dest_race;
+
+    // Unicast reply stuck in ARP
+    sim_hold_sendok(SN, 1);
+    sim_tick += 1500;
+    inject_query(40000, 0x4242, "panel.local", 1, 1);
+    run_loop(2);
+    assert(sent_count == 1 && memcmp(sent[0].dip, peer, 4) == 0 && sim_send_pending(SN));
+
+    // The peer's address has to stay while the chip is sending
+    run_loop(50);
+    assert(dest_is(peer, 40000) && sim_stats.dest_race == races);
+
+    // SENDOK: back to the group without any other traffic
+    sim_send_done(SN);
+    run_loop(2);
+    assert(dest_is(group, MDNS_PORT));
+
+    // A multicast answer while a unicast reply is in flight waits for it,
+    // then goes to the group
+    sim_tick += 1500;
+    inject_query(40000, 0x4343, "panel.local", 1, 1);
+    run_loop(2);
+    assert(sent_count == 2 && sim_send_pending(SN));
+    inject_query(MDNS_PORT, 0, "panel.local", 1, 1);
+    release_after = 20;
+    sim_tick_hook = release_later;
+    run_loop(2);
+    sim_tick_hook = NULL;
+    assert(sent_count == 3 && memcmp(sent[2].dip, group, 4) == 0 && sent[2].dport == MDNS_PORT);
+    sim_send_done(SN);
+
+    // A unicast reply that never completes: TIMEOUT releases the destination
+    inject_query(40000, 0x4444, "panel._http._tcp.local", 33, 1);
+    sim_tick += 1500;
+    run_loop(2);
+    assert(sent_count == 4 && dest_is(peer, 40000));
+    sim_send_timeout(SN);
+    run_loop(2);
+    assert(dest_is(group, MDNS_PORT) && !(sim_reg(SN, 0x02) & W5500_Sn_IR_TIMEOUT));
+
+    sim_hold_sendok(SN, 0);
+    assert(sim_stats.dest_race == races);
+    printf("slow SEND: %u datagrams, no destination change in flight\n", sent_count);
+    sent_count = 0;
+}
+
+int main(void)
+{
+    uint8_t memsize[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+    wiz_NetInfo ni = {
+        .mac = { 0x00, 0x08, 0xDC, 0x01, 0x02, 0x03 },
+        .ip = { 192, 168, 1, 50 }, .sn = { 255, 255, 255, 0 }, .gw = { 192, 168, 1, 1 },
+    };
+
+    sim_reset();
+    sim_int_edge = w5500_event_irq;
+    sim_send_hook = on_send;
+    assert(wizchip_init(memsize, memsize) == 0);
+    setnetinfo(&ni);
+    w5500_event_init();
+    mdns_init("panel");
+
+    test_startup();
+    test_answers();
+    test_slow_send();
+
+    printf("test_mdns: ok\n");
+    return 0;
+}
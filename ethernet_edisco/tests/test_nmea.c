@@ -0,0 +1,437 @@
+/* test_nmea.c - NMEA tokenizer: golden values, a recorded log, and
+ * differential fuzzing against the strtok parser it replaced
+ *
+ * gps_on_*() are stubbed here to record what the parser reports; DWT is
+ * the RAM-backed stand-in from hal_sim. Coordinates are checked against
+ * exact values, including the 1e-5 minute rounding and hemispheres, and
+ * every sentence type is checked with empty fields, which strtok used to
+ * merge. The fuzzer builds RMC/GGA sentences from random values and feeds
+ * them to both parsers: without empty fields they must agree to within
+ * the old parser's double rounding; with empty fields the new one must
+ * report the values the sentence was built from.
+ */
+
+#include "nmea.h"
+#include "gps.h"
+#include "hal_sim.h"
+#include "ref/nmea_strtok.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_FILE        "corpus/nmea/drive.nmea"
+#define FUZZ_ROUNDS     200000
+
+/* What a parser reported for the last sentence */
+typedef struct {
+    uint32_t positions;
+    uint32_t times;
+    int32_t  lat_e7, lon_e7;
+    double   lat, lon;          // Old parser
+    uint8_t  fix, sats;
+    int      year, month, day, hour, min, sec, ms;
+} report_t;
+
+static report_t got, ref;
+static gps_epoch_t epoch;
+static uint32_t epochs;
+
+void gps_on_new_position(int32_t lat_e7, int32_t lon_e7, uint8_t fix, uint8_t sats,
+                         int year, int month, int day, int hour, int min, int sec)
+{
+    got.positions++;
+    got.lat_e7 = lat_e7;
+    got.lon_e7 = lon_e7;
+    got.fix = fix;
+    got.sats = sats;
+    got.year = year; got.month = month; got.day = day;
+    got.hour = hour; got.min = min; got.sec = sec;
+}
+
+void gps_on_new_time(int year, int month, int day, int hour, int min, int sec, int ms, uint32_t cyc)
+{
+    (void)year; (void)month; (void)day; (void)hour; (void)min; (void)sec; (void)cyc;
+    got.times++;
+    got.ms = ms;
+}
+
+void gps_on_epoch(const gps_epoch_t* e)
+{
+    epoch = *e;
+    epochs++;
+}
+
+gps_pos_t gps_get_last_position(void)
+{
+    gps_pos_t p = { 0 };
+    return p;
+}
+
+void ref_on_new_position(double lat, double lon, uint8_t fix, uint8_t sats,
+                         int year, int month, int day, int hour, int min, int sec)
+{
+    ref.positions++;
+    ref.lat = lat;
+    ref.lon = lon;
+    ref.fix = fix;
+    ref.sats = sats;
+    ref.year = year; ref.month = month; ref.day = day;
+    ref.hour = hour; ref.min = min; ref.sec = sec;
+}
+
+void ref_on_new_time(int year, int month, int day, int hour, int min, int sec, int ms, uint32_t cyc)
+{
+    (void)year; (void)month; (void)day; (void)hour; (void)min; (void)sec; (void)cyc;
+    ref.times++;
+    ref.ms = ms;
+}
+
+/**
+ * "$<body>*hh\r\n" into out, return its length
+ */
+static int sentence(char* out, const char* body)
+{
+    uint8_t cs = 0;
+    for (const char* p = body; *p; p++) cs ^= (uint8_t)*p;
+    return sprintf(out, "$%s*%02X\r\n", body, cs);
+}
+
+static void feed(const char* body)
+{
+    char b[128];
+    int n = sentence(b, body);
+    nmea_push_chunk((const uint8_t*)b, n);
+}
+
+static void feed_both(const char* body)
+{
+    char b[128];
+    int n = sentence(b, body);
+    nmea_push_chunk((const uint8_t*)b, n);
+    ref_nmea_push_chunk((const uint8_t*)b, n);
+}
+
+/* ---- Golden values ---- */
+
+typedef struct {
+    const char* field;
+    const char* hemi;
+    int32_t     e7;             // Expected degrees * 1e7
+} coord_case_t;
+
+static const coord_case_t lat_cases[] = {
+    { "4807.038",     "N",  481173000 },
+    { "4807.03800",   "S", -481173000 },
+    { "0000.00001",   "N",          2 },   // 1e-5 min = 1.67e-7 deg, rounded
+    { "0000.00002",   "N",          3 },   // 3.33e-7 deg
+    { "0030.00000",   "N",    5000000 },
+    { "3351.1234",    "S", -338520567 },   // 33 + 51.1234 / 60 = 33.852056667
+    { "8959.99999",   "N",  899999998 },   // Largest minutes below 60
+    { "4807.0381299", "N",  481173020 },   // Digits past 1e-5 min are cut
+    { "4807",         "N",  481166667 },   // No fraction
+    { "4807.",        "N",  481166667 },
+    { "4807.038",     "",   481173000 },   // Hemisphere missing: positive
+};
+
+static const coord_case_t lon_cases[] = {
+    { "01131.000",    "E",  115166667 },
+    { "01131.000",    "W", -115166667 },
+    { "18000.00000",  "W", -1800000000 },
+    { "15112.5",      "W", -1512083333 },
+    { "00000.00000",  "E",          0 },
+};
+
+/* Rejected: the sentence reports nothing */
+static const char* const bad_coords[] = {
+    "48.5",             // Fewer than three integer digits
+    "4860.000",         // 60 minutes
+    "4899.9",
+    "1800100.0",        // More than 180 degrees of integer part
+    "",                 // Empty
+    ".5",
+};
+
+static void rmc(const char* lat, const char* ns, const char* lon, const char* ew)
+{
+    char b[128];
+    snprintf(b, sizeof(b), "GPRMC,123519.25,A,%s,%s,%s,%s,022.4,084.4,230394,003.1,W", lat, ns, lon, ew);
+    feed(b);
+}
+
+static void test_coordinates(void)
+{
+    for (size_t i = 0; i < sizeof(lat_cases) / sizeof(lat_cases[0]); i++) {
+        uint32_t n = got.positions;
+        rmc(lat_cases[i].field, lat_cases[i].hemi, "01131.000", "E");
+        if (got.positions != n + 1 || got.lat_e7 != lat_cases[i].e7) {
+            fprintf(stderr, "lat %s,%s: got %d, want %d\n", lat_cases[i].field, lat_cases[i].hemi,
+                    got.lat_e7, lat_cases[i].e7);
+            abort();
+        }
+    }
+    for (size_t i = 0; i < sizeof(lon_cases) / sizeof(lon_cases[0]); i++) {
+        uint32_t n = got.positions;
+        rmc("4807.038", "N", lon_cases[i].field, lon_cases[i].hemi);
+        if (got.positions != n + 1 || got.lon_e7 != lon_cases[i].e7) {
+            fprintf(stderr, "lon %s,%s: got %d, want %d\n", lon_cases[i].field, lon_cases[i].hemi,
+                    got.lon_e7, lon_cases[i].e7);
+            abort();
+        }
+    }
+    for (size_t i = 0; i < sizeof(bad_coords) / sizeof(bad_coords[0]); i++) {
+        uint32_t n = got.positions;
+        rmc(bad_coords[i], "N", "01131.000", "E");
+        rmc("4807.038", "N", bad_coords[i], "E");
+        assert(got.positions == n);
+    }
+
+    // Date, time and its fraction from the same sentence
+    rmc("4807.038", "N", "01131.000", "E");
+    assert(got.year == 2094 && got.month == 3 && got.day == 23);
+    assert(got.hour == 12 && got.min == 35 && got.sec == 19 && got.ms == 250);
+}
+
+static void test_empty_fields(void)
+{
+    uint32_t n = got.positions, e;
+
+    // Empty speed and track: the date after them stays the 9th field
+    feed("GNRMC,000001,A,3351.1234,S,15112.5,W,,,170926,,,A");
+    assert(got.positions == n + 1 && got.lat_e7 == -338520567 && got.lon_e7 == -1512083333);
+    assert(got.year == 2026 && got.month == 9 && got.day == 17 && got.ms == 0);
+
+    // No fix: empty position fields report nothing
+    feed("GPRMC,000002,V,,,,,,,170926,,,N");
+    feed("GPGGA,000002,,,,,0,00,,,M,,M,,");
+    feed("GPGGA,000002,4807.038,N,01131.000,E,,08,0.9,545.4,M,46.9,M,,");
+    assert(got.positions == n + 1);
+
+    // GGA with an empty satellite count
+    feed("GPGGA,000003,4807.038,N,01131.000,E,2,,0.9,545.4,M,46.9,M,,");
+    assert(got.positions == n + 2 && got.fix == 2 && got.sats == 0);
+
+    // An epoch with empty PRN slots, SNRs and course; published by the next one
+    feed("GNRMC,000004,A,4807.038,N,01131.000,E,0.0,,170926,,,A");
+    feed("GNVTG,,T,,M,0.0,N,0.0,K,A");
+    feed("GNGSA,A,3,04,,09,,,,,,,,,,2.50,,2.10,1");
+    feed("GPGSV,2,1,05,04,45,120,40,05,,,,09,80,010,45,12,05,200,");
+    feed("GPGSV,2,2,05,25,,,22");
+    e = epochs;
+    feed("GNRMC,000005,A,4807.038,N,01131.000,E,0.0,,170926,,,A");
+    assert(epochs == e + 1);
+    assert(epoch.hour == 0 && epoch.sec == 4 && epoch.fix_mode == 3);
+    assert(epoch.pdop == 250 && epoch.hdop == 0 && epoch.vdop == 210);
+    assert(epoch.course_cdeg == 0xFFFF && epoch.speed_cms == 0);
+    assert(epoch.used_count == 2 && epoch.sat_count == 5 && epoch.in_view == 5);
+    assert(epoch.sats[0].prn == 4 && epoch.sats[0].used && epoch.sats[0].snr_db == 40);
+    assert(epoch.sats[1].prn == 5 && !epoch.sats[1].used && epoch.sats[1].elev_deg == 0);
+    assert(epoch.sats[1].snr_db == 0 && epoch.sats[2].prn == 9 && epoch.sats[2].used);
+    assert(epoch.sats[3].prn == 12 && epoch.sats[3].snr_db == 0);
+    assert(epoch.sats[4].prn == 25 && epoch.sats[4].elev_deg == 0 && epoch.sats[4].snr_db == 22);
+
+    // A sentence of nothing but commas is counted valid and changes nothing
+    nmea_stats_t s = nmea_get_stats();
+    n = got.positions;
+    feed("GPRMC,,,,,,,,,,,");
+    feed("GPGGA,,,,,,,,,,,,,,");
+    feed("GPGSV,,,,,,,,,,,,,,,,,,,");
+    assert(got.positions == n && nmea_get_stats().valid == s.valid + 3);
+}
+
+/* ---- Recorded log ---- */
+
+static uint8_t log_buf[256 * 1024];
+static uint32_t log_len;
+
+static void load_log(void)
+{
+    FILE* f = fopen(LOG_FILE, "rb");
+    assert(f);
+    log_len = fread(log_buf, 1, sizeof(log_buf), f);
+    fclose(f);
+    assert(log_len > 0 && log_len < sizeof(log_buf));
+}
+
+static uint32_t rng = 1;
+
+static uint32_t rnd(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static void test_log(void)
+{
+    // Whole, then in random DMA-sized chunks: the same counts either way
+    nmea_stats_t before[2], after[2];
+    uint32_t positions[2], e[2];
+
+    for (int pass = 0; pass < 2; pass++) {
+        before[pass] = nmea_get_stats();
+        positions[pass] = got.positions;
+        e[pass] = epochs;
+        uint32_t pos = 0;
+        while (pos < log_len) {
+            uint32_t n = pass ? 1 + rnd() % 200 : log_len;
+            if (n > log_len - pos) n = log_len - pos;
+            nmea_push_chunk(log_buf + pos, n);
+            pos += n;
+        }
+        after[pass] = nmea_get_stats();
+        positions[pass] = got.positions - positions[pass];
+        e[pass] = epochs - e[pass];
+    }
+
+    uint32_t lines = 0;
+    for (uint32_t i = 0; i < log_len; i++) lines += (log_buf[i] == '$');
+
+    uint32_t valid = after[0].valid - before[0].valid;
+    uint32_t failed = (after[0].checksum_failed - before[0].checksum_failed) +
+                      (after[0].truncated - before[0].truncated);
+    printf("log: %u sentences, %u valid, %u dropped, %u positions, %u epochs\n",
+           lines, valid, failed, positions[0], e[0]);
+    assert(after[0].lines - before[0].lines == lines);
+    assert(valid + failed == lines && failed == 3);
+    assert(after[1].valid - before[1].valid == valid && positions[1] == positions[0]);
+    assert(e[1] == e[0] && e[0] >= 178);
+
+    // Last published epoch: 12 GPS + 7 GLONASS in view, 13 used
+    assert(epoch.sat_count == 19 && epoch.used_count == 13 && epoch.fix_mode == 3);
+}
+
+/* ---- Differential fuzzing against the strtok parser ---- */
+
+/**
+ * ddmm.mmm with digits fraction digits from degrees * 1e7
+ */
+static void coord_text(char* out, int32_t e7, uint8_t lon, uint8_t digits)
+{
+    uint32_t a = e7 < 0 ? -e7 : e7;
+    uint32_t deg = a / 10000000;
+    // Minutes * 1e7 from the remaining degrees
+    uint64_t min_e7 = (uint64_t)(a % 10000000) * 60;
+    uint32_t min = min_e7 / 10000000;
+    uint32_t frac = min_e7 % 10000000;
+    out += sprintf(out, lon ? "%03u%02u" : "%02u%02u", deg, min);
+    if (digits) {
+        char f[8];
+        sprintf(f, "%07u", frac);
+        f[digits] = '\0';
+        sprintf(out, ".%s", f);
+    }
+}
+
+static void test_differential(void)
+{
+    uint32_t agree = 0, empty_cases = 0, ref_wrong = 0;
+
+    for (uint32_t round = 0; round < FUZZ_ROUNDS; round++) {
+        int32_t lat = (int32_t)(rnd() % 1800000000) - 900000000;
+        int32_t lon = (int32_t)((int64_t)(rnd() % 3600000001u) - 1800000000);
+        uint8_t digits = rnd() % 8;
+        char la[24], lo[24], b[128];
+        coord_text(la, lat, 0, digits);
+        coord_text(lo, lon, 1, digits);
+        const char* ns = lat < 0 ? "S" : "N";
+        const char* ew = lon < 0 ? "W" : "E";
+        int hh = rnd() % 24, mm = rnd() % 60, ss = rnd() % 60, cs = rnd() % 100;
+        int dd = 1 + rnd() % 28, mon = 1 + rnd() % 12, yy = rnd() % 100;
+
+        // Every fourth sentence has empty optional fields
+        uint8_t empties = (rnd() % 4) == 0;
+        uint8_t gga = rnd() & 1;
+        if (gga) {
+            int fix = 1 + rnd() % 5, sats = rnd() % 25;
+            snprintf(b, sizeof(b), "GPGGA,%02d%02d%02d.%02d,%s,%s,%s,%s,%d,%02d,%s,545.4,M,46.9,M,,",
+                     hh, mm, ss, cs, la, ns, lo, ew, fix, sats, empties ? "" : "0.9");
+        } else {
+            snprintf(b, sizeof(b), "GNRMC,%02d%02d%02d.%02d,A,%s,%s,%s,%s,%s,%s,%02d%02d%02d,,,A",
+                     hh, mm, ss, cs, la, ns, lo, ew, empties ? "" : "12.5",
+                     empties ? "" : "084.4", dd, mon, yy);
+        }
+
+        memset(&got, 0, sizeof(got));
+        memset(&ref, 0, sizeof(ref));
+        feed_both(b);
+
+        assert(got.positions == 1 && got.hour == hh && got.min == mm && got.sec == ss);
+        // Minutes past 1e-5 are cut, so with more digits the two can differ by one unit more
+        int32_t tol = digits > 5 ? 2 : 1;
+        if (!gga) {
+            assert(got.times == 1 && got.ms == cs * 10);
+            assert(got.year == 2000 + yy && got.month == mon && got.day == dd);
+        }
+
+        if (empties && !gga) {
+            // strtok shifts the date onto the first empty field's place
+            empty_cases++;
+            if (ref.positions != 1 || ref.day != dd || ref.month != mon) ref_wrong++;
+            continue;
+        }
+
+        int32_t ref_lat = (int32_t)lround(ref.lat * 1e7), ref_lon = (int32_t)lround(ref.lon * 1e7);
+        if (ref.positions != 1 || abs(got.lat_e7 - ref_lat) > tol || abs(got.lon_e7 - ref_lon) > tol ||
+            got.hour != ref.hour || got.min != ref.min || got.sec != ref.sec ||
+            (gga ? (got.fix != ref.fix || got.sats != ref.sats)
+                 : (got.ms != ref.ms || got.year != ref.year || got.month != ref.month ||
+                    got.day != ref.day))) {
+            fprintf(stderr, "parsers disagree on %s: %d,%d vs %.8f,%.8f\n", b,
+                    got.lat_e7, got.lon_e7, ref.lat, ref.lon);
+            abort();
+        }
+        agree++;
+    }
+
+    printf("differential: %u sentences agree, %u with empty fields, where strtok was wrong %u times\n",
+           agree, empty_cases, ref_wrong);
+    assert(agree > FUZZ_ROUNDS / 2 && ref_wrong == empty_cases);
+}
+
+/* Byte-level mutations of the log: no crash, counters stay consistent */
+static void test_mutations(void)
+{
+    static uint8_t buf[2048];
+
+    for (uint32_t round = 0; round < 20000; round++) {
+        uint32_t at = rnd() % (log_len - sizeof(buf));
+        uint16_t len = 64 + rnd() % (sizeof(buf) - 64);
+        memcpy(buf, log_buf + at, len);
+        for (int k = 1 + rnd() % 8; k; k--) {
+            uint16_t i = rnd() % len;
+            switch (rnd() % 4) {
+                case 0: buf[i] ^= 1 << (rnd() % 8); break;
+                case 1: buf[i] = ",*$\r\n.0"[rnd() % 7]; break;
+                case 2: buf[i] = rnd(); break;
+                case 3: memset(buf + i, ',', (len - i) < 16 ? len - i : 16); break;
+            }
+        }
+        nmea_push_chunk(buf, len);
+        ref_nmea_push_chunk(buf, len);
+    }
+
+    nmea_stats_t s = nmea_get_stats();
+    assert(s.valid + s.checksum_failed + s.truncated + s.bad_char + s.overflow +
+           s.bad_checksum_hex + s.bad_eol <= s.lines + 1);
+    printf("mutations: %u sentences, %u valid, %u checksum, %u truncated, %u bad char, "
+           "%u overflow\n", s.lines, s.valid, s.checksum_failed, s.truncated, s.bad_char, s.overflow);
+}
+
+int main(void)
+{
+    nmea_parser_init();
+    ref_nmea_init();
+    load_log();
+
+    test_coordinates();
+    test_empty_fields();
+    test_log();
+    test_differential();
+    test_mutations();
+
+    printf("test_nmea: ok\n");
+    return 0;
+}
@@ -0,0 +1,363 @@
+/* test_ntp.c - Served time, offset and jitter of the NTP server
+ *
+ * A simulated world runs the DWT cycle counter from a crystal CLOCK_PPM
+ * off nominal. The GPS receiver, a u-blox M8 at 9600 Bd with its default
+ * NMEA set, pulses PPS on every UTC second (when enabled) and starts the RMC
+ * sentence RMC_MIN_US..RMC_MAX_US later, when the fix is ready; clients
+ * on the LAN send requests at random instants over a symmetric path, and
+ * the main loop reaches each one up to LOOP_US after INTn fell. Offsets
+ * are computed from the four timestamps the way a client does,
+ *
+ *   offset = ((T2 - T1) + (T3 - T4)) / 2
+ *
+ * against a perfect client clock, and reported as mean, jitter (standard
+ * deviation) and worst case for PPS and NMEA-only references. Once the
+ * reference has settled no offset may exceed the root dispersion the
+ * reply advertises.
+ *
+ * Also covers the header fields (LI, stratum, reference id, root
+ * dispersion) before sync, during holdover and after it runs out, and
+ * requests queued behind a reply the chip is slow to send: they wait in
+ * RX with their own receive timestamp instead of being dropped, and
+ * Sn_DIPR/Sn_DPORT do not change while a SEND is in flight.
+ */
+
+#include "ntp.h"
+#include "gps.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include "wizchip_conf.h"
+#include "w5500_sim.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SN              NTP_SOCKET
+#define START_UNIX      1792238400u     // 2026-10-17 12:00:00 UTC
+#define CLOCK_PPM       30.0            // Crystal error, uncorrected without PPS
+#define PATH_US         150.0           // One-way network delay
+#define LOOP_US         5000.0          // Main loop latency to a request, at most
+#define RMC_MIN_US      40000.0         // '$' of RMC after the second, light epoch
+#define RMC_MAX_US      180000.0        // and with many satellites in view
+#define REQUESTS_PER_S  4
+#define RUN_S           120
+
+static uint64_t cyc;                    // True cycles since the start
+static double hz;                       // True core clock
+
+static uint8_t reply_buf[48];
+static uint32_t reply_count;
+static uint8_t reply_dip[4];
+static uint16_t reply_dport;
+static double reply_at;                 // True time the reply left
+
+static uint32_t rng = 4321;
+
+static double rnd01(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng / 4294967296.0;
+}
+
+/**
+ * True time, seconds since START_UNIX
+ */
+static double now_s(void)
+{
+    return cyc / hz;
+}
+
+static void goto_s(double t)
+{
+    uint64_t c = (uint64_t)(t * hz);
+    if (c > cyc) cyc = c;
+    DWT->CYCCNT = (uint32_t)cyc;
+    sim_tick = (uint32_t)(now_s() * 1000);
+}
+
+static void on_send(uint8_t sn, const uint8_t* dip, uint16_t dport, const uint8_t* data, uint16_t len)
+{
+    if (sn != SN) return;
+    assert(len == 48);
+    memcpy(reply_buf, data, 48);
+    memcpy(reply_dip, dip, 4);
+    reply_dport = dport;
+    reply_at = now_s();
+    reply_count++;
+}
+
+static void run_loop(int passes)
+{
+    for (int i = 0; i < passes; i++) {
+        w5500_event_process();
+        socket_cmd_process();
+        ntp_process();
+    }
+}
+
+static uint32_t get32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * NTP timestamp at offset off of a reply, as seconds since START_UNIX
+ */
+static double ts_s(const uint8_t* b, uint8_t off)
+{
+    uint32_t sec = get32(b + off) - (START_UNIX + 2208988800u);
+    return (int32_t)sec + get32(b + off + 4) / 4294967296.0;
+}
+
+static void put_ts(uint8_t* p, double t)
+{
+    uint32_t sec = START_UNIX + 2208988800u + (uint32_t)floor(t);
+    uint32_t frac = (uint32_t)((t - floor(t)) * 4294967296.0);
+    for (int i = 0; i < 4; i++) {
+        p[i] = sec >> (24 - 8 * i);
+        p[4 + i] = frac >> (24 - 8 * i);
+    }
+}
+
+/**
+ * Client request arriving at the chip now, sent PATH_US ago
+ */
+static void request_from(uint8_t host, uint8_t first_byte)
+{
+    uint8_t b[48] = { 0 };
+    uint8_t ip[4] = { 192, 168, 1, host };
+    b[0] = first_byte;
+    b[2] = 6;
+    put_ts(b + 40, now_s() - PATH_US / 1e6);
+    assert(sim_udp_inject(SN, ip, 40000 + host, b, sizeof(b)) == 0);
+}
+
+static void request(uint8_t first_byte)
+{
+    request_from(20, first_byte);
+}
+
+/**
+ * RMC for the second t (whole seconds since START_UNIX) starts now
+ */
+static void gps_sentence(uint32_t t)
+{
+    uint32_t s = t % 60, m = (t / 60) % 60, h = 12 + t / 3600;
+    gps_on_new_time(2026, 10, 17, h, m, s, 0, DWT->CYCCNT);
+}
+
+typedef struct {
+    uint32_t n;
+    double sum, sum2, worst;
+} offset_stats_t;
+
+/**
+ * Serve RUN_S seconds of requests, PPS on every second if pps; offsets
+ * count from settle_s on
+ */
+static void serve(uint8_t pps, uint32_t settle_s, offset_stats_t* st)
+{
+    memset(st, 0, sizeof(*st));
+    uint32_t first = (uint32_t)ceil(now_s());
+
+    for (uint32_t sec = first; sec < first + RUN_S; sec++) {
+        goto_s(sec);
+        if (pps) ntp_pps_irq();
+        run_loop(1);
+        goto_s(sec + (RMC_MIN_US + rnd01() * (RMC_MAX_US - RMC_MIN_US)) / 1e6);
+        gps_sentence(sec);
+        run_loop(1);
+
+        double from = now_s() + 0.01;
+        for (int k = 0; k < REQUESTS_PER_S; k++) {
+            // Spread over the rest of the second, clear of the next edge
+            double at = from + (k + rnd01()) * (sec + 0.99 - from) / REQUESTS_PER_S - LOOP_US / 1e6;
+            goto_s(at);
+            double t1 = now_s() - PATH_US / 1e6;
+            uint32_t count = reply_count;
+            request(0x23);
+
+            goto_s(now_s() + rnd01() * LOOP_US / 1e6);
+            run_loop(2);
+            assert(reply_count == count + 1);
+            assert((reply_buf[0] & 7) == 4 && fabs(ts_s(reply_buf, 24) - t1) < 1e-9);
+
+            double t2 = ts_s(reply_buf, 32), t3 = ts_s(reply_buf, 40);
+            double t4 = reply_at + PATH_US / 1e6;
+            double off = ((t2 - t1) + (t3 - t4)) / 2;
+            if (sec < first + settle_s) continue;
+            assert(fabs(off) < get32(reply_buf + 8) / 65536.0);
+            st->n++;
+            st->sum += off;
+            st->sum2 += off * off;
+            if (fabs(off) > st->worst) st->worst = fabs(off);
+        }
+    }
+}
+
+static void report(const char* label, const offset_stats_t* st)
+{
+    double mean = st->sum / st->n;
+    double jitter = sqrt(st->sum2 / st->n - mean * mean);
+    printf("%-10s %4u replies  offset mean %+8.2f us  jitter %7.2f us  worst %8.2f us\n",
+           label, st->n, mean * 1e6, jitter * 1e6, st->worst * 1e6);
+}
+
+static void test_unsynced(void)
+{
+    request(0x23);      // v4 client
+    run_loop(2);
+    assert(reply_count == 1);
+    assert((reply_buf[0] >> 6) == 3 && ((reply_buf[0] >> 3) & 7) == 4 && (reply_buf[0] & 7) == 4);
+    assert(reply_buf[1] == 16 && reply_buf[2] == 6 && get32(reply_buf + 12) == 0);
+    assert(get32(reply_buf + 32) == 0 && get32(reply_buf + 40) == 0);
+    assert(memcmp(reply_dip, "\xc0\xa8\x01\x14", 4) == 0 && reply_dport == 40020);
+
+    // Not a client request
+    request(0x24);
+    run_loop(2);
+    assert(reply_count == 1);
+
+    ntp_stats_t s;
+    ntp_get_stats(&s);
+    assert(s.requests == 2 && s.replies == 1 && s.dropped == 1 && !s.synced);
+    assert(s.ref_age_ms == UINT32_MAX);
+}
+
+static void test_offsets(void)
+{
+    offset_stats_t nmea, pps;
+
+    serve(0, 0, &nmea);
+    assert((reply_buf[0] >> 6) == 0 && reply_buf[1] == 1 && memcmp(reply_buf + 12, "GPS", 4) == 0);
+    report("NMEA", &nmea);
+
+    // The frequency estimate needs a few dozen seconds of PPS to settle
+    serve(1, 60, &pps);
+    assert(reply_buf[1] == 1 && memcmp(reply_buf + 12, "PPS", 4) == 0);
+    report("NMEA+PPS", &pps);
+
+    ntp_stats_t s;
+    ntp_get_stats(&s);
+    printf("PPS frequency estimate %u Hz, true %.0f Hz\n", s.freq_hz, hz);
+    assert(s.pps && fabs(s.freq_hz - hz) < hz * 2e-6);
+
+    // NMEA is off by how far the receiver's delay is from NTP_NMEA_DELAY_US;
+    // PPS leaves the crystal and rounding, and the loop latency must not
+    // show in either since T2 is the INTn edge
+    double mid = NTP_NMEA_DELAY_US - (RMC_MIN_US + RMC_MAX_US) / 2;
+    assert(fabs(nmea.sum / nmea.n - mid / 1e6) < 5e-3);
+    assert(nmea.worst < NTP_NMEA_SPREAD_US / 1e6);
+    assert(pps.worst < 2e-6);
+}
+
+static void test_holdover(void)
+{
+    // GPS gone: still stratum 1 with a growing root dispersion, until
+    // NTP_HOLDOVER_S after the last time
+    double last = now_s();
+    uint32_t disp = 0;
+    for (uint32_t age = 10; age < NTP_HOLDOVER_S; age += 30) {
+        goto_s(last + age);
+        run_loop(1);
+        request(0x1b);  // v3 client
+        run_loop(2);
+        assert((reply_buf[0] >> 6) == 0 && ((reply_buf[0] >> 3) & 7) == 3 && reply_buf[1] == 1);
+        assert(get32(reply_buf + 8) > disp);
+        disp = get32(reply_buf + 8);
+    }
+    // 15 ppm of ~5 minutes, in 16.16 seconds
+    assert(disp > NTP_DRIFT_PPM * 250e-6 * 65536 && disp < NTP_DRIFT_PPM * 300e-6 * 65536);
+
+    goto_s(last + NTP_HOLDOVER_S + 5);
+    run_loop(1);
+    request(0x23);
+    run_loop(2);
+    assert((reply_buf[0] >> 6) == 3 && reply_buf[1] == 16 && get32(reply_buf + 12) == 0);
+    assert(get32(reply_buf + 32) != 0);     // Still the best time there is
+}
+
+static void test_slow_send(void)
+{
+    uint32_t races = sim_stats.dest_race;
+    ntp_stats_t before, after;
+
+    goto_s(ceil(now_s()) + NTP_NMEA_DELAY_US / 1e6);
+    gps_sentence((uint32_t)now_s());
+    run_loop(1);
+    ntp_get_stats(&before);
+
+    // The reply to .21 is stuck in ARP; .22 and .23 ask meanwhile
+    sim_hold_sendok(SN, 1);
+    request_from(21, 0x23);
+    run_loop(2);
+    assert(reply_count && reply_dip[3] == 21 && sim_send_pending(SN));
+    uint32_t count = reply_count;
+
+    goto_s(now_s() + 0.002);
+    double b_at = now_s();
+    request_from(22, 0x23);
+    run_loop(2);
+    goto_s(now_s() + 0.003);
+    request_from(23, 0x23);
+    run_loop(5);
+
+    // Both wait in RX, the destination stays on .21
+    assert(reply_count == count && get_socket_rx_size(SN) == 2 * (8 + 48));
+    assert(sim_reg(SN, 0x0C + 3) == 21);
+
+    // SENDOK: .22 is answered with the time its request arrived
+    goto_s(now_s() + 0.010);
+    sim_send_done(SN);
+    run_loop(1);
+    assert(reply_count == count + 1 && reply_dip[3] == 22 && reply_dport == 40022);
+    assert(fabs(ts_s(reply_buf, 32) - b_at) < 1e-6);
+
+    // TIMEOUT counts as done too
+    sim_send_timeout(SN);
+    run_loop(2);
+    assert(reply_count == count + 2 && reply_dip[3] == 23);
+    sim_send_done(SN);
+    sim_hold_sendok(SN, 0);
+
+    ntp_get_stats(&after);
+    assert(after.requests == before.requests + 3 && after.replies == before.replies + 3);
+    assert(after.dropped == before.dropped);
+    assert(sim_stats.dest_race == races);
+    printf("slow SEND: queued requests kept their receive time, none dropped\n");
+}
+
+int main(void)
+{
+    uint8_t memsize[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+    wiz_NetInfo ni = {
+        .mac = { 0x00, 0x08, 0xDC, 0x01, 0x02, 0x03 },
+        .ip = { 192, 168, 1, 50 }, .sn = { 255, 255, 255, 0 }, .gw = { 192, 168, 1, 1 },
+    };
+
+    hz = SystemCoreClock * (1 + CLOCK_PPM / 1e6);
+
+    sim_reset();
+    sim_int_edge = w5500_event_irq;
+    sim_send_hook = on_send;
+    assert(wizchip_init(memsize, memsize) == 0);
+    setnetinfo(&ni);
+    w5500_event_init();
+    ntp_init();
+    goto_s(0.25);
+    run_loop(3);
+    assert(sim_reg(SN, 0x03) == W5500_SR_SOCK_UDP && sim_reg16(SN, 0x04) == NTP_PORT);
+
+    test_unsynced();
+    test_offsets();
+    test_holdover();
+    test_slow_send();
+
+    printf("test_ntp: ok\n");
+    return 0;
+}
@@ -0,0 +1,231 @@
+/* test_status_json.c - /status documents against the printf layout they replaced
+ *
+ * proto_ver 1 was written with snprintf from double degrees and float
+ * seconds; the writer now gets the receiver's 1e-7 degree integers and
+ * ages in milliseconds. 200k random documents are rendered both ways and
+ * must be byte-identical, then every truncated buffer must be refused
+ * cleanly. Positions exactly half way between two 1e-6 steps have no
+ * exact double, printf decided them by representation; they round away
+ * from zero now and are checked on their own.
+ */
+
+#include "status_json.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DOCUMENTS       200000
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t rnd(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// Mostly realistic values, sometimes tiny or at the edge of the range
+static int32_t rnd_range(int32_t lo, int32_t hi)
+{
+    switch (rnd() % 8) {
+        case 0:  return (int32_t)(rnd() % 21) - 10;
+        case 1:  return (rnd() & 1) ? lo : hi;
+        default: return lo + (int32_t)(rnd() % ((uint32_t)(hi - lo) + 1));
+    }
+}
+
+static uint32_t rnd_age(void)
+{
+    uint32_t age;
+    switch (rnd() % 6) {
+        case 0:  return STATUS_AGE_NEVER;
+        case 1:  age = rnd(); break;
+        default: age = rnd() % 10000; break;
+    }
+    return age;
+}
+
+// Off the half-step ties, see test_position_ties()
+static int32_t no_tie(int32_t v)
+{
+    return (v % 10 == 5 || v % 10 == -5) ? v - 1 : v;
+}
+
+static void random_inputs(gps_pos_t* pos, status_readings_t* r, gps_epoch_t* e)
+{
+    memset(pos, 0, sizeof(*pos));
+    memset(e, 0, sizeof(*e));
+
+    pos->lat_e7 = no_tie(rnd_range(-900000000, 900000000));
+    pos->lon_e7 = no_tie(rnd_range(-1800000000, 1800000000));
+    pos->fix = rnd() % 3;
+    pos->sats = rnd() % 25;
+    if (rnd() % 4) {
+        pos->year = 2000 + rnd() % 80;
+        pos->month = 1 + rnd() % 12;
+        pos->day = 1 + rnd() % 28;
+        pos->hour = rnd() % 24;
+        pos->min = rnd() % 60;
+        pos->sec = rnd() % 60;
+    }
+
+    r->pos = pos;
+    r->env_tenths[0] = rnd_range(-400, 850);
+    r->env_tenths[1] = rnd_range(3000, 11000);
+    r->env_tenths[2] = rnd_range(0, 1000);
+    r->env_tenths[3] = rnd_range(0, 1200000);
+
+    e->fix_mode = rnd() % 4;
+    e->pdop = rnd() % 10000;
+    e->hdop = rnd() % 10000;
+    e->vdop = rnd() % 10000;
+    e->course_cdeg = (rnd() % 4) ? rnd() % 36000 : 0xFFFF;
+    e->speed_cms = (rnd() % 8) ? rnd() % 10000 : rnd() >> 1;     // json_fixed() is int32
+    e->in_view = rnd() % 64;
+    e->used_count = rnd() % 25;
+}
+
+// The proto_ver 1 layout as it was written with snprintf, doubles and float ages
+static int reference(char* buf, size_t size, const status_readings_t* r, const gps_epoch_t* e,
+                     uint32_t gps_age_ms, uint32_t env_age_ms)
+{
+    const gps_pos_t* p = r->pos;
+    char time_str[32], course[16];
+    format_utc_time(p->year, p->month, p->day, p->hour, p->min, p->sec, time_str, sizeof(time_str));
+    if (e->course_cdeg == 0xFFFF) strcpy(course, "null");
+    else snprintf(course, sizeof(course), "%.2f", e->course_cdeg / 100.0);
+
+    return snprintf(buf, size,
+        "{\"proto_ver\":1,\"device_id\":\"bp-411-0007\",\"time_utc\":\"%s\","
+        "\"gps\":{\"lat\":%.6f,\"lon\":%.6f,\"fix\":%d,\"sats\":%d},"
+        "\"env\":{\"t_c\":%.1f,\"p_hpa\":%.1f,\"rh_pct\":%.1f,\"lux\":%.1f},"
+        "\"fix_quality\":{\"mode\":%d,\"pdop\":%.2f,\"hdop\":%.2f,\"vdop\":%.2f,"
+        "\"course_deg\":%s,\"speed_mps\":%.2f,\"in_view\":%d,\"used\":%d},"
+        "\"stale_age_s\":{\"gps\":%.1f,\"env\":%.1f}}",
+        time_str, p->lat_e7 / 1e7, p->lon_e7 / 1e7, p->fix, p->sats,
+        r->env_tenths[0] / 10.0, r->env_tenths[1] / 10.0,
+        r->env_tenths[2] / 10.0, r->env_tenths[3] / 10.0,
+        e->fix_mode, e->pdop / 100.0, e->hdop / 100.0, e->vdop / 100.0,
+        course, e->speed_cms / 100.0, e->in_view, e->used_count,
+        gps_age_ms == STATUS_AGE_NEVER ? 999.9f : (float)gps_age_ms / 1000.0f,
+        env_age_ms == STATUS_AGE_NEVER ? 999.9f : (float)env_age_ms / 1000.0f);
+}
+
+static void test_identity(void)
+{
+    gps_pos_t pos;
+    status_readings_t r;
+    gps_epoch_t e;
+    char got[STATUS_JSON_MAX], want[1024];
+    uint16_t longest = 0;
+
+    for (uint32_t i = 0; i < DOCUMENTS; i++) {
+        random_inputs(&pos, &r, &e);
+        uint32_t ga = rnd_age(), ea = rnd_age();
+
+        uint16_t n = status_json(got, sizeof(got), &r, &e, ga, ea);
+        int m = reference(want, sizeof(want), &r, &e, ga, ea);
+        if (n != m || memcmp(got, want, n) != 0) {
+            fprintf(stderr, "document %u differs\n got: %.*s\nwant: %s\n", i, n, got, want);
+            abort();
+        }
+        if (n > longest) longest = n;
+    }
+    printf("%u documents identical, longest %u bytes\n", DOCUMENTS, longest);
+}
+
+static void test_ages(void)
+{
+    static const struct { uint32_t ms; const char* s; } cases[] = {
+        { 0, "0.0" }, { 1, "0.0" }, { 49, "0.0" }, { 50, "0.1" }, { 150, "0.2" },
+        { 250, "0.2" }, { 750, "0.8" }, { 1250, "1.2" }, { 2949, "2.9" }, { 2950, "3.0" },
+        { 999949, "999.9" }, { 16777250, "16777.2" }, { 4294967294u, "4294967.5" },
+        { STATUS_AGE_NEVER, "999.9" },
+    };
+    gps_pos_t pos = { 0 };
+    status_readings_t r = { .pos = &pos };
+    gps_epoch_t e = { 0 };
+    char buf[STATUS_JSON_MAX], want[64];
+
+    // 0.05f is above 0.05, 0.25f is an exact tie and goes to even
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        uint16_t n = status_json(buf, sizeof(buf), &r, &e, cases[i].ms, 0);
+        buf[n] = '\0';
+        snprintf(want, sizeof(want), "\"stale_age_s\":{\"gps\":%s,\"env\":0.0}}", cases[i].s);
+        assert(strstr(buf, want));
+    }
+}
+
+static void test_position_ties(void)
+{
+    static const struct { int32_t e7; const char* s; } cases[] = {
+        { 5, "0.000001" }, { -5, "-0.000001" }, { 4, "0.000000" }, { -4, "-0.000000" },
+        { 481173025, "48.117303" }, { -481173015, "-48.117302" },
+        { 1799999995, "180.000000" }, { INT32_MIN, "-214.748365" },
+    };
+    gps_pos_t pos = { 0 };
+    status_readings_t r = { .pos = &pos };
+    gps_epoch_t e = { 0 };
+    char buf[STATUS_JSON_MAX], want[64];
+
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        pos.lat_e7 = cases[i].e7;
+        uint16_t n = status_json(buf, sizeof(buf), &r, &e, 0, 0);
+        buf[n] = '\0';
+        snprintf(want, sizeof(want), "\"gps\":{\"lat\":%s,", cases[i].s);
+        assert(strstr(buf, want));
+    }
+}
+
+// Every field at its widest still fits STATUS_JSON_MAX
+static void test_longest(void)
+{
+    gps_pos_t pos = {
+        .lat_e7 = INT32_MIN, .lon_e7 = INT32_MIN, .fix = 255, .sats = 255,
+        .year = 2099, .month = 12, .day = 31, .hour = 23, .min = 59, .sec = 59,
+    };
+    status_readings_t r = { .pos = &pos, .env_tenths = { INT32_MIN, INT32_MIN, INT32_MIN, INT32_MIN } };
+    gps_epoch_t e = {
+        .fix_mode = 255, .pdop = 65535, .hdop = 65535, .vdop = 65535, .course_cdeg = 65534,
+        .speed_cms = INT32_MAX, .in_view = 255, .used_count = 255,
+    };
+    char buf[STATUS_JSON_MAX];
+    uint16_t n = status_json(buf, sizeof(buf), &r, &e, STATUS_AGE_NEVER - 1, STATUS_AGE_NEVER - 1);
+    assert(n > 0);
+    printf("widest document %u of %u bytes\n", n, STATUS_JSON_MAX);
+}
+
+// Short buffers give 0 and nothing past the end is touched
+static void test_overflow(void)
+{
+    gps_pos_t pos;
+    status_readings_t r;
+    gps_epoch_t e;
+    char buf[STATUS_JSON_MAX + 16];
+
+    random_inputs(&pos, &r, &e);
+    uint16_t full = status_json(buf, STATUS_JSON_MAX, &r, &e, 1234, 5678);
+    assert(full > 0);
+
+    for (uint16_t size = 0; size < full; size++) {
+        memset(buf, 0xA5, sizeof(buf));
+        assert(status_json(buf, size, &r, &e, 1234, 5678) == 0);
+        for (uint16_t i = size; i < sizeof(buf); i++) assert((uint8_t)buf[i] == 0xA5);
+    }
+    assert(status_json(buf, full, &r, &e, 1234, 5678) == full);
+}
+
+int main(void)
+{
+    test_identity();
+    test_ages();
+    test_position_ties();
+    test_longest();
+    test_overflow();
+
+    printf("test_status_json: ok\n");
+    return 0;
+}
@@ -0,0 +1,289 @@
+/* test_ubx.c - UBX frame parser and receiver setup
+ *
+ * Frames are built here with their Fletcher checksum and fed in uneven
+ * pieces, as the UART DMA hands them over. NAV-PVT is checked against
+ * what gps.c then reports (position, time reference, epoch); the parser
+ * must drop a bad checksum and a payload over UBX_MAX_PAYLOAD and then
+ * find the next frame, and must not resync on 0xB5 0x62 inside a
+ * payload. HAL_UART_Transmit_IT() is stubbed to capture the commands, so
+ * the CFG sequence can be answered with ACK-ACK or ACK-NAK.
+ */
+
+#include "ubx.h"
+#include "gps.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PVT_LEN         92
+
+static UART_HandleTypeDef huart;
+static uint8_t tx_last[64];
+static uint16_t tx_len;
+static uint32_t tx_count;
+static uint32_t baud;
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* h, const uint8_t* data, uint16_t len)
+{
+    // Sent at once: gState stays READY
+    assert(len <= sizeof(tx_last));
+    memcpy(tx_last, data, len);
+    tx_len = len;
+    tx_count++;
+    return HAL_OK;
+}
+
+static void set_baud(uint32_t b)
+{
+    baud = b;
+}
+
+static void put16(uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put32(uint8_t* p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+/**
+ * Sync, header, payload and checksum into out, return the frame length
+ */
+static uint16_t frame(uint8_t* out, uint8_t cls, uint8_t id, const uint8_t* payload, uint16_t len)
+{
+    uint8_t a = 0, b = 0;
+    out[0] = 0xB5;
+    out[1] = 0x62;
+    out[2] = cls;
+    out[3] = id;
+    put16(out + 4, len);
+    memcpy(out + 6, payload, len);
+    for (uint16_t i = 2; i < 6 + len; i++) {
+        a += out[i];
+        b += a;
+    }
+    out[6 + len] = a;
+    out[7 + len] = b;
+    return len + 8;
+}
+
+/* In pieces of 1..7 bytes */
+static void push(const uint8_t* buf, uint16_t len)
+{
+    static uint8_t n = 0;
+    for (uint16_t pos = 0; pos < len; ) {
+        uint16_t k = 1 + n++ % 7;
+        if (k > len - pos) k = len - pos;
+        ubx_push_chunk(buf + pos, k);
+        pos += k;
+    }
+}
+
+static void ack(uint8_t ok, uint8_t cls, uint8_t id)
+{
+    uint8_t p[2] = { cls, id }, b[16];
+    push(b, frame(b, 0x05, ok ? 0x01 : 0x00, p, sizeof(p)));
+}
+
+/* The last command sent was cls/id */
+static int sent(uint8_t cls, uint8_t id)
+{
+    return tx_len >= 8 && tx_last[2] == cls && tx_last[3] == id;
+}
+
+static uint32_t sent_u32(uint8_t off)
+{
+    const uint8_t* p = tx_last + 6 + off;
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Run the main loop for ms milliseconds */
+static void run(uint32_t ms)
+{
+    for (uint32_t i = 0; i <= ms; i++) {
+        ubx_process();
+        sim_tick++;
+    }
+}
+
+static void start(void)
+{
+    huart.gState = HAL_UART_STATE_READY;
+    tx_len = 0;
+    baud = 0;
+    ubx_init(&huart, set_baud);
+    assert(ubx_get_mode() == UBX_MODE_CONFIGURING);
+    run(UBX_START_DELAY_MS);
+    assert(sent(0x06, 0x01) && tx_last[6] == 0x01 && tx_last[7] == 0x07 && tx_last[8] == 1);
+}
+
+/* Probe ACK, port switch, rate ACK */
+static void configure(void)
+{
+    start();
+    ack(1, 0x06, 0x01);
+    run(1);
+    assert(sent(0x06, 0x00) && sent_u32(8) == UBX_BAUD && tx_last[6 + 14] == 0x01);
+    run(50);
+    assert(baud == UBX_BAUD && sent(0x06, 0x08) && (tx_last[6] | tx_last[7] << 8) == UBX_RATE_MS);
+    ack(1, 0x06, 0x08);
+    run(1);
+    assert(ubx_get_mode() == UBX_MODE_UBX);
+}
+
+static void test_config(void)
+{
+    // An ACK for another message is not the answer
+    start();
+    ack(1, 0x06, 0x08);
+    run(1);
+    assert(ubx_get_mode() == UBX_MODE_CONFIGURING);
+    // No NAV-PVT on this receiver: stay on NMEA
+    ack(0, 0x06, 0x01);
+    run(1);
+    assert(ubx_get_mode() == UBX_MODE_NMEA && baud == 0);
+
+    // NAK for the rate at the new speed: revert the receiver and USART1
+    start();
+    ack(1, 0x06, 0x01);
+    run(51);
+    assert(baud == UBX_BAUD);
+    uint32_t n = tx_count;
+    ack(0, 0x06, 0x08);
+    run(10);
+    assert(ubx_get_mode() == UBX_MODE_NMEA && baud == UBX_NMEA_BAUD && tx_count == n + 3);
+    assert(sent(0x06, 0x00) && sent_u32(8) == UBX_NMEA_BAUD && tx_last[6 + 14] == 0x02);
+    assert(ubx_get_stats().fallbacks == 1);
+
+    configure();
+}
+
+/* NAV-PVT payload for 2026-10-17 12:34:56.250 */
+static void pvt(uint8_t* p, uint8_t fix_type, uint8_t flags, int32_t lat, int32_t lon)
+{
+    memset(p, 0, PVT_LEN);
+    put32(p + 0, 0x62B562B5);           // iTOW: sync bytes in the payload
+    put16(p + 4, 2026);
+    p[6] = 10; p[7] = 17;
+    p[8] = 12; p[9] = 34; p[10] = 56;
+    p[11] = 0x07;                       // validDate, validTime, fullyResolved
+    put32(p + 16, 250000000);
+    p[20] = fix_type;
+    p[21] = flags;
+    p[23] = 11;
+    put32(p + 24, lon);
+    put32(p + 28, lat);
+    put32(p + 60, 5140);                // gSpeed, mm/s
+    put32(p + 64, 8440000);             // headMot, 1e-5 deg
+    put16(p + 76, 125);                 // pDOP x100
+}
+
+static void test_pvt(void)
+{
+    uint8_t p[PVT_LEN], b[PVT_LEN + 8];
+    gps_epoch_t e;
+
+    // lon 0x0862B5C0 = 14.0686784 deg has B5 62 in its bytes as well
+    pvt(p, 3, 0x03, 481173000, 0x0862B5C0);
+    uint16_t n = frame(b, 0x01, 0x07, p, sizeof(p));
+    push(b, n);
+    assert(ubx_process() == 1 && ubx_process() == 0);
+
+    gps_pos_t pos = gps_get_last_position();
+    assert(pos.valid && pos.lat_e7 == 481173000 && pos.lon_e7 == 0x0862B5C0);
+    assert(pos.fix == 2 && pos.sats == 11);
+    assert(pos.year == 2026 && pos.month == 10 && pos.day == 17 && pos.hour == 12 && pos.sec == 56);
+
+    gps_time_ref_t t = gps_get_time_ref();
+    assert(t.unix_sec == gps_unix_time(2026, 10, 17, 12, 34, 56) && t.ms == 250);
+
+    gps_get_epoch(&e);
+    uint32_t seq = e.seq;
+    assert(e.fix_mode == 3 && e.pdop == 125 && e.speed_cms == 514 && e.course_cdeg == 8440);
+    assert(e.used_count == 11 && e.ms == 250);
+
+    // No fix: time and epoch only
+    pvt(p, 0, 0x00, 0, 0);
+    push(b, frame(b, 0x01, 0x07, p, sizeof(p)));
+    assert(ubx_process() == 0);
+    gps_get_epoch(&e);
+    assert(e.seq == seq + 1 && e.fix_mode == 1);
+    assert(gps_get_last_position().lat_e7 == 481173000);
+
+    ubx_stats_t s = ubx_get_stats();
+    assert(s.pvt == 2 && s.checksum_failed == 0);
+}
+
+static void test_errors(void)
+{
+    uint8_t p[PVT_LEN], b[256 + 8];
+    ubx_stats_t s = ubx_get_stats();
+
+    pvt(p, 3, 0x01, 100000000, 200000000);
+    uint16_t n = frame(b, 0x01, 0x07, p, sizeof(p));
+
+    // Bad checksum, either byte, or a payload byte changed on the way
+    b[n - 1] ^= 0x01;
+    push(b, n);
+    b[n - 1] ^= 0x01;
+    b[n - 2] ^= 0x80;
+    push(b, n);
+    b[n - 2] ^= 0x80;
+    b[30] ^= 0x10;
+    push(b, n);
+    b[30] ^= 0x10;
+    assert(ubx_get_stats().checksum_failed == s.checksum_failed + 3);
+    assert(ubx_get_stats().pvt == s.pvt && ubx_process() == 0);
+
+    // Noise and a repeated first sync byte before a good frame
+    static const uint8_t noise[] = { '$', 'G', 0xB5, 0x00, 0x62, 0xB5, 0xB5 };
+    push(noise, sizeof(noise));
+    push(b + 1, n - 1);
+    assert(ubx_get_stats().pvt == s.pvt + 1 && ubx_process() == 1);
+
+    // Longer than UBX_MAX_PAYLOAD (NAV-SAT): dropped, the next frame is found
+    uint8_t sat[200];
+    memset(sat, 0x20, sizeof(sat));
+    uint16_t m = frame(b, 0x01, 0x35, sat, sizeof(sat));
+    push(b, m);
+    assert(ubx_get_stats().too_long == s.too_long + 1);
+    push(b, frame(b, 0x01, 0x07, p, sizeof(p)));
+    assert(ubx_get_stats().pvt == s.pvt + 2 && ubx_process() == 1);
+
+    // An ACK inside a NAV-PVT payload is payload, not an ACK
+    uint8_t inner[10];
+    uint8_t a[2] = { 0x06, 0x08 };
+    frame(inner, 0x05, 0x01, a, sizeof(a));
+    memcpy(p + 40, inner, sizeof(inner));
+    push(b, frame(b, 0x01, 0x07, p, sizeof(p)));
+    s = ubx_get_stats();
+    assert(s.frames == s.pvt + 2 && s.checksum_failed == 3 && s.too_long == 1);
+
+    // Sentences between frames (NMEA stays on at 9600) are skipped
+    static const char gga[] = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+    push((const uint8_t*)gga, sizeof(gga) - 1);
+    push(b, frame(b, 0x01, 0x07, p, sizeof(p)));
+    assert(ubx_get_stats().pvt == s.pvt + 1 && ubx_get_stats().checksum_failed == 3);
+}
+
+static void test_timeout(void)
+{
+    // NAV-PVT stops: back to NMEA, then set up again
+    run(UBX_PVT_TIMEOUT_MS + 10);
+    assert(ubx_get_stats().fallbacks == 1 && baud == UBX_NMEA_BAUD);
+    assert(ubx_get_mode() == UBX_MODE_CONFIGURING);
+    run(UBX_START_DELAY_MS);
+    assert(sent(0x06, 0x01));
+}
+
+int main(void)
+{
+    gps_init();
+
+    test_config();
+    test_pvt();
+    test_errors();
+    test_timeout();
+
+    ubx_stats_t s = ubx_get_stats();
+    printf("ubx: %u frames, %u NAV-PVT, %u checksum failed, %u too long\n",
+           s.frames, s.pvt, s.checksum_failed, s.too_long);
+    printf("test_ubx: ok\n");
+    return 0;
+}
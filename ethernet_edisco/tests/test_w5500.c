@@ -0,0 +1,142 @@
+/* test_w5500.c - W5500 SPI framing: register access, buffer bursts and TX DMA */
+
+#include "w5500.h"
+#include "wizchip_conf.h"
+#include "w5500_sim.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static void test_registers(void)
+{
+    W5500_WRITE_REG(W5500_RTR0, 0x12);
+    W5500_WRITE_REG(W5500_RTR0 + 1, 0x34);
+    assert(W5500_READ_REG(W5500_RTR0) == 0x12);
+    assert(W5500_READ_REG16(W5500_RTR0) == 0x1234);
+    assert(sim_common[W5500_RTR0 + 1] == 0x34);
+
+    W5500_WRITE_REG(W5500_Sn_PORT0(5), 0x00);
+    W5500_WRITE_REG(W5500_Sn_PORT0(5) + 1, 0x50);
+    assert(sim_reg16(5, 0x04) == 80);
+    assert(sim_reg16(4, 0x04) == 0);
+}
+
+/**
+ * Read a socket buffer block straight from the stand-in, one raw frame
+ */
+static void raw_read(uint8_t bsb, uint16_t offset, uint8_t* buf, uint16_t len)
+{
+    uint8_t h[3] = { offset >> 8, offset & 0xFF, bsb << 3 };
+
+    wizchip_select();
+    wiz_spi_writeburst(h, 3);
+    wiz_spi_readburst(buf, len);
+    wizchip_deselect();
+}
+
+static void test_bursts(void)
+{
+    // Either side of the single-burst limit and the largest buffer
+    static const uint16_t sizes[] = { 1, 2, 31, 32, 33, 700, 2048 };
+    static uint8_t out[2048], in[2048];
+
+    for (uint16_t i = 0; i < sizeof(out); i++) out[i] = (uint8_t)(i * 7 + 3);
+
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        uint16_t len = sizes[k];
+        uint16_t offset = 2048 - len;
+
+        // Header and payload go out under one chip select
+        uint32_t frames = sim_stats.frames;
+        W5500_WRITE_TXBUF(6, offset, out, len);
+        assert(sim_stats.frames - frames == 1);
+
+        memset(in, 0, sizeof(in));
+        raw_read(2 + 6 * 4, offset, in, len);
+        assert(memcmp(in, out, len) == 0);
+
+        // RX ring of socket 6 starts empty at pointer 0
+        sim_set_reg16(6, 0x28, 0);
+        sim_set_reg16(6, 0x2A, 0);
+        assert(sim_tcp_inject(6, out, len) == len);
+
+        memset(in, 0, sizeof(in));
+        frames = sim_stats.frames;
+        W5500_READ_RXBUF(6, 0, in, len);
+        assert(sim_stats.frames - frames == 1);
+        assert(memcmp(in, out, len) == 0);
+    }
+}
+
+static int dma_status;
+static uint32_t dma_calls;
+
+static void dma_done(void* ctx, int status)
+{
+    assert(ctx == &dma_status);
+    dma_status = status;
+    dma_calls++;
+}
+
+static void dma_irq_on_tick(void)
+{
+    sim_dma_irq();
+}
+
+static void test_dma(void)
+{
+    static uint8_t out[700], in[700];
+
+    for (uint16_t i = 0; i < sizeof(out); i++) out[i] = (uint8_t)(i * 5 + 1);
+
+    // Returns at once, the data and the callback follow with the interrupt
+    sim_hold_dma(1);
+    uint32_t frames = sim_stats.frames;
+    assert(W5500_WRITE_TXBUF_DMA(4, 1000, out, sizeof(out), dma_done, &dma_status) == 0);
+    assert(sim_dma_pending() && dma_calls == 0);
+    assert(W5500_WRITE_TXBUF_DMA(4, 0, out, 64, dma_done, &dma_status) == -2);
+    sim_dma_irq();
+    assert(dma_calls == 1 && dma_status == 0 && sim_stats.frames - frames == 1);
+    raw_read(2 + 4 * 4, 1000, in, sizeof(in));
+    assert(memcmp(in, out, sizeof(in)) == 0);
+
+    // Out of range: blocking path only
+    assert(W5500_WRITE_TXBUF_DMA(4, 0, out, W5500_DMA_MIN_LEN - 1, dma_done, &dma_status) == -1);
+    assert(W5500_WRITE_TXBUF_DMA(4, 0, out, W5500_DMA_MAX_LEN + 1, dma_done, &dma_status) == -1);
+
+    // A register access waits for the transfer before selecting the chip
+    assert(W5500_WRITE_TXBUF_DMA(4, 0, out, 64, dma_done, &dma_status) == 0);
+    sim_tick_hook = dma_irq_on_tick;
+    assert(W5500_READ_REG(W5500_RTR0) == 0x12);
+    sim_tick_hook = NULL;
+    assert(dma_calls == 2 && dma_status == 0);
+
+    // A transfer that never completes is aborted and reported once
+    assert(W5500_WRITE_TXBUF_DMA(4, 0, out, 64, dma_done, &dma_status) == 0);
+    sim_tick_step = 1;
+    assert(W5500_READ_REG(W5500_RTR0) == 0x12);
+    sim_tick_step = 0;
+    assert(dma_calls == 3 && dma_status == -1 && !sim_dma_pending());
+    w5500_dma_complete(0);
+    assert(dma_calls == 3);
+
+    sim_hold_dma(0);
+    assert(sim_stats.dma_overlap == 0);
+}
+
+int main(void)
+{
+    uint8_t memsize[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+
+    sim_reset();
+    assert(wizchip_init(memsize, memsize) == 0);
+    assert(wizchip_txbuf_size(3) == 2048);
+
+    test_registers();
+    test_bursts();
+    test_dma();
+
+    printf("test_w5500: ok\n");
+    return 0;
+}
@@ -0,0 +1,167 @@
+/* test_w5500_event.c - Interrupt sequences through the W5500 event layer
+ *
+ * INTn of the stand-in drives w5500_event_irq() on its falling edge, the
+ * way EXTI4 does on the board.
+ */
+
+#include "w5500_event.h"
+#include "w5500.h"
+#include "wizchip_conf.h"
+#include "w5500_sim.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+static uint8_t seen[8];
+static uint32_t calls[8];
+static uint32_t frame_no;
+
+static void handler(uint8_t sn, uint8_t events)
+{
+    seen[sn] |= events;
+    calls[sn]++;
+}
+
+// Socket 0 receives right after SIR was read
+static void recv_after_sir(void)
+{
+    if (++frame_no == 2) sim_raise(0, W5500_Sn_IR_RECV);
+}
+
+static void clear_seen(void)
+{
+    memset(seen, 0, sizeof(seen));
+    memset(calls, 0, sizeof(calls));
+}
+
+static void test_idle_is_silent(void)
+{
+    w5500_event_process();      // Startup pass, pending after init
+    uint32_t frames = sim_stats.frames;
+    for (int i = 0; i < 1000; i++) assert(w5500_event_process() == 0);
+    assert(sim_stats.frames == frames);
+}
+
+static void test_single_event(void)
+{
+    clear_seen();
+    uint32_t irqs = w5500_event_irq_count();
+
+    sim_raise(3, W5500_Sn_IR_RECV);
+    assert(w5500_event_irq_count() == irqs + 1);
+
+    // Three frames: SIR, Sn_IR and its clear; INTn is a GPIO read
+    uint32_t frames = sim_stats.frames;
+    assert(w5500_event_process() == 1);
+    assert(sim_stats.frames - frames == 3);
+    assert(seen[3] == W5500_Sn_IR_RECV && calls[3] == 1);
+    assert(sim_reg(3, 0x02) == 0 && !sim_int_asserted());
+}
+
+static void test_burst_on_several_sockets(void)
+{
+    clear_seen();
+
+    // CON, then data, then FIN on one socket plus a datagram on another,
+    // all before the loop gets round to it: one edge, one dispatch each
+    sim_raise(4, W5500_Sn_IR_CON);
+    sim_raise(4, W5500_Sn_IR_RECV);
+    sim_raise(0, W5500_Sn_IR_RECV);
+    sim_raise(4, W5500_Sn_IR_DISCON);
+
+    assert(w5500_event_process() == 2);
+    assert(seen[4] == (W5500_Sn_IR_CON | W5500_Sn_IR_RECV | W5500_Sn_IR_DISCON));
+    assert(calls[4] == 1 && seen[0] == W5500_Sn_IR_RECV);
+    assert(!sim_int_asserted());
+}
+
+static void test_event_during_dispatch(void)
+{
+    clear_seen();
+
+    // INTn never goes high between the two events, so there is no second
+    // edge; process() has to notice the line and go round again
+    uint32_t irqs = w5500_event_irq_count();
+
+    sim_raise(3, W5500_Sn_IR_RECV);
+    frame_no = 0;
+    sim_select_hook = recv_after_sir;
+    assert(w5500_event_process() == 1 && seen[0] == 0);
+    sim_select_hook = NULL;
+    assert(w5500_event_irq_count() == irqs + 1);
+    assert(w5500_event_process() == 1 && seen[0] == W5500_Sn_IR_RECV);
+    assert(w5500_event_process() == 0);
+}
+
+static void test_unowned_flags(void)
+{
+    clear_seen();
+
+    // SENDOK belongs to socket.c: not unmasked, not cleared, no interrupt
+    sim_raise(3, W5500_Sn_IR_SENDOK);
+    assert(!sim_int_asserted());
+    assert(w5500_event_process() == 0);
+    assert(sim_reg(3, 0x02) == W5500_Sn_IR_SENDOK);
+    sim_set_reg(3, 0x02, 0);
+
+    // Socket 5 has no handler
+    sim_raise(5, W5500_Sn_IR_RECV);
+    assert(!sim_int_asserted());
+    assert(w5500_event_process() == 0 && calls[5] == 0);
+
+    // A flag already pending when the handler is registered
+    uint32_t irqs = w5500_event_irq_count();
+    w5500_event_register(5, W5500_Sn_IR_RECV, handler);
+    assert(w5500_event_irq_count() == irqs + 1);
+    assert(w5500_event_process() == 1 && seen[5] == W5500_Sn_IR_RECV);
+
+    // Unregistering masks the socket again
+    w5500_event_register(5, 0, NULL);
+    sim_raise(5, W5500_Sn_IR_RECV);
+    assert(!sim_int_asserted());
+    assert(w5500_event_process() == 0);
+}
+
+static void test_timeout(void)
+{
+    clear_seen();
+
+    w5500_event_register(1, W5500_EVT_ALL, handler);
+    sim_raise(1, W5500_Sn_IR_TIMEOUT);
+    assert(w5500_event_process() == 1 && seen[1] == W5500_Sn_IR_TIMEOUT);
+
+    // With all flags unmasked SENDOK is delivered and cleared too
+    sim_raise(1, W5500_Sn_IR_SENDOK);
+    assert(w5500_event_process() == 1 && seen[1] & W5500_Sn_IR_SENDOK);
+    assert(sim_reg(1, 0x02) == 0);
+}
+
+int main(void)
+{
+    uint8_t memsize[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+
+    sim_reset();
+    sim_int_edge = w5500_event_irq;
+    assert(wizchip_init(memsize, memsize) == 0);
+
+    w5500_event_init();
+    for (uint8_t sn = 0; sn < 8; sn++) assert(sim_reg(sn, 0x2C) == 0);
+    assert(sim_common[W5500_SIMR] == 0);
+
+    w5500_event_register(0, W5500_Sn_IR_RECV, handler);
+    w5500_event_register(3, W5500_Sn_IR_CON | W5500_Sn_IR_RECV | W5500_Sn_IR_DISCON, handler);
+    w5500_event_register(4, W5500_Sn_IR_CON | W5500_Sn_IR_RECV | W5500_Sn_IR_DISCON, handler);
+    assert(sim_common[W5500_SIMR] == 0x19);
+    assert(sim_reg(3, 0x2C) == (W5500_Sn_IR_CON | W5500_Sn_IR_RECV | W5500_Sn_IR_DISCON));
+
+    test_idle_is_silent();
+    test_single_event();
+    test_burst_on_several_sockets();
+    test_event_during_dispatch();
+    test_unowned_flags();
+    test_timeout();
+
+    printf("test_w5500_event: ok\n");
+    return 0;
+}
@@ -0,0 +1,419 @@
+/* test_websocket.c - Scripted /ws client: read-only commands and push cost
+ *
+ * A client upgrades a pool connection to a WebSocket and sends CLI
+ * commands as masked text frames: the read-only ones are answered,
+ * REBOOT and BME changes are refused unless built with CLI_REMOTE_WRITE.
+ * Then the same run of telemetry updates is delivered once as pushed
+ * binary records and once by polling /status over a keep-alive connection,
+ * and the bytes per update of both are compared: payload plus frame
+ * headers for every data segment and connection setup/teardown (pure ACKs
+ * are left out, they favour neither side much).
+ *
+ * The CLI runs for real; the sensors, BME280 and NTP it reports on are
+ * stubbed below.
+ */
+
+#define _GNU_SOURCE     // memmem
+#include "websocket.h"
+#include "http_server.h"
+#include "cli.h"
+#include "bme.h"
+#include "sensors.h"
+#include "i2c_bus.h"
+#include "ntp.h"
+#include "nmea.h"
+#include "ubx.h"
+#include "status_json.h"
+#include "usart.h"
+#include "socket.h"
+#include "w5500.h"
+#include "w5500_event.h"
+#include "wizchip_conf.h"
+#include "w5500_sim.h"
+#include "hal_sim.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UPDATES         200
+#define RECORD_LEN      26      // Telemetry record main.c pushes
+#define TCP_OVERHEAD    54      // Ethernet + IPv4 + TCP headers per segment
+#define TCP_OPEN_CLOSE  7       // SYN, SYN-ACK, ACK, and FIN, ACK both ways
+
+/* ---- What the CLI reports on ---- */
+
+UART_HandleTypeDef huart1;
+gps_pos_t gps_data = { .lat_e7 = 523456789, .lon_e7 = -12345678, .fix = 1, .sats = 9 };
+
+static bme280_profile_t profile = { .name = "default", .osrs_t = 1, .osrs_p = 1, .osrs_h = 1,
+                                    .mode = BME280_MODE_FORCED, .period_ms = 1000 };
+static uint32_t profile_changes;
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* h, const uint8_t* d, uint16_t n, uint32_t t)
+{
+    (void)h; (void)d; (void)n; (void)t;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive(UART_HandleTypeDef* h, uint8_t* d, uint16_t n, uint32_t t)
+{
+    (void)h; (void)d; (void)n; (void)t;
+    return HAL_TIMEOUT;
+}
+
+int bme280_set_profile(const bme280_profile_t* p)
+{
+    profile = *p;
+    profile_changes++;
+    return 0;
+}
+
+int bme280_set_preset(const char* name)
+{
+    (void)name;
+    profile_changes++;
+    return 0;
+}
+
+const bme280_profile_t* bme280_preset(uint8_t i)
+{
+    return i == 0 ? &profile : NULL;
+}
+
+void bme280_get_profile(bme280_profile_t* out)
+{
+    *out = profile;
+}
+
+void bme280_profile_info(const bme280_profile_t* p, bme280_profile_info_t* out)
+{
+    (void)p;
+    memset(out, 0, sizeof(*out));
+}
+
+void i2c_bus_get_stats(i2c_bus_stats_t* out)
+{
+    memset(out, 0, sizeof(*out));
+}
+
+void ntp_get_stats(ntp_stats_t* out)
+{
+    memset(out, 0, sizeof(*out));
+    out->ref_age_ms = UINT32_MAX;
+}
+
+nmea_stats_t nmea_get_stats(void)
+{
+    return (nmea_stats_t){ .lines = 1980, .valid = 1977, .epochs = 180 };
+}
+
+ubx_mode_t ubx_get_mode(void)
+{
+    return UBX_MODE_NMEA;
+}
+
+ubx_stats_t ubx_get_stats(void)
+{
+    return (ubx_stats_t){ .fallbacks = 1 };
+}
+
+sensor_sample_t sensors_get(sensor_qty_t q)
+{
+    (void)q;
+    return (sensor_sample_t){ 0 };
+}
+
+uint32_t sensors_stale_ms(sensor_qty_t q)
+{
+    (void)q;
+    return 3000;
+}
+
+int sensors_info(uint8_t index, sensor_info_t* out)
+{
+    (void)index; (void)out;
+    return 0;
+}
+
+int32_t sensors_tenths(sensor_qty_t q)
+{
+    static const int32_t v[SENSOR_QTY_COUNT] = { 215, 10132, 456, 3120 };
+    return v[q];
+}
+
+int sensors_format_tenths(char* buf, uint16_t size, int32_t tenths)
+{
+    return snprintf(buf, size, "%ld.%ld", (long)(tenths / 10), (long)labs(tenths % 10));
+}
+
+/* ---- Firmware side ---- */
+
+static gps_epoch_t epoch = { .fix_mode = 3, .pdop = 180, .hdop = 95, .vdop = 150,
+                             .course_cdeg = 0xFFFF, .in_view = 14, .used_count = 9 };
+
+// Same shape as main.c's /status
+static uint16_t status_handler(const http_request_t* req, char* out, uint16_t out_size,
+                               const uint8_t** body, uint16_t* body_len)
+{
+    (void)body; (void)body_len;
+    status_readings_t r = { .pos = &gps_data };
+    char json_buf[STATUS_JSON_MAX];
+
+    for (uint8_t q = 0; q < SENSOR_QTY_COUNT; q++) r.env_tenths[q] = sensors_tenths(q);
+    uint16_t len = status_json(json_buf, sizeof(json_buf), &r, &epoch, 420, 180);
+    uint16_t n = http_write_head(out, out_size, "200 OK", "application/json", len,
+                                 req->keep_alive,
+                                 "Access-Control-Allow-Origin: *\r\n"
+                                 "Cache-Control: no-cache\r\n");
+    assert(len && n && n + len <= out_size);
+    memcpy(out + n, json_buf, len);
+    return n + len;
+}
+
+static uint16_t ws_command(const char* cmd, char* reply, uint16_t reply_size)
+{
+    return cli_run(cmd, reply, reply_size);
+}
+
+static const http_route_t routes[] = {
+    { HTTP_METHOD_GET, "/status", status_handler },
+    { HTTP_METHOD_GET, "/ws",     websocket_handler },
+};
+
+static void run_loop(int passes)
+{
+    for (int i = 0; i < passes; i++) {
+        w5500_event_process();
+        socket_cmd_process();
+        http_server_process();
+        sim_tick++;
+    }
+}
+
+/* ---- Client ---- */
+
+// What a browser sends for fetch("/status") on the dashboard page
+static const char poll_request[] =
+    "GET /status HTTP/1.1\r\n"
+    "Host: 192.168.1.50\r\n"
+    "Connection: keep-alive\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+    "Chrome/120.0 Safari/537.36\r\n"
+    "Accept: */*\r\n"
+    "Referer: http://192.168.1.50/\r\n"
+    "Accept-Encoding: gzip, deflate\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "\r\n";
+
+static const char ws_request[] =
+    "GET /ws HTTP/1.1\r\n"
+    "Host: 192.168.1.50\r\n"
+    "Connection: Upgrade\r\n"
+    "Upgrade: websocket\r\n"
+    "Origin: http://192.168.1.50\r\n"
+    "Sec-WebSocket-Version: 13\r\n"
+    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+    "\r\n";
+
+static uint8_t listening_socket(void)
+{
+    for (uint8_t sn = HTTP_POOL_FIRST; sn < HTTP_POOL_FIRST + HTTP_POOL_SIZE; sn++) {
+        if (sim_reg(sn, 0x03) == W5500_SR_SOCK_LISTEN) return sn;
+    }
+    assert(!"no listening socket");
+    return 0;
+}
+
+static uint8_t ws_connect(void)
+{
+    uint8_t sn = listening_socket();
+    sim_wire_len[sn] = 0;
+    sim_tcp_connect(sn);
+    assert(sim_tcp_inject(sn, ws_request, sizeof(ws_request) - 1) == sizeof(ws_request) - 1);
+    run_loop(4);
+
+    const char* r = (const char*)sim_wire[sn];
+    assert(memcmp(r, "HTTP/1.1 101 ", 13) == 0);
+    assert(memmem(r, sim_wire_len[sn], "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n", 52));
+    assert(websocket_clients() == 1);
+    return sn;
+}
+
+static void ws_send_text(uint8_t sn, const char* text)
+{
+    static const uint8_t mask[4] = { 0x37, 0xFA, 0x21, 0x3D };
+    uint8_t f[8 + WS_MAX_MESSAGE];
+    uint16_t n = strlen(text), k = 0;
+
+    assert(n <= 125);
+    f[k++] = 0x81;
+    f[k++] = 0x80 | n;
+    memcpy(f + k, mask, 4);
+    k += 4;
+    for (uint16_t i = 0; i < n; i++) f[k++] = text[i] ^ mask[i & 3];
+    assert(sim_tcp_inject(sn, f, k) == k);
+}
+
+/**
+ * Send a command, return the text frame that answers it (NUL terminated)
+ */
+static const char* ws_command_reply(uint8_t sn, const char* cmd)
+{
+    static char text[WS_OUT_SIZE + 1];
+
+    sim_wire_len[sn] = 0;
+    ws_send_text(sn, cmd);
+    run_loop(4);
+
+    const uint8_t* f = sim_wire[sn];
+    uint16_t len = f[1], hdr = 2;
+    assert(sim_wire_len[sn] >= 2 && f[0] == 0x81);
+    if (len == 126) {
+        len = (f[2] << 8) | f[3];
+        hdr = 4;
+    }
+    assert(sim_wire_len[sn] == hdr + len);
+    memcpy(text, f + hdr, len);
+    text[len] = '\0';
+    return text;
+}
+
+static void test_commands(void)
+{
+    uint8_t sn = ws_connect();
+
+    assert(strstr(ws_command_reply(sn, "help"), "REBOOT"));
+    // Whole reports fit one reply, counters included
+    const char* r = ws_command_reply(sn, "status");
+    assert(strstr(r, "=== Sensor Status ===") && strstr(r, "Receiver: NMEA"));
+    assert(strstr(r, "NMEA: 1977/1980 ok") && strstr(r, "====================\r\n"));
+    r = ws_command_reply(sn, "net");
+    assert(strstr(r, "=== Network Status ===") && strstr(r, "  SEND "));
+    assert(strstr(r, "====================\r\n"));
+    assert(strstr(ws_command_reply(sn, "ntp"), "=== NTP Server ==="));
+    assert(strstr(ws_command_reply(sn, "bme"), "=== BME280 Profile ==="));
+
+    // Mutating commands are refused and have no effect
+    r = ws_command_reply(sn, "reboot");
+    assert(strstr(r, "Not allowed") && sim_resets == 0);
+    r = ws_command_reply(sn, "BME SET 16 16 16 16 1000 NORMAL 2000");
+    assert(strstr(r, "Not allowed") && profile_changes == 0 && profile.osrs_t == 1);
+    r = ws_command_reply(sn, "bme weather");
+    assert(strstr(r, "Not allowed") && profile_changes == 0);
+
+    assert(strstr(ws_command_reply(sn, "nonsense"), "Unknown command"));
+
+    sim_tcp_peer_close(sn);
+    run_loop(4);
+    assert(websocket_clients() == 0);
+}
+
+typedef struct {
+    uint32_t down;          // Server to client payload
+    uint32_t up;            // Client to server payload
+    uint32_t segments;      // Data segments either way
+} traffic_t;
+
+static uint32_t on_wire(const traffic_t* t)
+{
+    return t->down + t->up + t->segments * TCP_OVERHEAD;
+}
+
+static void test_push_vs_poll(void)
+{
+    traffic_t ws = { 0 }, poll = { 0 }, setup = { 0 };
+    uint8_t rec[RECORD_LEN];
+
+    // Push: one handshake, then a binary frame per update
+    uint32_t sends = sim_stats.sends;
+    uint8_t sn = ws_connect();
+    setup.up = sizeof(ws_request) - 1;
+    setup.down = sim_wire_len[sn];
+    setup.segments = TCP_OPEN_CLOSE + 1 + (sim_stats.sends - sends);
+
+    for (uint32_t u = 0; u < UPDATES; u++) {
+        sim_tick += 1000;
+        memset(rec, (uint8_t)u, sizeof(rec));
+        rec[0] = 1;
+        sim_wire_len[sn] = 0;
+        sends = sim_stats.sends;
+        assert(websocket_publish(rec, sizeof(rec)) == 1);
+        run_loop(2);
+
+        // Unmasked binary frame with the record
+        assert(sim_wire_len[sn] == 2 + RECORD_LEN);
+        assert(sim_wire[sn][0] == 0x82 && sim_wire[sn][1] == RECORD_LEN);
+        assert(memcmp(sim_wire[sn] + 2, rec, RECORD_LEN) == 0);
+        ws.down += sim_wire_len[sn];
+        ws.segments += sim_stats.sends - sends;
+    }
+    sim_tcp_peer_close(sn);
+    run_loop(4);
+
+    // Poll: GET /status per update over keep-alive connections, a new one
+    // whenever the server closes after HTTP_MAX_REQUESTS
+    uint8_t open = 0;
+    for (uint32_t u = 0; u < UPDATES; u++) {
+        sim_tick += 1000;
+        if (!open) {
+            sn = listening_socket();
+            sim_tcp_connect(sn);
+            poll.segments += TCP_OPEN_CLOSE;
+            open = 1;
+        }
+        sim_wire_len[sn] = 0;
+        sends = sim_stats.sends;
+        assert(sim_tcp_inject(sn, poll_request, sizeof(poll_request) - 1) == sizeof(poll_request) - 1);
+        run_loop(4);
+
+        const char* r = (const char*)sim_wire[sn];
+        const char* end = memmem(r, sim_wire_len[sn], "\r\n\r\n", 4);
+        assert(memcmp(r, "HTTP/1.1 200 OK\r\n", 17) == 0 && end);
+        assert(sim_wire_len[sn] == (end + 4 - r) + atoi(strstr(r, "Content-Length: ") + 16));
+        poll.up += sizeof(poll_request) - 1;
+        poll.down += sim_wire_len[sn];
+        poll.segments += 1 + (sim_stats.sends - sends);
+
+        if (memmem(r, end - r, "Connection: close", 17)) {
+            sim_tcp_peer_close(sn);
+            run_loop(4);
+            open = 0;
+        }
+    }
+    if (open) {
+        sim_tcp_peer_close(sn);
+        run_loop(4);
+    }
+
+    double ws_per = (double)(on_wire(&ws) + on_wire(&setup)) / UPDATES;
+    double poll_per = (double)on_wire(&poll) / UPDATES;
+    printf("%u updates, bytes per update (payload down/up, with %u B per segment)\n",
+           UPDATES, TCP_OVERHEAD);
+    printf("  /ws push     %6.1f / %5.1f   %7.1f   (handshake %u B amortised)\n",
+           (double)(ws.down + setup.down) / UPDATES, (double)setup.up / UPDATES, ws_per,
+           on_wire(&setup));
+    printf("  /status poll %6.1f / %5.1f   %7.1f\n",
+           (double)poll.down / UPDATES, (double)poll.up / UPDATES, poll_per);
+    printf("  push is %.1fx less traffic\n", poll_per / ws_per);
+    assert(ws_per * 5 < poll_per);
+}
+
+int main(void)
+{
+    uint8_t memsize[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+
+    sim_reset();
+    sim_int_edge = w5500_event_irq;
+    assert(wizchip_init(memsize, memsize) == 0);
+    w5500_event_init();
+    websocket_init(ws_command);
+    http_server_init(routes, sizeof(routes) / sizeof(routes[0]));
+    run_loop(5);
+
+    test_commands();
+    test_push_vs_poll();
+
+    printf("test_websocket: ok\n");
+    return 0;
+}
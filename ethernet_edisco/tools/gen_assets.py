@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Pack the dashboard files in web/ into const flash arrays.
+
+Writes Core/Src/web_assets.c with, for every file, the raw bytes, a gzip
+copy (served when the client sends Accept-Encoding: gzip) and a strong
+ETag per representation. Run from anywhere after editing web/:
+
+    python3 tools/gen_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+WEB_DIR = os.path.join(ROOT, "web")
+OUT_C = os.path.join(ROOT, "Core", "Src", "web_assets.c")
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".png": "image/png",
+}
+
+
+def c_ident(name):
+    return re.sub(r"[^0-9A-Za-z]", "_", name)
+
+
+def c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "static const uint8_t %s[%d] = {\n%s\n};\n" % (name, len(data), "\n".join(lines))
+
+
+def c_string(s):
+    return '"%s"' % s.replace("\\", "\\\\").replace('"', '\\"')
+
+
+def etag(data):
+    return '"%s"' % hashlib.sha256(data).hexdigest()[:16]
+
+
+def main():
+    assets = []
+    for fname in sorted(os.listdir(WEB_DIR)):
+        path = os.path.join(WEB_DIR, fname)
+        if not os.path.isfile(path):
+            continue
+        ext = os.path.splitext(fname)[1].lower()
+        with open(path, "rb") as f:
+            raw = f.read()
+        # mtime=0 keeps the output (and so the ETag) reproducible
+        gz = gzip.compress(raw, compresslevel=9, mtime=0)
+        assets.append((fname, CONTENT_TYPES.get(ext, "application/octet-stream"), raw, gz))
+
+    out = []
+    out.append("/* web_assets.c - generated by tools/gen_assets.py from web/, do not edit */\n\n")
+    out.append('#include "web_assets.h"\n\n')
+    for fname, _, raw, gz in assets:
+        ident = c_ident(fname)
+        out.append(c_array(ident + "_raw", raw) + "\n")
+        out.append(c_array(ident + "_gz", gz) + "\n")
+
+    out.append("const web_asset_t web_assets[] = {\n")
+    for fname, ctype, raw, gz in assets:
+        ident = c_ident(fname)
+        out.append('    { "/%s", "%s",\n' % (fname, ctype))
+        out.append("      %s_raw, sizeof(%s_raw), %s,\n" % (ident, ident, c_string(etag(raw))))
+        out.append("      %s_gz, sizeof(%s_gz), %s },\n" % (ident, ident, c_string(etag(gz))))
+    out.append("};\n\n")
+    out.append("const uint8_t web_asset_count = sizeof(web_assets) / sizeof(web_assets[0]);\n")
+
+    with open(OUT_C, "w", newline="\n") as f:
+        f.write("".join(out))
+
+    for fname, _, raw, gz in assets:
+        print("%-20s %6d -> %6d bytes gzip" % (fname, len(raw), len(gz)))
+
+
+if __name__ == "__main__":
+    main()